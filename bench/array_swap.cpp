@@ -0,0 +1,155 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Encode / decode time of numeric arrays, for each array type.
+//
+// Usage: bench_array_swap [nb_elements [nb_iterations]]
+//
+// The Packet API is compared with a per element conversion loop
+// (what the library did before the bulk conversion kernels).
+// Run it with SEDNL_NO_SIMD=1 to measure the scalar kernels.
+
+#include "SEDNL/Packet.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+using namespace SedNL;
+
+typedef std::chrono::steady_clock Clock;
+
+//Keep the compiler from removing the benchmarked code.
+static volatile unsigned int sink;
+
+//Per element loop, with a push_back for each byte.
+template<typename T>
+static void reference_encode(ByteArray& data, const std::vector<T>& v)
+{
+    data.push_back(0);
+    data.push_back(static_cast<Byte>(v.size() >> 8));
+    data.push_back(static_cast<Byte>(v.size()));
+    for (auto elm : v)
+    {
+        const Byte* bytes = reinterpret_cast<const Byte*>(&elm);
+        for (int i = sizeof(T) - 1; i >= 0; i--)
+            data.push_back(bytes[i]);
+    }
+}
+
+template<typename T>
+static void reference_decode(const ByteArray& data, std::vector<T>& v)
+{
+    const unsigned int length = (data[1] << 8) | data[2];
+    v.clear();
+    for (unsigned int i = 0; i < length; i++)
+    {
+        T elm;
+        Byte* bytes = reinterpret_cast<Byte*>(&elm);
+        for (unsigned int j = 0; j < sizeof(T); j++)
+            bytes[j] = data[3 + i * sizeof(T) + sizeof(T) - 1 - j];
+        v.push_back(elm);
+    }
+}
+
+template<typename F>
+static double ns_per_element(F f, int iterations, std::size_t n)
+{
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    const auto end = Clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count()
+        / (static_cast<double>(iterations) * n);
+}
+
+template<typename T>
+static void bench(const char* name, std::size_t n, int iterations)
+{
+    std::vector<T> v(n);
+    for (std::size_t i = 0; i < n; i++)
+        v[i] = static_cast<T>(i * 3);
+
+    const double ref_enc = ns_per_element([&]() {
+            ByteArray data;
+            reference_encode(data, v);
+            sink = data.back();
+        }, iterations, n);
+
+    const double enc = ns_per_element([&]() {
+            Packet p;
+            p << v;
+            sink = p.get_data().back();
+        }, iterations, n);
+
+    ByteArray data;
+    reference_encode(data, v);
+    const double ref_dec = ns_per_element([&]() {
+            std::vector<T> u;
+            reference_decode(data, u);
+            sink = u.size();
+        }, iterations, n);
+
+    Packet p;
+    p << v;
+    const double dec = ns_per_element([&]() {
+            std::vector<T> u;
+            PacketReader(p) >> u;
+            sink = u.size();
+        }, iterations, n);
+
+    std::cout << std::setw(8) << name << std::fixed << std::setprecision(3)
+              << " | encode " << std::setw(7) << enc << " ns (loop "
+              << std::setw(7) << ref_enc << ", x" << std::setprecision(1)
+              << ref_enc / enc << ")" << std::setprecision(3)
+              << " | decode " << std::setw(7) << dec << " ns (loop "
+              << std::setw(7) << ref_dec << ", x" << std::setprecision(1)
+              << ref_dec / dec << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t n = argc > 1 ? atoi(argv[1]) : 30000;
+    const int iterations = argc > 2 ? atoi(argv[2]) : 2000;
+
+    if (n == 0 || n > 65535)
+    {
+        std::cerr << "Arrays hold from 1 to 65535 elements" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << n << " elements, " << iterations << " iterations"
+              << (getenv("SEDNL_NO_SIMD") ? ", scalar kernels" : "")
+              << " (time per element)" << std::endl;
+
+    bench<Int16>("Int16", n, iterations);
+    bench<UInt16>("UInt16", n, iterations);
+    bench<Int32>("Int32", n, iterations);
+    bench<UInt32>("UInt32", n, iterations);
+    bench<Int64>("Int64", n, iterations);
+    bench<UInt64>("UInt64", n, iterations);
+    bench<float>("Float", n, iterations);
+    bench<double>("Double", n, iterations);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Compression ratio and CPU time of compressed events (see
+// Connection::set_compression()), for each codec and a few payloads,
+// sent through a loopback connection.
+//
+// Usage: bench_compression [nb_events]
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+using namespace SedNL;
+
+static double us_per_event(std::chrono::nanoseconds time, UInt64 events)
+{
+    if (events == 0)
+        return 0;
+    return std::chrono::duration<double, std::micro>(time).count() / events;
+}
+
+static void bench(Compression codec, const char* name,
+                  const Packet& packet, int events)
+{
+    SocketAddress addr(23459, "127.0.0.1");
+    TCPServer server(addr, true);
+    EventListener server_listener(server);
+    EventConsumer consumer(server_listener);
+
+    std::atomic<int> received(0);
+    std::atomic<Connection*> server_cn(nullptr);
+    consumer.bind("payload").set_function([&](Connection& c, const Event&) {
+            server_cn = &c;
+            received++;
+        });
+    server_listener.run();
+    consumer.run();
+
+    TCPClient client(addr);
+    //zlib falls back to LZ if it isn't available
+    const bool available = client.set_compression(codec, 0);
+    for (int i = 0; i < events; i++)
+        client.send("payload", packet);
+
+    while (received < events)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    //Received statistics are updated after the events are queued
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    const CompressionStats sent = client.get_compression_stats();
+    const CompressionStats recv = server_cn.load()->get_compression_stats();
+
+    std::cout << std::setw(4)
+              << (codec == Compression::Zlib && available ? "zlib" : "LZ")
+              << " | " << std::setw(14) << name
+              << " | " << std::setw(6) << packet.get_data().size() << " B -> "
+              << std::setw(6) << sent.sent_bytes / events << " B"
+              << std::fixed << std::setprecision(2)
+              << " (ratio " << sent.send_ratio() << ")"
+              << " | compress " << std::setw(7)
+              << us_per_event(sent.compress_time, events) << " us"
+              << " | decompress " << std::setw(7)
+              << us_per_event(recv.decompress_time, recv.decompressed_events)
+              << " us" << std::endl;
+
+    consumer.join();
+    server_listener.join();
+    client.disconnect();
+}
+
+int main(int argc, char* argv[])
+{
+    const int events = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    //Events should fit in a connection buffer once compressed
+    std::string doc = "[";
+    for (int i = 0; i < 60; i++)
+        doc += "{\"id\":" + std::to_string(i) + ",\"name\":\"monster\",\"alive\":true},";
+    doc += "]";
+
+    std::mt19937 rng(42);
+    std::vector<Int32> sparse(900);
+    for (Int32& v : sparse)
+        v = (rng() % 20 == 0) ? rng() % 1000 : 0;
+    ByteArray noise(1000);
+    for (Byte& b : noise)
+        b = rng();
+
+    Packet p_doc, p_sparse, p_noise;
+    p_doc << doc;
+    p_sparse << sparse;
+    p_noise << Blob(noise);
+
+    for (Compression codec : {Compression::LZ, Compression::Zlib})
+    {
+        bench(codec, "JSON document", p_doc, events);
+        bench(codec, "sparse array", p_sparse, events);
+        bench(codec, "random bytes", p_noise, events);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Size and encode / decode time of delta encoded integer arrays
+// (Packet::ArrayEncoding::Delta), compared with the network encoding.
+//
+// Usage: bench_delta [nb_elements [nb_iterations]]
+
+#include "SEDNL/Packet.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+using namespace SedNL;
+
+typedef std::chrono::steady_clock Clock;
+
+//Keep the compiler from removing the benchmarked code.
+static volatile unsigned int sink;
+
+template<typename F>
+static double ns_per_element(F f, int iterations, std::size_t n)
+{
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    const auto end = Clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count()
+        / (static_cast<double>(iterations) * n);
+}
+
+template<typename T>
+static void bench(const char* name, const std::vector<T>& v, int iterations)
+{
+    auto encode = [&](Packet::ArrayEncoding encoding) {
+        Packet p;
+        p.set_array_encoding(encoding);
+        p << v;
+        return p;
+    };
+
+    const Packet network = encode(Packet::ArrayEncoding::Network);
+    const Packet delta = encode(Packet::ArrayEncoding::Delta);
+
+    const double enc = ns_per_element([&]() {
+            sink = encode(Packet::ArrayEncoding::Delta).get_data().size();
+        }, iterations, v.size());
+    const double net_enc = ns_per_element([&]() {
+            sink = encode(Packet::ArrayEncoding::Network).get_data().size();
+        }, iterations, v.size());
+
+    auto decode = [&](const Packet& p) {
+        return ns_per_element([&]() {
+                std::vector<T> u;
+                PacketReader(p) >> u;
+                sink = u.size();
+            }, iterations, v.size());
+    };
+    const double dec = decode(delta);
+    const double net_dec = decode(network);
+
+    std::cout << std::setw(12) << name
+              << " | " << std::setw(7) << delta.get_data().size() << " B"
+              << " (network " << std::setw(7) << network.get_data().size()
+              << " B, x" << std::fixed << std::setprecision(1)
+              << static_cast<double>(network.get_data().size())
+                 / delta.get_data().size() << ")"
+              << std::setprecision(2)
+              << " | encode " << std::setw(6) << enc << " ns (network "
+              << std::setw(6) << net_enc << ")"
+              << " | decode " << std::setw(6) << dec << " ns (network "
+              << std::setw(6) << net_dec << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t n = argc > 1 ? atoi(argv[1]) : 30000;
+    const int iterations = argc > 2 ? atoi(argv[2]) : 2000;
+
+    if (n == 0 || n > 65535)
+    {
+        std::cerr << "Arrays hold from 1 to 65535 elements" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << n << " elements, " << iterations << " iterations"
+              << " (time per element)" << std::endl;
+
+    std::mt19937 gen(42);
+
+    //Milliseconds timestamps, about 60 per second
+    std::vector<Int64> timestamps(n);
+    Int64 t = 1400000000000LL;
+    for (auto& v : timestamps)
+        v = (t += 16 + gen() % 3);
+    bench("timestamps", timestamps, iterations);
+
+    //Sorted ids, with holes
+    std::vector<UInt32> ids(n);
+    UInt32 id = 100000;
+    for (auto& v : ids)
+        v = (id += 1 + gen() % 20);
+    bench("sorted ids", ids, iterations);
+
+    //Counters sampled at random times
+    std::vector<UInt64> counters(n);
+    UInt64 c = 0;
+    for (auto& v : counters)
+        v = (c += gen() % 1000);
+    bench("counters", counters, iterations);
+
+    //Worst case : random values
+    std::vector<Int32> random(n);
+    for (auto& v : random)
+        v = static_cast<Int32>(gen());
+    bench("random", random, iterations);
+
+    return EXIT_SUCCESS;
+}
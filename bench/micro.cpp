@@ -0,0 +1,398 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Microbenchmarks of the building blocks of the receive and send paths,
+// written as JSON to track regressions across versions :
+//
+//  - RingBuf::put() and RingBuf::pick_event(), for a few frame sizes,
+//    with frames contiguous in the buffer or split by its end.
+//  - Packet encoding and decoding, for each Type and array length.
+//  - serializer_serialize() (SEDNL_SERIALIZABLE) against the same
+//    members written by hand.
+//  - SafeQueue::push() and SafeQueue::pop() from 1 to N threads. An
+//    operation is a push and a pop, and the time per operation is the
+//    wall time divided by the operations of all the threads.
+//
+// Usage: bench_micro [--filter=TEXT] [--min-time=MS] [--threads=N]
+//
+// Only the benchmarks whose name contains TEXT are run. Each one runs
+// for at least MS milliseconds (default 200). The queue is measured
+// up to N threads (default: the number of cores, at most 8).
+//
+// Output: {"version": "x.y.z", "benchmarks": [{"name": ...,
+// "params": {...}, "ops": ..., "ns_per_op": ..., "mb_per_s": ...}]}
+
+#include "SEDNL/sednl.hpp"
+#include "SEDNL/RingBuf.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+using namespace SedNL;
+
+typedef std::chrono::steady_clock Clock;
+
+//Keep the compiler from removing the benchmarked code.
+static volatile unsigned int sink;
+
+static std::string filter;
+static double min_time = 0.2;
+static bool first_result = true;
+
+static bool selected(const std::string& name)
+{
+    return name.find(filter) != std::string::npos;
+}
+
+//Print a result, \a params being the content of a JSON object.
+static void report(const std::string& name, const std::string& params,
+                   UInt64 ops, double seconds, UInt64 bytes_per_op = 0)
+{
+    std::cout << (first_result ? "\n" : ",\n")
+              << "    {\"name\": \"" << name << "\", \"params\": {"
+              << params << "}, \"ops\": " << ops
+              << std::fixed << std::setprecision(3)
+              << ", \"ns_per_op\": " << seconds * 1e9 / ops;
+    if (bytes_per_op)
+        std::cout << ", \"mb_per_s\": " << bytes_per_op * ops / seconds / 1e6;
+    std::cout << "}" << std::flush;
+    first_result = false;
+}
+
+//Call f() by batches, until min_time is spent, and report the time per call.
+template<typename F>
+static void run(const std::string& name, const std::string& params,
+                F f, UInt64 bytes_per_op = 0)
+{
+    if (!selected(name))
+        return;
+
+    //Warm up
+    for (int i = 0; i < 10; i++)
+        f();
+
+    UInt64 ops = 0;
+    UInt64 batch = 1;
+    const auto start = Clock::now();
+    double seconds = 0;
+    while (seconds < min_time)
+    {
+        for (UInt64 i = 0; i < batch; i++)
+            f();
+        ops += batch;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (batch < (1 << 20))
+            batch *= 2;
+    }
+    report(name, params, ops, seconds, bytes_per_op);
+}
+
+///////////
+//RingBuf//
+///////////
+
+//Frame of an event, as received : the UInt16 frame length, the
+// name and the packet.
+static std::string make_frame(const Packet& packet)
+{
+    const ByteArray& data = packet.get_data();
+    const UInt16 length = 2 + 2 + data.size();
+    std::string frame;
+    frame.push_back(static_cast<char>(length >> 8));
+    frame.push_back(static_cast<char>(length & 0xFF));
+    frame.append("e", 2);
+    frame.append(data.begin(), data.end());
+    return frame;
+}
+
+static void bench_ringbuf()
+{
+    const unsigned int payloads[] = {8, 256, 4096, 60000};
+    for (unsigned int payload : payloads)
+    {
+        Packet packet;
+        packet << std::vector<UInt8>(payload, 7);
+        const std::string frame = make_frame(packet);
+        const unsigned int length = frame.size();
+
+        //A ring of 2 frames (positions are taken modulo size + 1)
+        // keeps the frames contiguous. A ring of 1 frame splits
+        // nearly all of them.
+        for (int split = 0; split < 2; split++)
+        {
+            RingBuf buf(split ? length : 2 * length - 1);
+            std::ostringstream params;
+            params << "\"frame\": " << length
+                   << ", \"wrap\": " << (split ? "\"split\"" : "\"contiguous\"");
+
+            run("ringbuf/put", params.str(), [&]() {
+                    sink = buf.put(frame.data(), length);
+                    buf.reset();
+                }, length);
+
+            for (int trusted = 0; trusted < 2; trusted++)
+            {
+                Event event;
+                run(trusted ? "ringbuf/put_pick_trusted" : "ringbuf/put_pick",
+                    params.str(), [&]() {
+                        buf.put(frame.data(), length);
+                        sink = buf.pick_event(event, trusted);
+                    }, length);
+            }
+        }
+    }
+}
+
+//////////
+//Packet//
+//////////
+
+//Values written in each packet when benchmarking scalars.
+static const unsigned int SCALARS = 64;
+
+template<typename T>
+static void bench_scalar(const char* type, T value)
+{
+    const std::string params = std::string("\"type\": \"") + type + "\"";
+
+    run("packet/encode", params, [&]() {
+            Packet p;
+            for (unsigned int i = 0; i < SCALARS; i++)
+                p << value;
+            sink = p.get_data().size();
+        });
+
+    Packet p;
+    for (unsigned int i = 0; i < SCALARS; i++)
+        p << value;
+    run("packet/decode", params, [&]() {
+            PacketReader reader(p);
+            T v;
+            for (unsigned int i = 0; i < SCALARS; i++)
+                reader >> v;
+            sink = static_cast<unsigned int>(sizeof(v));
+        });
+}
+
+template<typename T>
+static void bench_array(const char* type)
+{
+    const unsigned int lengths[] = {1, 16, 256, 4096};
+    for (unsigned int length : lengths)
+    {
+        std::ostringstream params;
+        params << "\"type\": \"" << type << "Array\", \"length\": " << length;
+
+        std::vector<T> v(length);
+        for (unsigned int i = 0; i < length; i++)
+            v[i] = static_cast<T>(i * 3);
+
+        run("packet/encode", params.str(), [&]() {
+                Packet p;
+                p << v;
+                sink = p.get_data().size();
+            }, length * sizeof(T));
+
+        Packet p;
+        p << v;
+        run("packet/decode", params.str(), [&]() {
+                std::vector<T> u;
+                PacketReader(p) >> u;
+                sink = u.size();
+            }, length * sizeof(T));
+    }
+}
+
+static void bench_packet()
+{
+    bench_scalar<Int8>("Int8", 42);
+    bench_scalar<Int16>("Int16", 4242);
+    bench_scalar<Int32>("Int32", 424242);
+    bench_scalar<Int64>("Int64", 42424242424LL);
+    bench_scalar<UInt8>("UInt8", 42);
+    bench_scalar<UInt16>("UInt16", 4242);
+    bench_scalar<UInt32>("UInt32", 424242);
+    bench_scalar<UInt64>("UInt64", 42424242424ULL);
+    bench_scalar<float>("Float", 4.2f);
+    bench_scalar<double>("Double", 4.2);
+    bench_scalar<VarInt<Int32>>("VarInt", VarInt<Int32>(4242));
+    bench_scalar<std::string>("SizedString", std::string("position_update"));
+
+    bench_array<Int8>("Int8");
+    bench_array<Int16>("Int16");
+    bench_array<Int32>("Int32");
+    bench_array<Int64>("Int64");
+    bench_array<UInt8>("UInt8");
+    bench_array<UInt16>("UInt16");
+    bench_array<UInt32>("UInt32");
+    bench_array<UInt64>("UInt64");
+    bench_array<float>("Float");
+    bench_array<double>("Double");
+}
+
+//////////////
+//Serializer//
+//////////////
+
+struct Player
+{
+    Int32 id;
+    float x, y, z;
+    std::string name;
+    std::vector<Int16> inventory;
+
+    SEDNL_SERIALIZABLE(id, x, y, z, name, inventory);
+};
+
+static void bench_serializer()
+{
+    Player player;
+    player.id = 42;
+    player.x = 1.f;
+    player.y = 2.f;
+    player.z = 3.f;
+    player.name = "player_42";
+    player.inventory.assign(16, 7);
+
+    run("serializer/encode", "\"code\": \"serializer_serialize\"", [&]() {
+            Packet p;
+            p << player;
+            sink = p.get_data().size();
+        });
+    run("serializer/encode", "\"code\": \"hand_written\"", [&]() {
+            Packet p;
+            p << player.id << player.x << player.y << player.z
+              << player.name << player.inventory;
+            sink = p.get_data().size();
+        });
+
+    Packet serialized;
+    serialized << player;
+    run("serializer/decode", "\"code\": \"serializer_serialize\"", [&]() {
+            Player u;
+            PacketReader(serialized) >> u;
+            sink = u.inventory.size();
+        });
+
+    Packet written;
+    written << player.id << player.x << player.y << player.z
+            << player.name << player.inventory;
+    run("serializer/decode", "\"code\": \"hand_written\"", [&]() {
+            Player u;
+            PacketReader(written) >> u.id >> u.x >> u.y >> u.z
+                                  >> u.name >> u.inventory;
+            sink = u.inventory.size();
+        });
+}
+
+/////////////
+//SafeQueue//
+/////////////
+
+//Each thread pushes then pops an element, ops times.
+static void bench_queue(unsigned int max_threads)
+{
+    if (!selected("safequeue/push_pop"))
+        return;
+
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        SafeQueue<Event*> queue;
+        Event event;
+
+        //Find how many operations fill min_time with one thread.
+        UInt64 ops = 1 << 16;
+        double seconds = 0;
+        while (true)
+        {
+            std::atomic<bool> go(false);
+            std::vector<std::thread> pool;
+            for (unsigned int t = 0; t < threads; t++)
+                pool.push_back(std::thread([&]() {
+                            while (!go)
+                                std::this_thread::yield();
+                            Event* e;
+                            for (UInt64 i = 0; i < ops; i++)
+                            {
+                                queue.push(&event);
+                                queue.pop(e);
+                            }
+                        }));
+            const auto start = Clock::now();
+            go = true;
+            for (std::thread& t : pool)
+                t.join();
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (seconds >= min_time)
+                break;
+            ops *= 2;
+        }
+
+        std::ostringstream params;
+        params << "\"threads\": " << threads;
+        report("safequeue/push_pop", params.str(), ops * threads, seconds);
+
+        if (threads < max_threads && threads * 2 > max_threads)
+            threads = max_threads / 2;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int threads = std::min(8u, std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0)
+            filter = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--min-time=", 11) == 0)
+            min_time = std::atof(argv[i] + 11) / 1e3;
+        else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+            threads = std::max(1, std::atoi(argv[i] + 10));
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter=TEXT] [--min-time=MS] [--threads=N]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "{\n  \"version\": \"" << Version::Major << "."
+              << Version::Minor << "." << Version::Micro << "\","
+              << "\n  \"benchmarks\": [";
+
+    bench_ringbuf();
+    bench_packet();
+    bench_serializer();
+    bench_queue(threads);
+
+    std::cout << "\n  ]\n}" << std::endl;
+    return EXIT_SUCCESS;
+}
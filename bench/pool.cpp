@@ -0,0 +1,93 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Time to build, frame, receive and destroy small and medium events,
+// and heap allocations per event, with the buffer pool (see
+// PoolAllocator). Run it again with SEDNL_NO_POOL=1 to compare with
+// the heap allocator.
+//
+// Usage: bench_pool [nb_events]
+
+#include "SEDNL/Packet.hpp"
+#include "SEDNL/Event.hpp"
+#include "SEDNL/RingBuf.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+using namespace SedNL;
+
+typedef std::chrono::steady_clock Clock;
+
+static void bench(const char* name, const Packet& model, int events)
+{
+    RingBuf buf(8000);
+    const BufferPoolStats before = get_buffer_pool_stats();
+    const auto start = Clock::now();
+
+    for (int i = 0; i < events; i++)
+    {
+        Packet p(model);
+        p << i;
+        const ByteArray frame = Event("bench", std::move(p)).pack();
+        buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+        Event e;
+        buf.pick_event(e);
+    }
+
+    const auto end = Clock::now();
+    const BufferPoolStats after = get_buffer_pool_stats();
+
+    std::cout << std::setw(8) << name
+              << " | " << std::setw(5) << model.get_data().size() + 5 << " B"
+              << std::fixed << std::setprecision(1)
+              << " | " << std::setw(7)
+              << std::chrono::duration<double, std::nano>(end - start).count()
+                 / events << " ns/event"
+              << std::setprecision(3)
+              << " | " << std::setw(6)
+              << static_cast<double>(after.heap_allocations
+                                     - before.heap_allocations) / events
+              << " heap allocations/event" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int events = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::cout << (getenv("SEDNL_NO_POOL") ? "Heap allocator" : "Buffer pool")
+              << std::endl;
+
+    Packet tiny, small, medium;
+    tiny << Int8(1);
+    small << 1.f << 2.f << 3.f << std::string("player");
+    medium << std::vector<float>(500, 1.f);
+
+    bench("tiny", tiny, events);
+    bench("small", small, events);
+    bench("medium", medium, events);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,427 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Load generator : N connections send events to an echo / sink server
+// built on EventListener and EventConsumer, and the throughput, the
+// round trip latency of the echoed events and the CPU time of the
+// server are reported.
+//
+// Usage: sednl_bench [options]
+//
+//   --connections=N   Number of connections, each sending from its
+//                     own thread (default 8).
+//   --duration=S      Seconds of sending (default 5).
+//   --rate=N          Events per second and per connection,
+//                     0 for as fast as possible (default 0).
+//   --payload=SHAPE   ints, floats, string or mixed (default floats).
+//   --size=N          Number of values (or chars) of the payload
+//                     (default 16), as long as an event fits in
+//                     a frame.
+//   --echo=P          Percent of the events echoed by the server,
+//                     the others are discarded (default 10).
+//   --port=N          Port of the server (default 23470).
+//   --server          Only run the server, until SIGINT or SIGTERM.
+//   --connect=HOST    Don't start a server, send to the one on HOST.
+//   --capture=FILE    Capture the data received by the server into
+//                     FILE, to replay it with sednl_replay.
+//
+// Without --connect, the server runs in a child process, so that its
+// CPU time can be measured apart from the clients.
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace SedNL;
+
+struct Options
+{
+    Options()
+        :connections(8), duration(5), rate(0), payload("floats"),
+         size(16), echo(10), port(23470), server(false), host(), capture()
+    {}
+
+    int connections;
+    double duration;
+    double rate;
+    std::string payload;
+    int size;
+    int echo;
+    int port;
+    bool server;
+    std::string host;
+    std::string capture;
+};
+
+//Read "--name=value" into value.
+static bool option(const char* arg, const char* name, std::string& value)
+{
+    const std::size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=')
+        return false;
+    value = arg + length + 1;
+    return true;
+}
+
+//Largest --size of an event fitting in a frame : its header, its
+// name ("echo" or "sink"), its send time, and the payload.
+static int max_size(const std::string& payload)
+{
+    const int space = MAX_FRAME_SIZE - sizeof(UInt16) - 5
+        - PackedSize<UInt64>::value;
+
+    if (payload == "ints")
+        return space / PackedSize<Int32>::value;
+    //Array header : {type, length}
+    if (payload == "floats")
+        return (space - 3) / sizeof(float);
+    //Terminated string
+    if (payload == "string")
+        return space - 2;
+    //An int, the floats and the string
+    return (space - PackedSize<Int32>::value - 3 - 2) / (sizeof(float) + 1);
+}
+
+static bool parse(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string value;
+        if (option(argv[i], "--connections", value))
+            opt.connections = std::atoi(value.c_str());
+        else if (option(argv[i], "--duration", value))
+            opt.duration = std::atof(value.c_str());
+        else if (option(argv[i], "--rate", value))
+            opt.rate = std::atof(value.c_str());
+        else if (option(argv[i], "--payload", value))
+            opt.payload = value;
+        else if (option(argv[i], "--size", value))
+            opt.size = std::atoi(value.c_str());
+        else if (option(argv[i], "--echo", value))
+            opt.echo = std::atoi(value.c_str());
+        else if (option(argv[i], "--port", value))
+            opt.port = std::atoi(value.c_str());
+        else if (option(argv[i], "--connect", value))
+            opt.host = value;
+        else if (option(argv[i], "--capture", value))
+            opt.capture = value;
+        else if (std::strcmp(argv[i], "--server") == 0)
+            opt.server = true;
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    if (opt.payload != "ints" && opt.payload != "floats"
+        && opt.payload != "string" && opt.payload != "mixed")
+    {
+        std::cerr << "Unknown payload " << opt.payload << std::endl;
+        return false;
+    }
+    if (opt.size > max_size(opt.payload))
+    {
+        std::cerr << "--size=" << opt.size << " is too large for a "
+                  << opt.payload << " payload : events wouldn't fit in a"
+                  << " frame (at most " << max_size(opt.payload) << ")"
+                  << std::endl;
+        return false;
+    }
+    return opt.connections > 0 && opt.duration > 0 && opt.size >= 0;
+}
+
+//CPU time of rusage, in seconds.
+static double cpu_time(const struct rusage& usage)
+{
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+        + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+//////////
+//Server//
+//////////
+
+static volatile std::sig_atomic_t server_stop = 0;
+
+static void on_signal(int)
+{
+    server_stop = 1;
+}
+
+//Echo "echo" events to their sender, and count "sink" events.
+static int run_server(int port, const std::string& capture)
+{
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    try
+    {
+        SocketAddress addr(port, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener listener(server, 100000);
+        EventConsumer echo(listener);
+        EventConsumer sink(listener);
+        if (!capture.empty())
+            listener.set_capture(capture);
+
+        echo.bind("echo").set_function([](Connection& c, const Event& e) {
+                c.send(e);
+            });
+        sink.bind("sink").set_function([](Connection&, const Event&) {});
+
+        listener.run();
+        echo.run();
+        sink.run();
+
+        while (!server_stop)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        listener.join();
+        echo.join();
+        sink.join();
+
+        const ListenerMetrics metrics = listener.get_metrics();
+        std::cout << "server    " << metrics.events_in << " events received, "
+                  << metrics.dropped_queue_full << " dropped (queue full)"
+                  << std::endl;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << "Server: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+//////////
+//Client//
+//////////
+
+//Write the payload of an event, after its send time.
+static void write_payload(Packet& p, const Options& opt,
+                          const std::vector<Int32>& ints,
+                          const std::vector<float>& floats,
+                          const std::string& str)
+{
+    if (opt.payload == "ints")
+        for (Int32 i : ints)
+            p << i;
+    else if (opt.payload == "floats")
+        p << floats;
+    else if (opt.payload == "string")
+        p << str;
+    else
+        p << ints[0] << floats << str;
+}
+
+//Connect to the server, retrying while a child server starts.
+static std::unique_ptr<TCPClient> connect(const SocketAddress& addr)
+{
+    for (int i = 0;; i++)
+    {
+        try
+        {
+            return std::unique_ptr<TCPClient>(new TCPClient(addr));
+        }
+        catch(std::exception&)
+        {
+            if (i == 200)
+                throw;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+static int run_clients(const Options& opt)
+{
+    SocketAddress addr(opt.port, opt.host.empty() ? "127.0.0.1" : opt.host);
+
+    std::vector<std::unique_ptr<TCPClient>> clients;
+    EventListener listener(100000);
+    EventConsumer consumer(listener);
+
+    //Round trip time of the echoed events
+    LatencyHistogram rtt;
+    std::atomic<UInt64> echoed(0);
+    consumer.bind("echo").set_function([&](Connection&, const Event& e) {
+            PacketReader reader(e.get_packet());
+            UInt64 sent;
+            reader >> sent;
+            rtt.record(latency_clock() - sent);
+            echoed.fetch_add(1, std::memory_order_relaxed);
+        });
+
+    try
+    {
+        for (int i = 0; i < opt.connections; i++)
+        {
+            clients.push_back(connect(addr));
+            listener.attach(*clients.back());
+        }
+        listener.run();
+        consumer.run();
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << "Client: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Int32> ints(std::max(opt.size, 1), 42);
+    const std::vector<float> floats(opt.size, 1.5f);
+    const std::string str(opt.size, 'x');
+
+    std::vector<UInt64> echo_sent(opt.connections, 0);
+    std::vector<std::thread> senders;
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(opt.duration));
+
+    for (int c = 0; c < opt.connections; c++)
+        senders.push_back(std::thread([&, c]() {
+                    TCPClient& client = *clients[c];
+                    try
+                    {
+                        for (UInt64 i = 0;; i++)
+                        {
+                            auto now = std::chrono::steady_clock::now();
+                            if (now >= end)
+                                break;
+                            if (opt.rate > 0)
+                                std::this_thread::sleep_until(start
+                                    + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::duration<double>(i / opt.rate)));
+
+                            //The mix is deterministic : echo% of each
+                            // hundred events are echoed.
+                            const bool echo = static_cast<int>(i % 100) < opt.echo;
+                            Packet p;
+                            p << latency_clock();
+                            write_payload(p, opt, ints, floats, str);
+                            client.send(echo ? "echo" : "sink", p);
+                            if (echo)
+                                echo_sent[c]++;
+                        }
+                    }
+                    catch(std::exception &e)
+                    {
+                        std::cerr << "Client " << c << ": " << e.what() << std::endl;
+                    }
+                }));
+    for (std::thread& t : senders)
+        t.join();
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    UInt64 events = 0;
+    UInt64 bytes = 0;
+    UInt64 echoes = 0;
+    for (int c = 0; c < opt.connections; c++)
+    {
+        const ConnectionMetrics m = clients[c]->get_metrics();
+        events += m.events_out;
+        bytes += m.bytes_out;
+        echoes += echo_sent[c];
+    }
+
+    //Wait at most a second for the last echoes
+    for (int i = 0; i < 100 && echoed.load() < echoes; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    listener.join();
+    consumer.join();
+    for (auto& client : clients)
+        client->disconnect();
+
+    const LatencyStats stats = rtt.stats();
+    std::cout << std::fixed << std::setprecision(1)
+              << "sent      " << events << " events in " << seconds << " s, "
+              << events / seconds << " events/s, "
+              << bytes / seconds / 1e6 << " MB/s" << std::endl
+              << "echoed    " << echoed.load() << "/" << echoes
+              << ", rtt p50 " << stats.p50.count() / 1e3
+              << " us, p99 " << stats.p99.count() / 1e3
+              << " us, p99.9 " << stats.p999.count() / 1e3
+              << " us, max " << stats.max.count() / 1e3 << " us" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parse(argc, argv, opt))
+        return EXIT_FAILURE;
+
+    if (opt.server)
+        return run_server(opt.port, opt.capture);
+
+    std::cout << "sednl_bench: " << opt.connections << " connections, "
+              << opt.payload << " x" << opt.size << ", "
+              << opt.echo << "% echoed, ";
+    if (opt.rate > 0)
+        std::cout << opt.rate << " events/s per connection" << std::endl;
+    else
+        std::cout << "unlimited rate" << std::endl;
+
+    if (!opt.host.empty())
+        return run_clients(opt);
+
+    //Start the server before any thread
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "Can't fork the server: " << strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (pid == 0)
+        return run_server(opt.port, opt.capture);
+
+    const auto start = std::chrono::steady_clock::now();
+    const int result = run_clients(opt);
+
+    kill(pid, SIGTERM);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0)
+        return EXIT_FAILURE;
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    const double cpu = cpu_time(usage);
+    std::cout << std::fixed << std::setprecision(1)
+              << "server    " << cpu << " s CPU, "
+              << 100 * cpu / seconds << "% of a core" << std::endl;
+    return result;
+}
@@ -0,0 +1,163 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Replay a capture (see EventListener::set_capture()) into a listener,
+// and report how fast its events were processed.
+//
+// Usage: sednl_replay FILE [options]
+//
+//   --speed=X       1 to replay at the original speed (default), 2
+//                   twice faster, 0 as fast as possible.
+//   --port=N        Replay over loopback, to a local server listening
+//                   on N, instead of injecting the data into the
+//                   dispatch path of the listener.
+//   --connect=HOST  Replay to the server on HOST (with --port), without
+//                   local server.
+//
+// A capture can be made with 'sednl_bench --capture=FILE'.
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+using namespace SedNL;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " FILE [--speed=X] [--port=N] [--connect=HOST]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string path = argv[1];
+    double speed = 1;
+    int port = 0;
+    std::string host;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--speed=", 8) == 0)
+            speed = std::atof(argv[i] + 8);
+        else if (std::strncmp(argv[i], "--port=", 7) == 0)
+            port = std::atoi(argv[i] + 7);
+        else if (std::strncmp(argv[i], "--connect=", 10) == 0)
+            host = argv[i] + 10;
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (!host.empty() && port == 0)
+    {
+        std::cerr << "--connect needs --port" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        CaptureReplayer replayer(path);
+
+        //Send to an other server
+        if (!host.empty())
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const UInt64 records = replayer.replay(SocketAddress(port, host), speed);
+            const double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            std::cout << records << " records sent in "
+                      << std::fixed << std::setprecision(3) << seconds << " s"
+                      << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        std::unique_ptr<TCPServer> server;
+        std::unique_ptr<EventListener> listener;
+        if (port)
+        {
+            server.reset(new TCPServer(SocketAddress(port, "127.0.0.1"), true));
+            listener.reset(new EventListener(*server, 100000));
+        }
+        else
+            listener.reset(new EventListener(100000));
+
+        //Count every event
+        EventConsumer consumer(*listener);
+        std::atomic<UInt64> events(0);
+        std::atomic<UInt64> bytes(0);
+        std::atomic<UInt64> last_event(0);
+        consumer.on_event().set_function([&](Connection&, const Event& e) {
+                bytes.fetch_add(e.get_packet().get_data().size(),
+                                std::memory_order_relaxed);
+                events.fetch_add(1, std::memory_order_relaxed);
+                last_event.store(latency_clock(), std::memory_order_relaxed);
+            });
+        listener->run();
+        consumer.run();
+
+        const UInt64 start = latency_clock();
+        const UInt64 records = port
+            ? replayer.replay(SocketAddress(port, "127.0.0.1"), speed)
+            : replayer.replay(*listener, speed);
+
+        //Wait until the consumer is idle for 100 ms
+        UInt64 processed = events.load();
+        while (true)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (events.load() == processed)
+                break;
+            processed = events.load();
+        }
+
+        consumer.join();
+        listener->join();
+
+        const ListenerMetrics metrics = listener->get_metrics();
+        const double seconds = (std::max(last_event.load(), start) - start) / 1e9;
+        std::cout << std::fixed << std::setprecision(1)
+                  << records << " records, " << events.load() << " events in "
+                  << std::setprecision(3) << seconds << " s, "
+                  << std::setprecision(1)
+                  << events.load() / seconds << " events/s, "
+                  << bytes.load() / seconds / 1e6 << " MB/s" << std::endl
+                  << "dropped   " << metrics.dropped_queue_full
+                  << " (queue full), " << metrics.dropped_invalid_packets
+                  << " (invalid packets)" << std::endl;
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
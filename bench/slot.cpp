@@ -0,0 +1,105 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Time of a call through a Slot, for each kind of callback, compared
+// with the same callback stored in a std::function.
+//
+// Usage: bench_slot [nb_calls]
+
+#include "SEDNL/Slot.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+
+using namespace SedNL;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Handler
+{
+    long sum = 0;
+
+    void on_value(int v)
+    {
+        sum += v;
+    }
+};
+
+static long g_sum = 0;
+
+static void on_value(int v)
+{
+    g_sum += v;
+}
+
+template<typename F>
+static void bench(const char* name, F& callback, int calls)
+{
+    const auto start = Clock::now();
+
+    for (int i = 0; i < calls; i++)
+        callback(i);
+
+    const auto end = Clock::now();
+
+    std::cout << std::setw(24) << name
+              << std::fixed << std::setprecision(2)
+              << " | " << std::setw(6)
+              << std::chrono::duration<double, std::nano>(end - start).count()
+                 / calls << " ns/call" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int calls = argc > 1 ? std::atoi(argv[1]) : 100000000;
+
+    Handler handler;
+    Handler* ptr = &handler;
+
+    std::function<void(int)> function;
+    Slot<int> slot;
+
+    function = on_value;
+    bench("std::function, function", function, calls);
+    slot.set_function(on_value);
+    bench("Slot, function", slot, calls);
+    slot.set_function<&on_value>();
+    bench("Slot, bound function", slot, calls);
+
+    function = std::bind(&Handler::on_value, ptr, std::placeholders::_1);
+    bench("std::function, member", function, calls);
+    slot.set_function(ptr, &Handler::on_value);
+    bench("Slot, member", slot, calls);
+    slot.set_function<Handler, &Handler::on_value>(ptr);
+    bench("Slot, bound member", slot, calls);
+
+    function = [&](int v) { handler.sum += v; };
+    bench("std::function, lambda", function, calls);
+    slot.set_function([&](int v) { handler.sum += v; });
+    bench("Slot, lambda", slot, calls);
+
+    //Keep the results alive
+    return (g_sum + handler.sum) == 42;
+}
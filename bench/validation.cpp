@@ -0,0 +1,230 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Cost of the validation pass done on received packets, for
+// several packet shapes.
+//
+// Usage: bench_validation [nb_iterations]
+//
+// For each shape, it measures the time to pick an event from a
+// RingBuf with validation (the default) and without it (trusted
+// connections, see Connection::set_trusted()), and the time to
+// read the whole packet with a PacketReader (or to reject it, for
+// the malformed ones).
+
+#include "SEDNL/Packet.hpp"
+#include "SEDNL/RingBuf.hpp"
+#include "SEDNL/Event.hpp"
+#include "SEDNL/Serializer.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace SedNL;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Vec3
+{
+    float x, y, z;
+
+    SEDNL_SERIALIZABLE(x, y, z);
+};
+
+struct Body
+{
+    Int32 id;
+    Vec3 position;
+    Vec3 speed;
+
+    SEDNL_SERIALIZABLE(id, position, speed);
+};
+
+//Keep the compiler from removing the benchmarked code.
+static volatile unsigned int sink;
+
+template<typename F>
+static double ns_per_call(F f, int iterations)
+{
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    const auto end = Clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count()
+        / iterations;
+}
+
+//Frame of an event named "e", as sent by Connection::send().
+static ByteArray make_frame(const Packet& p)
+{
+    const ByteArray& data = p.get_data();
+    const unsigned int length = 2 + 2 + data.size();
+    ByteArray frame = {static_cast<Byte>(length >> 8),
+                       static_cast<Byte>(length), 'e', '\0'};
+    frame.insert(frame.end(), data.begin(), data.end());
+    return frame;
+}
+
+static void bench(const char* name, const Packet& p, int iterations,
+                  std::function<void (PacketReader&)> read)
+{
+    const ByteArray frame = make_frame(p);
+    RingBuf buf(65535);
+    Event e;
+
+    auto pick = [&](bool trusted) {
+        return ns_per_call([&]() {
+                buf.put(reinterpret_cast<const char*>(frame.data()),
+                        frame.size());
+                buf.pick_event(e, trusted);
+                sink = e.get_packet().get_data().size();
+            }, iterations);
+    };
+
+    const double validated = pick(false);
+    const double trusted = pick(true);
+    const double reading = ns_per_call([&]() {
+            PacketReader r(e.get_packet());
+            read(r);
+        }, iterations);
+
+    std::cout << std::setw(10) << name << std::setw(7) << p.get_data().size()
+              << " B" << std::fixed << std::setprecision(1)
+              << " | validated " << std::setw(9) << validated << " ns"
+              << " | trusted " << std::setw(9) << trusted << " ns"
+              << " | validation " << std::setw(5)
+              << 100. * (validated - trusted) / validated << " %"
+              << " | read " << std::setw(9) << reading << " ns" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+
+    std::cout << iterations << " iterations (time per packet)" << std::endl;
+
+    //A few scalars
+    {
+        Packet p = make_packet((Int32)1, (Int32)2, (float)3, (UInt64)4);
+        bench("scalars", p, iterations, [](PacketReader& r) {
+                Int32 a, b; float c; UInt64 d;
+                r >> a >> b >> c >> d;
+                sink = a + b + d;
+            });
+    }
+
+    //Strings
+    {
+        Packet p = make_packet(std::string("player_name"),
+                               std::string("a chat message of a few words"),
+                               std::string("channel"));
+        bench("strings", p, iterations, [](PacketReader& r) {
+                std::string a, b, c;
+                r >> a >> b >> c;
+                sink = a.size() + b.size() + c.size();
+            });
+    }
+
+    //Nested objects
+    {
+        Packet p;
+        Body body = {1, {1, 2, 3}, {4, 5, 6}};
+        for (int i = 0; i < 8; i++)
+            p << body;
+        bench("objects", p, iterations, [](PacketReader& r) {
+                Body body;
+                for (int i = 0; i < 8; i++)
+                    r >> body;
+                sink = body.id;
+            });
+    }
+
+    //Many objects, one by one and column by column
+    {
+        std::vector<Body> bodies(100, Body{1, {1, 2, 3}, {4, 5, 6}});
+        Packet p;
+        for (Body& body : bodies)
+            p << body;
+        bench("100 obj", p, iterations / 10, [](PacketReader& r) {
+                Body body;
+                for (int i = 0; i < 100; i++)
+                    r >> body;
+                sink = body.id;
+            });
+
+        Packet q = make_packet(bodies);
+        bench("columns", q, iterations / 10, [](PacketReader& r) {
+                std::vector<Body> bodies;
+                r >> bodies;
+                sink = bodies.size();
+            });
+    }
+
+    //Malformed input : an object with other members, rejected
+    // by an exception and by a status
+    {
+        Packet p;
+        Vec3 vec = {1, 2, 3};
+        p << vec;
+        bench("throw", p, iterations, [](PacketReader& r) {
+                Body body;
+                try { r >> body; }
+                catch (PacketException&) { sink = 0; }
+            });
+        bench("try_read", p, iterations, [](PacketReader& r) {
+                Body body;
+                if (!r.try_read(body))
+                    sink = 0;
+            });
+    }
+
+    //Many small items
+    {
+        Packet p;
+        for (int i = 0; i < 200; i++)
+            p << static_cast<UInt8>(i);
+        bench("items", p, iterations, [](PacketReader& r) {
+                UInt8 v;
+                while (r)
+                    r >> v;
+                sink = v;
+            });
+    }
+
+    //One large array
+    {
+        std::vector<float> v(4000, 1.5f);
+        Packet p = make_packet(v);
+        bench("array", p, iterations / 10, [](PacketReader& r) {
+                std::vector<float> v;
+                r >> v;
+                sink = v.size();
+            });
+    }
+
+    return EXIT_SUCCESS;
+}
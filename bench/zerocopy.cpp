@@ -0,0 +1,182 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Throughput of large ArrayFloat events, sent with and without MSG_ZEROCOPY.
+//
+// Usage: bench_zerocopy [nb_events [host port]]
+//        bench_zerocopy --sink port
+//
+// Without host, a local sink (an EventListener, like any SedNL peer)
+// receives the events on 127.0.0.1, and the throughput is measured
+// until it received them all. Notice that the loopback interface always
+// copy the data, so the kernel reports zero copy sends as copied, and
+// the connection falls back to normal sends. Run a remote sink with
+// --sink to measure real zero copy sends : the throughput is then
+// measured on the sender side only.
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/resource.h>
+
+using namespace SedNL;
+
+//Count the "bulk" events received on port, until stop is set.
+class Sink
+{
+public:
+    Sink(int port)
+        :m_server(SocketAddress(port), true), m_listener(m_server),
+         m_consumer(m_listener), m_received(0)
+    {
+        m_consumer.bind("bulk").set_function([this](Connection&, const Event&) {
+                m_received++;
+            });
+        m_listener.run();
+        m_consumer.run();
+    }
+
+    ~Sink()
+    {
+        m_consumer.join();
+        m_listener.join();
+    }
+
+    int received() const { return m_received; }
+
+    //Wait for the events to be received, at most 10s.
+    bool wait(int nb_events) const
+    {
+        const auto limit = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (m_received < nb_events && std::chrono::steady_clock::now() < limit)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return m_received >= nb_events;
+    }
+
+private:
+    TCPServer m_server;
+    EventListener m_listener;
+    EventConsumer m_consumer;
+    std::atomic<int> m_received;
+};
+
+//CPU time used by the calling thread, in seconds.
+static double thread_cpu_time()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+        + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static void run(const SocketAddress& addr, int nb_events, bool zerocopy,
+                Sink* sink)
+{
+    const int first = sink ? sink->received() : 0;
+
+    TCPClient client(addr);
+    EventListener listener(client);
+    listener.run();
+
+    const bool enabled = client.set_zerocopy(zerocopy);
+
+    //~64KB per event, close to the biggest frame allowed.
+    std::vector<float> data(16000, 1.5f);
+
+    const double cpu_start = thread_cpu_time();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < nb_events; i++)
+    {
+        Packet p;
+        p << data;
+        client.send("bulk", std::move(p));
+    }
+
+    const double cpu = thread_cpu_time() - cpu_start;
+    const bool complete = !sink || sink->wait(first + nb_events);
+    const auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double mbytes = nb_events * data.size() * sizeof(float) / 1e6;
+
+    std::cout << (zerocopy ? "zerocopy " : "copy     ")
+              << mbytes / seconds << " MB/s, "
+              << cpu * 1e6 / nb_events << " us CPU/event";
+    if (zerocopy && !enabled)
+        std::cout << " (SO_ZEROCOPY unsupported)";
+    else if (zerocopy && !client.is_zerocopy())
+        std::cout << " (kernel copied, fell back)";
+    if (!complete)
+        std::cout << " (only " << sink->received() - first << " events received)";
+    std::cout << std::endl;
+
+    listener.join();
+    client.disconnect();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2 && strcmp(argv[1], "--sink") == 0)
+    {
+        try
+        {
+            Sink sink(atoi(argv[2]));
+            std::cout << "Sink listening on port " << argv[2] << std::endl;
+            while (true)
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+        catch(std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const int nb_events = argc > 1 ? atoi(argv[1]) : 20000;
+    const bool remote = argc > 3;
+    const std::string host = remote ? argv[2] : "127.0.0.1";
+    const int port = remote ? atoi(argv[3]) : 9090;
+
+    try
+    {
+        std::unique_ptr<Sink> sink;
+        if (!remote)
+            sink.reset(new Sink(port));
+
+        SocketAddress addr(port, host);
+        run(addr, nb_events, false, sink.get());
+        run(addr, nb_events, true, sink.get());
+    }
+    catch(std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef BUFFER_POOL_HPP_
+#define BUFFER_POOL_HPP_
+
+#ifndef BUFFER_POOL_MIN_SIZE
+# define BUFFER_POOL_MIN_SIZE 64
+#endif /* !BUFFER_POOL_MIN_SIZE */
+
+#ifndef BUFFER_POOL_MAX_SIZE
+# define BUFFER_POOL_MAX_SIZE 65536
+#endif /* !BUFFER_POOL_MAX_SIZE */
+
+#ifndef BUFFER_POOL_DEPTH
+# define BUFFER_POOL_DEPTH 64
+#endif /* !BUFFER_POOL_DEPTH */
+
+#ifndef BUFFER_POOL_CLASS_BYTES
+# define BUFFER_POOL_CLASS_BYTES (256 << 10)
+#endif /* !BUFFER_POOL_CLASS_BYTES */
+
+#ifndef BUFFER_POOL_DEPOT_SIZE
+# define BUFFER_POOL_DEPOT_SIZE (16 << 20)
+#endif /* !BUFFER_POOL_DEPOT_SIZE */
+
+#include "SEDNL/Export.hpp"
+#include "SEDNL/Types.hpp"
+
+#include <cstddef>
+
+namespace SedNL
+{
+
+////////////////////////////////////////////////////////////
+//! \brief Counters of the buffer pool.
+//!
+//! See get_buffer_pool_stats().
+////////////////////////////////////////////////////////////
+struct SEDNL_API BufferPoolStats
+{
+    //! \brief Buffers allocated on the heap, by all threads.
+    UInt64 heap_allocations;
+    //! \brief Buffers released to the heap, by all threads.
+    UInt64 heap_releases;
+    //! \brief Buffers taken from the pool by the calling thread.
+    UInt64 reused;
+    //! \brief Buffers given back to the pool by the calling thread.
+    UInt64 recycled;
+    //! \brief Bytes of the free buffers kept by the depot.
+    UInt64 depot_bytes;
+};
+
+//! \brief Return a buffer of at least \a size bytes from the pool.
+//!
+//! Low level function, used by PoolAllocator.
+SEDNL_API void* __pool_allocate(std::size_t size);
+
+//! \brief Give back to the pool the buffer \a buffer of \a size bytes,
+//!        as given to __pool_allocate().
+//!
+//! Low level function, used by PoolAllocator.
+SEDNL_API void __pool_deallocate(void* buffer, std::size_t size) noexcept;
+
+//! \brief Return the counters of the buffer pool.
+//!
+//! Once the pool is warm, heap_allocations stays the same while
+//! packets are built, sent, received and destroyed.
+//!
+//! \return A copy of the counters.
+SEDNL_API BufferPoolStats get_buffer_pool_stats() noexcept;
+
+//! \brief Release to the heap the buffers cached by the calling thread.
+SEDNL_API void release_buffer_pool() noexcept;
+
+//! \brief Release to the heap the free buffers of the depot, and the
+//!        ones cached by the calling thread.
+//!
+//! The other threads keep their own buffers until they exit.
+SEDNL_API void trim_buffer_pool() noexcept;
+
+//! \brief Set the bytes of free buffers the depot can keep.
+//!
+//! It's BUFFER_POOL_DEPOT_SIZE by default. The buffers above it are
+//! released to the heap.
+SEDNL_API void set_buffer_pool_depot_size(std::size_t size) noexcept;
+
+////////////////////////////////////////////////////////////
+//! \brief Allocator taking its buffers from a pool.
+//!
+//! Buffers are rounded to a size class (a power of two between
+//! BUFFER_POOL_MIN_SIZE and BUFFER_POOL_MAX_SIZE). Each thread keeps
+//! up to BUFFER_POOL_DEPTH free buffers per class, and at most
+//! BUFFER_POOL_CLASS_BYTES bytes of them (two buffers at least), without
+//! any lock. It exchanges them by batches with a shared depot, so
+//! that buffers allocated by the listener thread and freed by a
+//! consumer thread are recycled too. The depot keeps up to
+//! BUFFER_POOL_DEPOT_SIZE bytes of buffers (see
+//! set_buffer_pool_depot_size()), and the other ones are released.
+//! Bigger buffers come from the heap.
+//!
+//! It's the allocator of ByteArray, so packets don't allocate memory
+//! in a steady state. Setting the SEDNL_NO_POOL environment variable
+//! disables the pool. See trim_buffer_pool() to give the cached
+//! buffers back to the heap.
+////////////////////////////////////////////////////////////
+template<class T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    inline PoolAllocator() noexcept;
+
+    template<class U>
+    inline PoolAllocator(const PoolAllocator<U>&) noexcept;
+
+    inline T* allocate(std::size_t n);
+
+    inline void deallocate(T* p, std::size_t n) noexcept;
+};
+
+template<class T, class U>
+inline bool operator== (const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept;
+
+template<class T, class U>
+inline bool operator!= (const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept;
+
+} // namespace SedNL
+
+#include "SEDNL/BufferPool.ipp"
+
+#endif /* !BUFFER_POOL_HPP_ */
@@ -0,0 +1,69 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef BUFFER_POOL_IPP_
+#define BUFFER_POOL_IPP_
+
+namespace SedNL
+{
+
+template<class T>
+inline
+PoolAllocator<T>::PoolAllocator() noexcept
+{}
+
+template<class T>
+template<class U>
+inline
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>&) noexcept
+{}
+
+template<class T>
+inline
+T* PoolAllocator<T>::allocate(std::size_t n)
+{
+    return static_cast<T*>(__pool_allocate(n * sizeof(T)));
+}
+
+template<class T>
+inline
+void PoolAllocator<T>::deallocate(T* p, std::size_t n) noexcept
+{
+    __pool_deallocate(p, n * sizeof(T));
+}
+
+template<class T, class U>
+inline
+bool operator== (const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept
+{
+    return true;
+}
+
+template<class T, class U>
+inline
+bool operator!= (const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept
+{
+    return false;
+}
+
+} // namespace SedNL
+
+#endif /* !BUFFER_POOL_IPP_ */
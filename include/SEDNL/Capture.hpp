@@ -0,0 +1,188 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef CAPTURE_HPP_
+#define CAPTURE_HPP_
+
+#include "SEDNL/Export.hpp"
+#include "SEDNL/Types.hpp"
+#include "SEDNL/NonCopyable.hpp"
+#include "SEDNL/Exception.hpp"
+#include "SEDNL/sednlfwd.hpp"
+
+#include <string>
+
+namespace SedNL
+{
+
+////////////////////////////////////////////////////////////
+//! \brief Data received from a connection, read from a capture.
+////////////////////////////////////////////////////////////
+struct SEDNL_API CaptureRecord
+{
+    //! \brief Reception time, in nanoseconds of latency_clock().
+    UInt64 timestamp;
+    //! \brief Identifier of the connection in the capture.
+    //!        Identifiers are reused once a connection is closed.
+    UInt32 connection;
+    //! \brief Number of bytes received. 0 means that the
+    //!        connection was closed.
+    UInt32 length;
+    //! \brief The bytes received, as they were read from the socket.
+    //!        They are in the mapping of the file, and valid until
+    //!        the reader is destroyed.
+    const char* data;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Append records to a memory-mapped capture file.
+//!
+//! The file is extended, and its mapping grown, by chunks of
+//! \a chunk_size bytes, so that appending a record is a copy
+//! into the mapping. Its size is set to the size of the records
+//! when the writer is destroyed; the zeros ending a file whose
+//! writer didn't stop are read as its end.
+//!
+//! Records are written in the byte order of the host.
+//!
+//! See EventListener::set_capture().
+////////////////////////////////////////////////////////////
+class SEDNL_API CaptureWriter : public NonCopyable
+{
+public:
+    //! \brief Create (or truncate) the capture file \a path.
+    CaptureWriter(const std::string& path,
+                  UInt64 chunk_size = 16 << 20) throw(EventException);
+
+    ~CaptureWriter();
+
+    //! \brief Append \a length bytes received from \a connection at
+    //!        \a timestamp. \a length can be 0 to record that the
+    //!        connection was closed.
+    //!
+    //! \return False if the file couldn't be extended, for example
+    //!         because the disk is full. The records already written
+    //!         are kept, and appending can be tried again later.
+    bool append(UInt32 connection, UInt64 timestamp,
+                const char* data, UInt32 length) noexcept;
+
+    //! \brief Size of the records written, in bytes.
+    inline UInt64 size() const noexcept;
+
+private:
+    //! \brief Extend the file and its mapping to hold \a size bytes.
+    //!
+    //! The current mapping is kept if it fails.
+    bool grow(UInt64 size) noexcept;
+
+    int m_fd;
+    char* m_map;
+    UInt64 m_mapped;
+    UInt64 m_used;
+    UInt64 m_chunk_size;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Read the records of a capture file, from its mapping.
+////////////////////////////////////////////////////////////
+class SEDNL_API CaptureReader : public NonCopyable
+{
+public:
+    //! \brief Map the capture file \a path.
+    CaptureReader(const std::string& path) throw(EventException);
+
+    ~CaptureReader();
+
+    //! \brief Read the next record into \a record.
+    //!
+    //! \return False at the end of the capture.
+    bool next(CaptureRecord& record) noexcept;
+
+    //! \brief Go back to the first record.
+    void rewind() noexcept;
+
+private:
+    int m_fd;
+    const char* m_map;
+    UInt64 m_size;
+    UInt64 m_position;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Feed a capture file to a listener.
+//!
+//! Records are replayed in order, waiting between them the time
+//! elapsed during the capture, divided by the speed. A speed of 0
+//! replays them as fast as possible.
+////////////////////////////////////////////////////////////
+class SEDNL_API CaptureReplayer : public NonCopyable
+{
+public:
+    //! \brief Open the capture file \a path.
+    CaptureReplayer(const std::string& path) throw(EventException);
+
+    //! \brief Give the records to \a listener, as if they were
+    //!        received from one Connection per captured connection
+    //!        (see EventListener::inject()).
+    //!
+    //! If the listener is running, its thread processes them,
+    //! along with the data it receives from its sockets.
+    //!
+    //! \return Number of records replayed.
+    UInt64 replay(EventListener& listener, double speed = 1);
+
+    //! \brief Send the records to \a address, with one TCPClient
+    //!        per captured connection.
+    //!
+    //! \return Number of records replayed.
+    UInt64 replay(const SocketAddress& address, double speed = 1)
+        throw(NetworkException, std::exception);
+
+private:
+    CaptureReader m_reader;
+};
+
+} // namespace SedNL
+
+#include "SEDNL/Capture.ipp"
+
+#endif /* !CAPTURE_HPP_ */
+
+////////////////////////////////////////////////////////////
+//!
+//! \file Capture.hpp
+//! \brief Capture the data received by a listener, and replay it.
+//!
+//! \code
+//! listener.set_capture("traffic.cap");
+//! //...
+//!
+//! //Later, and offline : twice faster, without sockets
+//! CaptureReplayer replayer("traffic.cap");
+//! replayer.replay(other_listener, 2);
+//! \endcode
+//!
+//! A capture is a 16 bytes header ("SEDNLCAP", a version and a
+//! reserved field, as UInt32) followed by records : a timestamp
+//! (UInt64), a connection identifier and a length (UInt32), then
+//! the data, padded to 8 bytes.
+//!
+////////////////////////////////////////////////////////////
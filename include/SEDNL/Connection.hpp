@@ -26,12 +26,47 @@
 # define CONNECTION_BUFFER_SIZE 4096
 #endif /* !MAX_CONNECTIONS */
 
+//Biggest frame (length, name and packet), since its length is an UInt16.
+//Receive buffers grow up to this size when a frame doesn't fit.
+#define MAX_FRAME_SIZE 65535
+
+#ifndef ZEROCOPY_THRESHOLD
+# define ZEROCOPY_THRESHOLD 16384
+#endif /* !ZEROCOPY_THRESHOLD */
+
+#ifndef COMPRESSION_THRESHOLD
+# define COMPRESSION_THRESHOLD 512
+#endif /* !COMPRESSION_THRESHOLD */
+
+#ifndef STRING_TABLE_SIZE
+# define STRING_TABLE_SIZE 256
+#endif /* !STRING_TABLE_SIZE */
+
+#ifndef STRING_TABLE_MAX_SIZE
+# define STRING_TABLE_MAX_SIZE 4096
+#endif /* !STRING_TABLE_MAX_SIZE */
+
+#ifndef STRING_TABLE_MAX_LENGTH
+# define STRING_TABLE_MAX_LENGTH 64
+#endif /* !STRING_TABLE_MAX_LENGTH */
+
+#ifndef SEND_TIMEOUT
+# define SEND_TIMEOUT 10000
+#endif /* !SEND_TIMEOUT */
+
 #include "SEDNL/Export.hpp"
 #include "SEDNL/Exception.hpp"
 #include "SEDNL/SocketInterface.hpp"
 #include "SEDNL/RingBuf.hpp"
+#include "SEDNL/Packet.hpp"
+#include "SEDNL/Metrics.hpp"
 
 #include <iostream>
+#include <deque>
+#include <atomic>
+#include <list>
+#include <unordered_map>
+#include <chrono>
 
 namespace SedNL
 {
@@ -44,6 +79,63 @@ namespace SedNL
     class EventListener;
     class Packet;
 
+//! \brief Codecs used to compress packets.
+//!
+//! See Connection::set_compression().
+enum class Compression
+{
+    //! \brief Packets are sent as they are.
+    None = 0,
+    //! \brief A small LZ77 codec, built in SedNL. Fast.
+    LZ = 1,
+    //! \brief zlib (deflate). Smaller, but slower. Only available
+    //!        if zlib was found when SedNL was configured.
+    Zlib = 2,
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Statistics about the packets compressed
+//!        and decompressed by a connection.
+//!
+//! See Connection::get_compression_stats().
+////////////////////////////////////////////////////////////
+struct SEDNL_API CompressionStats
+{
+    //! \brief Build empty statistics.
+    inline CompressionStats() noexcept;
+
+    //! \brief Packets sent compressed.
+    UInt64 compressed_events;
+    //! \brief Packets above the threshold sent as they are,
+    //!        because the compression didn't shrink them.
+    UInt64 incompressible_events;
+    //! \brief Size of the packets given to the compressor.
+    UInt64 raw_bytes;
+    //! \brief Size of those packets, as sent.
+    UInt64 sent_bytes;
+    //! \brief Time spent compressing.
+    std::chrono::nanoseconds compress_time;
+
+    //! \brief Compressed packets received.
+    UInt64 decompressed_events;
+    //! \brief Size of those packets, as received.
+    UInt64 received_bytes;
+    //! \brief Size of those packets, once decompressed.
+    UInt64 decompressed_bytes;
+    //! \brief Time spent decompressing.
+    std::chrono::nanoseconds decompress_time;
+
+    //! \brief Return sent_bytes / raw_bytes (1 if nothing was compressed).
+    inline double send_ratio() const noexcept;
+
+    //! \brief Return received_bytes / decompressed_bytes
+    //!        (1 if nothing was decompressed).
+    inline double receive_ratio() const noexcept;
+
+    //! \brief Add the counters of \a stats.
+    inline CompressionStats& operator+= (const CompressionStats& stats) noexcept;
+};
+
 ///////////////////////////////////////////////////////////////
 //! \brief Define the the Connection type wich
 //!        handle a connection and allow sending Event objects.
@@ -84,6 +176,9 @@ public:
     //! Send an event packet. It can throw exceptions
     //! (std::exception or NetworkException) if failed.
     //!
+    //! It throws a FrameTooLarge NetworkException if the frame (the
+    //! packet, the name, and 3 bytes) is bigger than MAX_FRAME_SIZE.
+    //!
     //! This function is thread safe, and you can use it to answer
     //! to events with events.
     //!
@@ -103,6 +198,15 @@ public:
     //! \param[in] event The event to send.
     void send(const Event& event) throw(NetworkException, std::exception);
 
+    //! \brief Send the event \a event through the connection.
+    //!
+    //! Same as send(const Event&), but when the event is sent
+    //! with MSG_ZEROCOPY (see set_zerocopy()), its packet is moved
+    //! into the connection instead of being copied.
+    //!
+    //! \param[in] event The event to send.
+    void send(Event&& event) throw(NetworkException, std::exception);
+
     //! \brief Create an event and send it through the connection.
     //!
     //! Same as:
@@ -114,6 +218,16 @@ public:
     //! \param[in] packet The data attached.
     void send(const std::string& name, const Packet& packet) throw(NetworkException, std::exception);
 
+    //! \brief Create an event and send it through the connection.
+    //!
+    //! Same as send(const std::string&, const Packet&), but when the
+    //! packet is sent with MSG_ZEROCOPY (see set_zerocopy()), it is
+    //! moved into the connection instead of being copied.
+    //!
+    //! \param[in] name Name of the event.
+    //! \param[in] packet The data attached.
+    void send(const std::string& name, Packet&& packet) throw(NetworkException, std::exception);
+
     //! \brief Create an empty event named \a name
     //!
     //! Same as:
@@ -124,6 +238,164 @@ public:
     //! \param[in] name Name of the event.
     void send(const std::string& name) throw(NetworkException, std::exception);
 
+    //! \brief Send bytes already framed, like the data of a capture.
+    //!
+    //! The bytes are sent as they are : they should be whole
+    //! frames, or the rest of frames sent with send_raw().
+    //! See CaptureReplayer.
+    //!
+    //! \param[in] data The bytes to send.
+    //! \param[in] length Number of bytes.
+    void send_raw(const char* data, std::size_t length)
+        throw(NetworkException, std::exception);
+
+    //! \brief Send large events without copying them into the kernel.
+    //!
+    //! When enabled, events whose packet is at least \a threshold
+    //! bytes long are sent with MSG_ZEROCOPY (Linux >= 4.14). The
+    //! packet is kept alive by the connection until the kernel
+    //! tells, through the socket error queue, that it doesn't need
+    //! it anymore. Those notifications are processed by the
+    //! EventListener watching the connection, and before each send.
+    //!
+    //! Prefer the send() overloads taking an rvalue: otherwise the
+    //! packet has to be copied to outlive the call.
+    //!
+    //! If the system doesn't support it, or if the kernel reports
+    //! it had to copy the data anyway (for example on the loopback
+    //! interface), the connection silently go back to normal sends.
+    //!
+    //! It only applies to the current socket: call it again after
+    //! TCPClient::connect().
+    //!
+    //! \param[in] enable True to enable zero copy sends.
+    //! \param[in] threshold Minimal packet size, in bytes.
+    //! \return True if zero copy sends are now enabled.
+    bool set_zerocopy(bool enable,
+                      unsigned int threshold = ZEROCOPY_THRESHOLD) noexcept;
+
+    //! \brief Offer the peer to exchange native arrays.
+    //!
+    //! Packets written with Packet::ArrayEncoding::Native contain
+    //! arrays in the byte order of their host, that a host with the
+    //! same byte order can read without any copy (see ArrayView).
+    //!
+    //! This send a control event to the peer. If its EventListener
+    //! understands it and its host has the same byte order, both
+    //! sides start sending native arrays as they are. Until then
+    //! (or forever with older peers), send() converts native
+    //! arrays to the network byte order.
+    //!
+    //! The answer is processed by the EventListener watching
+    //! this connection. See has_native_arrays().
+    void negotiate_native_arrays() throw(NetworkException, std::exception);
+
+    //! \brief Tell if native arrays are sent without conversion.
+    //!
+    //! \return True if the peer accepted native arrays.
+    bool has_native_arrays() noexcept;
+
+    //! \brief Compress the large packets sent.
+    //!
+    //! Packets of at least \a threshold bytes are compressed with
+    //! \a codec, and sent compressed if they shrink. The receiving
+    //! EventListener decompresses them before validating them, so
+    //! it's transparent for the consumers (see Event::is_compressed()).
+    //!
+    //! Compressed packets can be up to COMPRESSION_MAX_SIZE bytes
+    //! once decompressed, but they still have to fit in a frame.
+    //!
+    //! Reading them requires a peer running this version, compiled
+    //! with zlib for Compression::Zlib. See get_compression_stats()
+    //! to tune the threshold.
+    //!
+    //! \param[in] codec Codec to use, Compression::None to disable it.
+    //! \param[in] threshold Minimal packet size, in bytes.
+    //! \return False if the codec isn't available. Compression::LZ
+    //!         is then used instead.
+    bool set_compression(Compression codec,
+                         unsigned int threshold = COMPRESSION_THRESHOLD) noexcept;
+
+    //! \brief Return the codec used to compress the packets sent.
+    //!
+    //! \return The codec, Compression::None if disabled.
+    Compression get_compression() noexcept;
+
+    //! \brief Return the statistics of the packets compressed and
+    //!        decompressed since the creation of the connection
+    //!        (or the last call to reset_compression_stats()).
+    //!
+    //! \return A copy of the statistics.
+    CompressionStats get_compression_stats() noexcept;
+
+    //! \brief Reset the compression statistics.
+    void reset_compression_stats() noexcept;
+
+    //! \brief Return the events and bytes sent and received
+    //!        since the creation of the connection.
+    //!
+    //! Doesn't take the connection lock.
+    //!
+    //! \return A copy of the counters.
+    ConnectionMetrics get_metrics() const noexcept;
+
+    //! \brief Offer the peer to replace the strings sent
+    //!        by indexes in a table of recent strings.
+    //!
+    //! Each side keeps the \a size strings sent most recently
+    //! (at most STRING_TABLE_MAX_SIZE, and STRING_TABLE_MAX_LENGTH
+    //! bytes long): a string already in the table is sent as
+    //! its index, usually two bytes. It's done by send() and by the
+    //! EventListener receiving the events, so consumers still read
+    //! plain strings.
+    //!
+    //! Like negotiate_native_arrays(), this send a control event to
+    //! the peer, and strings are sent as they are until it accepts.
+    //! It only applies to the current socket: call it again after
+    //! TCPClient::connect(). See get_string_table_size().
+    //!
+    //! \param[in] size Number of strings in the table.
+    void set_string_table(unsigned int size = STRING_TABLE_SIZE)
+        throw(NetworkException, std::exception);
+
+    //! \brief Return the size of the string table the peer accepted.
+    //!
+    //! \return The number of strings in the table, 0 if strings
+    //!         are sent as they are.
+    unsigned int get_string_table_size() noexcept;
+
+    //! \brief Tell if large events are sent with MSG_ZEROCOPY.
+    //!
+    //! It can become false after a call to set_zerocopy(true), when
+    //! the kernel reported zero copy sends were actually copied.
+    //!
+    //! \return True if zero copy sends are enabled.
+    bool is_zerocopy() noexcept;
+
+    //! \brief Trust (or not) the packets received from the peer.
+    //!
+    //! Received packets are validated as a whole before being
+    //! delivered (see Packet::is_valid()). For peers you control,
+    //! like your own backend services, you can skip this pass:
+    //! PacketReader still checks the bounds of what is read,
+    //! and throws a PacketException (Truncated, or a type mismatch)
+    //! on a malformed packet. Don't trust client facing connections.
+    //!
+    //! Received packets aren't indexed either, so
+    //! PacketReader::seek() is O(n) on them.
+    //!
+    //! Connections accepted by a TCPServer inherit the setting of
+    //! their EventListener (see EventListener::set_trusted()).
+    //! It's kept after a disconnection.
+    //!
+    //! \param[in] trusted True to skip the validation.
+    void set_trusted(bool trusted) noexcept;
+
+    //! \brief Tell if the packets received are trusted.
+    //!
+    //! \return True if the packets aren't validated.
+    bool is_trusted() noexcept;
+
     //! \brief Link a value to this connection.
     //!
     //! This class assume that you will allways use the same
@@ -248,6 +520,202 @@ private:
     void unsafe_disconnect() noexcept;
     void safe_disconnect() noexcept;
 
+    //! \brief Send the frame of an event named \a name carrying \a packet.
+    //!
+    //! The header and the packet data are given to the system as two
+    //! separate buffers (scatter-gather I/O), so that the packet is
+    //! never copied into a concatenated buffer.
+    //!
+    //! If the frame is sent with MSG_ZEROCOPY, \a packet is moved
+    //! into the pending list when \a owner is not null (it should
+    //! then be &packet), and copied otherwise.
+    void send_frame(const std::string& name, const Packet& packet,
+                    Packet* owner = nullptr)
+        throw(NetworkException, std::exception);
+
+    //! \brief Tell if \a event is a control event, handled by
+    //!        the connection instead of being given to the user.
+    //!
+    //! Control event names start with '\\x01'.
+    static bool is_control_event(const Event& event) noexcept;
+
+    //! \brief Process a control event received from the peer.
+    //!
+    //! Called by the listener thread : answers are queued with
+    //! queue_frame(), it never waits for the socket.
+    void process_control_event(const Event& event) noexcept;
+
+    //! \brief Queue the frame of an event, to be sent before
+    //!        the next frame.
+    //!
+    //! Should be called with m_mutex locked.
+    void queue_frame(const std::string& name, const Packet& packet);
+
+    //! \brief Send the frames queued by queue_frame(), as far as
+    //!        the socket accepts them without waiting.
+    //!
+    //! Should be called with m_send_mutex and m_mutex locked.
+    //!
+    //! \return True if nothing is left to send.
+    bool send_output() noexcept;
+
+    //! \brief Call send_output(), unless an other thread is sending.
+    //!
+    //! Used by the listener thread, that never waits for the
+    //! socket, nor for a thread waiting for it.
+    //!
+    //! \return True if nothing is left to send.
+    bool flush_output() noexcept;
+
+    //! \brief Wait for the socket \a fd to be writable, at most
+    //!        SEND_TIMEOUT milliseconds, with \a lock (on m_mutex)
+    //!        released.
+    //!
+    //! \return False if the timeout expired, or if the connection
+    //!         was closed meanwhile.
+    bool wait_socket(std::unique_lock<std::mutex>& lock, FileDescriptor fd);
+
+    //! \brief Serialize the writes to the socket, so that frames
+    //!        are never interleaved.
+    //!
+    //! Taken before m_mutex. A sender waiting for the socket keeps
+    //! it, but releases m_mutex so that the listener thread, that
+    //! only takes m_mutex, never waits for the peer.
+    std::mutex m_send_mutex;
+
+    //! \brief Frames queued by queue_frame(), or their remainder.
+    ByteArray m_output;
+
+    //! \brief Number of frames in m_output.
+    unsigned int m_output_events;
+
+    //! \brief True if the peer accepted native arrays.
+    bool m_native_arrays;
+
+    //! \brief True if we offered native arrays to the peer.
+    bool m_native_offered;
+
+    //! \brief True if received packets aren't validated.
+    std::atomic<bool> m_trusted;
+
+    //! \brief Codec of the packets sent.
+    Compression m_compression;
+
+    //! \brief Minimal packet size compressed.
+    unsigned int m_compression_threshold;
+
+    //! \brief Statistics of the packets compressed, under m_mutex.
+    CompressionStats m_compression_stats;
+
+    //! \brief Statistics of the packets decompressed, written by
+    //!        the listener thread.
+    MetricCounter m_decompressed_events;
+    MetricCounter m_decompressed_received_bytes;
+    MetricCounter m_decompressed_bytes;
+    MetricCounter m_decompress_ns;
+
+    //! \brief Values of those counters at the last
+    //!        reset_compression_stats(), under m_mutex.
+    CompressionStats m_decompression_base;
+
+    //! \brief Counters of the events received, written by the
+    //!        listener thread.
+    MetricCounter m_events_in;
+    MetricCounter m_bytes_in;
+    //! \brief Counters of the events sent, written under m_mutex.
+    MetricCounter m_events_out;
+    MetricCounter m_bytes_out;
+
+    //! \brief The strings sent recently, and the index of
+    //!        the peer's table where each one is stored.
+    //!
+    //! Only the sender evicts strings (the least recently used
+    //! one), and tells the peer where to store each new string.
+    struct StringTable
+    {
+        inline StringTable();
+
+        //! \brief Empty the table, and set its size.
+        void reset(unsigned int size);
+
+        //! \brief Find \a str, or store it in place of the least
+        //!        recently used string.
+        //!
+        //! \param[out] slot Index of \a str in the table.
+        //! \return True if \a str was already in the table.
+        bool find(const std::string& str, UInt32& slot);
+
+        struct Entry
+        {
+            std::string str;
+            UInt32 slot;
+        };
+
+        //! \brief Number of strings, 0 if disabled.
+        unsigned int size;
+
+        //! \brief Strings, the most recently used first.
+        std::list<Entry> entries;
+
+        //! \brief Position of each string in \a entries.
+        std::unordered_map<std::string, std::list<Entry>::iterator> positions;
+    };
+
+    //! \brief Strings sent recently.
+    StringTable m_string_table;
+
+    //! \brief Size of the string table offered to the peer.
+    unsigned int m_string_table_offered;
+
+    //! \brief Write \a packet into \a out, replacing its strings by
+    //!        Packet::Type::StringDef and Packet::Type::StringRef items.
+    //!
+    //! Should be called with m_mutex locked.
+    //!
+    //! \return False if \a packet doesn't contain any string.
+    bool encode_strings(const Packet& packet, Packet& out);
+
+    //! \brief Empty the string table, and queue a new offer.
+    //!
+    //! Called when a frame whose strings were encoded isn't sent:
+    //! the peer doesn't know the strings it defined.
+    //!
+    //! Should be called with m_send_mutex and m_mutex locked.
+    void renegotiate_string_table();
+
+    //! \brief Process MSG_ZEROCOPY notifications from the
+    //!        socket error queue, and release the packets
+    //!        the kernel doesn't use anymore.
+    //!
+    //! Should be called with m_mutex locked.
+    //!
+    //! \return The number of notifications processed, or -1
+    //!         if the error queue contained an other error.
+    int reap_zerocopy() noexcept;
+
+    //! \brief A frame sent with MSG_ZEROCOPY, that should stay
+    //!        alive until the kernel notify its completion.
+    struct ZeroCopyFrame
+    {
+        //! \brief Id of the last sendmsg call using this frame.
+        UInt32 last_id;
+        ByteArray header;
+        Packet packet;
+    };
+
+    //! \brief True if MSG_ZEROCOPY sends are enabled.
+    bool m_zerocopy;
+
+    //! \brief Minimal packet size sent with MSG_ZEROCOPY.
+    unsigned int m_zerocopy_threshold;
+
+    //! \brief Id the kernel will give to the next
+    //!        sendmsg call with MSG_ZEROCOPY.
+    UInt32 m_zerocopy_next_id;
+
+    //! \brief Frames waiting for their completion, ordered by id.
+    std::deque<ZeroCopyFrame> m_zerocopy_pending;
+
     //! \brief Network input stream (partialy received events
     //!        are stored here).
     RingBuf m_buffer;
@@ -27,10 +27,56 @@
 namespace SedNL
 {
 
+CompressionStats::CompressionStats() noexcept
+    :compressed_events(0), incompressible_events(0),
+     raw_bytes(0), sent_bytes(0), compress_time(0),
+     decompressed_events(0), received_bytes(0),
+     decompressed_bytes(0), decompress_time(0)
+{}
+
+double CompressionStats::send_ratio() const noexcept
+{
+    if (raw_bytes == 0)
+        return 1.;
+    return static_cast<double>(sent_bytes) / raw_bytes;
+}
+
+double CompressionStats::receive_ratio() const noexcept
+{
+    if (decompressed_bytes == 0)
+        return 1.;
+    return static_cast<double>(received_bytes) / decompressed_bytes;
+}
+
+CompressionStats& CompressionStats::operator+= (const CompressionStats& stats) noexcept
+{
+    compressed_events += stats.compressed_events;
+    incompressible_events += stats.incompressible_events;
+    raw_bytes += stats.raw_bytes;
+    sent_bytes += stats.sent_bytes;
+    compress_time += stats.compress_time;
+    decompressed_events += stats.decompressed_events;
+    received_bytes += stats.received_bytes;
+    decompressed_bytes += stats.decompressed_bytes;
+    decompress_time += stats.decompress_time;
+    return *this;
+}
+
+Connection::StringTable::StringTable()
+    :size(0)
+{}
+
 //If you wonder why CONNECTION_BUFFER_SIZE-1, see RingBuf implementation.
 Connection::Connection()
     :m_data_type(UserDataType::None), m_data_double(0),
-     m_listener(nullptr), m_buffer(CONNECTION_BUFFER_SIZE-1)
+     m_listener(nullptr), m_output_events(0),
+     m_native_arrays(false), m_native_offered(false), m_trusted(false),
+     m_compression(Compression::None),
+     m_compression_threshold(COMPRESSION_THRESHOLD),
+     m_string_table_offered(0),
+     m_zerocopy(false), m_zerocopy_threshold(ZEROCOPY_THRESHOLD),
+     m_zerocopy_next_id(0),
+     m_buffer(CONNECTION_BUFFER_SIZE-1)
 {}
 
 Connection::~Connection() noexcept
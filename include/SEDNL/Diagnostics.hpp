@@ -0,0 +1,107 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef DIAGNOSTICS_HPP_
+#define DIAGNOSTICS_HPP_
+
+#include "SEDNL/Export.hpp"
+#include "SEDNL/Types.hpp"
+#include "SEDNL/Slot.hpp"
+
+namespace SedNL
+{
+
+//! \brief Severity of a diagnostic.
+enum class DiagnosticLevel
+{
+    Warning,
+    Error,
+};
+
+////////////////////////////////////////////////////////////
+//! \brief A warning or an error reported by SedNL.
+//!
+//! Diagnostics are formatted by the thread which reports them
+//! and delivered to the sink by a background thread, so that
+//! a flood of invalid packets or of full queues never blocks
+//! the network threads on std::cerr.
+////////////////////////////////////////////////////////////
+struct SEDNL_API Diagnostic
+{
+    //! \brief Severity of the diagnostic.
+    DiagnosticLevel level;
+    //! \brief Name of the place which reported it
+    //!        (like "RingBuf::invalid_packet").
+    const char* site;
+    //! \brief The message, without the severity prefix.
+    const char* message;
+    //! \brief Number of diagnostics of this site dropped by the
+    //!        rate limiter. When it isn't 0, this diagnostic is a
+    //!        summary of the last second rather than a message.
+    UInt64 suppressed;
+};
+
+//! \brief Callback receiving the diagnostics.
+typedef Slot<const Diagnostic&> DiagnosticSink;
+
+//! \brief Set the callback receiving the diagnostics.
+//!
+//! The sink is called from the diagnostic thread, or from the
+//! thread calling flush_diagnostics(), one diagnostic at a time.
+//! An empty sink discards all the diagnostics.
+//! By default, diagnostics are written to std::cerr.
+SEDNL_API void set_diagnostic_sink(const DiagnosticSink& sink);
+
+//! \brief The default sink, writing \a diagnostic to std::cerr.
+SEDNL_API void cerr_diagnostic_sink(const Diagnostic& diagnostic);
+
+//! \brief Deliver all the pending diagnostics (and summaries of
+//!        the rate limiter) before returning.
+//!
+//! It is also done when the program exits.
+SEDNL_API void flush_diagnostics() noexcept;
+
+} // namespace SedNL
+
+#endif /* !DIAGNOSTICS_HPP_ */
+
+////////////////////////////////////////////////////////////
+//!
+//! \file Diagnostics.hpp
+//! \brief Report warnings and errors out of the hot path.
+//!
+//! Each place reporting diagnostics is limited to a few messages
+//! per second. Above the limit, the messages are counted and a
+//! summary is reported once the second is over, like
+//! "Warning: RingBuf::invalid_packet: 42 messages dropped in the
+//! last second."
+//!
+//! \code
+//! DiagnosticSink sink;
+//! sink.set_function([&](const Diagnostic& d) {
+//!     log.write(d.message);
+//! });
+//! set_diagnostic_sink(sink);
+//! \endcode
+//!
+//! Building with SEDNL_NOWARN removes the diagnostics.
+//!
+////////////////////////////////////////////////////////////
@@ -47,6 +47,12 @@ public:
     //! \param[in] packet The data attached.
     inline Event(const std::string& name, const Packet& packet);
 
+    //! \brief Construct an event from a packet, without copying it.
+    //!
+    //! \param[in] name Name of the event.
+    //! \param[in] packet The data attached.
+    inline Event(const std::string& name, Packet&& packet);
+
     //! \brief Return a reference to the packet handled.
     //!
     //! Once this event is destructed, the packet will be
@@ -64,6 +70,14 @@ public:
     //! \return A handler to the event name.
     inline const std::string& get_name() const noexcept;
 
+    //! \brief Tell if the event was received compressed.
+    //!
+    //! Its packet is already decompressed. See
+    //! Connection::set_compression().
+    //!
+    //! \return True if the packet was compressed on the wire.
+    inline bool is_compressed() const noexcept;
+
     //! \brief Compute the binary header of an event.
     //!
     //! Low level function, used by the implementation.
@@ -78,6 +92,9 @@ public:
     //! Low level function. Return the concatenated value
     //! of Event::get_header() and Packet::get_data().
     //!
+    //! Connection::send() doesn't rely on it: the header and
+    //! the packet data are sent without being concatenated.
+    //!
     //! \return The serialised event as a binary string.
     ByteArray pack() const;
 
@@ -96,6 +113,19 @@ private:
 
     //! \brief Packet containing data.
     Packet m_packet;
+
+    //! \brief True if the packet was received compressed.
+    bool m_compressed;
+
+    //! \brief Time at which the event was received and queued,
+    //!        see latency_clock(). 0 if the latency isn't tracked.
+    UInt64 m_received_time;
+    UInt64 m_queued_time;
+
+    friend class Connection;
+    friend class RingBuf;
+    friend class EventListener;
+    friend class EventConsumer;
 };
 
 //! \brief Allow creating easily new events.
@@ -106,7 +136,7 @@ private:
 //! \param[in] args Values to write into the packet.
 //! \return The newly created event.
 template<typename... Args>
-Event make_event(const std::string& event_name, Args... args);
+Event make_event(const std::string& event_name, const Args&... args);
 
 
 //! \brief Display an Event in a JSON like format.
@@ -35,6 +35,9 @@ void Event::swap(Event& event) noexcept
     //basic_string's swap doesn't throw.
     swap(event.m_name, m_name);
     swap(event.m_packet, m_packet);
+    swap(event.m_compressed, m_compressed);
+    swap(event.m_received_time, m_received_time);
+    swap(event.m_queued_time, m_queued_time);
 }
 
 inline
@@ -44,11 +47,18 @@ void swap(Event& a, Event& b) noexcept
 }
 
 Event::Event(std::string name)
-    :m_name(name)
+    :m_name(name), m_compressed(false),
+     m_received_time(0), m_queued_time(0)
 {}
 
 Event::Event(const std::string& name, const Packet& packet)
-    :m_name(name), m_packet(packet)
+    :m_name(name), m_packet(packet), m_compressed(false),
+     m_received_time(0), m_queued_time(0)
+{}
+
+Event::Event(const std::string& name, Packet&& packet)
+    :m_name(name), m_packet(std::move(packet)), m_compressed(false),
+     m_received_time(0), m_queued_time(0)
 {}
 
 const std::string& Event::get_name() const noexcept
@@ -56,6 +66,11 @@ const std::string& Event::get_name() const noexcept
     return m_name;
 }
 
+bool Event::is_compressed() const noexcept
+{
+    return m_compressed;
+}
+
 const Packet& Event::get_packet() const noexcept
 {
     return m_packet;
@@ -63,7 +78,7 @@ const Packet& Event::get_packet() const noexcept
 
 template<typename... Args>
 inline
-Event make_event(const std::string& event_name, Args... args)
+Event make_event(const std::string& event_name, const Args&... args)
 {
     return Event(event_name, make_packet(args...));
 }
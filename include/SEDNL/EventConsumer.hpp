@@ -26,13 +26,17 @@
 #include "SEDNL/Export.hpp"
 #include "SEDNL/Exception.hpp"
 #include "SEDNL/Types.hpp"
+#include "SEDNL/Event.hpp"
 #include "SEDNL/Slot.hpp"
+#include "SEDNL/Metrics.hpp"
+#include "SEDNL/Latency.hpp"
 #include "SEDNL/ThreadHelp.hpp"
 
 #include <unordered_map>
 #include <condition_variable>
 #include <thread>
 #include <mutex>
+#include <memory>
 
 namespace SedNL
 {
@@ -186,6 +190,63 @@ public:
     //!                       this callback.
     inline Slot<Connection&, const Event&>& bind(std::string event_name);
 
+    //! \brief Bind a new event to a member function known at compile time.
+    //!
+    //! Usage: `consumer.bind<MyHandler, &MyHandler::on_move>("move", &handler);`
+    //!
+    //! Same as `bind(event_name).set_function<T, callback>(instance)`.
+    //! The member function is called directly by the consumer, instead
+    //! of through a pointer to member function.
+    //!
+    //! \param[in] event_name Name of the event that will be associated with
+    //!                       this callback.
+    //! \param[in] instance The instance pointer that will be stored.
+    template<typename T, void (T::*callback)(Connection&, const Event&)>
+    inline Slot<Connection&, const Event&>& bind(std::string event_name,
+                                                 T* instance);
+
+    //! \brief Bind a new event to a callback receiving the content
+    //!        of its packet.
+    //!
+    //! Usage:
+    //! \code
+    //! consumer.bind<std::string, Int32, std::vector<float>>("move",
+    //!     [](Connection& c, std::string& name, Int32 id,
+    //!        std::vector<float>& position) { ... });
+    //! \endcode
+    //!
+    //! The packet of each event is read, with PacketReader::try_read(),
+    //! into a value of each type of \a Types, in order. Those values are
+    //! then given to \a callback, after the connection.
+    //!
+    //! Events whose packet doesn't contain exactly those types are
+    //! dropped, with a warning, before \a callback is called.
+    //!
+    //! \param[in] event_name Name of the event that will be associated with
+    //!                       this callback.
+    //! \param[in] callback The callback, called as
+    //!                     `callback(Connection&, Types&...)`.
+    template<typename... Types, typename F>
+    inline Slot<Connection&, const Event&>& bind(std::string event_name,
+                                                 F callback);
+
+    //! \brief Return the counters of the consumer.
+    //!
+    //! Can be called at any time, from any thread, while
+    //! the consumer is running. See ConsumerMetrics.
+    //!
+    //! \return A snapshot of the counters.
+    ConsumerMetrics get_metrics() const;
+
+    //! \brief Return the latency of the events processed, by name.
+    //!
+    //! Only the events of a listener tracking latency are
+    //! measured, see EventListener::set_latency_tracking().
+    //! Can be called from any thread, while the consumer is running.
+    //!
+    //! \return The percentiles of the latencies, by event name.
+    std::map<std::string, EventLatency> get_latency() const;
+
 private:
     ConsumerDescriptor m_descriptor;
 
@@ -200,6 +261,17 @@ private:
 
     SafeType<bool> m_running;
 
+    //
+    // Metrics, written by the consumer thread
+    //
+
+    EventCountersMap m_event_counters;
+    MetricCounter m_events_out;
+    MetricCounter m_disconnections;
+    MetricCounter m_dropped_mismatched;
+    MetricCounter m_handler_exceptions;
+    MetricMap<EventLatencyHistograms> m_latency;
+
     //
     // Consumer implementation
     //
@@ -207,12 +279,38 @@ private:
     void run_init();
     void run_imp();
 
+    //! \brief Warn that the packet of \a event didn't match the types
+    //!        bound to the event.
+    void drop_mismatched(const Event& event, PacketExceptionT error);
+
     //! \brief Remove empty slots from the map.
     void clean_slots();
 
     //! \brief Consume events available from producer.
     void consume_events() noexcept;
 
+    typedef std::pair<std::shared_ptr<Connection>, Event> CnEvent;
+    typedef SafeQueue<CnEvent> EventQueue;
+    typedef SafeQueue<std::shared_ptr<Connection>> ConnectionQueue;
+    typedef SafeQueue<TCPServer *> ServerQueue;
+
+    //! \brief Give the elements of \a queue to \a slot.
+    //!
+    //! \param[in] name Name of the events of \a queue.
+    template<typename S>
+    void process(CnEvent& e, S& slot, EventQueue& queue,
+                 const std::string& name);
+
+    //! See process(CnEvent&, S&, EventQueue&, const std::string&).
+    template<typename S>
+    void process(CnEvent& e, S& slot, ConnectionQueue& queue,
+                 const std::string& name);
+
+    //! See process(CnEvent&, S&, EventQueue&, const std::string&).
+    template<typename S>
+    void process(CnEvent& e, S& slot, ServerQueue& queue,
+                 const std::string& name);
+
     friend class EventListener;
 };
 
@@ -22,9 +22,58 @@
 #ifndef EVENT_CONSUMER_IPP_
 #define EVENT_CONSUMER_IPP_
 
+#include <tuple>
+#include <type_traits>
+
 namespace SedNL
 {
 
+//! @cond Doxygen_Suppress
+
+//A list of indices of a tuple.
+template <std::size_t... Indices>
+struct ArgumentIndices
+{};
+
+template <std::size_t N, std::size_t... Indices>
+struct MakeArgumentIndices : MakeArgumentIndices<N - 1, N - 1, Indices...>
+{};
+
+template <std::size_t... Indices>
+struct MakeArgumentIndices<0, Indices...>
+{
+    typedef ArgumentIndices<Indices...> type;
+};
+
+//Read each element of a tuple, in order, from a packet.
+template <std::size_t N, typename Tuple>
+struct ArgumentsReader
+{
+    static bool read(PacketReader& reader, Tuple& args)
+    {
+        return ArgumentsReader<N - 1, Tuple>::read(reader, args)
+            && reader.try_read(std::get<N - 1>(args));
+    }
+};
+
+template <typename Tuple>
+struct ArgumentsReader<0, Tuple>
+{
+    static bool read(PacketReader&, Tuple&)
+    {
+        return true;
+    }
+};
+
+template <typename F, typename Tuple, std::size_t... Indices>
+inline void call_with_arguments(F& callback, Connection& connection,
+                                Tuple& args, ArgumentIndices<Indices...>)
+{
+    callback(connection, std::get<Indices>(args)...);
+}
+
+//! @endcond
+
 Slot<Connection&>& EventConsumer::on_disconnect()
 {
     return m_on_disconnect_slot;
@@ -45,6 +94,37 @@ Slot<Connection&, const Event&>& EventConsumer::bind(std::string event_name)
     return m_slots[event_name];
 }
 
+template<typename T, void (T::*callback)(Connection&, const Event&)>
+Slot<Connection&, const Event&>& EventConsumer::bind(std::string event_name,
+                                                     T* instance)
+{
+    Slot<Connection&, const Event&>& slot = m_slots[event_name];
+    slot.template set_function<T, callback>(instance);
+    return slot;
+}
+
+template<typename... Types, typename F>
+Slot<Connection&, const Event&>& EventConsumer::bind(std::string event_name,
+                                                     F callback)
+{
+    typedef std::tuple<typename std::decay<Types>::type...> Arguments;
+
+    Slot<Connection&, const Event&>& slot = m_slots[event_name];
+    slot.set_function([this, callback](Connection& connection, const Event& event) mutable {
+            Arguments args;
+            PacketReader reader(event.get_packet());
+
+            if (!ArgumentsReader<sizeof...(Types), Arguments>::read(reader, args))
+                return drop_mismatched(event, reader.get_error());
+            if (reader)
+                return drop_mismatched(event, PacketExceptionT::TrailingData);
+
+            call_with_arguments(callback, connection, args,
+                                typename MakeArgumentIndices<sizeof...(Types)>::type());
+        });
+    return slot;
+}
+
 } // namespace SedNL
 
 #endif /* !EVENT_CONSUMER_IPP_ */
@@ -30,6 +30,7 @@
 #include "SEDNL/Types.hpp"
 #include "SEDNL/Event.hpp"
 #include "SEDNL/Slot.hpp"
+#include "SEDNL/Metrics.hpp"
 
 #include <queue>
 #include <map>
@@ -37,6 +38,13 @@
 #include <thread>
 #include <mutex>
 #include <memory>
+#include <atomic>
+
+//! Maximal number of EventListener::inject() calls waiting for the
+//! listener thread : the next ones wait for it.
+#ifndef INJECT_QUEUE_SIZE
+# define INJECT_QUEUE_SIZE 256
+#endif /* !INJECT_QUEUE_SIZE */
 
 namespace SedNL
 {
@@ -185,6 +193,84 @@ public:
     //! you would like to keep it small and fast.
     inline Slot<Connection&>& on_connect();
 
+    //! \brief Trust (or not) the connections accepted from now.
+    //!
+    //! Connections accepted from the attached servers get this
+    //! setting, see Connection::set_trusted(). Only use it for
+    //! servers reserved to your own services. You can still choose
+    //! connection by connection from the on_connect() callback.
+    //!
+    //! You can't call it while the listener is running.
+    //!
+    //! \param[in] trusted True to skip the validation of the packets.
+    void set_trusted(bool trusted) throw(EventException);
+
+    //! \brief Tell if accepted connections are trusted.
+    //!
+    //! \return True if the accepted connections are trusted.
+    inline bool is_trusted() const noexcept;
+
+    //! \brief Timestamp (or not) the events received, to measure
+    //!        their latency.
+    //!
+    //! Events are timestamped when received (by the kernel if it
+    //! supports SO_TIMESTAMPING, at the return of recv() otherwise)
+    //! and when queued. Consumers add the time at which they pop
+    //! them and the time their callback returns, and keep histograms
+    //! of those latencies by event name (see
+    //! EventConsumer::get_latency()).
+    //!
+    //! Disabled by default : untracked events don't read any clock.
+    //! You can't call it while the listener is running.
+    //!
+    //! \param[in] enable True to track latency.
+    void set_latency_tracking(bool enable) throw(EventException);
+
+    //! \brief Tell if the latency of the events is tracked.
+    //!
+    //! \return True if the events are timestamped.
+    inline bool is_latency_tracked() const noexcept;
+
+    //! \brief Append the data received by the listener to
+    //!        a capture file.
+    //!
+    //! Each read from a connection is appended, with its time of
+    //! reception and the connection's file descriptor, to the
+    //! memory-mapped file \a path (see CaptureWriter). Closed
+    //! connections are recorded too. Use CaptureReplayer to
+    //! replay the capture.
+    //!
+    //! An empty \a path stops the capture, and closes the file.
+    //! You can't call it while the listener is running.
+    //!
+    //! \param[in] path The capture file, created or truncated.
+    void set_capture(const std::string& path) throw(EventException);
+
+    //! \brief Process \a data as if it was received from \a connection.
+    //!
+    //! The events are read from \a data and queued for the consumers,
+    //! like the data read from a socket. It is meant to replay captures
+    //! (see CaptureReplayer).
+    //!
+    //! While the listener is running, \a data is copied and processed
+    //! by its thread, and this call waits if INJECT_QUEUE_SIZE calls
+    //! are already waiting. Otherwise, it is processed by the calling
+    //! thread.
+    //!
+    //! \param[in] connection The connection given to the consumers.
+    //! \param[in] data The bytes received.
+    //! \param[in] length Number of bytes.
+    void inject(const std::shared_ptr<Connection>& connection,
+                const char* data, unsigned int length);
+
+    //! \brief Return the counters of the listener.
+    //!
+    //! Can be called at any time, from any thread, while
+    //! the listener is running. See ListenerMetrics.
+    //!
+    //! \return A snapshot of the counters.
+    ListenerMetrics get_metrics() const;
+
 private:
     //! \brief the connection event slot.
     Slot<Connection&> m_on_connect_slot;
@@ -195,6 +281,15 @@ private:
     //! \brief Maximal size of a queue.
     unsigned int m_max_queue_size;
 
+    //! \brief True if accepted connections are trusted.
+    bool m_trusted;
+
+    //! \brief True if received events are timestamped.
+    bool m_latency_tracking;
+
+    //! \brief Capture of the data received, or nullptr.
+    std::unique_ptr<CaptureWriter> m_capture;
+
     //! \brief The EventListener thread.
     std::thread m_thread;
 
@@ -227,6 +322,63 @@ private:
     //! \brief The map of all event queue.
     EventMap m_events;
 
+    //! \brief Connections whose answers to control events are
+    //!        waiting for the socket (see Connection::flush_output()).
+    std::vector<std::shared_ptr<Connection>> m_unflushed;
+
+    //! \brief Data given to inject() while the listener runs.
+    struct Injection
+    {
+        std::shared_ptr<Connection> connection;
+        ByteArray data;
+        UInt64 received_time;
+    };
+
+    //! \brief Data waiting for the listener thread.
+    SafeQueue<Injection> m_injected;
+
+    //! \brief Pipe written by inject() to wake the listener thread up,
+    //!        -1 if there is none (it then waits up to 100 ms).
+    FileDescriptor m_wake_pipe[2];
+
+    //! \brief Process the data queued by inject().
+    void process_injected();
+
+    //! \brief Process \a data given to inject(), from the thread
+    //!        owning the connections and the queues.
+    void process_injection(const std::shared_ptr<Connection>& connection,
+                           const char* data, unsigned int length,
+                           UInt64 received_time);
+
+    //! \brief Return the queue of the events \a name, creating it
+    //!        under m_metrics_mutex if needed.
+    EventQueue& event_queue(const std::string& name);
+
+    // --------------------------------------------------
+    //
+    // Metrics, written by the listener thread unless
+    // specified otherwise.
+    //
+    // --------------------------------------------------
+
+    //! \brief Held to add names to m_events, and to read
+    //!        them from other threads.
+    mutable std::mutex m_metrics_mutex;
+
+    EventCountersMap m_event_counters;
+    MetricCounter m_bytes_in;
+    MetricCounter m_events_in;
+    MetricCounter m_accepts;
+    MetricCounter m_failed_accepts;
+    MetricCounter m_dropped_queue_full;
+    MetricCounter m_dropped_invalid_packets;
+    MetricCounter m_wait_time;
+    MetricCounter m_process_time;
+    MetricCounter m_wake_ups;
+    //! \brief Also written by the threads calling Connection::disconnect().
+    std::atomic<UInt64> m_disconnects;
+    std::atomic<UInt64> m_dropped_disconnections;
+
     //
     // We assert that each list contain only one
     // time the same object.
@@ -264,6 +416,21 @@ private:
     //! \brief Read data (or close) from the connection fd.
     void read_connection(FileDescriptor fd);
 
+    //! \brief Read the events of the \a length bytes of \a data
+    //!        received from \a cn at \a received_time, and queue them.
+    //!
+    //! \return False if the data can't be buffered (protocol error) :
+    //!         the connection should be closed.
+    bool process_data(const std::shared_ptr<Connection>& cn,
+                      const char* data, unsigned int length,
+                      UInt64 received_time);
+
+    //! \brief Process the MSG_ZEROCOPY notifications of the connection fd.
+    //!
+    //! \return False if the error wasn't a notification, and the
+    //!         connection should be closed.
+    bool reap_zerocopy(FileDescriptor fd) noexcept;
+
     //! \brief Return the TCPServer associated, or nullptr.
     TCPServer* get_server(FileDescriptor fd) noexcept;
 
@@ -30,6 +30,16 @@ Slot<Connection&>& EventListener::on_connect()
     return m_on_connect_slot;
 }
 
+bool EventListener::is_trusted() const noexcept
+{
+    return m_trusted;
+}
+
+bool EventListener::is_latency_tracked() const noexcept
+{
+    return m_latency_tracking;
+}
+
 } // namespace SedNL
 
 #endif /* !EVENT_LISTENER_IPP_ */
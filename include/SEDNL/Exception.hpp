@@ -71,6 +71,8 @@ namespace SedNL
         CantSetNonblocking,
         //! Connection timed out.
         TimedOut,
+        //! The event doesn't fit in a frame.
+        FrameTooLarge,
     };
 
     //////////////////////////////////////////////
@@ -92,6 +94,10 @@ namespace SedNL
         PollerCreateFailed,
         //! Failed to add a connection to the poller.
         PollerAddFailed,
+        //! Failed to create, map or extend a capture file.
+        CaptureFailed,
+        //! The file isn't a capture file.
+        InvalidCapture,
     };
 
     //////////////////////////////////////////////
@@ -111,8 +117,12 @@ namespace SedNL
         Int64Expected,
         FloatExpected,
         DoubleExpected,
+        VarIntExpected,
+        VarUIntExpected,
         StringExpected,
+        BlobExpected,
         ObjectExpected,
+        ObjectArrayExpected,
 
         ArrayUInt8Expected,
         ArrayUInt16Expected,
@@ -127,7 +137,14 @@ namespace SedNL
 
         EmptyObject,
         WrongSizedObject,
+        SchemaMismatch,
         WrongArray,
+        NoSuchField,
+        Truncated,
+        VarIntOverflow,
+        UnknownObject,
+        EndOfPacket,
+        TrailingData,
         Unknown,
 
         //! @endcond
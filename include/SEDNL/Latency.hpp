@@ -0,0 +1,162 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+#ifndef LATENCY_HPP_
+#define LATENCY_HPP_
+
+#ifndef LATENCY_MAX_EXPONENT
+# define LATENCY_MAX_EXPONENT 40
+#endif /* !LATENCY_MAX_EXPONENT */
+
+#include "SEDNL/Export.hpp"
+#include "SEDNL/Types.hpp"
+#include "SEDNL/Metrics.hpp"
+
+#include <chrono>
+
+namespace SedNL
+{
+
+//! \brief Return the time used to timestamp events, in
+//!        nanoseconds of std::chrono::steady_clock.
+inline UInt64 latency_clock() noexcept;
+
+////////////////////////////////////////////////////////////
+//! \brief Percentiles of a latency.
+////////////////////////////////////////////////////////////
+struct SEDNL_API LatencyStats
+{
+    inline LatencyStats() noexcept;
+
+    //! \brief Number of measures.
+    UInt64 count;
+    //! \brief Median.
+    std::chrono::nanoseconds p50;
+    //! \brief 99th percentile.
+    std::chrono::nanoseconds p99;
+    //! \brief 99.9th percentile.
+    std::chrono::nanoseconds p999;
+    //! \brief Biggest measure.
+    std::chrono::nanoseconds max;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Latencies of the events of one name, stage by stage.
+//!
+//! See EventListener::set_latency_tracking().
+////////////////////////////////////////////////////////////
+struct SEDNL_API EventLatency
+{
+    //! \brief From the reception by the kernel (or the return of
+    //!        recv() when the kernel doesn't timestamp packets) to
+    //!        the push in the event queue.
+    LatencyStats receive;
+    //! \brief Time spent in the event queue, until the consumer
+    //!        pops the event.
+    LatencyStats queue;
+    //! \brief Time spent in the callback.
+    LatencyStats handler;
+    //! \brief From the reception to the return of the callback.
+    LatencyStats total;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief A log-linear histogram of latencies.
+//!
+//! Latencies below 8 ns have their own bucket. Above, each
+//! power of two is split in 8 buckets, so a percentile is at
+//! most 12.5% above the exact value. Latencies above
+//! 2^LATENCY_MAX_EXPONENT ns share the last bucket.
+//!
+//! record() must be called by a single thread, stats() can be
+//! called from any thread.
+////////////////////////////////////////////////////////////
+class SEDNL_API LatencyHistogram
+{
+public:
+    //! \brief Record a latency of \a ns nanoseconds.
+    inline void record(UInt64 ns) noexcept;
+
+    //! \brief Compute the percentiles of the latencies recorded.
+    LatencyStats stats() const noexcept;
+
+    //! \brief Return the latency of the \a q quantile
+    //!        (0.5 for the median), 0 if nothing was recorded.
+    UInt64 percentile(double q) const noexcept;
+
+    //! \brief Number of buckets.
+    static const unsigned int BUCKETS = (LATENCY_MAX_EXPONENT - 2) * 8 + 1;
+
+private:
+    //! \brief Return the bucket of a latency.
+    static inline unsigned int bucket(UInt64 ns) noexcept;
+
+    //! \brief Return the biggest latency of a bucket.
+    static UInt64 bucket_max(unsigned int bucket) noexcept;
+
+    MetricCounter m_buckets[BUCKETS];
+    MetricCounter m_max;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief The histograms of the stages of EventLatency.
+////////////////////////////////////////////////////////////
+struct EventLatencyHistograms
+{
+    LatencyHistogram receive;
+    LatencyHistogram queue;
+    LatencyHistogram handler;
+    LatencyHistogram total;
+
+    //! \brief Record the latencies of an event received at
+    //!        \a received, queued at \a queued, popped at
+    //!        \a popped, and processed at \a done.
+    inline void record(UInt64 received, UInt64 queued,
+                       UInt64 popped, UInt64 done) noexcept;
+};
+
+} // namespace SedNL
+
+#include "SEDNL/Latency.ipp"
+
+#endif /* !LATENCY_HPP_ */
+
+////////////////////////////////////////////////////////////
+//!
+//! \file Latency.hpp
+//! \brief Histograms of the latency of events.
+//!
+//! When a listener tracks latency (see
+//! EventListener::set_latency_tracking()), its consumers
+//! record, for each event name, the time spent between the
+//! reception of an event and the return of its callback.
+//!
+//! \code
+//! listener.set_latency_tracking(true);
+//! //...
+//! EventLatency latency = consumer.get_latency()["move"];
+//! std::cout << "p99: " << latency.total.p99.count() << " ns, "
+//!           << "in the queue: " << latency.queue.p99.count() << " ns"
+//!           << std::endl;
+//! \endcode
+//!
+////////////////////////////////////////////////////////////
@@ -0,0 +1,76 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+#ifndef LATENCY_IPP_
+#define LATENCY_IPP_
+
+namespace SedNL
+{
+
+inline UInt64 latency_clock() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LatencyStats::LatencyStats() noexcept
+    :count(0), p50(0), p99(0), p999(0), max(0)
+{}
+
+unsigned int LatencyHistogram::bucket(UInt64 ns) noexcept
+{
+    if (ns < 8)
+        return static_cast<unsigned int>(ns);
+    if (ns >> LATENCY_MAX_EXPONENT)
+        return BUCKETS - 1;
+
+    //Position of the highest bit, then the 3 bits following it.
+#ifdef __GNUC__
+    const unsigned int exponent = 63 - __builtin_clzll(ns);
+#else /* __GNUC__ */
+    unsigned int exponent = 3;
+    while (ns >> (exponent + 1))
+        exponent++;
+#endif /* __GNUC__ */
+    const unsigned int sub = (ns >> (exponent - 3)) & 7;
+    return (exponent - 2) * 8 + sub;
+}
+
+void LatencyHistogram::record(UInt64 ns) noexcept
+{
+    m_buckets[bucket(ns)].add();
+    m_max.raise(ns);
+}
+
+void EventLatencyHistograms::record(UInt64 received, UInt64 queued,
+                                    UInt64 popped, UInt64 done) noexcept
+{
+    //The clocks of the kernel and of the process can be slightly apart
+    receive.record(queued > received ? queued - received : 0);
+    queue.record(popped - queued);
+    handler.record(done - popped);
+    total.record(done > received ? done - received : 0);
+}
+
+} // namespace SedNL
+
+#endif /* !LATENCY_IPP_ */
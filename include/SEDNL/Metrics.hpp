@@ -0,0 +1,253 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include "SEDNL/Export.hpp"
+#include "SEDNL/Types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <map>
+#include <mutex>
+
+namespace SedNL
+{
+
+////////////////////////////////////////////////////////////
+//! \brief A counter written by one thread at a time, and
+//!        read by any thread.
+//!
+//! Writes are a relaxed load and store, without any locked
+//! instruction: the thread owning the counter (or the mutex
+//! serializing its writers) keeps it cheap on the hot path,
+//! and readers aggregate the counters when they ask for them.
+////////////////////////////////////////////////////////////
+class MetricCounter
+{
+public:
+    inline MetricCounter() noexcept;
+
+    //! \brief Add \a n to the counter. Only call it from
+    //!        the thread owning the counter.
+    inline void add(UInt64 n = 1) noexcept;
+
+    //! \brief Keep the biggest of the counter and \a n. Only
+    //!        call it from the thread owning the counter.
+    inline void raise(UInt64 n) noexcept;
+
+    //! \brief Read the counter from any thread.
+    inline UInt64 get() const noexcept;
+
+private:
+    std::atomic<UInt64> m_value;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Counters of the events of one name.
+////////////////////////////////////////////////////////////
+struct SEDNL_API EventMetrics
+{
+    inline EventMetrics() noexcept;
+
+    //! \brief Events queued by the listener, or processed
+    //!        by the consumer.
+    UInt64 events;
+    //! \brief Size of the packets of those events.
+    UInt64 bytes;
+    //! \brief Events dropped because their queue was full
+    //!        (listener), or their packet didn't match the
+    //!        types bound (consumer).
+    UInt64 dropped;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Metrics of type T, by event name.
+//!
+//! Names are added by the thread owning the metrics, under a
+//! lock also taken by for_each(). Finding existing metrics
+//! doesn't take it.
+////////////////////////////////////////////////////////////
+template<class T>
+class MetricMap
+{
+public:
+    //! \brief Return the metrics of the events \a name, adding
+    //!        them if needed. Only call it from the owning thread.
+    inline T& get(const std::string& name);
+
+    //! \brief Call \a f(name, metrics) on each name, from any thread.
+    template<typename F>
+    inline void for_each(F f) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, T> m_map;
+};
+
+//! \brief Counters of the events of one name.
+struct EventCounters
+{
+    MetricCounter events;
+    MetricCounter bytes;
+    MetricCounter dropped;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Counters of events, by event name.
+////////////////////////////////////////////////////////////
+class EventCountersMap : public MetricMap<EventCounters>
+{
+public:
+    typedef EventCounters Counters;
+
+    //! \brief Read the counters from any thread.
+    inline std::map<std::string, EventMetrics> snapshot() const;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief State of a queue between a listener and its consumers.
+////////////////////////////////////////////////////////////
+struct SEDNL_API QueueMetrics
+{
+    inline QueueMetrics() noexcept;
+
+    //! \brief Number of elements waiting in the queue.
+    UInt64 depth;
+    //! \brief Biggest depth reached since the creation of the queue.
+    UInt64 high_water_mark;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Counters of an EventListener.
+//!
+//! See EventListener::get_metrics().
+////////////////////////////////////////////////////////////
+struct SEDNL_API ListenerMetrics
+{
+    inline ListenerMetrics() noexcept;
+
+    //! \brief Counters of the events received, by name.
+    std::map<std::string, EventMetrics> events;
+    //! \brief Event queues, by name.
+    std::map<std::string, QueueMetrics> queues;
+    //! \brief The queue of the disconnected connections.
+    QueueMetrics disconnected_queue;
+    //! \brief The queue of the disconnected servers.
+    QueueMetrics server_disconnected_queue;
+
+    //! \brief Bytes received from all the connections.
+    UInt64 bytes_in;
+    //! \brief Events queued, all names together.
+    UInt64 events_in;
+    //! \brief Connections accepted.
+    UInt64 accepts;
+    //! \brief Connections closed.
+    UInt64 disconnects;
+
+    //! \brief Events lost because their queue was full.
+    UInt64 dropped_queue_full;
+    //! \brief Disconnection notifications lost because
+    //!        their queue was full.
+    UInt64 dropped_disconnections;
+    //! \brief Corrupted or invalid packets dropped.
+    UInt64 dropped_invalid_packets;
+    //! \brief Connections which couldn't be accepted.
+    UInt64 failed_accepts;
+
+    //! \brief Time spent waiting in the Poller.
+    std::chrono::nanoseconds wait_time;
+    //! \brief Time spent processing what the Poller reported.
+    std::chrono::nanoseconds process_time;
+    //! \brief Number of returns from the Poller.
+    UInt64 wake_ups;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Counters of an EventConsumer.
+//!
+//! See EventConsumer::get_metrics().
+////////////////////////////////////////////////////////////
+struct SEDNL_API ConsumerMetrics
+{
+    inline ConsumerMetrics() noexcept;
+
+    //! \brief Counters of the events processed, by name
+    //!        (including the ones given to on_event()).
+    std::map<std::string, EventMetrics> events;
+
+    //! \brief Events processed, all names together.
+    UInt64 events_out;
+    //! \brief Disconnections processed (connections and servers).
+    UInt64 disconnections;
+    //! \brief Events whose packet didn't match the types bound.
+    UInt64 dropped_mismatched;
+    //! \brief Exceptions thrown by the callbacks.
+    UInt64 handler_exceptions;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief Counters of a Connection.
+//!
+//! See Connection::get_metrics().
+////////////////////////////////////////////////////////////
+struct SEDNL_API ConnectionMetrics
+{
+    inline ConnectionMetrics() noexcept;
+
+    //! \brief Events received (control events included).
+    UInt64 events_in;
+    //! \brief Bytes received.
+    UInt64 bytes_in;
+    //! \brief Events sent (control events included).
+    UInt64 events_out;
+    //! \brief Bytes sent, as framed on the wire.
+    UInt64 bytes_out;
+};
+
+} // namespace SedNL
+
+#include "SEDNL/Metrics.ipp"
+
+#endif /* !METRICS_HPP_ */
+
+////////////////////////////////////////////////////////////
+//!
+//! \file Metrics.hpp
+//! \brief Counters of the listeners, consumers and connections.
+//!
+//! The counters are always on. Each one is written by a single
+//! thread (the listener thread, a consumer thread, or the sender
+//! holding the connection lock) and the snapshots returned by
+//! get_metrics() read them without stopping those threads.
+//!
+//! \code
+//! ListenerMetrics metrics = listener.get_metrics();
+//! for (auto& queue : metrics.queues)
+//!     std::cout << queue.first << ": " << queue.second.depth
+//!               << " (max " << queue.second.high_water_mark << ")"
+//!               << std::endl;
+//! \endcode
+//!
+////////////////////////////////////////////////////////////
@@ -0,0 +1,109 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+#ifndef METRICS_IPP_
+#define METRICS_IPP_
+
+namespace SedNL
+{
+
+MetricCounter::MetricCounter() noexcept
+    :m_value(0)
+{}
+
+void MetricCounter::add(UInt64 n) noexcept
+{
+    m_value.store(m_value.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+}
+
+void MetricCounter::raise(UInt64 n) noexcept
+{
+    if (n > m_value.load(std::memory_order_relaxed))
+        m_value.store(n, std::memory_order_relaxed);
+}
+
+UInt64 MetricCounter::get() const noexcept
+{
+    return m_value.load(std::memory_order_relaxed);
+}
+
+EventMetrics::EventMetrics() noexcept
+    :events(0), bytes(0), dropped(0)
+{}
+
+template<class T>
+T& MetricMap<T>::get(const std::string& name)
+{
+    auto it = m_map.find(name);
+    if (it != m_map.end())
+        return it->second;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_map[name];
+}
+
+template<class T>
+template<typename F>
+void MetricMap<T>::for_each(F f) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pair : m_map)
+        f(pair.first, pair.second);
+}
+
+std::map<std::string, EventMetrics> EventCountersMap::snapshot() const
+{
+    std::map<std::string, EventMetrics> metrics;
+
+    for_each([&](const std::string& name, const Counters& counters) {
+            EventMetrics& event = metrics[name];
+            event.events = counters.events.get();
+            event.bytes = counters.bytes.get();
+            event.dropped = counters.dropped.get();
+        });
+    return metrics;
+}
+
+QueueMetrics::QueueMetrics() noexcept
+    :depth(0), high_water_mark(0)
+{}
+
+ListenerMetrics::ListenerMetrics() noexcept
+    :bytes_in(0), events_in(0), accepts(0), disconnects(0),
+     dropped_queue_full(0), dropped_disconnections(0),
+     dropped_invalid_packets(0), failed_accepts(0),
+     wait_time(0), process_time(0), wake_ups(0)
+{}
+
+ConsumerMetrics::ConsumerMetrics() noexcept
+    :events_out(0), disconnections(0), dropped_mismatched(0),
+     handler_exceptions(0)
+{}
+
+ConnectionMetrics::ConnectionMetrics() noexcept
+    :events_in(0), bytes_in(0), events_out(0), bytes_out(0)
+{}
+
+} // namespace SedNL
+
+#endif /* !METRICS_IPP_ */
@@ -25,17 +25,144 @@
 #include "SEDNL/Export.hpp"
 #include "SEDNL/Exception.hpp"
 #include "SEDNL/Types.hpp"
+#include "SEDNL/BufferPool.hpp"
 
 #include <vector>
+#include <string>
+#include <cstddef>
+#include <initializer_list>
 
 namespace SedNL
 {
 
-//! An array of 'Byte's.
-typedef std::vector<Byte> ByteArray;
+//! An array of 'Byte's, allocated from the buffer pool (see PoolAllocator).
+typedef std::vector<Byte, PoolAllocator<Byte>> ByteArray;
 
 class RingBuf;
 
+template<typename T>
+struct SchemaField;
+
+////////////////////////////////////////////////////////////
+//! \brief An integer written as a varint.
+//!
+//! Varints are LEB128 encoded : 7 bits per byte, so that small
+//! values take one or two bytes (plus the type byte) whatever the
+//! size of the integer. Signed integers are zigzag encoded (0, -1,
+//! 1, -2, ... become 0, 1, 2, 3, ...) so that small negative values
+//! are short too.
+//!
+//! Use it to write a value (\c packet << varint(x)), or as the type
+//! of a field of a serializable object. \a T is one of Int16, Int32,
+//! Int64, UInt16, UInt32 and UInt64.
+//!
+//! A varint is read as a varint with the same signedness. If the
+//! value doesn't fit in \a T, it throws a PacketException.
+////////////////////////////////////////////////////////////
+template<typename T>
+class VarInt
+{
+public:
+    //! \brief Build a varint of value 0.
+    inline VarInt() noexcept;
+
+    //! \brief Build a varint of value \a value.
+    inline VarInt(T value) noexcept;
+
+    //! \brief Return the value.
+    inline operator T() const noexcept;
+
+    //! \brief Return the value as written (zigzag encoded
+    //!        for signed types).
+    inline UInt64 encoded() const noexcept;
+
+    //! \brief Set the value from its encoded form.
+    //!
+    //! \return False if it doesn't fit in \a T.
+    inline bool decode(UInt64 encoded) noexcept;
+
+    //! \brief The value.
+    T value;
+};
+
+//! \brief Return \a value as a VarInt, to write it as a varint.
+template<typename T>
+inline VarInt<T> varint(T value) noexcept;
+
+////////////////////////////////////////////////////////////
+//! \brief Binary data, written as a Packet::Type::Blob.
+//!
+//! Like a string, but the content isn't text. It's read with
+//! a single copy, or without any copy as a StringView.
+////////////////////////////////////////////////////////////
+class Blob
+{
+public:
+    //! \brief Build an empty blob.
+    inline Blob();
+
+    //! \brief Build a blob containing a copy of \a data.
+    inline Blob(const ByteArray& data);
+
+    //! \brief Build a blob taking the content of \a data.
+    inline Blob(ByteArray&& data) noexcept;
+
+    //! \brief Build a blob containing a copy of the \a size
+    //!        bytes at \a data.
+    inline Blob(const void* data, std::size_t size);
+
+    //! \brief The content.
+    ByteArray data;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief A read only view over a string (or a Blob) read
+//!        from a packet, without any allocation.
+//!
+//! The view points into the packet data : it is invalid once
+//! the packet is destroyed or modified.
+//!
+//! Writing a view into a packet writes a sized string
+//! (Packet::Type::SizedString).
+////////////////////////////////////////////////////////////
+class StringView
+{
+public:
+    //! \brief Build an empty view.
+    inline StringView() noexcept;
+
+    //! \brief Build a view over the \a size chars at \a data.
+    inline StringView(const char* data, std::size_t size) noexcept;
+
+    //! \brief Build a view over \a str.
+    inline StringView(const std::string& str) noexcept;
+
+    //! \brief Return a pointer to the first char (not '\\0' terminated).
+    inline const char* data() const noexcept;
+
+    //! \brief Return the number of chars.
+    inline std::size_t size() const noexcept;
+
+    //! \brief True if the view is empty.
+    inline bool empty() const noexcept;
+
+    inline const char* begin() const noexcept;
+    inline const char* end() const noexcept;
+
+    //! \brief Access the char \a i (no bound checking).
+    inline char operator[](std::size_t i) const noexcept;
+
+    //! \brief Return a copy of the content.
+    inline std::string str() const;
+
+    inline bool operator==(const StringView& view) const noexcept;
+    inline bool operator!=(const StringView& view) const noexcept;
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+};
+
 ////////////////////////////////////////////////////////////
 //! \brief A packet.
 ////////////////////////////////////////////////////////////
@@ -68,10 +195,36 @@ public:
         Float   = 0x10,
         //! \brief 64 bits floating number.
         Double  = 0x11,
+        //! \brief An unsigned integer of any size, as a LEB128 varint.
+        VarUInt = 0x09,
+        //! \brief A signed integer of any size, as a zigzag encoded
+        //!        LEB128 varint.
+        VarInt  = 0x0A,
         //! \brief A C string (from a const char* or std::string::c_str())
         String  = 0x20,
+        //! \brief A string prefixed by its length (a LEB128 varint),
+        //!        that can contain '\\0'. See StringEncoding.
+        SizedString = 0x21,
+        //! \brief Binary data prefixed by its length (a LEB128
+        //!        varint). See Blob.
+        Blob    = 0x22,
+        //! \brief A whole packet, compressed. Only found on the
+        //!        wire, and never read. See Connection::set_compression().
+        Compressed = 0x23,
+        //! \brief A string, stored by the peer in its string table.
+        //!        Only found on the wire. See Connection::set_string_table().
+        StringDef = 0x24,
+        //! \brief A string from the peer's string table. Only found
+        //!        on the wire. See Connection::set_string_table().
+        StringRef = 0x25,
         //! \brief An user defined type (serialized object).
         Object  = 0x40,
+        //! \brief A serialized object whose members are written
+        //!        without their type. See ObjectEncoding.
+        SchemaObject = 0x41,
+        //! \brief A vector of serialized objects, written member
+        //!        by member. See Packet::operator<<(const std::vector<T>&).
+        ObjectArray = 0x42,
         // Different kind of arrays
         //! \brief An array of 8 bits signed integer.
         ArrayInt8    = 0x81,
@@ -93,6 +246,110 @@ public:
         ArrayFloat   = 0x90,
         //! \brief An array of 64 bits floating number.
         ArrayDouble  = 0x91,
+        // Arrays in the byte order of the sender (see ArrayEncoding)
+        //! \brief An array of 8 bits signed integer, sender's byte order.
+        NativeArrayInt8    = 0xA1,
+        //! \brief An array of 16 bits signed integer, sender's byte order.
+        NativeArrayInt16   = 0xA2,
+        //! \brief An array of 32 bits signed integer, sender's byte order.
+        NativeArrayInt32   = 0xA3,
+        //! \brief An array of 64 bits signed integer, sender's byte order.
+        NativeArrayInt64   = 0xA4,
+        //! \brief An array of 8 bits unsigned integer, sender's byte order.
+        NativeArrayUInt8   = 0xA5,
+        //! \brief An array of 16 bits unsigned integer, sender's byte order.
+        NativeArrayUInt16  = 0xA6,
+        //! \brief An array of 32 bits unsigned integer, sender's byte order.
+        NativeArrayUInt32  = 0xA7,
+        //! \brief An array of 64 bits unsigned integer, sender's byte order.
+        NativeArrayUInt64  = 0xA8,
+        //! \brief An array of 32 bits floating number, sender's byte order.
+        NativeArrayFloat   = 0xB0,
+        //! \brief An array of 64 bits floating number, sender's byte order.
+        NativeArrayDouble  = 0xB1,
+        // Integer arrays as deltas (see ArrayEncoding)
+        //! \brief An array of 16 bits signed integer, delta encoded.
+        DeltaArrayInt16    = 0xC2,
+        //! \brief An array of 32 bits signed integer, delta encoded.
+        DeltaArrayInt32    = 0xC3,
+        //! \brief An array of 64 bits signed integer, delta encoded.
+        DeltaArrayInt64    = 0xC4,
+        //! \brief An array of 16 bits unsigned integer, delta encoded.
+        DeltaArrayUInt16   = 0xC6,
+        //! \brief An array of 32 bits unsigned integer, delta encoded.
+        DeltaArrayUInt32   = 0xC7,
+        //! \brief An array of 64 bits unsigned integer, delta encoded.
+        DeltaArrayUInt64   = 0xC8,
+    };
+
+    //! \brief How numeric arrays are written into the packet.
+    enum class ArrayEncoding
+    {
+        //! \brief Elements in network byte order (big endian).
+        Network,
+        //! \brief Elements in the byte order of this host, aligned
+        //!        on their size. They can be read without any copy
+        //!        (see ArrayView) by a host with the same byte order.
+        //!
+        //! Only understood by peers having accepted it, see
+        //! Connection::negotiate_native_arrays(). Otherwise,
+        //! Connection::send() converts the arrays back.
+        Native,
+        //! \brief Arrays of 16, 32 and 64 bits integers are written
+        //!        as the differences between consecutive elements,
+        //!        in zigzag encoded varints (see VarInt). Other
+        //!        arrays are written as with Network.
+        //!
+        //! Sorted ids, timestamps and counters take one or two
+        //! bytes per element instead of 4 or 8. Random values can
+        //! take more room than with Network.
+        //!
+        //! Reading them requires a peer running this version.
+        Delta,
+    };
+
+    //! \brief How strings are written into the packet.
+    enum class StringEncoding
+    {
+        //! \brief Followed by a '\\0' (Type::String). A string
+        //!        containing '\\0' is truncated.
+        Terminated,
+        //! \brief Prefixed by their length (Type::SizedString).
+        //!
+        //! They can contain '\\0', are skipped in O(1) by the
+        //! validation and PacketReader::skip(), and are read with a
+        //! single copy, or none with a StringView.
+        //!
+        //! Reading them requires a peer running this version.
+        Sized,
+    };
+
+    //! \brief How serializable objects (see SEDNL_SERIALIZABLE)
+    //!        are written into the packet.
+    enum class ObjectEncoding
+    {
+        //! \brief Each member is written with its type (Type::Object).
+        Tagged,
+        //! \brief A fingerprint of the types of the members is
+        //!        written once, followed by the members without their
+        //!        types (Type::SchemaObject).
+        //!
+        //! The header is {type, fingerprint : UInt16, length : varint},
+        //! the length being the number of bytes of the members. Fixed
+        //! size members only take their size, strings, blobs and
+        //! varints their length (a varint) and content, arrays their
+        //! number of elements (an UInt16) and elements.
+        //!
+        //! Objects having a member that isn't a number, a string, a
+        //! Blob, a VarInt, a numeric array or a serializable object
+        //! are written as with Tagged.
+        //!
+        //! Readers accept both. A schema object whose fingerprint
+        //! doesn't match the type read throws a PacketException
+        //! (SchemaMismatch) : keep Tagged to talk with peers whose
+        //! objects may differ. Reading them requires a peer running
+        //! this version.
+        Schema,
     };
 
     //! Create an empty packet.
@@ -107,6 +364,60 @@ public:
     inline
     void swap(Packet& packet) noexcept;
 
+    //! \brief Choose how the next arrays are written.
+    //!
+    //! The default is ArrayEncoding::Network. Readers accept both.
+    //!
+    //! \param[in] encoding Encoding of the arrays written from now.
+    inline
+    void set_array_encoding(ArrayEncoding encoding) noexcept;
+
+    //! \brief Return the encoding used to write arrays.
+    //!
+    //! \return The current array encoding.
+    inline
+    ArrayEncoding get_array_encoding() const noexcept;
+
+    //! \brief Choose how the next strings are written.
+    //!
+    //! The default is StringEncoding::Terminated. Readers accept both.
+    //!
+    //! \param[in] encoding Encoding of the strings written from now.
+    inline
+    void set_string_encoding(StringEncoding encoding) noexcept;
+
+    //! \brief Return the encoding used to write strings.
+    //!
+    //! \return The current string encoding.
+    inline
+    StringEncoding get_string_encoding() const noexcept;
+
+    //! \brief Choose how the next serializable objects are written.
+    //!
+    //! The default is ObjectEncoding::Tagged. Readers accept both.
+    //!
+    //! \param[in] encoding Encoding of the objects written from now.
+    inline
+    void set_object_encoding(ObjectEncoding encoding) noexcept;
+
+    //! \brief Return the encoding used to write serializable objects.
+    //!
+    //! \return The current object encoding.
+    inline
+    ObjectEncoding get_object_encoding() const noexcept;
+
+    //! \brief Reserve memory for \a size bytes of data.
+    //!
+    //! Writing into the packet won't reallocate its buffer until
+    //! it contains more than \a size bytes. You can compute the
+    //! size needed to store some values with packed_size().
+    //!
+    //! make_packet() and write_to_packet() already do it.
+    //!
+    //! \param[in] size Number of bytes to reserve.
+    inline
+    void reserve(std::size_t size);
+
     //! \brief Write \a dt into the packet.
     //!
     //! If you call << on types like [unsigned] char, [unsigned] short,
@@ -134,6 +445,28 @@ public:
     template<typename T>
     Packet& operator<<(T dt);
 
+    //! \brief Write a vector of serializable objects (declared with
+    //!        SEDNL_SERIALIZABLE) as a Type::ObjectArray.
+    //!
+    //! The objects are written column by column : the first member
+    //! of each object, then the second one, etc. Numeric members are
+    //! gathered into an array (written with the current ArrayEncoding),
+    //! serializable members into a nested Type::ObjectArray. Other
+    //! members are written one after the other.
+    //!
+    //! The header is {type, count : UInt16, members : UInt8}, followed
+    //! by a byte per member : 0 for a column written as a single
+    //! item, 1 for a column of count items.
+    //!
+    //! It can only be read back as a vector of objects of the same
+    //! type (see PacketReader::operator>>(std::vector<T>&)). The
+    //! vector can't contain more than 65535 objects.
+    //!
+    //! \param[in] dt The objects to write.
+    //! \return A reference to this.
+    template<typename T>
+    Packet& operator<< (const std::vector<T>& dt);
+
     //! \brief See operator<<(T dt).
     Packet& operator<< (const std::vector<char>& dt);
 
@@ -167,6 +500,34 @@ public:
     //! \brief See operator<<(T dt).
     Packet& operator<< (const std::vector<double>& dt);
 
+    //! \brief See operator<<(T dt). The string isn't copied.
+    Packet& operator<< (const std::string& dt);
+
+    //! \brief Write \a dt as a varint. See VarInt.
+    Packet& operator<< (VarInt<Int16> dt);
+
+    //! \brief See operator<<(VarInt<Int16> dt).
+    Packet& operator<< (VarInt<Int32> dt);
+
+    //! \brief See operator<<(VarInt<Int16> dt).
+    Packet& operator<< (VarInt<Int64> dt);
+
+    //! \brief See operator<<(VarInt<Int16> dt).
+    Packet& operator<< (VarInt<UInt16> dt);
+
+    //! \brief See operator<<(VarInt<Int16> dt).
+    Packet& operator<< (VarInt<UInt32> dt);
+
+    //! \brief See operator<<(VarInt<Int16> dt).
+    Packet& operator<< (VarInt<UInt64> dt);
+
+    //! \brief Write \a dt as a Type::Blob.
+    Packet& operator<< (const Blob& dt);
+
+    //! \brief Write \a dt as a Type::SizedString, whatever the
+    //!        string encoding is.
+    Packet& operator<< (const StringView& dt);
+
     //! \brief Return the computed data as a binary array.
     //!
     //! It's a reference to the data's internal buffer.
@@ -187,6 +548,12 @@ public:
     //!
     //! O(n) where n is the data length.
     //!
+    //! As a side effect, it index the position of each item so that
+    //! PacketReader::seek(), PacketReader::skip() and
+    //! PacketReader::seek_member() are O(1) on received packets.
+    //! The index is dropped as soon as something is written into
+    //! the packet.
+    //!
     //! \return True if the content is a valid packet, false otherwise.
     bool is_valid() noexcept;
 
@@ -201,18 +568,200 @@ public:
     friend
     void write_as_object(Packet& packet, Args&... args);
 
+    //! \brief Write all the argument as a schema object
+    //!        (see ObjectEncoding::Schema).
+    //!
+    //! This produce the same behavior as serialising an object containing
+    //! the values \a args with Packet::operator<<() when the object
+    //! encoding is ObjectEncoding::Schema.
+    //!
+    //! \param[in] args Typed values to pack as an object.
+    //! \param[in] packet Packet to write into.
+    template<typename... Args>
+    friend
+    void write_as_schema(Packet& packet, Args&... args);
+
+    template<typename T, typename... Args>
+    friend
+    void serializer_columns_write(Packet& packet, T& first, std::size_t count,
+                                  std::size_t stride, Args&... args);
+
 private:
     ByteArray m_data;
 
+    //! \brief Encoding of the arrays written.
+    ArrayEncoding m_array_encoding;
+
+    //! \brief Encoding of the strings written.
+    StringEncoding m_string_encoding;
+
+    //! \brief Encoding of the serializable objects written.
+    ObjectEncoding m_object_encoding;
+
+    //! \brief Write \a size bytes of \a data as a \a type item
+    //!        (Type::SizedString or Type::Blob).
+    void write_sized(Type type, const void* data, std::size_t size);
+
+    //! \brief True if at least one native array was written.
+    bool m_has_native_arrays;
+
+    //! \brief Write an array in the native encoding.
+    //!
+    //! Header : {type, length : UInt16, info : UInt8, padding},
+    //! where info contain the padding length (3 low bits), and
+    //! 0x80 if the elements are big endian.
+    void write_native_array(Type type, const void* data,
+                            std::size_t count, std::size_t size);
+
+    //! \brief Write an integer array in the delta encoding.
+    //!
+    //! Header : {type, length : UInt16}, followed by a varint
+    //! per element.
+    void write_delta_array(Type type, const void* data,
+                           std::size_t count, std::size_t size);
+
+    //! \brief Return a copy of this packet where native arrays
+    //!        are written in the network byte order.
+    Packet with_network_arrays() const;
+
     //! \brief Write he header of an object (i.e. {Type::Object, length})
     //!        in the packet (without any data).
     void write_object_header(unsigned short length) throw(PacketException);
 
-    //! \brief Try to validate one more item.
-    bool valid_next_item(unsigned int size, unsigned int& i) noexcept;
+    //! \brief Write the header of an object array (i.e. {Type::ObjectArray,
+    //!        count, fields, kinds}) in the packet (without any data).
+    void write_object_array_header(std::size_t count, const Byte* kinds,
+                                   unsigned int fields) throw(PacketException);
+
+    //! \brief Return the size of the header of the Type::Object or
+    //!        Type::ObjectArray at \a i, whose members follow.
+    //!
+    //! \return 0 if it's another type, or if the header is truncated.
+    unsigned int container_header_size(unsigned int i) const noexcept;
+
+    //! \brief Write the header of a schema object, with a
+    //!        placeholder for its length.
+    //!
+    //! \return The offset of the first member.
+    std::size_t write_schema_header(UInt16 fingerprint);
+
+    //! \brief Write the length of the schema object whose first
+    //!        member is at \a payload, once all members are written.
+    void write_schema_length(std::size_t payload);
+
+    //! \brief Write a number of \a size bytes (1, 2, 4 or 8)
+    //!        without its type, in network byte order.
+    void write_schema_fixed(const void* dt, unsigned int size);
+
+    //! \brief Write an encoded varint without its type.
+    void write_schema_varint(UInt64 encoded);
+
+    //! \brief Write a string or a blob without its type.
+    void write_schema_sized(const void* data, std::size_t size);
+
+    //! \brief Write an array of \a count elements of \a size
+    //!        bytes without its type, in network byte order.
+    void write_schema_array(const void* data, std::size_t count,
+                            std::size_t size) throw(PacketException);
+
+    //! \brief Position of the items, built by is_valid().
+    struct Index
+    {
+        //! \brief An item (members of objects included).
+        struct Item
+        {
+            //! \brief Offset of the type byte.
+            UInt32 offset;
+            //! \brief Offset of the first byte after the item.
+            UInt32 end;
+            //! \brief Objects only, position of their members in
+            //!        Index::members.
+            UInt32 members;
+        };
+
+        //! \brief Items, in the order of their offsets.
+        std::vector<Item> items;
+        //! \brief Items at the top level of the packet.
+        std::vector<UInt32> fields;
+        //! \brief Items of each object, stored contiguously.
+        std::vector<UInt32> members;
+        //! \brief Size of the data indexed. The index is
+        //!        outdated if it differs from m_data.size().
+        std::size_t size;
+
+        inline Index() noexcept;
+        inline void clear() noexcept;
+    };
+
+    Index m_index;
+
+    //! \brief True if m_index describe the current data.
+    inline bool is_indexed() const noexcept;
+
+    //! \brief Try to validate one more item, and add it
+    //!        to \a index if not null.
+    //!
+    //! \a i is left on the last byte of the item.
+    bool valid_next_item(unsigned int size, unsigned int& i,
+                         Index* index = nullptr) const;
+
+    template<typename T>
+    friend struct SchemaField;
 
     friend class PacketReader;
     friend class RingBuf;
+    friend class Connection;
+    friend class StateSync;
+};
+
+////////////////////////////////////////////////////////////
+//! \brief A read only view over an array read from a packet.
+//!
+//! When the array was written with ArrayEncoding::Native by a
+//! host with the same byte order, the view points directly into
+//! the packet data: reading it is O(1). Otherwise, the elements
+//! are converted into a storage owned by the view.
+//!
+//! A view pointing into a packet is invalid once the packet
+//! is destroyed or modified.
+////////////////////////////////////////////////////////////
+template<typename T>
+class ArrayView
+{
+public:
+    //! \brief Build an empty view.
+    inline ArrayView() noexcept;
+
+    inline ArrayView(const ArrayView& view);
+    inline ArrayView(ArrayView&& view) noexcept;
+    inline ArrayView& operator=(ArrayView view) noexcept;
+
+    //! \brief Return a pointer to the first element.
+    inline const T* data() const noexcept;
+
+    //! \brief Return the number of elements.
+    inline std::size_t size() const noexcept;
+
+    //! \brief True if the array is empty.
+    inline bool empty() const noexcept;
+
+    inline const T* begin() const noexcept;
+    inline const T* end() const noexcept;
+
+    //! \brief Access the element \a i (no bound checking).
+    inline const T& operator[](std::size_t i) const noexcept;
+
+    //! \brief True if the view points into the packet data.
+    inline bool is_zero_copy() const noexcept;
+
+private:
+    const T* m_data;
+    std::size_t m_size;
+
+    //! \brief Elements converted, when a view isn't possible.
+    std::vector<T> m_storage;
+
+    friend class PacketReader;
 };
 
 ////////////////////////////////////////////////////////////
@@ -248,6 +797,16 @@ public:
     template<typename T>
     PacketReader& operator>> (T &dt);
 
+    //! \brief Read a vector of serializable objects written by
+    //!        Packet::operator<<(const std::vector<T>&).
+    //!
+    //! \a dt is resized to the number of objects read.
+    //!
+    //! \param[out] dt The objects read.
+    //! \return A reference to this.
+    template<typename T>
+    PacketReader& operator>> (std::vector<T>& dt);
+
     //! See operator>> (T &dt).
     PacketReader& operator>> (std::vector<char>& dt);
 
@@ -281,6 +840,142 @@ public:
     //! See operator>> (T &dt).
     PacketReader& operator>> (std::vector<double>& dt);
 
+    //! \brief Read a varint. See VarInt.
+    PacketReader& operator>> (VarInt<Int16>& dt);
+
+    //! See operator>> (VarInt<Int16>& dt).
+    PacketReader& operator>> (VarInt<Int32>& dt);
+
+    //! See operator>> (VarInt<Int16>& dt).
+    PacketReader& operator>> (VarInt<Int64>& dt);
+
+    //! See operator>> (VarInt<Int16>& dt).
+    PacketReader& operator>> (VarInt<UInt16>& dt);
+
+    //! See operator>> (VarInt<Int16>& dt).
+    PacketReader& operator>> (VarInt<UInt32>& dt);
+
+    //! See operator>> (VarInt<Int16>& dt).
+    PacketReader& operator>> (VarInt<UInt64>& dt);
+
+    //! \brief Read a Blob (only a Type::Blob).
+    PacketReader& operator>> (Blob& dt);
+
+    //! \brief Read a string (of any StringEncoding) or a Blob
+    //!        without any allocation.
+    //!
+    //! See StringView.
+    PacketReader& operator>> (StringView& dt);
+
+    //! \brief Read an array without copying it when possible.
+    //!
+    //! Accept the same arrays as operator>>(std::vector<T>&).
+    //! See ArrayView.
+    //!
+    //! \param[out] dt View over the array.
+    //! \return A reference to this.
+    template<typename T>
+    PacketReader& operator>> (ArrayView<T>& dt);
+
+    //! \brief Read \a dt without throwing a PacketException.
+    //!
+    //! Accept the same types as operator>>(T&). The type of the
+    //! next item and its bounds are checked before reading it, so
+    //! a malformed packet is rejected without any stack unwinding.
+    //!
+    //! On failure, \a dt and the position of the reader are left
+    //! unchanged and the error is kept : all the following calls
+    //! fail until clear_error() is called. Reading past the end of
+    //! the packet is an error (PacketExceptionT::EndOfPacket).
+    //!
+    //! The members of schema objects, the columns of object arrays
+    //! and the objects having their own unserialize() method are
+    //! checked by the throwing readers once their header was checked :
+    //! the exceptions are caught and reported the same way.
+    //!
+    //! \param[out] dt Data
+    //! \return False if \a dt couldn't be read. See get_error().
+    template<typename T>
+    bool try_read(T& dt);
+
+    //! See try_read(T& dt).
+    template<typename T>
+    bool try_read(std::vector<T>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<char>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<Int8>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<Int16>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<Int32>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<Int64>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<UInt8>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<UInt16>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<UInt32>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<UInt64>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<float>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(std::vector<double>& dt);
+
+    //! \brief See try_read(T& dt). A value that doesn't fit
+    //!        is a PacketExceptionT::VarIntOverflow.
+    bool try_read(VarInt<Int16>& dt);
+
+    //! See try_read(VarInt<Int16>& dt).
+    bool try_read(VarInt<Int32>& dt);
+
+    //! See try_read(VarInt<Int16>& dt).
+    bool try_read(VarInt<Int64>& dt);
+
+    //! See try_read(VarInt<Int16>& dt).
+    bool try_read(VarInt<UInt16>& dt);
+
+    //! See try_read(VarInt<Int16>& dt).
+    bool try_read(VarInt<UInt32>& dt);
+
+    //! See try_read(VarInt<Int16>& dt).
+    bool try_read(VarInt<UInt64>& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(Blob& dt);
+
+    //! See try_read(T& dt).
+    bool try_read(StringView& dt);
+
+    //! See try_read(T& dt).
+    template<typename T>
+    bool try_read(ArrayView<T>& dt);
+
+    //! \brief Tell if a try_read() failed since the construction of
+    //!        the reader (or the last call to clear_error()).
+    inline bool failed() const noexcept;
+
+    //! \brief Return the error of the first try_read() which
+    //!        failed. Only meaningful if failed() is true.
+    inline PacketExceptionT get_error() const noexcept;
+
+    //! \brief Forget the error kept by the reader, so that
+    //!        try_read() can be called again.
+    inline void clear_error() noexcept;
+
 
     //! \brief True until the packet was completely read.
     //!
@@ -293,20 +988,204 @@ public:
     //!         end was reached.
     inline Packet::Type next_type() const noexcept;
 
+    //! \brief Return the number of fields at the top level of
+    //!        the packet (an object counts as one field).
+    //!
+    //! O(1) if the packet was validated (see Packet::is_valid()),
+    //! which is the case of all received packets. O(n) otherwise.
+    //!
+    //! \return The number of fields.
+    std::size_t field_count() const;
+
+    //! \brief Move the reader to the field \a field of the packet.
+    //!
+    //! Fields are the top level items, numbered from 0. Seeking to
+    //! field_count() moves the reader to the end of the packet.
+    //!
+    //! O(1) if the packet was validated, O(n) otherwise.
+    //!
+    //! \param[in] field Number of the field.
+    //! \return A reference to this.
+    PacketReader& seek(std::size_t field) throw(PacketException);
+
+    //! \brief Skip the next \a count items without reading them.
+    //!
+    //! An object is skipped with all its members.
+    //!
+    //! O(count * log(n)) if the packet was validated.
+    //!
+    //! \param[in] count Number of items to skip.
+    //! \return A reference to this.
+    PacketReader& skip(std::size_t count = 1) throw(PacketException);
+
+    //! \brief Move the reader to the member \a member of the object
+    //!        which is the next item.
+    //!
+    //! The next read returns this member. Reading goes on with the
+    //! following members, then with the items after the object.
+    //!
+    //! O(log(n)) if the packet was validated.
+    //!
+    //! \param[in] member Number of the member, from 0.
+    //! \return A reference to this.
+    PacketReader& seek_member(std::size_t member) throw(PacketException);
+
 private:
+    //! \brief Consume a varint of type \a type, and return its
+    //!        encoded value.
+    //!
+    //! \return False if the end of the packet was reached.
+    bool read_varint(Packet::Type type, UInt64& encoded)
+        throw(PacketException);
+
+    //! \brief Consume a string or a blob.
+    //!
+    //! \param[in] blob True to read a Type::Blob, false to read a
+    //!                 Type::String or a Type::SizedString.
+    //! \param[out] dt View over the content.
+    //! \return False if the end of the packet was reached.
+    bool read_sized(bool blob, StringView& dt) throw(PacketException);
+
     //! \brief Consume the header of an object if it's a valid one (i.e. {Type::Object, length}).
     void read_object_header(unsigned short length) throw(PacketException);
 
+    //! \brief Consume an array of type \a type (or \a alt), written
+    //!        with any ArrayEncoding.
+    //!
+    //! \param[out] length Number of elements.
+    //! \param[out] swap True if the elements aren't in the host
+    //!                  byte order.
+    //! \return A pointer to the first element, or nullptr if the
+    //!         end of the packet was reached.
+    const Byte* read_array(Packet::Type type, Packet::Type alt,
+                           unsigned short& length, bool& swap)
+        throw(PacketException);
+
+    //! \brief Read the header of a delta encoded array of type
+    //!        \a type (or \a alt).
+    //!
+    //! m_idx isn't moved : the caller moves it after the varints.
+    //!
+    //! \param[out] length Number of elements.
+    //! \param[out] available Number of bytes left after the header.
+    //! \return A pointer to the first varint.
+    const Byte* read_delta_array(Packet::Type type, Packet::Type alt,
+                                 unsigned short& length, std::size_t& available)
+        throw(PacketException);
+
+    //! \brief Return the position of the item starting at \a offset
+    //!        in the index of the packet (which must be up to date).
+    std::size_t indexed_item(unsigned int offset) const
+        throw(PacketException);
+
+    //! \brief Return the offset of the first byte after the item
+    //!        starting at \a offset.
+    unsigned int item_end(unsigned int offset) const throw(PacketException);
+
+    //! \brief Return the number of objects of the Type::ObjectArray
+    //!        which is the next item.
+    unsigned short object_array_length() const throw(PacketException);
+
+    //! \brief Keep \a error as the error of the reader, if
+    //!        there is no error yet.
+    //!
+    //! \return False.
+    bool fail(PacketExceptionT error) noexcept;
+
+    //! \brief Check, without throwing, that the next item is one of
+    //!        \a types and is complete. Native and delta arrays are
+    //!        checked as the matching array type.
+    //!
+    //! \return False, after a call to fail(), if it isn't.
+    bool check_next(std::initializer_list<Packet::Type> types) noexcept;
+
+    //! \brief Check, and consume, the header of an object of
+    //!        \a length members without throwing.
+    bool try_object_header(unsigned short length) noexcept;
+
+    //! \brief Check, without throwing, that the next item is a schema
+    //!        object of fingerprint \a fingerprint.
+    bool check_schema(UInt16 fingerprint) noexcept;
+
+    //! \brief Read an object declared with SEDNL_SERIALIZABLE.
+    template<typename T>
+    auto try_unserialize(T& dt, int) -> decltype(dt.sednl_try_read(*this));
+
+    //! \brief Read an object by its own unserialize() method,
+    //!        whose exceptions are caught.
+    template<typename T>
+    bool try_unserialize(T& dt, long);
+
+    //! \brief Consume the header of an object array of \a count
+    //!        objects, if its columns are the ones expected.
+    void read_object_array_header(std::size_t count, const Byte* kinds,
+                                  unsigned int fields) throw(PacketException);
+
+    //! \brief Consume the header of a schema object.
+    //!
+    //! \param[in] fingerprint Fingerprint of the members read.
+    //! \return The offset of the first byte after the object.
+    unsigned int read_schema_header(UInt16 fingerprint)
+        throw(PacketException);
+
+    //! \brief Throw if the members of the schema object weren't
+    //!        read up to \a end.
+    void read_schema_end(unsigned int end) const throw(PacketException);
+
+    //! \brief See Packet::write_schema_fixed().
+    void read_schema_fixed(void* dt, unsigned int size)
+        throw(PacketException);
+
+    //! \brief See Packet::write_schema_varint().
+    UInt64 read_schema_varint() throw(PacketException);
+
+    //! \brief See Packet::write_schema_sized().
+    StringView read_schema_sized() throw(PacketException);
+
+    //! \brief Consume the number of elements of an array.
+    //!        See Packet::write_schema_array().
+    unsigned short read_schema_length() throw(PacketException);
+
+    //! \brief Consume the \a count elements of \a size bytes
+    //!        of an array, written into \a dt.
+    void read_schema_array(void* dt, std::size_t count, std::size_t size)
+        throw(PacketException);
+
     const Packet* m_p;
     unsigned int m_idx;
 
+    //! \brief True once a try_read() failed.
+    bool m_failed;
+    //! \brief Error of the first try_read() which failed.
+    PacketExceptionT m_error;
+
     //! \brief Write the next element of \a r into the stream \a os.
     bool output_one(int& i, std::ostream& os);
 
     template<typename... Args>
     friend void read_as_object(PacketReader& packet_reader, Args&... args);
 
+    template<typename... Args>
+    friend void read_as_schema(PacketReader& packet_reader, Args&... args);
+
+    template<typename... Args>
+    friend bool try_read_as_object(PacketReader& packet_reader,
+                                   Args&... args);
+
+    template<typename... Args>
+    friend bool try_read_as_schema(PacketReader& packet_reader,
+                                   Args&... args);
+
+    template<typename T, typename... Args>
+    friend void serializer_columns_read(PacketReader& packet_reader, T& first,
+                                        std::size_t count, std::size_t stride,
+                                        Args&... args);
+
+    template<typename T>
+    friend struct SchemaField;
+
     friend std::ostream& operator<< (std::ostream& os, const Packet& p);
+    friend class StateSync;
 };
 
 //! @cond Doxygen_Suppress
@@ -335,8 +1214,6 @@ Packet& Packet::operator<< <float>(float dt);
 template<>
 Packet& Packet::operator<< <double>(double dt);
 
-template<>
-Packet& Packet::operator<< <std::string>(std::string dt);
 template<>
 Packet& Packet::operator<< <char*>(char* dt);
 template<>
@@ -374,6 +1251,33 @@ PacketReader& PacketReader::operator>> <double>(double& dt);
 template<>
 PacketReader& PacketReader::operator>> <std::string>(std::string& dt);
 
+template<>
+bool PacketReader::try_read<char>(char& dt);
+template<>
+bool PacketReader::try_read<Int8>(Int8& dt);
+template<>
+bool PacketReader::try_read<Int16>(Int16& dt);
+template<>
+bool PacketReader::try_read<Int32>(Int32& dt);
+template<>
+bool PacketReader::try_read<Int64>(Int64& dt);
+template<>
+bool PacketReader::try_read<UInt8>(UInt8& dt);
+template<>
+bool PacketReader::try_read<UInt16>(UInt16& dt);
+template<>
+bool PacketReader::try_read<UInt32>(UInt32& dt);
+template<>
+bool PacketReader::try_read<UInt64>(UInt64& dt);
+
+template<>
+bool PacketReader::try_read<float>(float& dt);
+template<>
+bool PacketReader::try_read<double>(double& dt);
+
+template<>
+bool PacketReader::try_read<std::string>(std::string& dt);
+
 //! @endcond
 
 //! \brief Write a short description of a packet in a JSON like fashion.
@@ -396,6 +1300,54 @@ SEDNL_API std::ostream& operator<< (std::ostream& os, const Packet& p);
 template<typename... Args>
 void read_as_object(PacketReader& packet_reader, Args&... args);
 
+//! \brief Read all the argument as an object of length
+//!        number_of_args(args), without throwing a PacketException.
+//!
+//! See read_as_object() and PacketReader::try_read(). On failure,
+//! the reader isn't moved and keeps the error.
+//!
+//! \param[in] packet_reader Reader from wich to read data.
+//! \param[out] args Variables to write into.
+//! \return False if the object couldn't be read.
+template<typename... Args>
+bool try_read_as_object(PacketReader& packet_reader, Args&... args);
+
+//! \brief Read all the argument as an object written by
+//!        write_as_schema() or by write_as_object(), without
+//!        throwing a PacketException.
+//!
+//! See read_as_schema() and PacketReader::try_read().
+//!
+//! \param[in] packet_reader Reader from wich to read data.
+//! \param[out] args Variables to write into.
+//! \return False if the object couldn't be read.
+template<typename... Args>
+bool try_read_as_schema(PacketReader& packet_reader, Args&... args);
+
+//! \brief Read all the argument as an object written by
+//!        write_as_schema() or by write_as_object().
+//!
+//! A Type::Object is read as by read_as_object(). A Type::SchemaObject
+//! must have the fingerprint of \a args (see schema_fingerprint()).
+//!
+//! \param[in] packet_reader Reader from wich to read data.
+//! \param[out] args Variables to write into.
+template<typename... Args>
+void read_as_schema(PacketReader& packet_reader, Args&... args);
+
+//! \brief Compute the fingerprint written in the header of schema
+//!        objects (see Packet::ObjectEncoding).
+//!
+//! It only depends on the types of \a args (and of the members of
+//! the serializable objects among them), so the compiler folds it
+//! into a constant.
+//!
+//! \param[in] args Members of the object.
+//! \return The fingerprint.
+template<typename... Args>
+inline
+UInt16 schema_fingerprint(const Args&... args) noexcept;
+
 //! \brief Allow creating easily new packets.
 //!
 //! You can create a packet with make_packet(arg1, arg2, ...).
@@ -403,16 +1355,51 @@ void read_as_object(PacketReader& packet_reader, Args&... args);
 //! \param args Values to store in the new packet.
 //! \return The newly created packet.
 template<typename... Args>
-Packet make_packet(Args... args);
+Packet make_packet(const Args&... args);
 
 //! \brief Allow writing easily into packets.
 //!
 //! You can write into a packet with write_to_packet(packet, arg1, arg2, ...)
 //!
+//! The packet buffer is grown once, to packed_size(packet, args...)
+//! more bytes.
+//!
 //! \param[out] packet Pacet in which data are stored.
 //! \param[in] args Data to write sequencialy into the packet.
 template<typename... Args>
-void write_to_packet(Packet& packet, Args... args);
+void write_to_packet(Packet& packet, const Args&... args);
+
+//! \brief Compute the number of bytes written by
+//!        write_to_packet(packet, args...) into a new packet.
+//!
+//! For fixed size types (integers, float, double) the size is
+//! known at compile time. Strings and arrays are measured.
+//!
+//! A serializable object is measured if it was declared with
+//! SEDNL_SERIALIZABLE, and counts for 0 byte otherwise, so
+//! the result is then only a lower bound.
+//!
+//! \param[in] args Values that would be written.
+//! \return The size of the encoded values, in bytes.
+template<typename... Args>
+inline
+std::size_t packed_size(const Args&... args);
+
+//! \brief Compute an upper bound of the number of bytes written by
+//!        write_to_packet(packet, args...), with the encodings
+//!        of \a packet.
+//!
+//! The size is exact with the encodings of a new packet. Native
+//! arrays are counted with their largest padding, delta arrays
+//! with the largest varints, and schema objects with the size
+//! of their tagged members.
+//!
+//! \param[in] packet Packet whose encodings are used.
+//! \param[in] args Values that would be written.
+//! \return The size of the encoded values, in bytes.
+template<typename... Args>
+inline
+std::size_t packed_size(const Packet& packet, const Args&... args);
 
 //! \brief Allow reading data from a PacketReader.
 //!
@@ -445,7 +1432,7 @@ SEDNL_API std::ostream& operator<< (std::ostream& os, Packet::Type type);
 //! \return The number of arguments given to this function.
 template<typename... Args>
 inline
-unsigned short number_of_args(Args... args);
+unsigned short number_of_args(const Args&... args);
 
 //! Swap two packets.
 //!
@@ -494,6 +1481,9 @@ void swap(Packet& a, Packet& b) noexcept;
 //! //You can also use this syntax :
 //! write_to_packet(packet, 3.0, 2.0, 1.0);
 //!
+//! //Small integers take less room as varints (see VarInt) :
+//! packet << varint(42);
+//!
 //! //You can even write array :
 //! std::vector<int> ints = {1, 2, 3, 4, 5};
 //!
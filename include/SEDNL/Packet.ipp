@@ -22,6 +22,15 @@
 #ifndef PACKET_IPP_
 #define PACKET_IPP_
 
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+//Kinds of the columns of a Type::ObjectArray : a single item,
+// or an item per object.
+#define SEDNL_COLUMN_PACKED 0x00
+#define SEDNL_COLUMN_ITEMS  0x01
+
 namespace SedNL
 {
 
@@ -31,6 +40,14 @@ inline
 void Packet::swap(Packet& p) noexcept
 {
     std::swap(m_data, p.m_data);
+    std::swap(m_array_encoding, p.m_array_encoding);
+    std::swap(m_string_encoding, p.m_string_encoding);
+    std::swap(m_object_encoding, p.m_object_encoding);
+    std::swap(m_has_native_arrays, p.m_has_native_arrays);
+    std::swap(m_index.items, p.m_index.items);
+    std::swap(m_index.fields, p.m_index.fields);
+    std::swap(m_index.members, p.m_index.members);
+    std::swap(m_index.size, p.m_index.size);
 }
 
 inline
@@ -39,8 +56,298 @@ void swap(Packet& a, Packet& b) noexcept
     a.swap(b);
 }
 
+inline
+void Packet::reserve(std::size_t size)
+{
+    m_data.reserve(size);
+}
+
+inline
+void Packet::set_array_encoding(ArrayEncoding encoding) noexcept
+{
+    m_array_encoding = encoding;
+}
+
+inline
+Packet::ArrayEncoding Packet::get_array_encoding() const noexcept
+{
+    return m_array_encoding;
+}
+
+inline
+void Packet::set_string_encoding(StringEncoding encoding) noexcept
+{
+    m_string_encoding = encoding;
+}
+
+inline
+Packet::StringEncoding Packet::get_string_encoding() const noexcept
+{
+    return m_string_encoding;
+}
+
+inline
+void Packet::set_object_encoding(ObjectEncoding encoding) noexcept
+{
+    m_object_encoding = encoding;
+}
+
+inline
+Packet::ObjectEncoding Packet::get_object_encoding() const noexcept
+{
+    return m_object_encoding;
+}
+
+inline
+Blob::Blob()
+{}
+
+inline
+Blob::Blob(const ByteArray& data)
+    :data(data)
+{}
+
+inline
+Blob::Blob(ByteArray&& data) noexcept
+    :data(std::move(data))
+{}
+
+inline
+Blob::Blob(const void* data, std::size_t size)
+    :data(static_cast<const Byte*>(data), static_cast<const Byte*>(data) + size)
+{}
+
+inline
+StringView::StringView() noexcept
+    :m_data(""), m_size(0)
+{}
+
+inline
+StringView::StringView(const char* data, std::size_t size) noexcept
+    :m_data(data), m_size(size)
+{}
+
+inline
+StringView::StringView(const std::string& str) noexcept
+    :m_data(str.data()), m_size(str.size())
+{}
+
+inline
+const char* StringView::data() const noexcept
+{
+    return m_data;
+}
+
+inline
+std::size_t StringView::size() const noexcept
+{
+    return m_size;
+}
+
+inline
+bool StringView::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+inline
+const char* StringView::begin() const noexcept
+{
+    return m_data;
+}
+
+inline
+const char* StringView::end() const noexcept
+{
+    return m_data + m_size;
+}
+
+inline
+char StringView::operator[](std::size_t i) const noexcept
+{
+    return m_data[i];
+}
+
+inline
+std::string StringView::str() const
+{
+    return std::string(m_data, m_size);
+}
+
+inline
+bool StringView::operator==(const StringView& view) const noexcept
+{
+    return m_size == view.m_size && std::memcmp(m_data, view.m_data, m_size) == 0;
+}
+
+inline
+bool StringView::operator!=(const StringView& view) const noexcept
+{
+    return !(*this == view);
+}
+
+inline
+Packet::Index::Index() noexcept
+    :size(0)
+{}
+
+inline
+void Packet::Index::clear() noexcept
+{
+    items.clear();
+    fields.clear();
+    members.clear();
+    size = 0;
+}
+
+inline
+bool Packet::is_indexed() const noexcept
+{
+    return m_index.size == m_data.size();
+}
+
+template<typename T>
+inline
+VarInt<T>::VarInt() noexcept
+    :value(0)
+{}
+
+template<typename T>
+inline
+VarInt<T>::VarInt(T value) noexcept
+    :value(value)
+{}
+
+template<typename T>
+inline
+VarInt<T>::operator T() const noexcept
+{
+    return value;
+}
+
+template<typename T>
+inline
+UInt64 VarInt<T>::encoded() const noexcept
+{
+    if (!std::is_signed<T>::value)
+        return static_cast<UInt64>(value);
+
+    //Zigzag : the sign goes to the low bit
+    const Int64 v = value;
+    return (static_cast<UInt64>(v) << 1) ^ static_cast<UInt64>(v >> 63);
+}
+
+template<typename T>
+inline
+bool VarInt<T>::decode(UInt64 encoded) noexcept
+{
+    if (!std::is_signed<T>::value)
+    {
+        if (encoded > static_cast<UInt64>(std::numeric_limits<T>::max()))
+            return false;
+        value = static_cast<T>(encoded);
+        return true;
+    }
+
+    const Int64 v = static_cast<Int64>(encoded >> 1)
+        ^ -static_cast<Int64>(encoded & 1);
+    if (v < static_cast<Int64>(std::numeric_limits<T>::min())
+        || v > static_cast<Int64>(std::numeric_limits<T>::max()))
+        return false;
+    value = static_cast<T>(v);
+    return true;
+}
+
+template<typename T>
+inline
+VarInt<T> varint(T value) noexcept
+{
+    return VarInt<T>(value);
+}
+
+template<typename T>
+inline
+ArrayView<T>::ArrayView() noexcept
+    :m_data(nullptr), m_size(0)
+{}
+
+template<typename T>
+inline
+ArrayView<T>::ArrayView(const ArrayView& view)
+    :m_data(view.m_data), m_size(view.m_size), m_storage(view.m_storage)
+{
+    if (!view.is_zero_copy())
+        m_data = m_storage.data();
+}
+
+template<typename T>
+inline
+ArrayView<T>::ArrayView(ArrayView&& view) noexcept
+    :m_data(view.m_data), m_size(view.m_size),
+     m_storage(std::move(view.m_storage))
+{}
+
+template<typename T>
+inline
+ArrayView<T>& ArrayView<T>::operator=(ArrayView view) noexcept
+{
+    std::swap(m_data, view.m_data);
+    std::swap(m_size, view.m_size);
+    m_storage.swap(view.m_storage);
+    return *this;
+}
+
+template<typename T>
+inline
+const T* ArrayView<T>::data() const noexcept
+{
+    return m_data;
+}
+
+template<typename T>
+inline
+std::size_t ArrayView<T>::size() const noexcept
+{
+    return m_size;
+}
+
+template<typename T>
+inline
+bool ArrayView<T>::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+template<typename T>
+inline
+const T* ArrayView<T>::begin() const noexcept
+{
+    return m_data;
+}
+
+template<typename T>
+inline
+const T* ArrayView<T>::end() const noexcept
+{
+    return m_data + m_size;
+}
+
+template<typename T>
+inline
+const T& ArrayView<T>::operator[](std::size_t i) const noexcept
+{
+    return m_data[i];
+}
+
+template<typename T>
+inline
+bool ArrayView<T>::is_zero_copy() const noexcept
+{
+    return m_storage.empty();
+}
+
 PacketReader::PacketReader(const Packet &p)
-    :m_p(&p), m_idx(0)
+    :m_p(&p), m_idx(0), m_failed(false), m_error(PacketExceptionT::Unknown)
 {}
 
 PacketReader::operator bool() const noexcept
@@ -55,8 +362,282 @@ Packet::Type PacketReader::next_type() const noexcept
     return static_cast<Packet::Type>(m_p->m_data[m_idx]);
 }
 
+bool PacketReader::failed() const noexcept
+{
+    return m_failed;
+}
+
+PacketExceptionT PacketReader::get_error() const noexcept
+{
+    return m_error;
+}
+
+void PacketReader::clear_error() noexcept
+{
+    m_failed = false;
+}
+
+//Encodings under which a value is measured by PackedSize.
+struct PackedEncodings
+{
+    Packet::ArrayEncoding array;
+    Packet::StringEncoding string;
+    Packet::ObjectEncoding object;
+};
+
+//Encodings of a new packet.
+inline
+PackedEncodings default_packed_encodings() noexcept
+{
+    return {Packet::ArrayEncoding::Network,
+            Packet::StringEncoding::Terminated,
+            Packet::ObjectEncoding::Tagged};
+}
+
+inline
+PackedEncodings packed_encodings(const Packet& packet) noexcept
+{
+    return {packet.get_array_encoding(),
+            packet.get_string_encoding(),
+            packet.get_object_encoding()};
+}
+
+//Upper bound of the length of a varint holding \a v.
+inline
+std::size_t varint_packed_size(UInt64 v)
+{
+    std::size_t size = 1;
+    for (v >>= 7; v; v >>= 7)
+        size++;
+    return size;
+}
+
+//A schema object whose tagged members take \a members bytes :
+// {Type::SchemaObject, fingerprint, length}, then the members.
+inline
+std::size_t schema_packed_size(std::size_t members)
+{
+    return 1 + sizeof(UInt16) + varint_packed_size(members) + members;
+}
+
+//A string of \a length bytes, without its '\0'.
+inline
+std::size_t string_packed_size(std::size_t length, const PackedEncodings& e)
+{
+    if (e.string == Packet::StringEncoding::Sized)
+        return 1 + varint_packed_size(length) + length;
+    return 2 + length;
+}
+
+//An array of \a count numbers of \a size bytes. Native arrays have
+// an info byte and up to size - 1 bytes of padding, and each element
+// of a delta array is a varint (integers of 16 bits or more only).
+inline
+std::size_t array_packed_size(std::size_t count, std::size_t size,
+                              bool delta, const PackedEncodings& e)
+{
+    const std::size_t header = 1 + sizeof(UInt16);
+    if (e.array == Packet::ArrayEncoding::Native)
+        return header + sizeof(UInt8) + (size - 1) + count * size;
+    if (e.array == Packet::ArrayEncoding::Delta && delta)
+        return header + count * ((8 * size + 6) / 7);
+    return header + count * size;
+}
+
+//Encoded size of each type written by Packet::operator<<.
+//Fixed size types have a constant PackedSize<T>::value.
+template<typename T>
+struct PackedSize
+{
+    //Serializable objects declared with SEDNL_SERIALIZABLE
+    template<typename U>
+    static inline
+    auto of(const U& dt, const PackedEncodings& e, int)
+        -> decltype(dt.sednl_packed_size(e))
+    {
+        return dt.sednl_packed_size(e);
+    }
+
+    //Unknown size
+    template<typename U>
+    static inline
+    std::size_t of(const U&, const PackedEncodings&, long)
+    {
+        return 0;
+    }
+
+    static inline
+    std::size_t of(const T& dt, const PackedEncodings& e)
+    {
+        return of(dt, e, 0);
+    }
+};
+
+#define SEDNL_FIXED_PACKED_SIZE(type, size)                     \
+    template<>                                                  \
+    struct PackedSize<type>                                     \
+    {                                                           \
+        static constexpr std::size_t value = 1 + (size);        \
+                                                                \
+        static constexpr inline                                 \
+        std::size_t of(const type&, const PackedEncodings&)     \
+        { return value; }                                       \
+    };
+
+SEDNL_FIXED_PACKED_SIZE(char, sizeof(Int8))
+SEDNL_FIXED_PACKED_SIZE(Int8, sizeof(Int8))
+SEDNL_FIXED_PACKED_SIZE(Int16, sizeof(Int16))
+SEDNL_FIXED_PACKED_SIZE(Int32, sizeof(Int32))
+SEDNL_FIXED_PACKED_SIZE(Int64, sizeof(Int64))
+SEDNL_FIXED_PACKED_SIZE(UInt8, sizeof(UInt8))
+SEDNL_FIXED_PACKED_SIZE(UInt16, sizeof(UInt16))
+SEDNL_FIXED_PACKED_SIZE(UInt32, sizeof(UInt32))
+SEDNL_FIXED_PACKED_SIZE(UInt64, sizeof(UInt64))
+SEDNL_FIXED_PACKED_SIZE(float, sizeof(UInt32))
+SEDNL_FIXED_PACKED_SIZE(double, sizeof(UInt64))
+
+#undef SEDNL_FIXED_PACKED_SIZE
+
+//Terminated strings are written with their '\0'
+template<>
+struct PackedSize<const char*>
+{
+    static inline
+    std::size_t of(const char* dt, const PackedEncodings& e)
+    {
+        return string_packed_size(std::strlen(dt), e);
+    }
+};
+
+template<>
+struct PackedSize<char*>
+{
+    static inline
+    std::size_t of(const char* dt, const PackedEncodings& e)
+    {
+        return string_packed_size(std::strlen(dt), e);
+    }
+};
+
+template<std::size_t N>
+struct PackedSize<char[N]>
+{
+    static inline
+    std::size_t of(const char* dt, const PackedEncodings& e)
+    {
+        return string_packed_size(std::strlen(dt), e);
+    }
+};
+
+//Only an upper bound if the string contains '\0' in
+// StringEncoding::Terminated (it is cut there).
+template<>
+struct PackedSize<std::string>
+{
+    static inline
+    std::size_t of(const std::string& dt, const PackedEncodings& e)
+    {
+        return string_packed_size(dt.size(), e);
+    }
+};
+
+template<>
+struct PackedSize<Blob>
+{
+    static inline
+    std::size_t of(const Blob& dt, const PackedEncodings&)
+    {
+        return 1 + varint_packed_size(dt.data.size()) + dt.data.size();
+    }
+};
+
+template<>
+struct PackedSize<StringView>
+{
+    static inline
+    std::size_t of(const StringView& dt, const PackedEncodings&)
+    {
+        return 1 + varint_packed_size(dt.size()) + dt.size();
+    }
+};
+
+template<typename T>
+struct PackedSize<VarInt<T>>
+{
+    static inline
+    std::size_t of(const VarInt<T>& dt, const PackedEncodings&)
+    {
+        return 1 + varint_packed_size(dt.encoded());
+    }
+};
+
+//Arrays of numbers, or object arrays of serializable objects.
+template<typename T>
+struct PackedSize<std::vector<T>>
+{
+    template<typename U>
+    static inline
+    auto of(const std::vector<U>& dt, const PackedEncodings& e, int)
+        -> decltype(dt.front().sednl_columns_packed_size(e, 0, 0))
+    {
+        //Header : {Type::ObjectArray, count, 0}
+        if (dt.empty())
+            return 1 + sizeof(UInt16) + sizeof(UInt8);
+        return dt.front().sednl_columns_packed_size(e, dt.size(), sizeof(U));
+    }
+
+    template<typename U>
+    static inline
+    std::size_t of(const std::vector<U>& dt, const PackedEncodings& e, long)
+    {
+        return array_packed_size(dt.size(), sizeof(U),
+                                 std::is_integral<U>::value && sizeof(U) > 1,
+                                 e);
+    }
+
+    static inline
+    std::size_t of(const std::vector<T>& dt, const PackedEncodings& e)
+    {
+        return of(dt, e, 0);
+    }
+};
+
+inline
+std::size_t packed_size_aux(const PackedEncodings&)
+{
+    return 0;
+}
+
+template<typename T, typename... Args>
+inline
+std::size_t packed_size_aux(const PackedEncodings& e,
+                            const T& arg, const Args&... args)
+{
+    return PackedSize<T>::of(arg, e) + packed_size_aux(e, args...);
+}
+
+inline
+std::size_t packed_size()
+{
+    return 0;
+}
+
+template<typename T, typename... Args>
+inline
+std::size_t packed_size(const T& arg, const Args&... args)
+{
+    return packed_size_aux(default_packed_encodings(), arg, args...);
+}
+
 template<typename... Args>
-Packet make_packet(Args... args)
+inline
+std::size_t packed_size(const Packet& packet, const Args&... args)
+{
+    return packed_size_aux(packed_encodings(packet), args...);
+}
+
+template<typename... Args>
+Packet make_packet(const Args&... args)
 {
     Packet p;
     write_to_packet(p, args...);
@@ -64,14 +645,21 @@ Packet make_packet(Args... args)
 }
 
 template<typename T, typename... Args>
-void write_to_packet(Packet& p, T arg, Args... args)
+void write_to_packet_aux(Packet& p, const T& arg, const Args&... args)
 {
-    write_to_packet(p << arg, args...);
+    write_to_packet_aux(p << arg, args...);
 }
 
-inline void write_to_packet(Packet&)
+inline void write_to_packet_aux(Packet&)
 {}
 
+template<typename... Args>
+void write_to_packet(Packet& p, const Args&... args)
+{
+    p.reserve(p.get_data().size() + packed_size(p, args...));
+    write_to_packet_aux(p, args...);
+}
+
 template<typename T, typename... Args>
 void read_from_packet(PacketReader& p, T& arg, Args&... args)
 {
@@ -81,48 +669,378 @@ void read_from_packet(PacketReader& p, T& arg, Args&... args)
 inline void read_from_packet(PacketReader&)
 {}
 
+template<typename... Args>
 inline
-unsigned short number_of_args_aux()
+unsigned short number_of_args(const Args&...)
 {
-    return 0;
+    return sizeof...(Args);
+}
+
+template<typename... Args>
+void write_as_object(Packet& packet, Args&... args)
+{
+    //Header : {Type::Object, length}
+    packet.reserve(packet.get_data().size() + 2
+                   + packed_size(packet, args...));
+    packet.write_object_header(sizeof...(Args));
+    write_to_packet_aux(packet, args...);
+}
+
+template<typename... Args>
+void read_as_object(PacketReader& packet_reader, Args&... args)
+{
+    PacketReader tmp_reader = packet_reader;
+    tmp_reader.read_object_header(sizeof...(Args));
+    read_from_packet(tmp_reader, args...);
+    //If everything gone well, just modify the reader
+    using std::swap;
+    swap(packet_reader, tmp_reader);
+}
+
+//How each type is written into a schema object (without its type).
+//SchemaField<T>::value is false for types that can't be.
+template<typename T>
+struct SchemaField
+{
+    //Serializable objects declared with SEDNL_SERIALIZABLE
+    template<typename U>
+    static char test(decltype(&U::sednl_schema_write));
+
+    template<typename U>
+    static long test(...);
+
+    static const bool value = sizeof(test<T>(nullptr)) == sizeof(char);
+
+    template<typename U>
+    static inline
+    auto code(const U& dt, int) -> decltype(dt.sednl_schema(), UInt32())
+    {
+        return (static_cast<UInt32>(Packet::Type::SchemaObject) << 16)
+            | dt.sednl_schema();
+    }
+
+    template<typename U>
+    static inline
+    UInt32 code(const U&, long)
+    {
+        return static_cast<UInt32>(Packet::Type::Unknown);
+    }
+
+    static inline
+    UInt32 code(const T& dt)
+    {
+        return code(dt, 0);
+    }
+
+    static inline
+    void write(Packet& p, T& dt)
+    {
+        dt.sednl_schema_write(p);
+    }
+
+    static inline
+    void read(PacketReader& r, T& dt)
+    {
+        dt.sednl_schema_read(r);
+    }
+};
+
+#define SEDNL_FIXED_SCHEMA_FIELD(type, ptype)                   \
+    template<>                                                  \
+    struct SchemaField<type>                                    \
+    {                                                           \
+        static const bool value = true;                         \
+                                                                \
+        static inline                                           \
+        UInt32 code(const type&)                                \
+        {                                                       \
+            return static_cast<UInt32>(ptype);                  \
+        }                                                       \
+                                                                \
+        static inline                                           \
+        void write(Packet& p, const type& dt)                   \
+        {                                                       \
+            p.write_schema_fixed(&dt, sizeof(type));            \
+        }                                                       \
+                                                                \
+        static inline                                           \
+        void read(PacketReader& r, type& dt)                    \
+        {                                                       \
+            r.read_schema_fixed(&dt, sizeof(type));             \
+        }                                                       \
+    }
+
+SEDNL_FIXED_SCHEMA_FIELD(char, Packet::Type::Int8);
+SEDNL_FIXED_SCHEMA_FIELD(Int8, Packet::Type::Int8);
+SEDNL_FIXED_SCHEMA_FIELD(Int16, Packet::Type::Int16);
+SEDNL_FIXED_SCHEMA_FIELD(Int32, Packet::Type::Int32);
+SEDNL_FIXED_SCHEMA_FIELD(Int64, Packet::Type::Int64);
+SEDNL_FIXED_SCHEMA_FIELD(UInt8, Packet::Type::UInt8);
+SEDNL_FIXED_SCHEMA_FIELD(UInt16, Packet::Type::UInt16);
+SEDNL_FIXED_SCHEMA_FIELD(UInt32, Packet::Type::UInt32);
+SEDNL_FIXED_SCHEMA_FIELD(UInt64, Packet::Type::UInt64);
+SEDNL_FIXED_SCHEMA_FIELD(float, Packet::Type::Float);
+SEDNL_FIXED_SCHEMA_FIELD(double, Packet::Type::Double);
+
+#undef SEDNL_FIXED_SCHEMA_FIELD
+
+template<>
+struct SchemaField<std::string>
+{
+    static const bool value = true;
+
+    static inline
+    UInt32 code(const std::string&)
+    {
+        return static_cast<UInt32>(Packet::Type::SizedString);
+    }
+
+    static inline
+    void write(Packet& p, const std::string& dt)
+    {
+        p.write_schema_sized(dt.data(), dt.size());
+    }
+
+    static inline
+    void read(PacketReader& r, std::string& dt)
+    {
+        const StringView view = r.read_schema_sized();
+        dt.assign(view.data(), view.size());
+    }
+};
+
+template<>
+struct SchemaField<Blob>
+{
+    static const bool value = true;
+
+    static inline
+    UInt32 code(const Blob&)
+    {
+        return static_cast<UInt32>(Packet::Type::Blob);
+    }
+
+    static inline
+    void write(Packet& p, const Blob& dt)
+    {
+        p.write_schema_sized(dt.data.data(), dt.data.size());
+    }
+
+    static inline
+    void read(PacketReader& r, Blob& dt)
+    {
+        const StringView view = r.read_schema_sized();
+        dt.data.assign(view.begin(), view.end());
+    }
+};
+
+//The size of the integer is part of the code, since
+// a smaller one may overflow.
+template<typename T>
+struct SchemaField<VarInt<T>>
+{
+    static const bool value = true;
+
+    static inline
+    UInt32 code(const VarInt<T>&)
+    {
+        return static_cast<UInt32>(std::is_signed<T>::value
+                                   ? Packet::Type::VarInt
+                                   : Packet::Type::VarUInt)
+            | (sizeof(T) << 8);
+    }
+
+    static inline
+    void write(Packet& p, const VarInt<T>& dt)
+    {
+        p.write_schema_varint(dt.encoded());
+    }
+
+    static inline
+    void read(PacketReader& r, VarInt<T>& dt)
+    {
+        if (!dt.decode(r.read_schema_varint()))
+            throw PacketException(PacketExceptionT::VarIntOverflow);
+    }
+};
+
+//Arrays of numbers, whose codes are the array types.
+template<typename T>
+struct SchemaField<std::vector<T>>
+{
+    static const bool value = std::is_arithmetic<T>::value
+        && SchemaField<T>::value;
+
+    static inline
+    UInt32 code(const std::vector<T>&)
+    {
+        return 0x80 | SchemaField<T>::code(T());
+    }
+
+    static inline
+    void write(Packet& p, const std::vector<T>& dt)
+    {
+        p.write_schema_array(dt.data(), dt.size(), sizeof(T));
+    }
+
+    static inline
+    void read(PacketReader& r, std::vector<T>& dt)
+    {
+        const unsigned short length = r.read_schema_length();
+        dt.resize(length);
+        r.read_schema_array(dt.data(), length, sizeof(T));
+    }
+};
+
+//True if all the types can be written into a schema object.
+template<typename... Args>
+struct SchemaFields;
+
+template<>
+struct SchemaFields<> : std::true_type
+{};
+
+template<typename T, typename... Args>
+struct SchemaFields<T, Args...>
+    : std::integral_constant<bool, SchemaField<T>::value
+                             && SchemaFields<Args...>::value>
+{};
+
+//FNV-1a over the codes of the members
+inline
+UInt32 schema_hash(UInt32 hash) noexcept
+{
+    return hash;
 }
 
 template<typename T, typename... Args>
 inline
-unsigned short number_of_args_aux(T, Args... args)
+UInt32 schema_hash(UInt32 hash, const T& arg, const Args&... args) noexcept
 {
-    return 1 + number_of_args_aux(args...);
+    return schema_hash((hash ^ SchemaField<T>::code(arg)) * 16777619u,
+                       args...);
 }
 
 template<typename... Args>
 inline
-unsigned short number_of_args(Args... args)
+UInt16 schema_fingerprint(const Args&... args) noexcept
 {
-    return number_of_args_aux(args...);
+    const UInt32 hash = schema_hash(2166136261u ^ sizeof...(Args), args...);
+    return static_cast<UInt16>((hash >> 16) ^ hash);
+}
+
+inline void write_schema_aux(Packet&)
+{}
+
+template<typename T, typename... Args>
+void write_schema_aux(Packet& p, T& arg, Args&... args)
+{
+    SchemaField<T>::write(p, arg);
+    write_schema_aux(p, args...);
+}
+
+inline void read_schema_aux(PacketReader&)
+{}
+
+template<typename T, typename... Args>
+void read_schema_aux(PacketReader& r, T& arg, Args&... args)
+{
+    SchemaField<T>::read(r, arg);
+    read_schema_aux(r, args...);
 }
 
 template<typename... Args>
-void write_as_object(Packet& packet, Args&... args)
+void write_as_schema(Packet& packet, Args&... args)
 {
-    const unsigned short nb_args = number_of_args(args...);
+    static_assert(SchemaFields<Args...>::value,
+                  "write_as_schema: a member can't be written without"
+                  " its type, use write_as_object.");
 
-    packet.write_object_header(nb_args);
-    write_to_packet(packet, args...);
+    //Header : {Type::SchemaObject, fingerprint, length}, and members
+    // without their type are smaller than their packed_size.
+    packet.reserve(packet.get_data().size()
+                   + schema_packed_size(packed_size(packet, args...)));
+    const std::size_t payload =
+        packet.write_schema_header(schema_fingerprint(args...));
+    write_schema_aux(packet, args...);
+    packet.write_schema_length(payload);
 }
 
 template<typename... Args>
-void read_as_object(PacketReader& packet_reader, Args&... args)
+void read_as_schema(PacketReader& packet_reader, Args&... args)
 {
-    const unsigned short nb_args = number_of_args(args...);
+    static_assert(SchemaFields<Args...>::value,
+                  "read_as_schema: a member can't be read without"
+                  " its type, use read_as_object.");
+
+    //Fall back to the tagged format
+    if (packet_reader.next_type() != Packet::Type::SchemaObject)
+    {
+        read_as_object(packet_reader, args...);
+        return;
+    }
 
     PacketReader tmp_reader = packet_reader;
-    tmp_reader.read_object_header(nb_args);
-    read_from_packet(tmp_reader, args...);
+    const unsigned int end =
+        tmp_reader.read_schema_header(schema_fingerprint(args...));
+    read_schema_aux(tmp_reader, args...);
+    tmp_reader.read_schema_end(end);
     //If everything gone well, just modify the reader
     using std::swap;
     swap(packet_reader, tmp_reader);
 }
 
+inline
+bool try_read_from_packet(PacketReader&)
+{
+    return true;
+}
+
+template<typename T, typename... Args>
+bool try_read_from_packet(PacketReader& p, T& arg, Args&... args)
+{
+    return p.try_read(arg) && try_read_from_packet(p, args...);
+}
+
+template<typename... Args>
+bool try_read_as_object(PacketReader& packet_reader, Args&... args)
+{
+    PacketReader tmp_reader = packet_reader;
+    if (!tmp_reader.try_object_header(sizeof...(Args))
+        || !try_read_from_packet(tmp_reader, args...))
+        return packet_reader.fail(tmp_reader.m_error);
+    //If everything gone well, just modify the reader
+    using std::swap;
+    swap(packet_reader, tmp_reader);
+    return true;
+}
+
+template<typename... Args>
+bool try_read_as_schema(PacketReader& packet_reader, Args&... args)
+{
+    static_assert(SchemaFields<Args...>::value,
+                  "try_read_as_schema: a member can't be read without"
+                  " its type, use try_read_as_object.");
+
+    //Fall back to the tagged format
+    if (packet_reader.next_type() != Packet::Type::SchemaObject)
+        return try_read_as_object(packet_reader, args...);
+
+    if (!packet_reader.check_schema(schema_fingerprint(args...)))
+        return false;
+
+    //Members aren't tagged : only the throwing readers can check them
+    try
+    {
+        read_as_schema(packet_reader, args...);
+    }
+    catch (PacketException& e)
+    {
+        return packet_reader.fail(e.get_type());
+    }
+    return true;
+}
+
 template<typename T>
 inline
 Packet& Packet::operator<< (T dt)
@@ -139,6 +1057,98 @@ PacketReader& PacketReader::operator>> (T& dt)
     return *this;
 }
 
+template<typename T>
+Packet& Packet::operator<< (const std::vector<T>& dt)
+{
+    if (dt.empty())
+    {
+        write_object_array_header(0, nullptr, 0);
+        return *this;
+    }
+
+    //The elements of a vector are never const objects, and
+    // the serialization hooks may modify them.
+    T& first = const_cast<T&>(dt.front());
+    first.sednl_columns_write(*this, dt.size(), sizeof(T));
+    return *this;
+}
+
+template<typename T>
+PacketReader& PacketReader::operator>> (std::vector<T>& dt)
+{
+    if (!*this)
+        return *this;
+
+    const unsigned short count = object_array_length();
+    if (count == 0)
+    {
+        skip();
+        dt.clear();
+        return *this;
+    }
+
+    dt.resize(count);
+    dt.front().sednl_columns_read(*this, count, sizeof(T));
+    return *this;
+}
+
+template<typename T>
+inline
+bool PacketReader::try_read(T& dt)
+{
+    return try_unserialize(dt, 0);
+}
+
+template<typename T>
+inline
+auto PacketReader::try_unserialize(T& dt, int)
+    -> decltype(dt.sednl_try_read(*this))
+{
+    return dt.sednl_try_read(*this);
+}
+
+template<typename T>
+bool PacketReader::try_unserialize(T& dt, long)
+{
+    //Such objects can be written as any sequence of items
+    if (m_failed)
+        return false;
+    if (!*this)
+        return fail(PacketExceptionT::EndOfPacket);
+
+    PacketReader tmp_reader = *this;
+    try
+    {
+        dt.unserialize(tmp_reader);
+    }
+    catch (PacketException& e)
+    {
+        return fail(e.get_type());
+    }
+    //If everything gone well, just modify the reader
+    using std::swap;
+    swap(*this, tmp_reader);
+    return true;
+}
+
+template<typename T>
+bool PacketReader::try_read(std::vector<T>& dt)
+{
+    if (!check_next({Packet::Type::ObjectArray}))
+        return false;
+
+    //Columns aren't tagged : only the throwing readers can check them
+    try
+    {
+        *this >> dt;
+    }
+    catch (PacketException& e)
+    {
+        return fail(e.get_type());
+    }
+    return true;
+}
+
 template<>
 inline
 Packet& Packet::operator<< <char*>(char* dt)
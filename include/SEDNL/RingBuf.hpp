@@ -26,11 +26,16 @@
 #include "SEDNL/Export.hpp"
 
 #include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
 
 namespace SedNL
 {
 
 class Event;
+class Packet;
+struct CompressionStats;
 
 ///////////////////////////////////////////////////////////////
 //! \brief A ring buffer, for implementation purpose.
@@ -51,6 +56,11 @@ public:
     //! \return False if failed (unmodified buffer), True otherwise.
     bool put(const char* string, unsigned int length) noexcept;
 
+    //! \brief Make the buffer \a size bytes long, keeping its content.
+    //!
+    //! Nothing is done if the buffer is already bigger.
+    void grow(unsigned int size) throw (std::bad_alloc);
+
     //! \brief Return the buffer size.
     //!
     //! \return Size available.
@@ -73,14 +83,58 @@ public:
     //! return the new event throught \a event.
     //! If it fails, it do not modify event.
     //!
+    //! Packets are validated (and indexed) unless \a trusted is true.
+    //! See Connection::set_trusted().
+    //!
+    //! Compressed packets are decompressed first, and accounted
+    //! in \a stats. See Connection::set_compression().
+    //!
+    //! \param[out] event The event read.
+    //! \param[in] trusted True to skip the validation of the packet.
+    //! \param[in,out] stats Decompression statistics to update, if not null.
     //! \return True if new event stored in \a event, False otherwise.
-    bool pick_event(Event& event) noexcept;
+    bool pick_event(Event& event, bool trusted = false,
+                    CompressionStats* stats = nullptr) noexcept;
+
+    //! \brief Empty the table of the strings received, and set
+    //!        its size. 0 disables it.
+    //!
+    //! See Connection::set_string_table().
+    //!
+    //! \param[in] size Number of strings in the table.
+    void set_string_table(unsigned int size);
+
+    //! \brief Return the number of corrupted or invalid packets
+    //!        dropped by pick_event() since the last call.
+    //!
+    //! \return Number of packets dropped.
+    inline unsigned int take_dropped() noexcept;
 
 private:
+    //! \brief Strings defined by a packet, by index.
+    typedef std::unordered_map<unsigned int, std::string> StringDefs;
+
+    //! \brief Replace the Packet::Type::StringDef and
+    //!        Packet::Type::StringRef items of \a packet by strings.
+    //!
+    //! The table isn't modified: the strings defined are stored
+    //! in \a defs, to be applied once the packet is validated.
+    //!
+    //! \param[in,out] packet Packet to decode.
+    //! \param[out] defs Strings defined by the packet.
+    //! \return False if the packet is invalid.
+    bool decode_strings(Packet& packet, StringDefs& defs) const;
+
+    //! \brief Strings received, by index.
+    std::vector<std::string> m_strings;
+
     std::unique_ptr<UInt8[]> m_dt;
     unsigned int m_size;
     unsigned int m_start;
     unsigned int m_end;
+
+    //! \brief Packets dropped, see take_dropped().
+    unsigned int m_dropped;
 };
 
 } // namespace SedNL
@@ -34,6 +34,14 @@ RingBuf::reset() noexcept
     m_start = m_end;
 }
 
+inline unsigned int
+RingBuf::take_dropped() noexcept
+{
+    const unsigned int dropped = m_dropped;
+    m_dropped = 0;
+    return dropped;
+}
+
 inline unsigned int
 RingBuf::length() const noexcept
 {
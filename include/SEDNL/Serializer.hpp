@@ -39,7 +39,51 @@ namespace SedNL
         SedNL::serializer_unserialize(p, *this, __VA_ARGS__);        \
     }                                                                \
     inline void unserialize(const SedNL::Packet& p)                  \
-    { SedNL::PacketReader r(p); unserialize(r); };
+    { SedNL::PacketReader r(p); unserialize(r); };                   \
+    inline std::size_t                                               \
+    sednl_packed_size(const SedNL::PackedEncodings& e) const         \
+    {                                                                \
+        return SedNL::serializer_packed_size(e, __VA_ARGS__);        \
+    }                                                                \
+    inline void sednl_schema_write(SedNL::Packet& p)                 \
+    {                                                                \
+        SedNL::serializer_schema_write(p, *this, __VA_ARGS__);       \
+    }                                                                \
+    inline void sednl_schema_read(SedNL::PacketReader& p)            \
+    {                                                                \
+        SedNL::serializer_schema_read(p, *this, __VA_ARGS__);        \
+    }                                                                \
+    inline SedNL::UInt16 sednl_schema() const                        \
+    {                                                                \
+        return SedNL::schema_fingerprint(__VA_ARGS__);               \
+    }                                                                \
+    inline void sednl_columns_write(SedNL::Packet& p,                \
+                                    std::size_t count,               \
+                                    std::size_t stride)              \
+    {                                                                \
+        SedNL::serializer_columns_write(p, *this, count, stride,     \
+                                        __VA_ARGS__);                \
+    }                                                                \
+    inline void sednl_columns_read(SedNL::PacketReader& p,           \
+                                   std::size_t count,                \
+                                   std::size_t stride)               \
+    {                                                                \
+        SedNL::serializer_columns_read(p, *this, count, stride,      \
+                                       __VA_ARGS__);                 \
+    }                                                                \
+    inline std::size_t                                               \
+    sednl_columns_packed_size(const SedNL::PackedEncodings& e,       \
+                              std::size_t count,                     \
+                              std::size_t stride) const              \
+    {                                                                \
+        return SedNL::serializer_columns_packed_size(e, *this, count,\
+                                                     stride,         \
+                                                     __VA_ARGS__);   \
+    }                                                                \
+    inline bool sednl_try_read(SedNL::PacketReader& p)               \
+    {                                                                \
+        return SedNL::serializer_try_read(p, *this, __VA_ARGS__);    \
+    }
 
 //! Implementation of serialization.
 template<typename T, typename... Args>
@@ -49,6 +93,45 @@ void serializer_serialize(Packet& packet, T&inst, Args&... args);
 template<typename T, typename... Args>
 void serializer_unserialize(PacketReader& packet_reader, T&inst, Args&... args);
 
+//! Implementation of the serialization as a member of a schema object.
+template<typename T, typename... Args>
+void serializer_schema_write(Packet& packet, T&inst, Args&... args);
+
+//! Implementation of the unserialization as a member of a schema object.
+template<typename T, typename... Args>
+void serializer_schema_read(PacketReader& packet_reader, T&inst, Args&... args);
+
+//! Implementation of the serialization of \a count objects, the first
+//! one being \a first and the next ones every \a stride bytes.
+template<typename T, typename... Args>
+void serializer_columns_write(Packet& packet, T& first, std::size_t count,
+                              std::size_t stride, Args&... args);
+
+//! Implementation of the unserialization of \a count objects, the first
+//! one being \a first and the next ones every \a stride bytes.
+template<typename T, typename... Args>
+void serializer_columns_read(PacketReader& packet_reader, T& first,
+                             std::size_t count, std::size_t stride,
+                             Args&... args);
+
+//! Upper bound of the size of an object, see packed_size().
+template<typename... Args>
+std::size_t serializer_packed_size(const PackedEncodings& e,
+                                   const Args&... args);
+
+//! Upper bound of the size of \a count objects written by
+//! serializer_columns_write().
+template<typename T, typename... Args>
+std::size_t serializer_columns_packed_size(const PackedEncodings& e,
+                                           const T& first, std::size_t count,
+                                           std::size_t stride,
+                                           const Args&... args);
+
+//! Implementation of the unserialization without exceptions.
+//! See PacketReader::try_read().
+template<typename T, typename... Args>
+bool serializer_try_read(PacketReader& packet_reader, T&inst, Args&... args);
+
 };
 
 #include "Serializer.ipp"
@@ -91,6 +174,17 @@ void serializer_unserialize(PacketReader& packet_reader, T&inst, Args&... args);
 //! / unserialization process. Thats the recomanded way for costumisation
 //! of serialization and unserialization process.
 //!
+//! Objects are written with the type of each member. When both sides
+//! share the same classes, set the Packet::ObjectEncoding::Schema
+//! encoding on the packet : a fingerprint of the types of the members
+//! (see schema_fingerprint()) is written once, followed by the members
+//! without their types. Nested serializable objects are written the same
+//! way, inside their parent. An object is read from both encodings.
+//!
+//! A std::vector of serializable objects is written member by member
+//! (see Packet::operator<<(const std::vector<T>&)) : the numeric members
+//! of all the objects are written as a single array.
+//!
 //! A serializable instances (i.e. an instance of a serializable class)
 //! can be used with Packet::operator<<() and PacketReader::operator>>().
 //! It means that you can read / write it as if it was a simple string.
@@ -160,7 +254,14 @@ void serializer_unserialize(PacketReader& packet_reader, T&inst, Args&... args);
 //! call the SEDNL_SERIALIZE() inside your class definition
 //! with the list of fields you would like to see serialized.
 //!
-//! This will create two member methods serialize and unserialize.
+//! This will create two member methods serialize and unserialize,
+//! a sednl_packed_size() method used by packed_size(), the
+//! sednl_schema_write(), sednl_schema_read() and sednl_schema()
+//! methods used by the schema encoding (see Packet::ObjectEncoding),
+//! the sednl_columns_write(), sednl_columns_read() and
+//! sednl_columns_packed_size() methods used to write vectors
+//! of objects, and the sednl_try_read()
+//! method used by PacketReader::try_read().
 //!
 //! Then, you can call your_instance.serialize(packet)
 //! and your_instance.unserialize(packet_reader).
@@ -197,6 +298,43 @@ void serializer_unserialize(PacketReader& packet_reader, T&inst, Args&... args);
 //!     PacketReader r(p);
 //!     unserialize(r);
 //! };
+//! inline std::size_t sednl_packed_size(const PackedEncodings& e) const
+//! {
+//!     return serializer_packed_size(e, __VA_ARGS__);
+//! }
+//! inline void sednl_schema_write(Packet& p)
+//! {
+//!     serializer_schema_write(p, *this, __VA_ARGS__);
+//! }
+//! inline void sednl_schema_read(PacketReader& p)
+//! {
+//!     serializer_schema_read(p, *this, __VA_ARGS__);
+//! }
+//! inline UInt16 sednl_schema() const
+//! {
+//!     return schema_fingerprint(__VA_ARGS__);
+//! }
+//! inline void sednl_columns_write(Packet& p, std::size_t count,
+//!                                 std::size_t stride)
+//! {
+//!     serializer_columns_write(p, *this, count, stride, __VA_ARGS__);
+//! }
+//! inline void sednl_columns_read(PacketReader& p, std::size_t count,
+//!                                std::size_t stride)
+//! {
+//!     serializer_columns_read(p, *this, count, stride, __VA_ARGS__);
+//! }
+//! inline std::size_t sednl_columns_packed_size(const PackedEncodings& e,
+//!                                              std::size_t count,
+//!                                              std::size_t stride) const
+//! {
+//!     return serializer_columns_packed_size(e, *this, count, stride,
+//!                                           __VA_ARGS__);
+//! }
+//! inline bool sednl_try_read(PacketReader& p)
+//! {
+//!     return serializer_try_read(p, *this, __VA_ARGS__);
+//! }
 //!
 //! \endcode
 //!
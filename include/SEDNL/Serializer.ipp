@@ -86,11 +86,261 @@ struct Serializer
     {};
 };
 
+//Objects whose members can all be written without their type
+template<typename... Args>
+inline
+void serializer_write(Packet& packet, std::true_type, Args&... args)
+{
+    if (packet.get_object_encoding() == Packet::ObjectEncoding::Schema)
+        write_as_schema(packet, args...);
+    else
+        write_as_object(packet, args...);
+}
+
+template<typename... Args>
+inline
+void serializer_write(Packet& packet, std::false_type, Args&... args)
+{
+    write_as_object(packet, args...);
+}
+
+template<typename... Args>
+inline
+void serializer_read(PacketReader& packet_reader, std::true_type,
+                     Args&... args)
+{
+    read_as_schema(packet_reader, args...);
+}
+
+template<typename... Args>
+inline
+void serializer_read(PacketReader& packet_reader, std::false_type,
+                     Args&... args)
+{
+    read_as_object(packet_reader, args...);
+}
+
+template<typename... Args>
+inline
+bool serializer_try_read(PacketReader& packet_reader, std::true_type,
+                         Args&... args)
+{
+    return try_read_as_schema(packet_reader, args...);
+}
+
+template<typename... Args>
+inline
+bool serializer_try_read(PacketReader& packet_reader, std::false_type,
+                         Args&... args)
+{
+    return try_read_as_object(packet_reader, args...);
+}
+
+//Members of a schema object : a nested object having a member
+// that can't be written without its type is a whole tagged object.
+template<typename... Args>
+inline
+void serializer_schema_fields(Packet& packet, std::true_type, Args&... args)
+{
+    write_schema_aux(packet, args...);
+}
+
+template<typename... Args>
+inline
+void serializer_schema_fields(Packet& packet, std::false_type, Args&... args)
+{
+    write_as_object(packet, args...);
+}
+
+template<typename... Args>
+inline
+void serializer_schema_fields(PacketReader& packet_reader, std::true_type,
+                              Args&... args)
+{
+    read_schema_aux(packet_reader, args...);
+}
+
+template<typename... Args>
+inline
+void serializer_schema_fields(PacketReader& packet_reader, std::false_type,
+                              Args&... args)
+{
+    read_as_object(packet_reader, args...);
+}
+
+//The element \a i of a column whose first element is \a first :
+// the same member of each object is found \a stride bytes further.
+template<typename T>
+inline
+T& column_element(T& first, std::size_t i, std::size_t stride) noexcept
+{
+    return *reinterpret_cast<T*>(reinterpret_cast<char*>(&first)
+                                 + i * stride);
+}
+
+template<typename T>
+inline
+const T& column_element(const T& first, std::size_t i,
+                        std::size_t stride) noexcept
+{
+    return *reinterpret_cast<const T*>(reinterpret_cast<const char*>(&first)
+                                       + i * stride);
+}
+
+//How the column of a member of type T is written.
+template<typename T>
+struct ColumnField
+{
+    //Serializable objects declared with SEDNL_SERIALIZABLE
+    template<typename U>
+    static char test(decltype(&U::sednl_columns_write));
+
+    template<typename U>
+    static long test(...);
+
+    static const bool nested = sizeof(test<T>(nullptr)) == sizeof(char);
+    static const bool numeric = std::is_arithmetic<T>::value
+        && SchemaField<T>::value;
+
+    static const Byte kind = (numeric || nested)
+        ? SEDNL_COLUMN_PACKED : SEDNL_COLUMN_ITEMS;
+
+    typedef std::integral_constant<int, numeric ? 0 : nested ? 1 : 2> tag;
+
+    //Numbers are gathered into an array
+    static inline
+    void write(Packet& p, T& first, std::size_t count, std::size_t stride,
+               std::integral_constant<int, 0>)
+    {
+        std::vector<T> column(count);
+        for (std::size_t i = 0; i < count; i++)
+            column[i] = column_element(first, i, stride);
+        p << column;
+    }
+
+    static inline
+    void read(PacketReader& r, T& first, std::size_t count,
+              std::size_t stride, std::integral_constant<int, 0>)
+    {
+        std::vector<T> column;
+        r >> column;
+        if (column.size() != count)
+            throw PacketException(PacketExceptionT::WrongSizedObject);
+        for (std::size_t i = 0; i < count; i++)
+            column_element(first, i, stride) = column[i];
+    }
+
+    static inline
+    std::size_t packed_size(const PackedEncodings& e, const T&,
+                            std::size_t count, std::size_t,
+                            std::integral_constant<int, 0>)
+    {
+        return array_packed_size(count, sizeof(T),
+                                 std::is_integral<T>::value && sizeof(T) > 1,
+                                 e);
+    }
+
+    //Serializable objects are a nested ObjectArray
+    static inline
+    void write(Packet& p, T& first, std::size_t count, std::size_t stride,
+               std::integral_constant<int, 1>)
+    {
+        first.sednl_columns_write(p, count, stride);
+    }
+
+    static inline
+    void read(PacketReader& r, T& first, std::size_t count,
+              std::size_t stride, std::integral_constant<int, 1>)
+    {
+        first.sednl_columns_read(r, count, stride);
+    }
+
+    static inline
+    std::size_t packed_size(const PackedEncodings& e, const T& first,
+                            std::size_t count, std::size_t stride,
+                            std::integral_constant<int, 1>)
+    {
+        return first.sednl_columns_packed_size(e, count, stride);
+    }
+
+    //Anything else is written one after the other
+    static inline
+    void write(Packet& p, T& first, std::size_t count, std::size_t stride,
+               std::integral_constant<int, 2>)
+    {
+        for (std::size_t i = 0; i < count; i++)
+            p << column_element(first, i, stride);
+    }
+
+    static inline
+    void read(PacketReader& r, T& first, std::size_t count,
+              std::size_t stride, std::integral_constant<int, 2>)
+    {
+        for (std::size_t i = 0; i < count; i++)
+            r >> column_element(first, i, stride);
+    }
+
+    static inline
+    std::size_t packed_size(const PackedEncodings& e, const T& first,
+                            std::size_t count, std::size_t stride,
+                            std::integral_constant<int, 2>)
+    {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < count; i++)
+            size += PackedSize<T>::of(column_element(first, i, stride), e);
+        return size;
+    }
+};
+
+inline
+std::size_t serializer_columns_packed_aux(const PackedEncodings&,
+                                          std::size_t, std::size_t)
+{
+    return 0;
+}
+
+template<typename T, typename... Args>
+std::size_t serializer_columns_packed_aux(const PackedEncodings& e,
+                                          std::size_t count,
+                                          std::size_t stride,
+                                          const T& arg, const Args&... args)
+{
+    return ColumnField<T>::packed_size(e, arg, count, stride,
+                                       typename ColumnField<T>::tag())
+        + serializer_columns_packed_aux(e, count, stride, args...);
+}
+
+inline
+void serializer_columns_aux(Packet&, std::size_t, std::size_t)
+{}
+
+template<typename T, typename... Args>
+void serializer_columns_aux(Packet& packet, std::size_t count,
+                            std::size_t stride, T& arg, Args&... args)
+{
+    ColumnField<T>::write(packet, arg, count, stride,
+                          typename ColumnField<T>::tag());
+    serializer_columns_aux(packet, count, stride, args...);
+}
+
+inline
+void serializer_columns_aux(PacketReader&, std::size_t, std::size_t)
+{}
+
+template<typename T, typename... Args>
+void serializer_columns_aux(PacketReader& packet_reader, std::size_t count,
+                            std::size_t stride, T& arg, Args&... args)
+{
+    ColumnField<T>::read(packet_reader, arg, count, stride,
+                         typename ColumnField<T>::tag());
+    serializer_columns_aux(packet_reader, count, stride, args...);
+}
+
 template<typename T, typename... Args>
 void serializer_serialize(Packet& packet, T& inst, Args&... args)
 {
     SedNL::Serializer<T>::pre_serialize(inst, 0);
-    write_as_object(packet, args...);
+    serializer_write(packet, SchemaFields<Args...>(), args...);
     SedNL::Serializer<T>::post_serialize(inst, 0);
 }
 
@@ -98,10 +348,92 @@ template<typename T, typename... Args>
 void serializer_unserialize(PacketReader& packet_reader, T& inst, Args&... args)
 {
     SedNL::Serializer<T>::pre_unserialize(inst, 0);
-    read_as_object(packet_reader, args...);
+    serializer_read(packet_reader, SchemaFields<Args...>(), args...);
+    SedNL::Serializer<T>::post_unserialize(inst, 0);
+}
+
+template<typename T, typename... Args>
+bool serializer_try_read(PacketReader& packet_reader, T& inst, Args&... args)
+{
+    SedNL::Serializer<T>::pre_unserialize(inst, 0);
+    if (!serializer_try_read(packet_reader, SchemaFields<Args...>(), args...))
+        return false;
+    SedNL::Serializer<T>::post_unserialize(inst, 0);
+    return true;
+}
+
+template<typename T, typename... Args>
+void serializer_schema_write(Packet& packet, T& inst, Args&... args)
+{
+    SedNL::Serializer<T>::pre_serialize(inst, 0);
+    serializer_schema_fields(packet, SchemaFields<Args...>(), args...);
+    SedNL::Serializer<T>::post_serialize(inst, 0);
+}
+
+template<typename T, typename... Args>
+void serializer_schema_read(PacketReader& packet_reader, T& inst, Args&... args)
+{
+    SedNL::Serializer<T>::pre_unserialize(inst, 0);
+    serializer_schema_fields(packet_reader, SchemaFields<Args...>(), args...);
     SedNL::Serializer<T>::post_unserialize(inst, 0);
 }
 
+template<typename T, typename... Args>
+void serializer_columns_write(Packet& packet, T& first, std::size_t count,
+                              std::size_t stride, Args&... args)
+{
+    static const Byte kinds[] = {ColumnField<Args>::kind...};
+
+    for (std::size_t i = 0; i < count; i++)
+        SedNL::Serializer<T>::pre_serialize(column_element(first, i, stride), 0);
+    packet.write_object_array_header(count, kinds, sizeof...(Args));
+    serializer_columns_aux(packet, count, stride, args...);
+    for (std::size_t i = 0; i < count; i++)
+        SedNL::Serializer<T>::post_serialize(column_element(first, i, stride), 0);
+}
+
+template<typename... Args>
+std::size_t serializer_packed_size(const PackedEncodings& e,
+                                   const Args&... args)
+{
+    const std::size_t members = packed_size_aux(e, args...);
+    if (SchemaFields<Args...>::value
+        && e.object == Packet::ObjectEncoding::Schema)
+        return schema_packed_size(members);
+    //Header : {Type::Object, length}
+    return 2 + members;
+}
+
+template<typename T, typename... Args>
+std::size_t serializer_columns_packed_size(const PackedEncodings& e,
+                                           const T&, std::size_t count,
+                                           std::size_t stride,
+                                           const Args&... args)
+{
+    //Header : {Type::ObjectArray, count, members}, and a kind per member
+    return 1 + sizeof(UInt16) + sizeof(UInt8) + sizeof...(Args)
+        + serializer_columns_packed_aux(e, count, stride, args...);
+}
+
+template<typename T, typename... Args>
+void serializer_columns_read(PacketReader& packet_reader, T& first,
+                             std::size_t count, std::size_t stride,
+                             Args&... args)
+{
+    static const Byte kinds[] = {ColumnField<Args>::kind...};
+
+    PacketReader tmp_reader = packet_reader;
+    tmp_reader.read_object_array_header(count, kinds, sizeof...(Args));
+    for (std::size_t i = 0; i < count; i++)
+        SedNL::Serializer<T>::pre_unserialize(column_element(first, i, stride), 0);
+    serializer_columns_aux(tmp_reader, count, stride, args...);
+    for (std::size_t i = 0; i < count; i++)
+        SedNL::Serializer<T>::post_unserialize(column_element(first, i, stride), 0);
+    //If everything gone well, just modify the reader
+    using std::swap;
+    swap(packet_reader, tmp_reader);
+}
+
 } //namespace SedNL
 
 //! @endcond
@@ -22,7 +22,8 @@
 #ifndef SLOT_HPP_
 #define SLOT_HPP_
 
-#include <memory>
+#include <cstddef>
+#include <type_traits>
 
 namespace SedNL
 {
@@ -42,11 +43,35 @@ public:
     template <typename T>
     using MemberCallback = void (T::*)(Arguments...);
 
+    //! \brief Size of the buffer in which the callback is stored.
+    //!
+    //! Callbacks bigger than this buffer are allocated on the heap,
+    //! and the buffer only stores a pointer to them.
+    static constexpr std::size_t StorageSize = 6 * sizeof(void*);
+
+    //! \brief Construct an empty slot.
+    Slot() noexcept;
+
+    //! \brief Copy the callback of \a slot.
+    Slot(const Slot& slot);
+
+    //! \brief Move the callback of \a slot, leaving \a slot empty.
+    Slot(Slot&& slot);
+
+    //! \brief Copy the callback of \a slot.
+    Slot& operator=(const Slot& slot);
+
+    //! \brief Move the callback of \a slot, leaving \a slot empty.
+    Slot& operator=(Slot&& slot);
+
+    //! \brief Destroy the stored callback.
+    ~Slot();
+
     //! \brief Remove an eventualy stored callback.
     void reset() noexcept;
 
     //! \brief Call the current callback, or do nothing.
-    void operator()(Arguments... args);
+    inline void operator()(Arguments... args);
 
     //! \brief Check if the slot isn't empty.
     //!
@@ -56,9 +81,10 @@ public:
     //! \brief Set the callback.
     //!
     //! Set the callback from a function pointer, a lambda
-    //! or a functor. Actualy, it just wrap T to the internal
-    //! std::function constructor, so you can also give a std::function,
-    //! for example from a call to std::bind.
+    //! or a functor. The callback is stored inside the slot if it
+    //! isn't bigger than StorageSize bytes, and allocated otherwise.
+    //! You can also give a std::function, for example from a call
+    //! to std::bind.
     //!
     //! \param[in] function The callback to store.
     template<typename T>
@@ -93,8 +119,53 @@ public:
     template<typename T>
     void set_function(T* instance, MemberCallback<T> callback);
 
+    //! \brief Set a function known at compile time as the callback.
+    //!
+    //! Usage: `slot.set_function<&my_callback>();`
+    //!
+    //! The function is called directly (and can be inlined)
+    //! by the slot.
+    template<Callback function>
+    void set_function();
+
+    //! \brief Set a member function known at compile time as the callback.
+    //!
+    //! Usage: `slot.set_function<MyClass, &MyClass::on_hello>(&my_class);`
+    //!
+    //! Only the pointer to \a instance is stored, and the member
+    //! function is called directly (and can be inlined) by the slot.
+    //!
+    //! \param[in] instance The instance pointer that will be stored.
+    template<typename T, void (T::*callback)(Arguments...)>
+    void set_function(T* instance);
+
 private:
-    std::function<void(Arguments...)> container;
+    //! Call the callback stored in a buffer.
+    typedef void (*Invoker)(void*, Arguments...);
+
+    //! Copy (when source isn't null) or destroy the callback
+    //! stored in a buffer.
+    typedef void (*Manager)(void* destination, const void* source);
+
+    //! Store \a function, replacing the current callback.
+    template<typename F>
+    void store(F function);
+
+    //! Store \a function inside the buffer.
+    template<typename F>
+    void store(F function, std::true_type);
+
+    //! Store a pointer to a copy of \a function allocated on the heap.
+    template<typename F>
+    void store(F function, std::false_type);
+
+    //! Copy the callback of \a slot into this empty slot.
+    void copy_from(const Slot& slot);
+
+    typename std::aligned_storage<StorageSize>::type m_storage;
+    Invoker m_invoker;
+    //! Null for trivially copyable callbacks.
+    Manager m_manager;
 };
 
 } // namespace SedNL
@@ -108,6 +179,9 @@ private:
 //! \class SedNL::Slot
 //!
 //! A slot is an emplacement that can store callback.
+//! The callback is stored inside the slot, in a buffer of
+//! Slot::StorageSize bytes, so setting, copying and calling a slot
+//! don't allocate memory. Only bigger callbacks are allocated.
 //!
 //! A callback can be :
 //!   - A function pointer, as `void (*function)(int)`.
@@ -120,6 +194,10 @@ private:
 //!     the class.
 //!   - A pointer to member function, with a reference to an instance of
 //!     the class.
+//!   - A function, or a pointer to member function with a reference
+//!     to an instance of the class, given as template arguments.
+//!     The callback is then called directly instead of through a
+//!     pointer.
 //!
 //! Slots are the way you bind your callbacks to event consumers.
 //!
@@ -153,7 +231,11 @@ private:
 //!
 //! EventConsumer consumer;
 //! //consumer.bind("hello") is a reference to a Slot<Connection&, const Event&>.
-//! consumer.bind("hello").set_function(&my_class, MyClass::on_hello);
+//! consumer.bind("hello").set_function(&my_class, &MyClass::on_hello);
+//!
+//! //Or, with a member function known at compile time,
+//! //called directly by the consumer:
+//! consumer.bind<MyClass, &MyClass::on_hello>("hello", &my_class);
 //!
 //! \endcode
 ////////////////////////////////////////////////////////////
@@ -20,6 +20,8 @@
 //        distribution.
 
 #include <utility>
+#include <new>
+#include <cstring>
 
 #ifndef SLOT_IPP_
 #define SLOT_IPP_
@@ -27,44 +29,218 @@
 namespace SedNL
 {
 
+//! @cond Doxygen_Suppress
+
+//Call and manage a callback of type F stored in a slot buffer.
+template <typename F, typename... Arguments>
+struct SlotStub
+{
+    static void call(void* storage, Arguments... args)
+    {
+        (*static_cast<F*>(storage))(std::forward<Arguments>(args)...);
+    }
+
+    static void manage(void* destination, const void* source)
+    {
+        if (source)
+            new (destination) F(*static_cast<const F*>(source));
+        else
+            static_cast<F*>(destination)->~F();
+    }
+};
+
+//Call and manage a callback of type F too big for a slot buffer,
+//allocated on the heap : the buffer only stores a pointer to it.
+template <typename F, typename... Arguments>
+struct SlotHeapStub
+{
+    static void call(void* storage, Arguments... args)
+    {
+        (**static_cast<F**>(storage))(std::forward<Arguments>(args)...);
+    }
+
+    static void manage(void* destination, const void* source)
+    {
+        if (source)
+            new (destination) F*(new F(**static_cast<F* const*>(source)));
+        else
+            delete *static_cast<F**>(destination);
+    }
+};
+
+//Call a function known at compile time.
+template <typename Callback, Callback function, typename... Arguments>
+struct SlotFunctionStub
+{
+    static void call(void*, Arguments... args)
+    {
+        function(std::forward<Arguments>(args)...);
+    }
+};
+
+//Call a member function known at compile time,
+//on the instance pointer stored in a slot buffer.
+template <typename T, typename Callback, Callback method, typename... Arguments>
+struct SlotMethodStub
+{
+    static void call(void* storage, Arguments... args)
+    {
+        (static_cast<T*>(*static_cast<T**>(storage))->*method)(std::forward<Arguments>(args)...);
+    }
+};
+
+//! @endcond
+
+template <typename... Arguments>
+Slot<Arguments...>::Slot() noexcept
+    :m_invoker(nullptr), m_manager(nullptr)
+{}
+
+template <typename... Arguments>
+Slot<Arguments...>::Slot(const Slot& slot)
+    :Slot()
+{
+    copy_from(slot);
+}
+
+template <typename... Arguments>
+Slot<Arguments...>::Slot(Slot&& slot)
+    :Slot()
+{
+    copy_from(slot);
+    slot.reset();
+}
+
+template <typename... Arguments>
+Slot<Arguments...>& Slot<Arguments...>::operator=(const Slot& slot)
+{
+    if (this != &slot)
+    {
+        reset();
+        copy_from(slot);
+    }
+    return *this;
+}
+
+template <typename... Arguments>
+Slot<Arguments...>& Slot<Arguments...>::operator=(Slot&& slot)
+{
+    if (this != &slot)
+    {
+        reset();
+        copy_from(slot);
+        slot.reset();
+    }
+    return *this;
+}
+
+template <typename... Arguments>
+Slot<Arguments...>::~Slot()
+{
+    reset();
+}
+
+template <typename... Arguments>
+void Slot<Arguments...>::copy_from(const Slot& slot)
+{
+    if (slot.m_manager)
+        slot.m_manager(&m_storage, &slot.m_storage);
+    else
+        std::memcpy(&m_storage, &slot.m_storage, sizeof(m_storage));
+    m_invoker = slot.m_invoker;
+    m_manager = slot.m_manager;
+}
+
+template <typename... Arguments>
+template <typename F>
+void Slot<Arguments...>::store(F f)
+{
+    store(std::move(f), std::integral_constant<bool,
+          sizeof(F) <= StorageSize
+          && alignof(F) <= alignof(decltype(m_storage))>());
+}
+
+template <typename... Arguments>
+template <typename F>
+void Slot<Arguments...>::store(F f, std::true_type)
+{
+    reset();
+    new (&m_storage) F(std::move(f));
+    m_invoker = &SlotStub<F, Arguments...>::call;
+    m_manager = std::is_trivially_copyable<F>::value
+        ? nullptr : &SlotStub<F, Arguments...>::manage;
+}
+
+template <typename... Arguments>
+template <typename F>
+void Slot<Arguments...>::store(F f, std::false_type)
+{
+    //Allocated before the current callback is destroyed
+    F* const function = new F(std::move(f));
+    reset();
+    new (&m_storage) F*(function);
+    m_invoker = &SlotHeapStub<F, Arguments...>::call;
+    m_manager = &SlotHeapStub<F, Arguments...>::manage;
+}
+
 template <typename... Arguments>
 void Slot<Arguments...>::operator()(Arguments... args)
 {
-    if (container)
-        container(args...);
+    if (m_invoker)
+        m_invoker(&m_storage, std::forward<Arguments>(args)...);
 }
 
 template <typename... Arguments>
 template <class T>
 void Slot<Arguments...>::set_function(T f)
 {
-    container = std::function<void(Arguments...)>(f);
+    store(std::move(f));
 }
 
 template <typename... Arguments>
 template <class T>
 void Slot<Arguments...>::set_function(T& inst, MemberCallback<T> f)
 {
-    container = [=](Arguments... args) mutable {(inst.*f)(args...);};
+    store([=](Arguments... args) mutable {(inst.*f)(std::forward<Arguments>(args)...);});
 }
 
 template <typename... Arguments>
 template <class T>
 void Slot<Arguments...>::set_function(T* inst, MemberCallback<T> f)
 {
-    container = [=](Arguments... args){(inst->*f)(args...);};
+    store([=](Arguments... args){(inst->*f)(std::forward<Arguments>(args)...);});
+}
+
+template <typename... Arguments>
+template <typename Slot<Arguments...>::Callback function>
+void Slot<Arguments...>::set_function()
+{
+    reset();
+    m_invoker = &SlotFunctionStub<Callback, function, Arguments...>::call;
+}
+
+template <typename... Arguments>
+template <typename T, void (T::*method)(Arguments...)>
+void Slot<Arguments...>::set_function(T* inst)
+{
+    reset();
+    new (&m_storage) T*(inst);
+    m_invoker = &SlotMethodStub<T, MemberCallback<T>, method, Arguments...>::call;
 }
 
 template <typename... Arguments>
 void Slot<Arguments...>::reset() noexcept
 {
-    container = std::function<void(Arguments...)>();
+    if (m_manager)
+        m_manager(&m_storage, nullptr);
+    m_invoker = nullptr;
+    m_manager = nullptr;
 }
 
 template <typename... Arguments>
 Slot<Arguments...>::operator bool() const noexcept
 {
-    return (bool)container;
+    return m_invoker != nullptr;
 }
 
 } // namespace SedNL
@@ -0,0 +1,145 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef STATE_SYNC_HPP_
+#define STATE_SYNC_HPP_
+
+#include "SEDNL/Export.hpp"
+#include "SEDNL/Types.hpp"
+#include "SEDNL/Packet.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace SedNL
+{
+
+////////////////////////////////////////////////////////////
+//! \brief Synchronize serializable objects by sending only
+//!        the fields that changed.
+//!
+//! Each side keeps the last state of each object, known by an id.
+//! write() compares the object with the last state written, and
+//! only writes the fields that changed. read() applies them to the
+//! last state read, and rebuilds the whole object.
+//!
+//! An object is written as :
+//! {id : VarInt<UInt32>, mask : Blob, changed fields...}, where the
+//! mask is {number of fields, a bit per field}. The first write of an
+//! object (or the first one after forget()) contains all the fields.
+//!
+//! Use one instance per connection and per direction : since
+//! connections are reliable, a state written is the state read by
+//! the peer. If a packet written isn't sent (an exception from
+//! Connection::send(), a disconnection, etc.) call reset() so that
+//! the next writes contain the whole objects.
+//!
+//! Objects are compared by their serialized fields (see
+//! SEDNL_SERIALIZABLE), written with the Packet::ObjectEncoding::Tagged
+//! encoding. It isn't thread safe.
+//!
+//! \code
+//! //Sender, every tick
+//! Packet p;
+//! for (auto& player : players)
+//!     sync.write(p, player.id, player);
+//! connection.send(Event("players", p));
+//!
+//! //Receiver
+//! PacketReader r(event.get_packet());
+//! UInt32 id;
+//! Player player;
+//! while (r)
+//! {
+//!     sync.read(r, id, player);
+//!     players[id] = player;
+//! }
+//! \endcode
+////////////////////////////////////////////////////////////
+class SEDNL_API StateSync
+{
+public:
+    //! \brief Build an instance knowing no object.
+    StateSync();
+
+    //! \brief Write the fields of \a object that changed since the
+    //!        last time the object \a id was written.
+    //!
+    //! \param[out] packet Packet to write into.
+    //! \param[in] id Id of the object.
+    //! \param[in] object The object.
+    //! \return False if nothing changed : nothing was written.
+    template<typename T>
+    bool write(Packet& packet, UInt32 id, T& object);
+
+    //! \brief Read an object written by write().
+    //!
+    //! \a object is rebuilt from all its fields : the changed ones
+    //! read and the other ones from the last state of the object.
+    //!
+    //! It throws a PacketException (UnknownObject) if the last
+    //! state of the object is needed, but unknown.
+    //!
+    //! \param[in] reader Reader to read from.
+    //! \param[out] id Id of the object.
+    //! \param[out] object The object.
+    template<typename T>
+    void read(PacketReader& reader, UInt32& id, T& object);
+
+    //! \brief Forget the state of the object \a id.
+    //!
+    //! The next write of the object writes all its fields.
+    void forget(UInt32 id);
+
+    //! \brief Forget the state of all objects.
+    void reset();
+
+    //! \brief Return the number of objects known.
+    std::size_t size() const noexcept;
+
+private:
+    //! \brief The serialized fields of an object.
+    struct State
+    {
+        //! \brief The object, as written by Packet::operator<<().
+        ByteArray data;
+        //! \brief Offset of each field in data, and of its end.
+        std::vector<UInt32> offsets;
+    };
+
+    std::unordered_map<UInt32, State> m_states;
+
+    //! \brief Write the changes of the object \a id, whose fields
+    //!        are in \a object (a Packet::Type::Object).
+    bool write_delta(Packet& packet, UInt32 id, const Packet& object)
+        throw(PacketException);
+
+    //! \brief Read the changes of an object, and write the whole
+    //!        object into \a object.
+    void read_delta(PacketReader& reader, UInt32& id, Packet& object)
+        throw(PacketException);
+};
+
+} // namespace SedNL
+
+#include "SEDNL/StateSync.ipp"
+
+#endif /* !STATE_SYNC_HPP_ */
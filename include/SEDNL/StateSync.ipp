@@ -0,0 +1,52 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef STATE_SYNC_IPP_
+#define STATE_SYNC_IPP_
+
+namespace SedNL
+{
+
+template<typename T>
+bool StateSync::write(Packet& packet, UInt32 id, T& object)
+{
+    //Native arrays are aligned on their offset in the packet,
+    // which differs once copied.
+    Packet fields;
+    if (packet.get_array_encoding() != Packet::ArrayEncoding::Native)
+        fields.set_array_encoding(packet.get_array_encoding());
+    fields.set_string_encoding(packet.get_string_encoding());
+    object.serialize(fields);
+
+    return write_delta(packet, id, fields);
+}
+
+template<typename T>
+void StateSync::read(PacketReader& reader, UInt32& id, T& object)
+{
+    Packet fields;
+    read_delta(reader, id, fields);
+    PacketReader(fields) >> object;
+}
+
+} // namespace SedNL
+
+#endif /* !STATE_SYNC_IPP_ */
@@ -70,6 +70,9 @@ template<class T, class Container = std::deque<T>>
 class SafeQueue
 {
 public:
+    //! \brief Construct an empty queue.
+    inline SafeQueue();
+
     //! \brief Checks whether the underlying container is empty.
     //!
     //! \return True if empty, False otherwise.
@@ -80,6 +83,11 @@ public:
     //! \return Number of elements stored.
     inline typename Container::size_type size() const noexcept;
 
+    //! \brief Return the biggest size reached by the queue.
+    //!
+    //! \return Number of elements stored, at most.
+    inline typename Container::size_type high_water_mark() const noexcept;
+
     //! \brief Push elements to the back of the queue.
     //!
     //! \param[in] value The value to push.
@@ -98,6 +106,7 @@ private:
     mutable std::mutex m_mutex;
     typedef Container QType;
     QType m_queue;
+    typename Container::size_type m_high_water_mark;
 };
 
 } // namespace SedNL
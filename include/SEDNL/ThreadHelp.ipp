@@ -68,6 +68,31 @@ bool SafeQueue<T, C>::empty() const noexcept
     return false;
 }
 
+template<class T, class C>
+SafeQueue<T, C>::SafeQueue()
+    :m_high_water_mark(0)
+{}
+
+template<class T, class C>
+typename C::size_type SafeQueue<T, C>::high_water_mark() const noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_high_water_mark;
+    }
+    catch(std::exception &e)
+    {
+#ifndef SEDNL_NOWARN
+            std::cerr << "Error: std::mutex::lock failed."
+                      << std::endl;
+            std::cerr << e.what() << std::endl;
+#endif /* !SEDNL_NOWARN */
+
+    }
+    return 0;
+}
+
 template<class T, class C>
 typename C::size_type SafeQueue<T, C>::size() const noexcept
 {
@@ -120,6 +145,8 @@ bool SafeQueue<T, C>::push(const T& value) noexcept
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         m_queue.push_back(value);
+        if (m_queue.size() > m_high_water_mark)
+            m_high_water_mark = m_queue.size();
         return true;
     }
     catch(std::bad_alloc &e)
@@ -31,8 +31,13 @@
 #include "SEDNL/TCPServer.hpp"
 #include "SEDNL/EventListener.hpp"
 #include "SEDNL/EventConsumer.hpp"
+#include "SEDNL/Metrics.hpp"
+#include "SEDNL/Latency.hpp"
+#include "SEDNL/Diagnostics.hpp"
+#include "SEDNL/Capture.hpp"
 #include "SEDNL/Packet.hpp"
 #include "SEDNL/Serializer.hpp"
+#include "SEDNL/StateSync.hpp"
 #include "SEDNL/ThreadHelp.hpp"
 #include "SEDNL/SocketAddress.hpp"
 
@@ -35,6 +35,10 @@ class EventConsumer;
 class Packet;
 class PacketReader;
 class RingBuf;
+class StateSync;
+class CaptureWriter;
+class CaptureReader;
+class CaptureReplayer;
 class Event;
 class SocketAddress;
 class SocketInterface;
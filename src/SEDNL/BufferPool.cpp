@@ -0,0 +1,320 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#include "SEDNL/BufferPool.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <new>
+#include <cstdlib>
+
+namespace SedNL
+{
+
+static constexpr
+unsigned int nb_classes(std::size_t size)
+{
+    return size > BUFFER_POOL_MAX_SIZE ? 0 : 1 + nb_classes(2 * size);
+}
+
+#define POOL_CLASSES nb_classes(BUFFER_POOL_MIN_SIZE)
+
+//Class of the buffers of \a size bytes, -1 if too big.
+static inline
+int size_class(std::size_t size) noexcept
+{
+    if (size > BUFFER_POOL_MAX_SIZE)
+        return -1;
+    if (size <= BUFFER_POOL_MIN_SIZE)
+        return 0;
+    //Number of bits of size - 1, minus the ones of the smallest class
+    return (8 * sizeof(unsigned long) - __builtin_clzl(size - 1))
+        - (8 * sizeof(unsigned long) - __builtin_clzl(BUFFER_POOL_MIN_SIZE - 1));
+}
+
+static inline
+std::size_t class_size(int c) noexcept
+{
+    return static_cast<std::size_t>(BUFFER_POOL_MIN_SIZE) << c;
+}
+
+//Free buffers of class \a c kept by a thread.
+static inline
+unsigned int class_depth(int c) noexcept
+{
+    const std::size_t depth = BUFFER_POOL_CLASS_BYTES / class_size(c);
+    if (depth < 2)
+        return 2;
+    return depth < BUFFER_POOL_DEPTH ? depth : BUFFER_POOL_DEPTH;
+}
+
+//Buffers of class \a c moved at once between a thread and the depot.
+static inline
+unsigned int class_batch(int c) noexcept
+{
+    return class_depth(c) / 2;
+}
+
+static std::atomic<UInt64> heap_allocations(0);
+static std::atomic<UInt64> heap_releases(0);
+
+static
+bool pool_enabled() noexcept
+{
+    //Thread safe initialisation (C++11)
+    static const bool enabled = getenv("SEDNL_NO_POOL") == nullptr;
+    return enabled;
+}
+
+static inline
+void heap_release(void* buffer) noexcept
+{
+    heap_releases++;
+    ::operator delete(buffer);
+}
+
+//Free buffers shared by all threads.
+struct Depot
+{
+    Depot() : bytes(0), capacity(BUFFER_POOL_DEPOT_SIZE) {}
+
+    //Release the biggest buffers until there are at most
+    // \a size bytes of them. Called with the mutex locked.
+    void trim(std::size_t size) noexcept;
+
+    std::mutex mutex;
+    std::vector<void*> buffers[POOL_CLASSES];
+    //Written with the mutex locked, read by get_buffer_pool_stats().
+    std::atomic<std::size_t> bytes;
+    std::size_t capacity;
+};
+
+void Depot::trim(std::size_t size) noexcept
+{
+    for (int c = POOL_CLASSES - 1; c >= 0 && bytes > size; c--)
+    {
+        std::vector<void*>& free = buffers[c];
+        while (!free.empty() && bytes > size)
+        {
+            heap_release(free.back());
+            free.pop_back();
+            bytes -= class_size(c);
+        }
+        if (free.empty())
+            std::vector<void*>().swap(free);
+    }
+}
+
+static
+Depot& depot()
+{
+    //Never destroyed : threads can give back buffers while exiting.
+    static Depot* const d = new Depot;
+    return *d;
+}
+
+//Free buffers of a thread, used without any lock.
+//
+//It's trivial, so that thread_local accesses don't check
+// its initialisation : ThreadPoolGuard flush it at the thread exit.
+struct ThreadPool
+{
+    //Take a batch of buffers of class \a c from the depot.
+    void refill(int c) noexcept;
+
+    //Give \a count buffers of class \a c to the depot,
+    // or to the heap if it's full.
+    void flush(int c, unsigned int count) noexcept;
+
+    //Tell if the pool can be used, and register the guard.
+    bool start() noexcept;
+
+    //Only the class_depth() first buffers of a class are used.
+    void* buffers[POOL_CLASSES][BUFFER_POOL_DEPTH];
+    unsigned int count[POOL_CLASSES];
+    UInt64 reused;
+    UInt64 recycled;
+    //True once the guard is registered, false after its destruction.
+    bool started;
+    bool destroyed;
+};
+
+struct ThreadPoolGuard
+{
+    ~ThreadPoolGuard();
+};
+
+static thread_local ThreadPool tl_pool;
+static thread_local ThreadPoolGuard tl_guard;
+
+ThreadPoolGuard::~ThreadPoolGuard()
+{
+    tl_pool.started = false;
+    tl_pool.destroyed = true;
+    for (unsigned int c = 0; c < POOL_CLASSES; c++)
+        tl_pool.flush(c, tl_pool.count[c]);
+}
+
+bool ThreadPool::start() noexcept
+{
+    if (destroyed || !pool_enabled())
+        return false;
+    //Register its destructor
+    (void)&tl_guard;
+    started = true;
+    return true;
+}
+
+void ThreadPool::refill(int c) noexcept
+{
+    try
+    {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        std::vector<void*>& free = d.buffers[c];
+        while (!free.empty() && count[c] < class_batch(c))
+        {
+            buffers[c][count[c]++] = free.back();
+            free.pop_back();
+            d.bytes -= class_size(c);
+        }
+    }
+    catch(std::exception&)
+    {}
+}
+
+void ThreadPool::flush(int c, unsigned int nb) noexcept
+{
+    try
+    {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        std::vector<void*>& free = d.buffers[c];
+        for (; nb && d.bytes + class_size(c) <= d.capacity; nb--)
+        {
+            free.push_back(buffers[c][count[c] - 1]);
+            count[c]--;
+            d.bytes += class_size(c);
+        }
+    }
+    catch(std::exception&)
+    {}
+
+    for (; nb; nb--)
+        heap_release(buffers[c][--count[c]]);
+}
+
+void* __pool_allocate(std::size_t size)
+{
+    const int c = size_class(size);
+    if (c < 0)
+    {
+        heap_allocations++;
+        return ::operator new(size);
+    }
+
+    ThreadPool& pool = tl_pool;
+    if (pool.count[c])
+    {
+        pool.reused++;
+        return pool.buffers[c][--pool.count[c]];
+    }
+    if (pool.started || pool.start())
+    {
+        pool.refill(c);
+        if (pool.count[c])
+        {
+            pool.reused++;
+            return pool.buffers[c][--pool.count[c]];
+        }
+    }
+
+    //Always the size of the class : it may be recycled.
+    heap_allocations++;
+    return ::operator new(class_size(c));
+}
+
+void __pool_deallocate(void* buffer, std::size_t size) noexcept
+{
+    if (!buffer)
+        return;
+
+    const int c = size_class(size);
+    ThreadPool& pool = tl_pool;
+    if (c < 0 || !(pool.started || pool.start()))
+    {
+        heap_release(buffer);
+        return;
+    }
+
+    if (pool.count[c] >= class_depth(c))
+        pool.flush(c, class_batch(c));
+    pool.buffers[c][pool.count[c]++] = buffer;
+    pool.recycled++;
+}
+
+BufferPoolStats get_buffer_pool_stats() noexcept
+{
+    BufferPoolStats stats;
+    stats.heap_allocations = heap_allocations;
+    stats.heap_releases = heap_releases;
+    stats.reused = tl_pool.reused;
+    stats.recycled = tl_pool.recycled;
+    stats.depot_bytes = depot().bytes;
+    return stats;
+}
+
+void release_buffer_pool() noexcept
+{
+    ThreadPool& pool = tl_pool;
+    for (unsigned int c = 0; c < POOL_CLASSES; c++)
+        while (pool.count[c])
+            heap_release(pool.buffers[c][--pool.count[c]]);
+}
+
+void trim_buffer_pool() noexcept
+{
+    release_buffer_pool();
+    try
+    {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.trim(0);
+    }
+    catch(std::exception&)
+    {}
+}
+
+void set_buffer_pool_depot_size(std::size_t size) noexcept
+{
+    try
+    {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.capacity = size;
+        d.trim(size);
+    }
+    catch(std::exception&)
+    {}
+}
+
+} // namespace SedNL
@@ -0,0 +1,298 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Bulk conversion of arrays between host and network byte order.
+
+#include "SEDNL/ByteSwap.hpp"
+#include "SEDNL/SocketHelp.hpp"
+
+#include <cstring>
+#include <cstdlib>
+
+#if (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+# define SEDNL_SIMD_X86
+# include <immintrin.h>
+#endif
+
+namespace SedNL
+{
+
+typedef void (*SwapKernel)(Byte* dst, const Byte* src, std::size_t count);
+
+////////////
+// Scalar //
+////////////
+
+//The shifts are recognized by compilers as a single bswap.
+
+static
+void swap_16_scalar(Byte* dst, const Byte* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++, src += 2, dst += 2)
+    {
+        UInt16 v;
+        memcpy(&v, src, sizeof(v));
+        v = static_cast<UInt16>((v >> 8) | (v << 8));
+        memcpy(dst, &v, sizeof(v));
+    }
+}
+
+static
+void swap_32_scalar(Byte* dst, const Byte* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++, src += 4, dst += 4)
+    {
+        UInt32 v;
+        memcpy(&v, src, sizeof(v));
+        v = (v >> 24) | ((v >> 8) & 0x0000FF00u)
+            | ((v << 8) & 0x00FF0000u) | (v << 24);
+        memcpy(dst, &v, sizeof(v));
+    }
+}
+
+static
+void swap_64_scalar(Byte* dst, const Byte* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++, src += 8, dst += 8)
+    {
+        UInt64 v;
+        memcpy(&v, src, sizeof(v));
+        v = ((v >> 56) & 0x00000000000000FFull)
+            | ((v >> 40) & 0x000000000000FF00ull)
+            | ((v >> 24) & 0x0000000000FF0000ull)
+            | ((v >> 8)  & 0x00000000FF000000ull)
+            | ((v << 8)  & 0x000000FF00000000ull)
+            | ((v << 24) & 0x0000FF0000000000ull)
+            | ((v << 40) & 0x00FF000000000000ull)
+            | ((v << 56) & 0xFF00000000000000ull);
+        memcpy(dst, &v, sizeof(v));
+    }
+}
+
+#ifdef SEDNL_SIMD_X86
+
+///////////
+// SSSE3 //
+///////////
+
+//Shuffle masks reversing each element of 2, 4 or 8 bytes.
+#define SEDNL_SHUFFLE_16 14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1
+#define SEDNL_SHUFFLE_32 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3
+#define SEDNL_SHUFFLE_64 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7
+
+//_mm_set_epi8 take the bytes from the last one to the first one.
+template<int N>
+struct ShuffleMask;
+
+template<>
+struct ShuffleMask<2>
+{
+    __attribute__((target("ssse3")))
+    static inline __m128i sse() { return _mm_set_epi8(SEDNL_SHUFFLE_16); }
+    __attribute__((target("avx2")))
+    static inline __m256i avx()
+    { return _mm256_set_epi8(SEDNL_SHUFFLE_16, SEDNL_SHUFFLE_16); }
+};
+
+template<>
+struct ShuffleMask<4>
+{
+    __attribute__((target("ssse3")))
+    static inline __m128i sse() { return _mm_set_epi8(SEDNL_SHUFFLE_32); }
+    __attribute__((target("avx2")))
+    static inline __m256i avx()
+    { return _mm256_set_epi8(SEDNL_SHUFFLE_32, SEDNL_SHUFFLE_32); }
+};
+
+template<>
+struct ShuffleMask<8>
+{
+    __attribute__((target("ssse3")))
+    static inline __m128i sse() { return _mm_set_epi8(SEDNL_SHUFFLE_64); }
+    __attribute__((target("avx2")))
+    static inline __m256i avx()
+    { return _mm256_set_epi8(SEDNL_SHUFFLE_64, SEDNL_SHUFFLE_64); }
+};
+
+template<int N>
+__attribute__((target("ssse3")))
+static
+std::size_t swap_sse(Byte* dst, const Byte* src, std::size_t count)
+{
+    const __m128i mask = ShuffleMask<N>::sse();
+    const std::size_t bytes = count * N;
+    std::size_t i = 0;
+
+    for (; i + 16 <= bytes; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_shuffle_epi8(v, mask));
+    }
+    //Number of elements converted
+    return i / N;
+}
+
+template<int N>
+__attribute__((target("avx2")))
+static
+std::size_t swap_avx2(Byte* dst, const Byte* src, std::size_t count)
+{
+    const __m256i mask = ShuffleMask<N>::avx();
+    const std::size_t bytes = count * N;
+    std::size_t i = 0;
+
+    for (; i + 32 <= bytes; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_shuffle_epi8(v, mask));
+    }
+    return i / N;
+}
+
+#undef SEDNL_SHUFFLE_16
+#undef SEDNL_SHUFFLE_32
+#undef SEDNL_SHUFFLE_64
+
+//Vector loop, then the scalar one for the remaining elements.
+#define SEDNL_SIMD_KERNEL(name, vector, scalar, n)                      \
+    static                                                              \
+    void name(Byte* dst, const Byte* src, std::size_t count)            \
+    {                                                                   \
+        const std::size_t done = vector<n>(dst, src, count);            \
+        scalar(dst + done * n, src + done * n, count - done);           \
+    }
+
+SEDNL_SIMD_KERNEL(swap_16_sse, swap_sse, swap_16_scalar, 2)
+SEDNL_SIMD_KERNEL(swap_32_sse, swap_sse, swap_32_scalar, 4)
+SEDNL_SIMD_KERNEL(swap_64_sse, swap_sse, swap_64_scalar, 8)
+SEDNL_SIMD_KERNEL(swap_16_avx2, swap_avx2, swap_16_scalar, 2)
+SEDNL_SIMD_KERNEL(swap_32_avx2, swap_avx2, swap_32_scalar, 4)
+SEDNL_SIMD_KERNEL(swap_64_avx2, swap_avx2, swap_64_scalar, 8)
+
+#undef SEDNL_SIMD_KERNEL
+
+#endif /* SEDNL_SIMD_X86 */
+
+//////////////
+// Dispatch //
+//////////////
+
+struct SwapKernels
+{
+    SwapKernel swap_16;
+    SwapKernel swap_32;
+    SwapKernel swap_64;
+    const char* name;
+};
+
+static
+SwapKernels select_kernels() noexcept
+{
+    SwapKernels k = {swap_16_scalar, swap_32_scalar, swap_64_scalar, "scalar"};
+
+    if (getenv("SEDNL_NO_SIMD"))
+        return k;
+
+#ifdef SEDNL_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        k = {swap_16_avx2, swap_32_avx2, swap_64_avx2, "avx2"};
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        k = {swap_16_sse, swap_32_sse, swap_64_sse, "ssse3"};
+    }
+#endif /* SEDNL_SIMD_X86 */
+
+    return k;
+}
+
+static
+const SwapKernels& kernels() noexcept
+{
+    //Thread safe initialisation (C++11)
+    static const SwapKernels k = select_kernels();
+    return k;
+}
+
+static inline
+void swap_copy(Byte* dst, const Byte* src,
+               std::size_t count, std::size_t size, bool swap) noexcept
+{
+    if (count == 0)
+        return;
+
+    if (size == 1 || !swap)
+    {
+        memcpy(dst, src, count * size);
+        return;
+    }
+
+    switch (size)
+    {
+    case 2:
+        kernels().swap_16(dst, src, count);
+        break;
+    case 4:
+        kernels().swap_32(dst, src, count);
+        break;
+    case 8:
+        kernels().swap_64(dst, src, count);
+        break;
+    default:
+        break;
+    }
+}
+
+//The network order is big endian.
+
+void __array_to_network(Byte* dst, const void* src,
+                        std::size_t count, std::size_t size) noexcept
+{
+    swap_copy(dst, static_cast<const Byte*>(src), count, size,
+              !__is_big_endian());
+}
+
+void __array_from_network(void* dst, const Byte* src,
+                          std::size_t count, std::size_t size) noexcept
+{
+    swap_copy(static_cast<Byte*>(dst), src, count, size,
+              !__is_big_endian());
+}
+
+void __array_swap(void* dst, const Byte* src,
+                  std::size_t count, std::size_t size) noexcept
+{
+    swap_copy(static_cast<Byte*>(dst), src, count, size, true);
+}
+
+const char* __array_kernel_name() noexcept
+{
+    if (__is_big_endian())
+        return "none";
+    return kernels().name;
+}
+
+} // namespace SedNL
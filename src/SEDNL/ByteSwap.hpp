@@ -0,0 +1,67 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef BYTE_SWAP_HPP_
+#define BYTE_SWAP_HPP_
+
+#include "SEDNL/Types.hpp"
+
+#include <cstddef>
+
+namespace SedNL
+{
+
+//! \brief Copy \a count elements of \a size bytes (1, 2, 4 or 8)
+//!        from \a src to \a dst, converting them from the host
+//!        byte order to the network byte order.
+//!
+//! Large arrays are converted with SSSE3 or AVX2 byte shuffles when
+//! the CPU supports them (checked once, at the first call), and with
+//! a scalar loop otherwise. Setting the SEDNL_NO_SIMD environment
+//! variable forces the scalar loop.
+//!
+//! \a dst and \a src shouldn't overlap, and don't need any alignment.
+void __array_to_network(Byte* dst, const void* src,
+                        std::size_t count, std::size_t size) noexcept;
+
+//! \brief Copy \a count elements of \a size bytes (1, 2, 4 or 8)
+//!        from \a src to \a dst, converting them from the network
+//!        byte order to the host byte order.
+//!
+//! See __array_to_network().
+void __array_from_network(void* dst, const Byte* src,
+                          std::size_t count, std::size_t size) noexcept;
+
+//! \brief Copy \a count elements of \a size bytes (1, 2, 4 or 8)
+//!        from \a src to \a dst, reversing the bytes of each one
+//!        whatever the host byte order is.
+//!
+//! See __array_to_network().
+void __array_swap(void* dst, const Byte* src,
+                  std::size_t count, std::size_t size) noexcept;
+
+//! \brief Name of the kernels used by __array_to_network()
+//!        ("avx2", "ssse3", "scalar" or "none" on big endian hosts).
+const char* __array_kernel_name() noexcept;
+
+} // namespace SedNL
+
+#endif /* !BYTE_SWAP_HPP_ */
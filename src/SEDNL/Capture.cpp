@@ -0,0 +1,337 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#include "SEDNL/Capture.hpp"
+#include "SEDNL/Connection.hpp"
+#include "SEDNL/EventListener.hpp"
+#include "SEDNL/TCPClient.hpp"
+#include "SEDNL/SocketAddress.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+
+#ifndef SEDNL_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* !SEDNL_WINDOWS */
+
+namespace SedNL
+{
+
+namespace
+{
+
+const char CAPTURE_MAGIC[8] = {'S', 'E', 'D', 'N', 'L', 'C', 'A', 'P'};
+const UInt32 CAPTURE_VERSION = 1;
+const UInt64 HEADER_SIZE = 16;
+
+struct RecordHeader
+{
+    UInt64 timestamp;
+    UInt32 connection;
+    UInt32 length;
+};
+
+static_assert(sizeof(RecordHeader) == 16, "Unexpected record header size");
+
+//Records start on 8 bytes boundaries.
+inline UInt64 padded(UInt64 length)
+{
+    return (length + 7) & ~static_cast<UInt64>(7);
+}
+
+//Wait until the time of a record, relative to the first one,
+// divided by the speed.
+class Pacer
+{
+public:
+    Pacer(double speed)
+        :m_speed(speed), m_first(0), m_started(false)
+    {}
+
+    void wait(UInt64 timestamp)
+    {
+        if (m_speed <= 0)
+            return;
+        if (!m_started)
+        {
+            m_first = timestamp;
+            m_start = std::chrono::steady_clock::now();
+            m_started = true;
+            return;
+        }
+        const double elapsed = (timestamp - std::min(timestamp, m_first)) / m_speed;
+        std::this_thread::sleep_until(
+            m_start + std::chrono::nanoseconds(static_cast<UInt64>(elapsed)));
+    }
+
+private:
+    double m_speed;
+    UInt64 m_first;
+    bool m_started;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace
+
+#ifndef SEDNL_WINDOWS
+
+CaptureWriter::CaptureWriter(const std::string& path, UInt64 chunk_size)
+    throw(EventException)
+    :m_fd(-1), m_map(nullptr), m_mapped(0), m_used(0),
+     m_chunk_size(std::max<UInt64>(chunk_size, 4096))
+{
+    m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+        throw EventException(EventExceptionT::CaptureFailed, strerror(errno));
+    if (!grow(HEADER_SIZE))
+    {
+        close(m_fd);
+        throw EventException(EventExceptionT::CaptureFailed, strerror(errno));
+    }
+
+    std::memcpy(m_map, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    std::memcpy(m_map + sizeof(CAPTURE_MAGIC), &CAPTURE_VERSION,
+                sizeof(CAPTURE_VERSION));
+    m_used = HEADER_SIZE;
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    if (m_map)
+        munmap(m_map, m_mapped);
+    //Remove the zeros of the last chunk
+    if (ftruncate(m_fd, m_used) != 0)
+        m_used = 0;
+    close(m_fd);
+}
+
+bool CaptureWriter::grow(UInt64 size) noexcept
+{
+    const UInt64 mapped = (size + m_chunk_size - 1) / m_chunk_size * m_chunk_size;
+
+    //Allocate the new part of the file, filled with zeros, so a full
+    // disk is an error here rather than a SIGBUS when writing to the map
+    const int error = posix_fallocate(m_fd, m_mapped, mapped - m_mapped);
+    if (error != 0)
+    {
+        errno = error;
+        return false;
+    }
+
+    //The current map stays valid if the new one fails
+    void* map = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED)
+        return false;
+
+    if (m_map)
+        munmap(m_map, m_mapped);
+    m_map = static_cast<char*>(map);
+    m_mapped = mapped;
+    return true;
+}
+
+bool CaptureWriter::append(UInt32 connection, UInt64 timestamp,
+                           const char* data, UInt32 length) noexcept
+{
+    const UInt64 end = m_used + sizeof(RecordHeader) + padded(length);
+    if (end > m_mapped && !grow(end))
+        return false;
+
+    //A null timestamp is the end of the capture
+    RecordHeader header;
+    header.timestamp = timestamp ? timestamp : 1;
+    header.connection = connection;
+    header.length = length;
+    std::memcpy(m_map + m_used, &header, sizeof(header));
+    if (length)
+        std::memcpy(m_map + m_used + sizeof(header), data, length);
+    m_used = end;
+    return true;
+}
+
+CaptureReader::CaptureReader(const std::string& path) throw(EventException)
+    :m_fd(-1), m_map(nullptr), m_size(0), m_position(HEADER_SIZE)
+{
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+        throw EventException(EventExceptionT::CaptureFailed, strerror(errno));
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || static_cast<UInt64>(st.st_size) < HEADER_SIZE)
+    {
+        close(m_fd);
+        throw EventException(EventExceptionT::InvalidCapture);
+    }
+    m_size = st.st_size;
+
+    void* map = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(m_fd);
+        throw EventException(EventExceptionT::CaptureFailed, strerror(errno));
+    }
+    m_map = static_cast<const char*>(map);
+
+    UInt32 version;
+    std::memcpy(&version, m_map + sizeof(CAPTURE_MAGIC), sizeof(version));
+    if (std::memcmp(m_map, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0
+        || version != CAPTURE_VERSION)
+    {
+        munmap(const_cast<char*>(m_map), m_size);
+        close(m_fd);
+        throw EventException(EventExceptionT::InvalidCapture);
+    }
+}
+
+CaptureReader::~CaptureReader()
+{
+    munmap(const_cast<char*>(m_map), m_size);
+    close(m_fd);
+}
+
+#else /* !SEDNL_WINDOWS */
+
+CaptureWriter::CaptureWriter(const std::string&, UInt64)
+    throw(EventException)
+    :m_fd(-1), m_map(nullptr), m_mapped(0), m_used(0), m_chunk_size(0)
+{
+    throw EventException(EventExceptionT::CaptureFailed,
+                         "Captures aren't supported on Windows.");
+}
+
+CaptureWriter::~CaptureWriter()
+{}
+
+bool CaptureWriter::grow(UInt64) noexcept
+{
+    return false;
+}
+
+bool CaptureWriter::append(UInt32, UInt64, const char*, UInt32) noexcept
+{
+    return false;
+}
+
+CaptureReader::CaptureReader(const std::string&) throw(EventException)
+    :m_fd(-1), m_map(nullptr), m_size(0), m_position(HEADER_SIZE)
+{
+    throw EventException(EventExceptionT::CaptureFailed,
+                         "Captures aren't supported on Windows.");
+}
+
+CaptureReader::~CaptureReader()
+{}
+
+#endif /* !SEDNL_WINDOWS */
+
+bool CaptureReader::next(CaptureRecord& record) noexcept
+{
+    if (m_position + sizeof(RecordHeader) > m_size)
+        return false;
+
+    RecordHeader header;
+    std::memcpy(&header, m_map + m_position, sizeof(header));
+    //End of a capture whose writer didn't stop, or truncated record
+    if (header.timestamp == 0
+        || m_position + sizeof(header) + header.length > m_size)
+        return false;
+
+    record.timestamp = header.timestamp;
+    record.connection = header.connection;
+    record.length = header.length;
+    record.data = m_map + m_position + sizeof(header);
+    m_position += sizeof(header) + padded(header.length);
+    return true;
+}
+
+void CaptureReader::rewind() noexcept
+{
+    m_position = HEADER_SIZE;
+}
+
+CaptureReplayer::CaptureReplayer(const std::string& path) throw(EventException)
+    :m_reader(path)
+{}
+
+UInt64 CaptureReplayer::replay(EventListener& listener, double speed)
+{
+    std::map<UInt32, std::shared_ptr<Connection>> connections;
+    Pacer pacer(speed);
+    CaptureRecord record;
+    UInt64 count = 0;
+
+    m_reader.rewind();
+    while (m_reader.next(record))
+    {
+        pacer.wait(record.timestamp);
+        count++;
+
+        if (record.length == 0)
+        {
+            connections.erase(record.connection);
+            continue;
+        }
+
+        std::shared_ptr<Connection>& cn = connections[record.connection];
+        if (!cn)
+            cn = std::make_shared<Connection>();
+        listener.inject(cn, record.data, record.length);
+    }
+    return count;
+}
+
+UInt64 CaptureReplayer::replay(const SocketAddress& address, double speed)
+    throw(NetworkException, std::exception)
+{
+    std::map<UInt32, std::unique_ptr<TCPClient>> clients;
+    Pacer pacer(speed);
+    CaptureRecord record;
+    UInt64 count = 0;
+
+    m_reader.rewind();
+    while (m_reader.next(record))
+    {
+        pacer.wait(record.timestamp);
+        count++;
+
+        if (record.length == 0)
+        {
+            clients.erase(record.connection);
+            continue;
+        }
+
+        std::unique_ptr<TCPClient>& client = clients[record.connection];
+        if (!client)
+            client.reset(new TCPClient(address));
+        client->send_raw(record.data, record.length);
+    }
+    return count;
+}
+
+} // namespace SedNL
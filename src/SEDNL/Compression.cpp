@@ -0,0 +1,290 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#include "SEDNL/Compression.hpp"
+#include "SEDNL/Packet.hpp"
+#include "SEDNL/SocketHelp.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef SEDNL_ZLIB
+# include <zlib.h>
+#endif /* SEDNL_ZLIB */
+
+namespace SedNL
+{
+
+//Shortest match worth an offset
+#define LZ_MIN_MATCH  4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS  12
+
+static inline
+UInt32 read_32(const Byte* src) noexcept
+{
+    UInt32 v;
+    memcpy(&v, src, sizeof(v));
+    return v;
+}
+
+static inline
+UInt32 lz_hash(UInt32 v) noexcept
+{
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+//Lengths that don't fit in the 4 bits of the token continue
+// with bytes of 255, and end with a byte < 255.
+static inline
+Byte* write_length(Byte* dst, std::size_t length) noexcept
+{
+    for (; length >= 255; length -= 255)
+        *dst++ = 255;
+    *dst++ = static_cast<Byte>(length);
+    return dst;
+}
+
+static inline
+bool read_length(const Byte* src, std::size_t length,
+                 std::size_t& i, std::size_t& value) noexcept
+{
+    Byte b;
+    do
+    {
+        if (i >= length)
+            return false;
+        b = src[i++];
+        value += b;
+    } while (b == 255);
+    return true;
+}
+
+//Write the literals [src, src + literals[, followed by a match
+// of \a match bytes at \a offset if \a match isn't 0.
+static inline
+Byte* write_sequence(Byte* dst, const Byte* src, std::size_t literals,
+                     std::size_t offset, std::size_t match) noexcept
+{
+    Byte* const token = dst++;
+    *token = static_cast<Byte>(std::min<std::size_t>(literals, 15) << 4);
+    if (literals >= 15)
+        dst = write_length(dst, literals - 15);
+    memcpy(dst, src, literals);
+    dst += literals;
+
+    if (match == 0)
+        return dst;
+
+    *dst++ = static_cast<Byte>(offset);
+    *dst++ = static_cast<Byte>(offset >> 8);
+    match -= LZ_MIN_MATCH;
+    *token |= static_cast<Byte>(std::min<std::size_t>(match, 15));
+    if (match >= 15)
+        dst = write_length(dst, match - 15);
+    return dst;
+}
+
+std::size_t __lz_max_length(std::size_t length) noexcept
+{
+    return length + length / 255 + 16;
+}
+
+std::size_t __lz_compress(Byte* dst, const Byte* src,
+                          std::size_t length) noexcept
+{
+    Byte* const start = dst;
+
+    //Last position (+ 1) of each hash of 4 bytes, 0 if none
+    UInt32 table[1 << LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    std::size_t anchor = 0;
+    std::size_t i = 0;
+    while (i + LZ_MIN_MATCH <= length)
+    {
+        const UInt32 sequence = read_32(src + i);
+        const UInt32 hash = lz_hash(sequence);
+        const std::size_t candidate = table[hash];
+        table[hash] = static_cast<UInt32>(i + 1);
+
+        if (candidate == 0 || i + 1 - candidate > LZ_MAX_OFFSET
+            || read_32(src + candidate - 1) != sequence)
+        {
+            i++;
+            continue;
+        }
+
+        const std::size_t ref = candidate - 1;
+        std::size_t match = LZ_MIN_MATCH;
+        while (i + match < length && src[ref + match] == src[i + match])
+            match++;
+
+        dst = write_sequence(dst, src + anchor, i - anchor, i - ref, match);
+        i += match;
+        anchor = i;
+    }
+
+    dst = write_sequence(dst, src + anchor, length - anchor, 0, 0);
+    return dst - start;
+}
+
+bool __lz_decompress(Byte* dst, std::size_t size,
+                     const Byte* src, std::size_t length) noexcept
+{
+    std::size_t i = 0;
+    std::size_t o = 0;
+
+    while (true)
+    {
+        if (i >= length)
+            return false;
+        const Byte token = src[i++];
+
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !read_length(src, length, i, literals))
+            return false;
+        if (literals > length - i || literals > size - o)
+            return false;
+        memcpy(dst + o, src + i, literals);
+        i += literals;
+        o += literals;
+
+        //Only the last sequence ends after its literals
+        if (i == length)
+            return o == size;
+
+        if (length - i < 2)
+            return false;
+        const std::size_t offset = src[i] | (src[i + 1] << 8);
+        i += 2;
+        if (offset == 0 || offset > o)
+            return false;
+
+        std::size_t match = token & 0x0F;
+        if (match == 15 && !read_length(src, length, i, match))
+            return false;
+        match += LZ_MIN_MATCH;
+        if (match > size - o)
+            return false;
+
+        //The match can overlap what it writes (runs)
+        Byte* const out = dst + o;
+        const Byte* const ref = out - offset;
+        if (offset >= match)
+            memcpy(out, ref, match);
+        else
+            for (std::size_t j = 0; j < match; j++)
+                out[j] = ref[j];
+        o += match;
+    }
+}
+
+bool __has_zlib() noexcept
+{
+#ifdef SEDNL_ZLIB
+    return true;
+#else /* SEDNL_ZLIB */
+    return false;
+#endif /* SEDNL_ZLIB */
+}
+
+bool __compress_packet(UInt8 codec, const ByteArray& data, ByteArray& out)
+{
+    if (data.size() > COMPRESSION_MAX_SIZE)
+        return false;
+
+    out.clear();
+    out.push_back(static_cast<Byte>(Packet::Type::Compressed));
+    out.push_back(codec);
+    __push_varint(out, data.size());
+    const std::size_t header = out.size();
+
+    switch (codec)
+    {
+    case CODEC_LZ:
+    {
+        out.resize(header + __lz_max_length(data.size()));
+        const std::size_t length = __lz_compress(&out[header], data.data(),
+                                                 data.size());
+        out.resize(header + length);
+        break;
+    }
+#ifdef SEDNL_ZLIB
+    case CODEC_ZLIB:
+    {
+        uLongf length = compressBound(data.size());
+        out.resize(header + length);
+        if (compress2(&out[header], &length, data.data(), data.size(),
+                      COMPRESSION_ZLIB_LEVEL) != Z_OK)
+            return false;
+        out.resize(header + length);
+        break;
+    }
+#endif /* SEDNL_ZLIB */
+    default:
+        return false;
+    }
+
+    return out.size() < data.size();
+}
+
+bool __decompress_packet(const ByteArray& data, ByteArray& out)
+{
+    if (data.size() < 2
+        || data[0] != static_cast<Byte>(Packet::Type::Compressed))
+        return false;
+
+    UInt64 size;
+    const unsigned int varint = __front_varint(2, data, size);
+    if (varint == 0 || size > COMPRESSION_MAX_SIZE)
+        return false;
+
+    const std::size_t header = 2 + varint;
+    const Byte* const src = data.data() + header;
+    const std::size_t length = data.size() - header;
+    ByteArray raw(size);
+
+    switch (data[1])
+    {
+    case CODEC_LZ:
+        if (!__lz_decompress(raw.data(), size, src, length))
+            return false;
+        break;
+#ifdef SEDNL_ZLIB
+    case CODEC_ZLIB:
+    {
+        uLongf written = size;
+        if (uncompress(raw.data(), &written, src, length) != Z_OK
+            || written != size)
+            return false;
+        break;
+    }
+#endif /* SEDNL_ZLIB */
+    default:
+        return false;
+    }
+
+    out.swap(raw);
+    return true;
+}
+
+} // namespace SedNL
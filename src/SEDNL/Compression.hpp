@@ -0,0 +1,88 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef COMPRESSION_HPP_
+#define COMPRESSION_HPP_
+
+#include "SEDNL/Packet.hpp"
+
+#include <cstddef>
+
+#ifndef COMPRESSION_MAX_SIZE
+# define COMPRESSION_MAX_SIZE 1048576
+#endif /* !COMPRESSION_MAX_SIZE */
+
+#ifndef COMPRESSION_ZLIB_LEVEL
+# define COMPRESSION_ZLIB_LEVEL 1
+#endif /* !COMPRESSION_ZLIB_LEVEL */
+
+//Codec byte of compressed packets (see Compression).
+#define CODEC_LZ   1
+#define CODEC_ZLIB 2
+
+namespace SedNL
+{
+
+//! \brief Maximal length of the LZ compression of \a length bytes.
+std::size_t __lz_max_length(std::size_t length) noexcept;
+
+//! \brief Compress the \a length bytes of \a src into \a dst.
+//!
+//! It's a LZ77 byte oriented codec (the LZ4 block format):
+//! a list of sequences {token, literals, offset, match length},
+//! where the token holds the literal length and the match
+//! length in 4 bits each. The last sequence only has literals.
+//!
+//! \a dst must hold at least __lz_max_length(length) bytes.
+//!
+//! \return The number of bytes written.
+std::size_t __lz_compress(Byte* dst, const Byte* src,
+                          std::size_t length) noexcept;
+
+//! \brief Decompress the \a length bytes of \a src, that should
+//!        produce exactly \a size bytes, into \a dst.
+//!
+//! \return False if \a src is corrupted.
+bool __lz_decompress(Byte* dst, std::size_t size,
+                     const Byte* src, std::size_t length) noexcept;
+
+//! \brief Tell if the library was compiled with zlib.
+bool __has_zlib() noexcept;
+
+//! \brief Write into \a out the packet \a data compressed with \a codec,
+//!        as a Packet::Type::Compressed item:
+//!        {Type::Compressed, codec : UInt8, size : varint, bytes}.
+//!
+//! \return False if the codec isn't available or if the packet
+//!         doesn't shrink. \a out is then unspecified.
+bool __compress_packet(UInt8 codec, const ByteArray& data, ByteArray& out);
+
+//! \brief Write into \a out the packet compressed in \a data.
+//!
+//! Packets bigger than COMPRESSION_MAX_SIZE are refused.
+//!
+//! \return False if \a data is corrupted, or was compressed
+//!         with a codec that isn't available.
+bool __decompress_packet(const ByteArray& data, ByteArray& out);
+
+} // namespace SedNL
+
+#endif /* !COMPRESSION_HPP_ */
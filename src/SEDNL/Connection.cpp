@@ -24,13 +24,26 @@
 #include "SEDNL/Event.hpp"
 #include "SEDNL/EventListener.hpp"
 #include "SEDNL/SocketHelp.hpp"
-#include "SEDNL/Packet.hpp"
+#include "SEDNL/Compression.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
+
+#include <algorithm>
 
 #ifdef SEDNL_WINDOWS
 #else /* SEDNL_WINDOWS */
 
 #include <unistd.h>
 #include <string.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+# include <linux/errqueue.h>
+#endif /* __linux__ */
+
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) \
+    && defined(SO_EE_ORIGIN_ZEROCOPY)
+# define SEDNL_ZEROCOPY
+#endif
 
 #endif /* SEDNL_WINDOWS */
 
@@ -77,26 +90,308 @@ void Connection::unsafe_disconnect() noexcept
         m_fd = -1;
         m_connected = false;
     }
+
+    //A new socket will have to negotiate again.
+    m_native_arrays = false;
+    m_native_offered = false;
+    m_string_table.reset(0);
+    m_string_table_offered = 0;
+
+    //Notifications belong to the socket: a new one
+    // start again from id 0.
+    m_zerocopy = false;
+    m_zerocopy_next_id = 0;
+    m_zerocopy_pending.clear();
+    m_output.clear();
+    m_output_events = 0;
 }
 
-void Connection::send(const Event& event) throw(NetworkException, std::exception)
+#ifdef SEDNL_WINDOWS
+typedef WSABUF IOBuffer;
+
+static inline
+void set_buffer(IOBuffer& buffer, const Byte* data, std::size_t length)
+{
+    buffer.buf = reinterpret_cast<CHAR*>(const_cast<Byte*>(data));
+    buffer.len = static_cast<ULONG>(length);
+}
+
+static inline
+std::size_t buffer_length(const IOBuffer& buffer)
+{
+    return buffer.len;
+}
+
+static inline
+void advance_buffer(IOBuffer& buffer, std::size_t count)
+{
+    buffer.buf += count;
+    buffer.len -= static_cast<ULONG>(count);
+}
+
+//Return the number of bytes sent, or -1.
+static inline
+long send_buffers(FileDescriptor fd, IOBuffer* buffers, int count,
+                  int /*flags*/)
+{
+    DWORD sent = 0;
+    if (WSASend(fd, buffers, count, &sent, 0, nullptr, nullptr) != 0)
+        return -1;
+    return static_cast<long>(sent);
+}
+#else /* SEDNL_WINDOWS */
+typedef struct iovec IOBuffer;
+
+static inline
+void set_buffer(IOBuffer& buffer, const Byte* data, std::size_t length)
+{
+    buffer.iov_base = const_cast<Byte*>(data);
+    buffer.iov_len = length;
+}
+
+static inline
+std::size_t buffer_length(const IOBuffer& buffer)
+{
+    return buffer.iov_len;
+}
+
+static inline
+void advance_buffer(IOBuffer& buffer, std::size_t count)
+{
+    buffer.iov_base = static_cast<Byte*>(buffer.iov_base) + count;
+    buffer.iov_len -= count;
+}
+
+//Return the number of bytes sent, or -1.
+static inline
+long send_buffers(FileDescriptor fd, IOBuffer* buffers, int count,
+                  int flags)
+{
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = buffers;
+    msg.msg_iovlen = count;
+
+    return static_cast<long>(sendmsg(fd, &msg, flags));
+}
+#endif /* SEDNL_WINDOWS */
+
+void Connection::send_frame(const std::string& name, const Packet& packet,
+                            Packet* owner)
+    throw(NetworkException, std::exception)
 {
     try
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        //Frames are written whole, one thread at a time. While the
+        // socket is full, only m_send_mutex is kept (see wait_socket()).
+        std::lock_guard<std::mutex> send_lock(m_send_mutex);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const FileDescriptor fd = m_fd;
+
+        //The peer didn't accept native arrays
+        Packet converted;
+        const Packet* source = &packet;
+        if (packet.m_has_native_arrays && !m_native_arrays)
+        {
+            converted = packet.with_network_arrays();
+            source = &converted;
+            owner = &converted;
+        }
+
+        //Strings already sent are replaced by their index. If the
+        // frame isn't sent, the table has to be renegotiated.
+        Packet strings;
+        const bool strings_encoded = m_string_table.size
+            && encode_strings(*source, strings);
+        if (strings_encoded)
+        {
+            source = &strings;
+            owner = &strings;
+        }
 
-        ByteArray data = event.pack();
-        const char* data_ptr = reinterpret_cast<const char *>(&data[0]);
+        //Send it compressed if it shrinks
+        Packet compressed;
+        if (m_compression != Compression::None
+            && source->get_data().size() >= m_compression_threshold)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const bool shrunk = __compress_packet(static_cast<UInt8>(m_compression),
+                                                  source->get_data(),
+                                                  compressed.m_data);
+            m_compression_stats.compress_time +=
+                std::chrono::steady_clock::now() - start;
+            m_compression_stats.raw_bytes += source->get_data().size();
+
+            if (shrunk)
+            {
+                m_compression_stats.compressed_events++;
+                source = &compressed;
+                owner = &compressed;
+            }
+            else
+                m_compression_stats.incompressible_events++;
+            m_compression_stats.sent_bytes += source->get_data().size();
+        }
+
+        //Its length wouldn't fit in the header
+        if (source->get_data().size() + name.size() + 1 + sizeof(UInt16)
+            > MAX_FRAME_SIZE)
+        {
+            if (strings_encoded)
+                renegotiate_string_table();
+            throw NetworkException(NetworkExceptionT::FrameTooLarge);
+        }
+
+        //The header is small, and the packet data is sent from
+        // where it is stored: we never build the concatenated frame.
+        ByteArray tmp_header = __event_header(name, source->get_data().size());
+        const ByteArray* header = &tmp_header;
+        const ByteArray* data = &source->get_data();
+        int flags = 0;
+
+        //Answers queued by the listener go first.
+        const unsigned int nb_events = 1 + m_output_events;
+        const std::size_t queued = m_output.size();
+        if (!m_output.empty())
+        {
+            m_output.insert(m_output.end(), tmp_header.begin(), tmp_header.end());
+            tmp_header.swap(m_output);
+            m_output.clear();
+            m_output_events = 0;
+        }
+
+#ifdef SEDNL_ZEROCOPY
+        if (m_zerocopy || !m_zerocopy_pending.empty())
+            reap_zerocopy();
 
-        unsigned long count = 0;
-        unsigned long tmp_count = 1;
-        while (data.size() != count
-               && (tmp_count = ::send(m_fd, data_ptr + count, data.size() - count, 0)) > 0)
-            count += tmp_count;
-        if (data.size() != static_cast<ByteArray::size_type>(count))
+        //The kernel will read the buffers after we return, so they
+        // have to live in the pending list.
+        if (m_zerocopy && data->size() >= m_zerocopy_threshold)
         {
+            m_zerocopy_pending.push_back(ZeroCopyFrame());
+            ZeroCopyFrame& frame = m_zerocopy_pending.back();
+            //No notification can release it before we send it.
+            frame.last_id = m_zerocopy_next_id;
+            frame.header.swap(tmp_header);
+            if (owner)
+                frame.packet.swap(*owner);
+            else
+                frame.packet = *source;
+
+            header = &frame.header;
+            data = &frame.packet.get_data();
+            flags = MSG_ZEROCOPY;
+        }
+        bool used_zerocopy = false;
+#else /* SEDNL_ZEROCOPY */
+        (void)owner;
+#endif /* SEDNL_ZEROCOPY */
+
+        const std::size_t frame_size = header->size() + data->size();
+        IOBuffer buffers[2];
+        set_buffer(buffers[0], &(*header)[0], header->size());
+        set_buffer(buffers[1], data->data(), data->size());
+
+        IOBuffer* first = buffers;
+        int nb_buffers = data->empty() ? 1 : 2;
+        long tmp_count = 1;
+        std::size_t written = 0;
+        bool timed_out = false;
+        bool closed = false;
+
+        while (nb_buffers > 0)
+        {
+            tmp_count = send_buffers(fd, first, nb_buffers, flags);
+
+            if (tmp_count == 0)
+                break;
+            if (tmp_count < 0)
+            {
+#ifdef SEDNL_ZEROCOPY
+                //Not enough option memory to pin the pages:
+                // send this part with a copy.
+                if (flags && errno == ENOBUFS)
+                {
+                    flags = 0;
+                    continue;
+                }
+#endif /* SEDNL_ZEROCOPY */
+                if (!would_block())
+                    break;
+
+#ifdef SEDNL_ZEROCOPY
+                //The listener may process notifications while we
+                // wait: keep our frame out of their reach.
+                if (header != &tmp_header)
+                    m_zerocopy_pending.back().last_id = m_zerocopy_next_id;
+#endif /* SEDNL_ZEROCOPY */
+                if (!wait_socket(lock, fd))
+                {
+                    closed = !m_connected || m_fd != fd;
+                    timed_out = !closed;
+                    break;
+                }
+                continue;
+            }
+
+#ifdef SEDNL_ZEROCOPY
+            //Each successful call get its own notification id.
+            if (flags)
+            {
+                m_zerocopy_pending.back().last_id = m_zerocopy_next_id++;
+                used_zerocopy = true;
+            }
+#endif /* SEDNL_ZEROCOPY */
+
+            //Jump over what was written (a partial write can stop
+            // in the middle of a buffer).
+            std::size_t count = tmp_count;
+            written += count;
+            while (nb_buffers > 0 && count >= buffer_length(*first))
+            {
+                count -= buffer_length(*first);
+                first++;
+                nb_buffers--;
+            }
+            if (nb_buffers > 0)
+                advance_buffer(*first, count);
+        }
+
+        //Nothing was written : the answers are still to be sent.
+        if (nb_buffers > 0 && written == 0 && queued && !closed)
+        {
+            m_output.insert(m_output.begin(),
+                            header->begin(), header->begin() + queued);
+            m_output_events += nb_events - 1;
+        }
+
+#ifdef SEDNL_ZEROCOPY
+        //The kernel copied everything, we don't need to keep the frame.
+        // (A disconnection already emptied the pending list.)
+        if (header != &tmp_header && !used_zerocopy && !closed)
+            m_zerocopy_pending.pop_back();
+#endif /* SEDNL_ZEROCOPY */
+
+        if (nb_buffers == 0)
+        {
+            m_events_out.add(nb_events);
+            m_bytes_out.add(frame_size);
+
+            //Answers queued while we were waiting
+            if (!m_output.empty())
+                send_output();
+        }
+        else
+        {
+            if (closed)
+                throw NetworkException(NetworkExceptionT::SendFailed,
+                                       "The connection was closed.");
+            if (strings_encoded)
+                renegotiate_string_table();
             if (tmp_count == 0)
                 throw NetworkException(NetworkExceptionT::EmptySend);
+            if (timed_out)
+                throw NetworkException(NetworkExceptionT::TimedOut);
 
             // if (tmp_count == -1)
             throw NetworkException(NetworkExceptionT::SendFailed,
@@ -106,22 +401,662 @@ void Connection::send(const Event& event) throw(NetworkException, std::exception
     catch(std::system_error &e)
     {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Error: "
-                      << "std::mutex::lock failed in SedNL::Connection::send"
-                      << std::endl;
-        std::cerr << e.what() << std::endl;
+        SEDNL_DIAGNOSTIC(Error, "Connection::send",
+                         "std::mutex::lock failed in SedNL::Connection::send"
+                         << "\n    " << e.what());
+#endif /* !SEDNL_NOWARN */
+    }
+}
+
+bool Connection::wait_socket(std::unique_lock<std::mutex>& lock,
+                             FileDescriptor fd)
+{
+    //Wake up regularly to notice a disconnection : closing the
+    // socket doesn't interrupt a poll() on it.
+    const int slice = 100;
+
+    for (int waited = 0; waited < SEND_TIMEOUT; waited += slice)
+    {
+        lock.unlock();
+        const bool writable = wait_writable(fd, std::min(slice, SEND_TIMEOUT - waited));
+        lock.lock();
+
+        if (!m_connected || m_fd != fd)
+            return false;
+        if (writable)
+            return true;
+    }
+    return false;
+}
+
+void Connection::queue_frame(const std::string& name, const Packet& packet)
+{
+    const ByteArray header = __event_header(name, packet.get_data().size());
+    m_output.insert(m_output.end(), header.begin(), header.end());
+    m_output.insert(m_output.end(),
+                    packet.get_data().begin(), packet.get_data().end());
+    m_output_events++;
+}
+
+bool Connection::send_output() noexcept
+{
+    //Nobody will read them
+    if (!m_connected)
+    {
+        m_output.clear();
+        m_output_events = 0;
+        return true;
+    }
+
+    std::size_t sent = 0;
+    while (sent < m_output.size())
+    {
+        IOBuffer buffer;
+        set_buffer(buffer, &m_output[sent], m_output.size() - sent);
+        const long count = send_buffers(m_fd, &buffer, 1, 0);
+        if (count <= 0)
+            break;
+        sent += count;
+    }
+    m_bytes_out.add(sent);
+    m_output.erase(m_output.begin(), m_output.begin() + sent);
+
+    if (!m_output.empty())
+    {
+        //Only a full socket is worth retrying later.
+        if (sent == 0 && !would_block())
+        {
+#ifndef SEDNL_NOWARN
+            SEDNL_DIAGNOSTIC(Warning, "Connection::send_output",
+                             "Failed to send a control event to connection "
+                             << m_fd << "\n    " << strerror(errno));
+#endif /* !SEDNL_NOWARN */
+            m_output.clear();
+            m_output_events = 0;
+            return true;
+        }
+        return false;
+    }
+
+    m_events_out.add(m_output_events);
+    m_output_events = 0;
+    return true;
+}
+
+bool Connection::flush_output() noexcept
+{
+    try
+    {
+        std::unique_lock<std::mutex> send_lock(m_send_mutex, std::try_to_lock);
+        //The sender will send them after its frame.
+        if (!send_lock.owns_lock())
+            return false;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return send_output();
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::flush_output()");
+        return false;
+    }
+}
+
+int Connection::reap_zerocopy() noexcept
+{
+#ifdef SEDNL_ZEROCOPY
+    int count = 0;
+
+    while (true)
+    {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(m_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return count;
+            return -1;
+        }
+
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+             cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                && !(cmsg->cmsg_level == SOL_IPV6
+                     && cmsg->cmsg_type == IPV6_RECVERR))
+                continue;
+
+            struct sock_extended_err serr;
+            memcpy(&serr, CMSG_DATA(cmsg), sizeof(serr));
+            if (serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr.ee_errno != 0)
+                return -1;
+
+            //The kernel had to copy the data anyway (loopback,
+            // no scatter-gather on the device...): pinning pages
+            // is then only an overhead.
+            if (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                m_zerocopy = false;
+
+            //Calls from ee_info to ee_data are completed, and
+            // completions arrive in order.
+            const UInt32 hi = serr.ee_data;
+            while (!m_zerocopy_pending.empty()
+                   && static_cast<Int32>(hi - m_zerocopy_pending.front().last_id) >= 0)
+                m_zerocopy_pending.pop_front();
+            count++;
+        }
+    }
+#else /* SEDNL_ZEROCOPY */
+    return 0;
+#endif /* SEDNL_ZEROCOPY */
+}
+
+bool Connection::set_zerocopy(bool enable, unsigned int threshold) noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_zerocopy_threshold = threshold;
+        m_zerocopy = false;
+#ifdef SEDNL_ZEROCOPY
+        const int flag = 1;
+        if (enable && m_connected)
+            m_zerocopy = setsockopt(m_fd, SOL_SOCKET, SO_ZEROCOPY,
+                                    &flag, sizeof(flag)) == 0;
+#else /* SEDNL_ZEROCOPY */
+        (void)enable;
+#endif /* SEDNL_ZEROCOPY */
+        return m_zerocopy;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::set_zerocopy()");
+        return false;
+    }
+}
+
+bool Connection::is_zerocopy() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_zerocopy;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::is_zerocopy()");
+        return false;
+    }
+}
+
+//Name of the control event used to negotiate native arrays.
+//Its packet is {kind : UInt8, big_endian : UInt8}.
+static const char native_arrays_event[] = "\x01native_arrays";
+
+enum NativeArraysMessage
+{
+    NativeArraysOffer = 0,
+    NativeArraysAccept = 1,
+    NativeArraysRefuse = 2,
+};
+
+//Name of the control event used to negotiate the string table.
+//Its packet is {kind : UInt8, size : UInt32}.
+static const char string_table_event[] = "\x01string_table";
+
+enum StringTableMessage
+{
+    StringTableOffer = 0,
+    StringTableAccept = 1,
+};
+
+void Connection::negotiate_native_arrays() throw(NetworkException, std::exception)
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_native_offered = true;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::negotiate_native_arrays()");
+    }
+
+    send(native_arrays_event,
+         make_packet(static_cast<UInt8>(NativeArraysOffer),
+                     static_cast<UInt8>(__is_big_endian())));
+}
+
+bool Connection::has_native_arrays() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_native_arrays;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::has_native_arrays()");
+        return false;
+    }
+}
+
+void Connection::set_trusted(bool trusted) noexcept
+{
+    m_trusted.store(trusted, std::memory_order_relaxed);
+}
+
+bool Connection::is_trusted() noexcept
+{
+    //Read for each packet received : don't take the lock
+    return m_trusted.load(std::memory_order_relaxed);
+}
+
+bool Connection::set_compression(Compression codec,
+                                 unsigned int threshold) noexcept
+{
+    //Fall back to the built-in codec
+    const bool available = codec != Compression::Zlib || __has_zlib();
+    if (!available)
+        codec = Compression::LZ;
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_compression = codec;
+        m_compression_threshold = threshold;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::set_compression()");
+        m_compression = codec;
+        m_compression_threshold = threshold;
+    }
+    return available;
+}
+
+Compression Connection::get_compression() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_compression;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::get_compression()");
+        return m_compression;
+    }
+}
+
+CompressionStats Connection::get_compression_stats() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        CompressionStats stats = m_compression_stats;
+        stats.decompressed_events = m_decompressed_events.get()
+            - m_decompression_base.decompressed_events;
+        stats.received_bytes = m_decompressed_received_bytes.get()
+            - m_decompression_base.received_bytes;
+        stats.decompressed_bytes = m_decompressed_bytes.get()
+            - m_decompression_base.decompressed_bytes;
+        stats.decompress_time = std::chrono::nanoseconds(m_decompress_ns.get())
+            - m_decompression_base.decompress_time;
+        return stats;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::get_compression_stats()");
+        return CompressionStats();
+    }
+}
+
+ConnectionMetrics Connection::get_metrics() const noexcept
+{
+    ConnectionMetrics metrics;
+    metrics.events_in = m_events_in.get();
+    metrics.bytes_in = m_bytes_in.get();
+    metrics.events_out = m_events_out.get();
+    metrics.bytes_out = m_bytes_out.get();
+    return metrics;
+}
+
+void Connection::reset_compression_stats() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_compression_stats = CompressionStats();
+        //The listener keeps counting the packets decompressed
+        m_decompression_base.decompressed_events = m_decompressed_events.get();
+        m_decompression_base.received_bytes =
+            m_decompressed_received_bytes.get();
+        m_decompression_base.decompressed_bytes = m_decompressed_bytes.get();
+        m_decompression_base.decompress_time =
+            std::chrono::nanoseconds(m_decompress_ns.get());
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::reset_compression_stats()");
+    }
+}
+
+void Connection::StringTable::reset(unsigned int table_size)
+{
+    size = table_size;
+    entries.clear();
+    positions.clear();
+}
+
+bool Connection::StringTable::find(const std::string& str, UInt32& slot)
+{
+    auto it = positions.find(str);
+    if (it != positions.end())
+    {
+        entries.splice(entries.begin(), entries, it->second);
+        slot = it->second->slot;
+        return true;
+    }
+
+    //Reuse the slot of the least recently used string
+    if (entries.size() < size)
+        slot = entries.size();
+    else
+    {
+        slot = entries.back().slot;
+        positions.erase(entries.back().str);
+        entries.pop_back();
+    }
+    entries.push_front(Entry{str, slot});
+    positions[str] = entries.begin();
+    return false;
+}
+
+bool Connection::encode_strings(const Packet& packet, Packet& out)
+{
+    const ByteArray& data = packet.m_data;
+    const unsigned int size = data.size();
+    ByteArray& dst = out.m_data;
+    dst.reserve(size);
+    bool found = false;
+
+    unsigned int i = 0;
+    while (i < size)
+    {
+        const Packet::Type t = static_cast<Packet::Type>(data[i]);
+
+        //Objects only have a header : their fields follow.
+        if (const unsigned int header = packet.container_header_size(i))
+        {
+            dst.insert(dst.end(), data.begin() + i, data.begin() + i + header);
+            i += header;
+            continue;
+        }
+
+        //valid_next_item stop on the last byte of the item.
+        const unsigned int begin = i;
+        if (!packet.valid_next_item(size, i))
+        {
+            if (found)
+                renegotiate_string_table();
+            throw PacketException(PacketExceptionT::Unknown);
+        }
+        i++;
+
+        //Content of the string
+        unsigned int first = begin + 1;
+        unsigned int last = i - 1;
+        if (t == Packet::Type::SizedString)
+        {
+            UInt64 length;
+            first += __front_varint(begin + 1, data, length);
+            last = i;
+        }
+
+        if ((t != Packet::Type::String && t != Packet::Type::SizedString)
+            || last - first < 2 || last - first > STRING_TABLE_MAX_LENGTH)
+        {
+            dst.insert(dst.end(), data.begin() + begin, data.begin() + i);
+            continue;
+        }
+
+        found = true;
+        const std::string str(data.begin() + first, data.begin() + last);
+        UInt32 slot;
+        if (m_string_table.find(str, slot))
+        {
+            dst.push_back(static_cast<Byte>(Packet::Type::StringRef));
+            __push_varint(dst, slot);
+        }
+        else
+        {
+            dst.push_back(static_cast<Byte>(Packet::Type::StringDef));
+            __push_varint(dst, slot);
+            __push_varint(dst, str.size());
+            dst.insert(dst.end(), str.begin(), str.end());
+        }
+    }
+
+    return found;
+}
+
+void Connection::set_string_table(unsigned int size)
+    throw(NetworkException, std::exception)
+{
+    if (size > STRING_TABLE_MAX_SIZE)
+        size = STRING_TABLE_MAX_SIZE;
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_string_table_offered = size;
+        //The peer empties its table when it receives the offer
+        m_string_table.reset(0);
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::set_string_table()");
+    }
+
+    send(string_table_event,
+         make_packet(static_cast<UInt8>(StringTableOffer),
+                     static_cast<UInt32>(size)));
+}
+
+void Connection::renegotiate_string_table()
+{
+    //Strings are sent as they are until the peer, that empties
+    // its table, accepts the offer again.
+    m_string_table.reset(0);
+    queue_frame(string_table_event,
+                make_packet(static_cast<UInt8>(StringTableOffer),
+                            static_cast<UInt32>(m_string_table_offered)));
+    send_output();
+}
+
+unsigned int Connection::get_string_table_size() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_string_table.size;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "Connection::get_string_table_size()");
+        return 0;
+    }
+}
+
+bool Connection::is_control_event(const Event& event) noexcept
+{
+    const std::string& name = event.get_name();
+    return !name.empty() && name[0] == native_arrays_event[0];
+}
+
+void Connection::process_control_event(const Event& event) noexcept
+{
+    try
+    {
+        if (event.get_name() == string_table_event)
+        {
+            UInt8 kind;
+            UInt32 size;
+            PacketReader(event.get_packet()) >> kind >> size;
+            if (size > STRING_TABLE_MAX_SIZE)
+                size = STRING_TABLE_MAX_SIZE;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            //The table should exist before the peer use it.
+            if (kind == StringTableOffer)
+            {
+                m_buffer.set_string_table(size);
+                queue_frame(string_table_event,
+                            make_packet(static_cast<UInt8>(StringTableAccept), size));
+            }
+            else if (kind == StringTableAccept)
+                m_string_table.reset(std::min(size, m_string_table_offered));
+            return;
+        }
+        if (event.get_name() != native_arrays_event)
+            return;
+
+        UInt8 kind;
+        UInt8 big_endian;
+        PacketReader reader(event.get_packet());
+        reader >> kind >> big_endian;
+
+        //Native arrays are only useful between hosts
+        // having the same byte order.
+        const bool same_order = (big_endian != 0) == __is_big_endian();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        switch (kind)
+        {
+        case NativeArraysOffer:
+            //Queued before any native array we could send.
+            queue_frame(native_arrays_event,
+                        make_packet(static_cast<UInt8>(same_order
+                                                       ? NativeArraysAccept
+                                                       : NativeArraysRefuse),
+                                    static_cast<UInt8>(__is_big_endian())));
+            if (same_order)
+                m_native_arrays = true;
+            break;
+        case NativeArraysAccept:
+            m_native_arrays = m_native_offered && same_order;
+            break;
+        default:
+            m_native_offered = false;
+            break;
+        }
+    }
+    catch(std::exception &e)
+    {
+#ifndef SEDNL_NOWARN
+        SEDNL_DIAGNOSTIC(Warning, "Connection::control_event",
+                         "Failed to process the control event \""
+                         << event.get_name().c_str() + 1
+                         << "\".\n    " << e.what());
 #endif /* !SEDNL_NOWARN */
     }
 }
 
+void Connection::send(const Event& event) throw(NetworkException, std::exception)
+{
+    send_frame(event.get_name(), event.get_packet());
+}
+
+void Connection::send(Event&& event) throw(NetworkException, std::exception)
+{
+    send_frame(event.get_name(), event.m_packet, &event.m_packet);
+}
+
 void Connection::send(const std::string& name, const Packet& packet) throw(NetworkException, std::exception)
 {
-    send(Event(name, packet));
+    send_frame(name, packet);
+}
+
+void Connection::send(const std::string& name, Packet&& packet) throw(NetworkException, std::exception)
+{
+    send_frame(name, packet, &packet);
 }
 
 void Connection::send(const std::string& name) throw(NetworkException, std::exception)
 {
-    send(Event(name));
+    send_frame(name, Packet());
+}
+
+void Connection::send_raw(const char* data, std::size_t length)
+    throw(NetworkException, std::exception)
+{
+    if (length == 0)
+        throw NetworkException(NetworkExceptionT::EmptySend);
+
+    try
+    {
+        std::lock_guard<std::mutex> send_lock(m_send_mutex);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const FileDescriptor fd = m_fd;
+
+        IOBuffer buffer;
+        set_buffer(buffer, reinterpret_cast<const Byte*>(data), length);
+        long tmp_count = 1;
+        bool timed_out = false;
+        bool closed = false;
+
+        while (buffer_length(buffer) > 0)
+        {
+            tmp_count = send_buffers(fd, &buffer, 1, 0);
+
+            if (tmp_count == 0)
+                break;
+            if (tmp_count < 0)
+            {
+                if (!would_block())
+                    break;
+                if (!wait_socket(lock, fd))
+                {
+                    closed = !m_connected || m_fd != fd;
+                    timed_out = !closed;
+                    break;
+                }
+                continue;
+            }
+            advance_buffer(buffer, tmp_count);
+        }
+
+        if (buffer_length(buffer) == 0)
+            m_bytes_out.add(length);
+        else
+        {
+            if (closed)
+                throw NetworkException(NetworkExceptionT::SendFailed,
+                                       "The connection was closed.");
+            if (tmp_count == 0)
+                throw NetworkException(NetworkExceptionT::EmptySend);
+            if (timed_out)
+                throw NetworkException(NetworkExceptionT::TimedOut);
+            throw NetworkException(NetworkExceptionT::SendFailed,
+                                   strerror(errno));
+        }
+    }
+    catch(std::system_error &e)
+    {
+#ifndef SEDNL_NOWARN
+        SEDNL_DIAGNOSTIC(Error, "Connection::send",
+                         "std::mutex::lock failed in SedNL::Connection::send_raw"
+                         << "\n    " << e.what());
+#endif /* !SEDNL_NOWARN */
+    }
 }
 
 void Connection::set_user_data(const char* data)
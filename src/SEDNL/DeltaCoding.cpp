@@ -0,0 +1,205 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#include "SEDNL/DeltaCoding.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace SedNL
+{
+
+//Differences are computed by blocks of this many elements
+#define DELTA_BLOCK 256
+
+//Maximal length of a varint holding \a bits bits.
+static inline
+std::size_t varint_max_length(std::size_t bits) noexcept
+{
+    return (bits + 6) / 7;
+}
+
+std::size_t __delta_max_length(std::size_t count, std::size_t size) noexcept
+{
+    return count * varint_max_length(8 * size);
+}
+
+template<typename U>
+static
+std::size_t delta_encode(Byte* dst, const U* src, std::size_t count) noexcept
+{
+    typedef typename std::make_signed<U>::type S;
+    const unsigned int shift = 8 * sizeof(U) - 1;
+
+    Byte* const start = dst;
+    U previous = 0;
+    U zigzag[DELTA_BLOCK];
+
+    for (std::size_t i = 0; i < count; i += DELTA_BLOCK)
+    {
+        const std::size_t block = std::min<std::size_t>(DELTA_BLOCK, count - i);
+
+        //Vectorizable : no dependency between iterations
+        zigzag[0] = src[i] - previous;
+        for (std::size_t j = 1; j < block; j++)
+            zigzag[j] = src[i + j] - src[i + j - 1];
+        for (std::size_t j = 0; j < block; j++)
+        {
+            const S d = static_cast<S>(zigzag[j]);
+            zigzag[j] = static_cast<U>(static_cast<U>(d) << 1)
+                ^ static_cast<U>(d >> shift);
+        }
+        previous = src[i + block - 1];
+
+        for (std::size_t j = 0; j < block; j++)
+        {
+            U v = zigzag[j];
+            if (v < 0x80)
+            {
+                *dst++ = static_cast<Byte>(v);
+                continue;
+            }
+            while (v >= 0x80)
+            {
+                *dst++ = static_cast<Byte>(v) | 0x80;
+                v >>= 7;
+            }
+            *dst++ = static_cast<Byte>(v);
+        }
+    }
+
+    return dst - start;
+}
+
+template<typename U>
+static
+bool delta_decode(U* dst, const Byte* src, std::size_t length,
+                  std::size_t count, std::size_t& read) noexcept
+{
+    const std::size_t max_length = varint_max_length(8 * sizeof(U));
+    const Byte* const start = src;
+    const Byte* const end = src + length;
+    U previous = 0;
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (src == end)
+            return false;
+
+        U v = *src++;
+        if (v >= 0x80 && end - src >= static_cast<std::ptrdiff_t>(max_length))
+        {
+            //Enough bytes for the longest varint : no bound check
+            v &= 0x7F;
+            unsigned int shift = 7;
+            Byte b;
+            do
+            {
+                b = *src++;
+                v |= static_cast<U>(static_cast<U>(b & 0x7F) << shift);
+                shift += 7;
+            } while ((b & 0x80) && shift < 7 * max_length);
+            if (b & 0x80)
+                return false;
+        }
+        else if (v >= 0x80)
+        {
+            v &= 0x7F;
+            unsigned int shift = 7;
+            Byte b;
+            do
+            {
+                if (src == end || shift >= 7 * max_length)
+                    return false;
+                b = *src++;
+                v |= static_cast<U>(static_cast<U>(b & 0x7F) << shift);
+                shift += 7;
+            } while (b & 0x80);
+        }
+
+        //Undo the zigzag, then the difference
+        previous += static_cast<U>(v >> 1) ^ static_cast<U>(-(v & 1));
+        dst[i] = previous;
+    }
+
+    read = src - start;
+    return true;
+}
+
+std::size_t __delta_encode(Byte* dst, const void* src,
+                           std::size_t count, std::size_t size) noexcept
+{
+    switch (size)
+    {
+    case 2:
+        return delta_encode(dst, static_cast<const UInt16*>(src), count);
+    case 4:
+        return delta_encode(dst, static_cast<const UInt32*>(src), count);
+    case 8:
+        return delta_encode(dst, static_cast<const UInt64*>(src), count);
+    default:
+        return 0;
+    }
+}
+
+bool __delta_decode(void* dst, const Byte* src, std::size_t length,
+                    std::size_t count, std::size_t size,
+                    std::size_t& read) noexcept
+{
+    switch (size)
+    {
+    case 2:
+        return delta_decode(static_cast<UInt16*>(dst), src, length, count, read);
+    case 4:
+        return delta_decode(static_cast<UInt32*>(dst), src, length, count, read);
+    case 8:
+        return delta_decode(static_cast<UInt64*>(dst), src, length, count, read);
+    default:
+        return false;
+    }
+}
+
+bool __delta_length(const Byte* src, std::size_t length,
+                    std::size_t count, std::size_t size,
+                    std::size_t& read) noexcept
+{
+    const std::size_t max_length = varint_max_length(8 * size);
+    std::size_t i = 0;
+
+    for (; count > 0; count--)
+    {
+        std::size_t j = 0;
+        while (i < length && (src[i] & 0x80))
+        {
+            i++;
+            if (++j >= max_length)
+                return false;
+        }
+        if (i == length)
+            return false;
+        i++;
+    }
+
+    read = i;
+    return true;
+}
+
+} // namespace SedNL
@@ -0,0 +1,72 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef DELTA_CODING_HPP_
+#define DELTA_CODING_HPP_
+
+#include "SEDNL/Types.hpp"
+
+#include <cstddef>
+
+namespace SedNL
+{
+
+//! \brief Maximal length of the encoding of \a count elements
+//!        of \a size bytes (2, 4 or 8).
+std::size_t __delta_max_length(std::size_t count, std::size_t size) noexcept;
+
+//! \brief Write \a count elements of \a size bytes (2, 4 or 8) from
+//!        \a src into \a dst, as a list of zigzag LEB128 varints.
+//!
+//! Each element is stored as its difference with the previous one
+//! (the first one with 0), computed modulo 2^(8 * size): it's the
+//! same for signed and unsigned elements. \a dst must hold at least
+//! __delta_max_length(count, size) bytes.
+//!
+//! Differences are computed by blocks, in a loop the compiler can
+//! vectorize. Varints of one byte take a fast path.
+//!
+//! \return The number of bytes written.
+std::size_t __delta_encode(Byte* dst, const void* src,
+                           std::size_t count, std::size_t size) noexcept;
+
+//! \brief Read \a count elements of \a size bytes (2, 4 or 8) into
+//!        \a dst from the \a length bytes of \a src (see __delta_encode()).
+//!
+//! \param[out] read Number of bytes read.
+//! \return False if \a src is truncated.
+bool __delta_decode(void* dst, const Byte* src, std::size_t length,
+                    std::size_t count, std::size_t size,
+                    std::size_t& read) noexcept;
+
+//! \brief Compute the length of \a count varints stored in the
+//!        \a length bytes of \a src.
+//!
+//! \param[out] read Number of bytes used by the varints.
+//! \return False if \a src is truncated or a varint is too long
+//!         for elements of \a size bytes.
+bool __delta_length(const Byte* src, std::size_t length,
+                    std::size_t count, std::size_t size,
+                    std::size_t& read) noexcept;
+
+} // namespace SedNL
+
+#endif /* !DELTA_CODING_HPP_ */
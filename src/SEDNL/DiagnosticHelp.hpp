@@ -0,0 +1,135 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#ifndef DIAGNOSTIC_HELP_HPP_
+#define DIAGNOSTIC_HELP_HPP_
+
+#include "SEDNL/Diagnostics.hpp"
+
+#include <atomic>
+#include <string>
+
+#ifndef SEDNL_DIAGNOSTIC_RATE
+# define SEDNL_DIAGNOSTIC_RATE 10
+#endif /* !SEDNL_DIAGNOSTIC_RATE */
+
+namespace SedNL
+{
+
+//! \brief A place reporting diagnostics, and its rate limiter.
+//!
+//! Sites are static objects, constant initialized, which link
+//! themselves in the list of sites the first time one of their
+//! messages is dropped, so that the diagnostic thread can
+//! summarize them.
+class SEDNL_API DiagnosticSite
+{
+public:
+    constexpr DiagnosticSite(DiagnosticLevel level, const char* name) noexcept
+        :m_level(level), m_name(name), m_window(0), m_count(0),
+         m_suppressed(0), m_registered(false), m_next(nullptr)
+    {}
+
+    //! \brief Return true if a message can be reported now,
+    //!        or count it as suppressed.
+    bool allow() noexcept;
+
+    //! \brief Count a message which was formatted but couldn't
+    //!        be queued.
+    void suppress() noexcept;
+
+    inline DiagnosticLevel level() const noexcept { return m_level; }
+    inline const char* name() const noexcept { return m_name; }
+
+    //! \brief Take the number of suppressed messages.
+    inline UInt64 take_suppressed() noexcept
+    { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+    //! \brief Next site of the list of sites which dropped messages.
+    inline DiagnosticSite* next() const noexcept { return m_next; }
+
+private:
+    const DiagnosticLevel m_level;
+    const char* const m_name;
+    std::atomic<UInt64> m_window;
+    std::atomic<UInt32> m_count;
+    std::atomic<UInt64> m_suppressed;
+    std::atomic<bool> m_registered;
+    DiagnosticSite* m_next;
+};
+
+//! \brief A message formatted without allocation, truncated
+//!        to the size of a diagnostic queue entry.
+class SEDNL_API DiagnosticMessage
+{
+public:
+    static const unsigned int Capacity = 232;
+
+    inline DiagnosticMessage() noexcept :m_length(0) { m_text[0] = '\0'; }
+
+    DiagnosticMessage& operator<<(const char* str) noexcept;
+    DiagnosticMessage& operator<<(char c) noexcept;
+    DiagnosticMessage& operator<<(long long n) noexcept;
+    DiagnosticMessage& operator<<(unsigned long long n) noexcept;
+    DiagnosticMessage& operator<<(const void* ptr) noexcept;
+
+    inline DiagnosticMessage& operator<<(const std::string& str) noexcept
+    { return *this << str.c_str(); }
+    inline DiagnosticMessage& operator<<(int n) noexcept
+    { return *this << static_cast<long long>(n); }
+    inline DiagnosticMessage& operator<<(long n) noexcept
+    { return *this << static_cast<long long>(n); }
+    inline DiagnosticMessage& operator<<(unsigned int n) noexcept
+    { return *this << static_cast<unsigned long long>(n); }
+    inline DiagnosticMessage& operator<<(unsigned long n) noexcept
+    { return *this << static_cast<unsigned long long>(n); }
+
+    inline const char* c_str() const noexcept { return m_text; }
+
+private:
+    unsigned int m_length;
+    char m_text[Capacity];
+};
+
+//! \brief Queue \a message for the diagnostic thread. Never blocks:
+//!        when the queue is full, the message is counted as
+//!        suppressed by \a site.
+SEDNL_API void post_diagnostic(DiagnosticSite& site,
+                               const DiagnosticMessage& message) noexcept;
+
+} // namespace SedNL
+
+//! \brief Report a diagnostic from the site \a name, at most
+//!        SEDNL_DIAGNOSTIC_RATE times per second. \a message is
+//!        a chain of values separated by <<, like for std::cerr.
+#define SEDNL_DIAGNOSTIC(level, name, message)                          \
+    do {                                                                \
+        static ::SedNL::DiagnosticSite sednl_site(                      \
+            ::SedNL::DiagnosticLevel::level, name);                     \
+        if (sednl_site.allow())                                         \
+        {                                                               \
+            ::SedNL::DiagnosticMessage sednl_message;                   \
+            sednl_message << message;                                   \
+            ::SedNL::post_diagnostic(sednl_site, sednl_message);        \
+        }                                                               \
+    } while (0)
+
+#endif /* !DIAGNOSTIC_HELP_HPP_ */
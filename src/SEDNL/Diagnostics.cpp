@@ -0,0 +1,362 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#include "SEDNL/Diagnostics.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifndef SEDNL_DIAGNOSTIC_QUEUE_SIZE
+# define SEDNL_DIAGNOSTIC_QUEUE_SIZE 256
+#endif /* !SEDNL_DIAGNOSTIC_QUEUE_SIZE */
+
+namespace SedNL
+{
+
+namespace
+{
+
+//Sites which dropped messages, summarized every second.
+std::atomic<DiagnosticSite*> g_sites(nullptr);
+
+//Bounded queue of formatted messages, written by any thread
+// without lock, and drained by the diagnostic thread (or by
+// flush_diagnostics()) under m_mutex. The mutex is recursive,
+// so that a sink reporting a diagnostic doesn't dead lock.
+//Each entry has a sequence number telling which turn of the
+// queue may write it (sequence == position) or read it
+// (sequence == position + 1).
+class DiagnosticQueue
+{
+public:
+    static const UInt64 Size = SEDNL_DIAGNOSTIC_QUEUE_SIZE;
+
+    DiagnosticQueue()
+        :m_head(0), m_tail(0), m_quit(false),
+         m_started(false), m_stopped(false)
+    {
+        for (UInt64 i = 0; i < Size; i++)
+            m_entries[i].sequence.store(i, std::memory_order_relaxed);
+        m_sink.set_function<&cerr_diagnostic_sink>();
+    }
+
+    bool push(DiagnosticSite& site, const DiagnosticMessage& message) noexcept
+    {
+        UInt64 pos = m_head.load(std::memory_order_relaxed);
+        Entry* entry;
+        for (;;)
+        {
+            entry = &m_entries[pos % Size];
+            const UInt64 sequence = entry->sequence.load(std::memory_order_acquire);
+            if (sequence == pos)
+            {
+                if (m_head.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed))
+                    break;
+            }
+            else if (sequence < pos)
+                return false; //Full
+            else
+                pos = m_head.load(std::memory_order_relaxed);
+        }
+        entry->site = &site;
+        entry->message = message;
+        entry->sequence.store(pos + 1, std::memory_order_release);
+
+        start();
+        return true;
+    }
+
+    void drain() noexcept
+    {
+        std::lock_guard<std::recursive_mutex> lk(m_mutex);
+        for (;;)
+        {
+            Entry& entry = m_entries[m_tail % Size];
+            if (entry.sequence.load(std::memory_order_acquire) != m_tail + 1)
+                break;
+            DiagnosticSite* site = entry.site;
+            const DiagnosticMessage message = entry.message;
+            entry.sequence.store(m_tail + Size, std::memory_order_release);
+            m_tail++;
+
+            deliver(*site, message.c_str(), 0);
+        }
+    }
+
+    void summarize() noexcept
+    {
+        std::lock_guard<std::recursive_mutex> lk(m_mutex);
+        for (DiagnosticSite* site = g_sites.load(std::memory_order_acquire);
+             site; site = site->next())
+        {
+            const UInt64 suppressed = site->take_suppressed();
+            if (suppressed == 0)
+                continue;
+            DiagnosticMessage message;
+            message << static_cast<unsigned long long>(suppressed)
+                    << " messages dropped in the last second.";
+            deliver(*site, message.c_str(), suppressed);
+        }
+    }
+
+    void set_sink(const DiagnosticSink& sink)
+    {
+        std::lock_guard<std::recursive_mutex> lk(m_mutex);
+        m_sink = sink;
+    }
+
+    //Called at exit : the remaining messages are delivered,
+    // and the next ones by the thread reporting them.
+    void stop() noexcept
+    {
+        try
+        {
+            {
+                std::lock_guard<std::mutex> lk(m_thread_mutex);
+                m_quit = true;
+                m_stopped.store(true, std::memory_order_release);
+            }
+            m_cv.notify_one();
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+        catch(std::exception&)
+        {}
+        drain();
+        summarize();
+    }
+
+private:
+    struct Entry
+    {
+        std::atomic<UInt64> sequence;
+        DiagnosticSite* site;
+        DiagnosticMessage message;
+    };
+
+    void start() noexcept
+    {
+        if (!m_started.load(std::memory_order_acquire))
+        {
+            try
+            {
+                std::lock_guard<std::mutex> lk(m_thread_mutex);
+                if (!m_started.load(std::memory_order_relaxed) && !m_quit)
+                {
+                    m_thread = std::thread(&DiagnosticQueue::run, this);
+                    m_started.store(true, std::memory_order_release);
+                }
+            }
+            catch(std::exception&)
+            {
+                //Without thread, messages are delivered by
+                // the threads reporting them.
+                m_stopped.store(true, std::memory_order_release);
+            }
+        }
+        if (m_stopped.load(std::memory_order_acquire))
+            drain();
+    }
+
+    void run() noexcept
+    {
+        try
+        {
+            auto next_summary = std::chrono::steady_clock::now()
+                + std::chrono::seconds(1);
+            std::unique_lock<std::mutex> lk(m_thread_mutex);
+            while (!m_quit)
+            {
+                m_cv.wait_for(lk, std::chrono::milliseconds(50));
+                lk.unlock();
+                drain();
+                if (std::chrono::steady_clock::now() >= next_summary)
+                {
+                    summarize();
+                    next_summary += std::chrono::seconds(1);
+                }
+                lk.lock();
+            }
+        }
+        catch(std::exception&)
+        {}
+    }
+
+    void deliver(DiagnosticSite& site, const char* message,
+                 UInt64 suppressed) noexcept
+    {
+        Diagnostic diagnostic;
+        diagnostic.level = site.level();
+        diagnostic.site = site.name();
+        diagnostic.message = message;
+        diagnostic.suppressed = suppressed;
+        try
+        {
+            m_sink(diagnostic);
+        }
+        catch(...)
+        {}
+    }
+
+    Entry m_entries[Size];
+    std::atomic<UInt64> m_head;
+
+    //Reader side
+    std::recursive_mutex m_mutex;
+    UInt64 m_tail;
+    DiagnosticSink m_sink;
+
+    //Diagnostic thread
+    std::mutex m_thread_mutex;
+    std::condition_variable m_cv;
+    bool m_quit;
+    std::atomic<bool> m_started;
+    std::atomic<bool> m_stopped;
+    std::thread m_thread;
+};
+
+//Never destroyed, so that it can be used while other static
+// objects are destroyed.
+DiagnosticQueue& diagnostic_queue()
+{
+    static DiagnosticQueue* queue = new DiagnosticQueue;
+    return *queue;
+}
+
+//Deliver the pending diagnostics when the program exits.
+struct DiagnosticsAtExit
+{
+    ~DiagnosticsAtExit()
+    {
+        diagnostic_queue().stop();
+    }
+} g_at_exit;
+
+} // namespace
+
+bool DiagnosticSite::allow() noexcept
+{
+    const UInt64 now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    UInt64 window = m_window.load(std::memory_order_relaxed);
+    if (window != now
+        && m_window.compare_exchange_strong(window, now,
+                                            std::memory_order_relaxed))
+        m_count.store(0, std::memory_order_relaxed);
+
+    if (m_count.fetch_add(1, std::memory_order_relaxed) < SEDNL_DIAGNOSTIC_RATE)
+        return true;
+    suppress();
+    return false;
+}
+
+void DiagnosticSite::suppress() noexcept
+{
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+
+    //Link the site the first time it drops a message
+    if (!m_registered.exchange(true, std::memory_order_relaxed))
+    {
+        DiagnosticSite* head = g_sites.load(std::memory_order_relaxed);
+        do
+            m_next = head;
+        while (!g_sites.compare_exchange_weak(head, this,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+}
+
+DiagnosticMessage& DiagnosticMessage::operator<<(const char* str) noexcept
+{
+    if (!str)
+        str = "(null)";
+    const unsigned int length = std::min<std::size_t>(std::strlen(str),
+                                                      Capacity - 1 - m_length);
+    std::memcpy(m_text + m_length, str, length);
+    m_length += length;
+    m_text[m_length] = '\0';
+    return *this;
+}
+
+DiagnosticMessage& DiagnosticMessage::operator<<(char c) noexcept
+{
+    const char str[2] = {c, '\0'};
+    return *this << str;
+}
+
+DiagnosticMessage& DiagnosticMessage::operator<<(long long n) noexcept
+{
+    char str[24];
+    std::snprintf(str, sizeof(str), "%lld", n);
+    return *this << static_cast<const char*>(str);
+}
+
+DiagnosticMessage& DiagnosticMessage::operator<<(unsigned long long n) noexcept
+{
+    char str[24];
+    std::snprintf(str, sizeof(str), "%llu", n);
+    return *this << static_cast<const char*>(str);
+}
+
+DiagnosticMessage& DiagnosticMessage::operator<<(const void* ptr) noexcept
+{
+    char str[24];
+    std::snprintf(str, sizeof(str), "%p", ptr);
+    return *this << static_cast<const char*>(str);
+}
+
+void post_diagnostic(DiagnosticSite& site,
+                     const DiagnosticMessage& message) noexcept
+{
+    if (!diagnostic_queue().push(site, message))
+        site.suppress();
+}
+
+void set_diagnostic_sink(const DiagnosticSink& sink)
+{
+    diagnostic_queue().set_sink(sink);
+}
+
+void cerr_diagnostic_sink(const Diagnostic& diagnostic)
+{
+    std::cerr << (diagnostic.level == DiagnosticLevel::Error
+                  ? "Error: " : "Warning: ");
+    if (diagnostic.suppressed)
+        std::cerr << diagnostic.site << ": ";
+    std::cerr << diagnostic.message << std::endl;
+}
+
+void flush_diagnostics() noexcept
+{
+    diagnostic_queue().drain();
+    diagnostic_queue().summarize();
+}
+
+} // namespace SedNL
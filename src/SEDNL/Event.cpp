@@ -28,23 +28,14 @@ namespace SedNL
 
 ByteArray Event::get_header() const
 {
-    const auto data = m_packet.get_data();
-    //Size of the packet = |length : UInt16| + |m_name . '\0'| + |Packet|
-    const UInt16 length = data.size() + m_name.length() + 1 + sizeof(UInt16);
-
-    ByteArray header;
-    __push_16(header, length);
-    header.insert(header.end(), m_name.begin(), m_name.end());
-    header.push_back('\0');
-
-    return header;
+    return __event_header(m_name, m_packet.get_data().size());
 }
 
 ByteArray Event::pack() const
 {
     ByteArray ev = get_header();
 
-    const ByteArray data = m_packet.get_data();
+    const ByteArray& data = m_packet.get_data();
     ev.insert(ev.end(), data.begin(), data.end());
 
     return ev;
@@ -22,8 +22,10 @@
 #include "SEDNL/EventConsumer.hpp"
 #include "SEDNL/EventListener.hpp"
 #include "SEDNL/Exception.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
 
 #include<iostream>
+#include<functional>
 
 namespace SedNL
 {
@@ -70,6 +72,22 @@ void EventConsumer::set_producer(EventListener &producer) throw(EventException)
     m_producer = &producer;
 }
 
+void EventConsumer::drop_mismatched(const Event& event, PacketExceptionT error)
+{
+    m_dropped_mismatched.add();
+    m_event_counters.get(event.get_name()).dropped.add();
+
+#ifndef SEDNL_NOWARN
+    SEDNL_DIAGNOSTIC(Warning, "EventConsumer::mismatched_packet",
+                     "Packet of event \"" << event.get_name()
+                     << "\" doesn't match the bound types: "
+                     << PacketException(error).what() << " Dropped.");
+#else
+    (void)event;
+    (void)error;
+#endif /* !SEDNL_NOWARN */
+}
+
 void EventConsumer::clean_slots()
 {
     for (auto it = m_slots.begin();
@@ -89,14 +107,9 @@ void EventConsumer::run_init()
     clean_slots();
 }
 
-typedef std::pair<std::shared_ptr<Connection>, Event> CnEvent;
-typedef SafeQueue<CnEvent> EventQueue;
-typedef SafeQueue<std::shared_ptr<Connection>> ConnectionQueue;
-typedef SafeQueue<TCPServer *> ServerQueue;
-
 template<typename S, typename... Args>
 inline
-void slot_call(S& s, Args& ...args)
+void slot_call(MetricCounter& exceptions, S& s, Args& ...args)
 {
     try
     {
@@ -105,69 +118,97 @@ void slot_call(S& s, Args& ...args)
     catch(std::exception& e)
     {
 #ifndef SEDNL_NOWARN
-        std::cerr << "Warning: Non handled exception caugh inside slot "
-                  << &s
-                  << std::endl;
-        std::cerr << "    "
-                  << "It means that one of your callback throw"
-                  << "the following exception: "
-                  << std::endl;
-        std::cerr << "    "
-                  << e.what()
-                  << std::endl;
+        SEDNL_DIAGNOSTIC(Warning, "EventConsumer::slot_exception",
+                         "Non handled exception caugh inside slot "
+                         << static_cast<const void*>(&s)
+                         << "\n    It means that one of your callback throw"
+                         << " the following exception:\n    " << e.what());
 #endif /* !SEDNL_NOWARN */
+        exceptions.add();
     }
     catch(...)
     {
 #ifndef SEDNL_NOWARN
-        std::cerr << "Warning: Non handled exception caugh inside slot "
-                  << &s
-                  << std::endl;
-        std::cerr << "    "
-                  << "It means that one of your callback throw an exception."
-                  << std::endl;
+        SEDNL_DIAGNOSTIC(Warning, "EventConsumer::slot_exception",
+                         "Non handled exception caugh inside slot "
+                         << static_cast<const void*>(&s)
+                         << "\n    It means that one of your callback"
+                         << " throw an exception.");
 #endif /* !SEDNL_NOWARN */
+        exceptions.add();
     }
 }
 
 template<typename S>
-static
-void process(CnEvent& e, S& slot, EventQueue& queue)
+void EventConsumer::process(CnEvent& e, S& slot, EventQueue& queue,
+                            const std::string& name)
 {
+    //Counters are only looked up when there is something to process
+    EventCountersMap::Counters* counters = nullptr;
+    EventLatencyHistograms* latency = nullptr;
+
     while(queue.pop(e))
-        slot_call(slot, *e.first.get(), e.second);
+    {
+        if (!counters)
+            counters = &m_event_counters.get(name);
+        counters->events.add();
+        counters->bytes.add(e.second.get_packet().get_data().size());
+        m_events_out.add();
+
+        //Not timestamped by the listener
+        if (!e.second.m_received_time)
+        {
+            slot_call(m_handler_exceptions, slot, *e.first.get(), e.second);
+            continue;
+        }
+
+        const UInt64 popped = latency_clock();
+        slot_call(m_handler_exceptions, slot, *e.first.get(), e.second);
+        if (!latency)
+            latency = &m_latency.get(name);
+        latency->record(e.second.m_received_time, e.second.m_queued_time,
+                        popped, latency_clock());
+    }
 }
 
 template<typename S>
-static
-void process(CnEvent&, S& slot, ConnectionQueue& queue)
+void EventConsumer::process(CnEvent&, S& slot, ConnectionQueue& queue,
+                            const std::string&)
 {
     std::shared_ptr<Connection> ptr;
     while(queue.pop(ptr))
-        slot_call(slot, *ptr);
+    {
+        m_disconnections.add();
+        slot_call(m_handler_exceptions, slot, *ptr);
+    }
 }
 
 template<typename S>
-static
-void process(CnEvent&, S& slot, ServerQueue& queue)
+void EventConsumer::process(CnEvent&, S& slot, ServerQueue& queue,
+                            const std::string&)
 {
     TCPServer* ptr;
     while(queue.pop(ptr))
-        slot_call(slot, *ptr);
+    {
+        m_disconnections.add();
+        slot_call(m_handler_exceptions, slot, *ptr);
+    }
 }
 
-#define PROCESS_MESSAGES(slot, queue)      \
-    {                                      \
-        if ((slot))                        \
-            process(e, (slot), (queue));   \
+#define PROCESS_MESSAGES(slot, queue, name)        \
+    {                                              \
+        if ((slot))                                \
+            process(e, (slot), (queue), (name));   \
     }
 
 void EventConsumer::consume_events() noexcept
 {
     CnEvent e;
+    const std::string none;
 
     for (auto& pair : m_slots)
-        PROCESS_MESSAGES(pair.second, m_producer->m_events[pair.first]);
+        PROCESS_MESSAGES(pair.second, m_producer->m_events[pair.first],
+                         pair.first);
 
     if (m_on_event_slot)
     {
@@ -177,13 +218,39 @@ void EventConsumer::consume_events() noexcept
             //If there is no consumer assigned
             if (m_producer->m_links.find(pair.first) == m_producer->m_links.end())
                 //Process it
-                PROCESS_MESSAGES(m_on_event_slot, pair.second);
+                PROCESS_MESSAGES(m_on_event_slot, pair.second, pair.first);
         }
     }
 
     PROCESS_MESSAGES(m_on_server_disconnect_slot,
-                     m_producer->m_server_disconnected_queue);
-    PROCESS_MESSAGES(m_on_disconnect_slot, m_producer->m_disconnected_queue);
+                     m_producer->m_server_disconnected_queue, none);
+    PROCESS_MESSAGES(m_on_disconnect_slot, m_producer->m_disconnected_queue,
+                     none);
+}
+
+std::map<std::string, EventLatency> EventConsumer::get_latency() const
+{
+    std::map<std::string, EventLatency> latency;
+    m_latency.for_each([&](const std::string& name,
+                           const EventLatencyHistograms& histograms) {
+            EventLatency& event = latency[name];
+            event.receive = histograms.receive.stats();
+            event.queue = histograms.queue.stats();
+            event.handler = histograms.handler.stats();
+            event.total = histograms.total.stats();
+        });
+    return latency;
+}
+
+ConsumerMetrics EventConsumer::get_metrics() const
+{
+    ConsumerMetrics metrics;
+    metrics.events = m_event_counters.snapshot();
+    metrics.events_out = m_events_out.get();
+    metrics.disconnections = m_disconnections.get();
+    metrics.dropped_mismatched = m_dropped_mismatched.get();
+    metrics.handler_exceptions = m_handler_exceptions.get();
+    return metrics;
 }
 
 void EventConsumer::run_imp()
@@ -26,19 +26,127 @@
 #include "SEDNL/TCPClient.hpp"
 #include "SEDNL/SocketHelp.hpp"
 #include "SEDNL/Poller.hpp"
+#include "SEDNL/Latency.hpp"
+#include "SEDNL/Capture.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
 
 #include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <cassert>
+#include <functional>
+#include <chrono>
+#include <thread>
+
+#ifndef SEDNL_WINDOWS
+#include <time.h>
+#ifdef __linux__
+# include <linux/net_tstamp.h>
+# include <linux/errqueue.h>
+#endif /* __linux__ */
+
+#if defined(SO_TIMESTAMPING) && defined(SOF_TIMESTAMPING_RX_SOFTWARE)
+# define SEDNL_RX_TIMESTAMPING
+//Only defined by the kernel headers
+# ifndef SCM_TIMESTAMPING
+#  define SCM_TIMESTAMPING SO_TIMESTAMPING
+# endif
+#endif
+
+#endif /* !SEDNL_WINDOWS */
 
 namespace SedNL
 {
 
+//Ask the kernel to timestamp the data received on fd.
+static void enable_rx_timestamps(FileDescriptor fd) noexcept
+{
+#ifdef SEDNL_RX_TIMESTAMPING
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+#else /* SEDNL_RX_TIMESTAMPING */
+    (void)fd;
+#endif /* SEDNL_RX_TIMESTAMPING */
+}
+
+//Read data from fd, like recv(), and the latency_clock() time at
+// which the kernel received it (or the current time if it doesn't tell).
+static ssize_t recv_timestamped(FileDescriptor fd, char* buf, std::size_t length,
+                                UInt64& received) noexcept
+{
+#ifdef SEDNL_RX_TIMESTAMPING
+    iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = length;
+    union
+    {
+        char data[CMSG_SPACE(sizeof(scm_timestamping))];
+        cmsghdr align;
+    } control;
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data;
+    msg.msg_controllen = sizeof(control.data);
+
+    const ssize_t count = recvmsg(fd, &msg, 0);
+    if (count <= 0)
+        return count;
+    received = latency_clock();
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPING)
+            continue;
+
+        //The kernel timestamp is on CLOCK_REALTIME: we keep its age.
+        scm_timestamping stamp;
+        std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+        timespec now;
+        if ((stamp.ts[0].tv_sec || stamp.ts[0].tv_nsec)
+            && clock_gettime(CLOCK_REALTIME, &now) == 0)
+        {
+            const Int64 age = (now.tv_sec - stamp.ts[0].tv_sec) * 1000000000LL
+                + (now.tv_nsec - stamp.ts[0].tv_nsec);
+            if (age > 0 && static_cast<UInt64>(age) < received)
+                received -= age;
+        }
+        break;
+    }
+    return count;
+#else /* SEDNL_RX_TIMESTAMPING */
+    const ssize_t count = recv(fd, buf, length, 0);
+    if (count > 0)
+        received = latency_clock();
+    return count;
+#endif /* SEDNL_RX_TIMESTAMPING */
+}
+
 EventListener::EventListener(unsigned int max_queue_size)
-    :m_max_queue_size(max_queue_size), m_running(false)
+    :m_max_queue_size(max_queue_size), m_trusted(false),
+     m_latency_tracking(false), m_running(false),
+     m_disconnects(0), m_dropped_disconnections(0)
 {
     clear_consumer_links();
+
+    m_wake_pipe[0] = -1;
+    m_wake_pipe[1] = -1;
+#ifndef SEDNL_WINDOWS
+    //Without it, injected data waits for the next wake up
+    if (pipe(m_wake_pipe) != 0
+        || !set_non_blocking(m_wake_pipe[0])
+        || !set_non_blocking(m_wake_pipe[1]))
+    {
+        if (m_wake_pipe[0] >= 0)
+        {
+            close(m_wake_pipe[0]);
+            close(m_wake_pipe[1]);
+        }
+        m_wake_pipe[0] = -1;
+        m_wake_pipe[1] = -1;
+    }
+#endif /* !SEDNL_WINDOWS */
 }
 
 EventListener::EventListener(Connection& connection, unsigned int max_queue_size)
@@ -56,6 +164,13 @@ EventListener::EventListener(TCPServer& server, unsigned int max_queue_size)
 EventListener::~EventListener()
 {
     join();
+#ifndef SEDNL_WINDOWS
+    if (m_wake_pipe[0] >= 0)
+    {
+        close(m_wake_pipe[0]);
+        close(m_wake_pipe[1]);
+    }
+#endif /* !SEDNL_WINDOWS */
 }
 
 //
@@ -155,10 +270,18 @@ void EventListener::run_init()
         if(server->is_connected() && !poller->add_fd(server->m_fd))
             throw EventException(EventExceptionT::PollerAddFailed);
 
+    //Register the pipe waking us up for injected data
+    if (m_wake_pipe[0] >= 0 && !poller->add_fd(m_wake_pipe[0]))
+        throw EventException(EventExceptionT::PollerAddFailed);
+
     //Register clients
     for (auto connection : m_connections)
+    {
         if(connection->is_connected() && !poller->add_fd(connection->m_fd))
             throw EventException(EventExceptionT::PollerAddFailed);
+        if (m_latency_tracking && connection->is_connected())
+            enable_rx_timestamps(connection->m_fd);
+    }
 
     // Associate registered consumer to their events (so that
     // we can wake_up the condition_variable).
@@ -171,8 +294,12 @@ void EventListener::run_init()
         link(m_on_server_disconnect_slot, m_on_server_disconnect_link);
         link(m_on_event_slot, m_on_event_link);
 
-        for (auto slot_pair : consumer->m_slots)
+        for (auto& slot_pair : consumer->m_slots)
+        {
             link_consumer(consumer, slot_pair.second, m_links[slot_pair.first]);
+            //Consumers find the queues of their events without adding them
+            event_queue(slot_pair.first);
+        }
     }
 
     //Keep the event poll
@@ -229,18 +356,19 @@ bool is_full(T& queue, unsigned int max_queue_size)
 
 template <class T, class U>
 static inline
-void disconnected_event(T& queue, U cn, FileDescriptor fd,
+bool disconnected_event(T& queue, U cn, FileDescriptor fd,
                         const char* type, unsigned int max_queue_size)
 {
     if (is_full(queue, max_queue_size) || !queue.push(cn))
     {
 #ifndef SEDNL_NOWARN
-        std::cerr << "Error: "
-                  << "Lost a " << type << " disconnected event for fd "
-                  << fd
-                  << std::endl;
+        SEDNL_DIAGNOSTIC(Error, "EventListener::lost_disconnection",
+                         "Lost a " << type << " disconnected event for fd "
+                         << fd);
 #endif /* !SEDNL_NOWARN */
+        return false;
     }
+    return true;
 }
 
 //Assume fd is a connection
@@ -274,13 +402,18 @@ void EventListener::close_connection(FileDescriptor fd)
     if (!cn)
         return;
 
+    if (m_capture)
+        m_capture->append(fd, latency_clock(), nullptr, 0);
+
     cn->safe_disconnect();
     if (m_poller)
         m_poller->remove_fd(fd);
 
     //Create the server disconnected event
-    disconnected_event(m_disconnected_queue, cn, cn->get_fd(),
-                       "connection", m_max_queue_size);
+    m_disconnects++;
+    if (!disconnected_event(m_disconnected_queue, cn, cn->get_fd(),
+                            "connection", m_max_queue_size))
+        m_dropped_disconnections++;
 
     //Wake up consumer
     notify(m_on_disconnect_link);
@@ -313,38 +446,38 @@ void EventListener::accept_connections(FileDescriptor fd)
 #endif /* !SEDNL_WINDOWS */
 
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: "
-                      << "Can't accept on server socket "
-                      << fd
-                      << std::endl;
-            std::cerr << "    " << strerror(errno) << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::accept",
+                             "Can't accept on server socket " << fd
+                             << "\n    " << strerror(errno));
 #endif /* !SEDNL_NOWARN */
+            m_failed_accepts.add();
             return;
         }
 
         if (set_non_blocking(cfd) == false)
         {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: "
-                      << "Can't set accepted socket non-blocking "
-                      << cfd
-                      << std::endl;
-            std::cerr << "    " << strerror(errno) << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::set_non_blocking",
+                             "Can't set accepted socket non-blocking " << cfd
+                             << "\n    " << strerror(errno));
 #endif /* !SEDNL_NOWARN */
             close(cfd);
+            m_failed_accepts.add();
             return;
         }
 
+        if (m_latency_tracking)
+            enable_rx_timestamps(cfd);
+
         if (m_poller->add_fd(cfd) == false)
         {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: "
-                      << "Can't accepted socket to epoll "
-                      << cfd
-                      << std::endl;
-            std::cerr << "    " << strerror(errno) << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::add_fd",
+                             "Can't accepted socket to epoll " << cfd
+                             << "\n    " << strerror(errno));
 #endif /* !SEDNL_NOWARN */
             close(cfd);
+            m_failed_accepts.add();
             return;
         }
 
@@ -357,6 +490,7 @@ void EventListener::accept_connections(FileDescriptor fd)
             auto cn = std::shared_ptr<Connection>(new Connection);
             cn->m_listener = this;
             cn->m_connected = true;
+            cn->m_trusted = m_trusted;
 
             cn->m_fd = cfd;
             auto p = m_internal_connections.emplace(cfd, cn);
@@ -367,19 +501,19 @@ void EventListener::accept_connections(FileDescriptor fd)
 
             using std::swap;
             swap(connection, cn);
+            m_accepts.add();
         }
         //Catch std::bad_alloc and others
         catch(std::exception &e)
         {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: "
-                      << "Can't create/store connection "
-                      << cfd
-                      << std::endl;
-            std::cerr << "    " << e.what() << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::store_connection",
+                             "Can't create/store connection " << cfd
+                             << "\n    " << e.what());
 #endif /* !SEDNL_NOWARN */
             close(cfd);
             m_poller->remove_fd(cfd);
+            m_failed_accepts.add();
             return;
         }
 
@@ -392,18 +526,16 @@ void EventListener::accept_connections(FileDescriptor fd)
         catch(std::exception& e)
         {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: Non handled exception caugh inside on_connect."
-                      << std::endl;
-            std::cerr << "    "
-                      << e.what()
-                      << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::on_connect",
+                             "Non handled exception caugh inside on_connect."
+                             << "\n    " << e.what());
 #endif /* !SEDNL_NOWARN */
         }
         catch(...)
         {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: Non handled exception caugh inside on_connect."
-                      << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::on_connect",
+                             "Non handled exception caugh inside on_connect.");
 #endif /* !SEDNL_NOWARN */
         }
 
@@ -417,12 +549,15 @@ void EventListener::read_connection(FileDescriptor fd)
 {
     char buf[512];
     ssize_t count = 0;
-    Event e;
     std::shared_ptr<Connection> cn = get_connection(fd);
+    UInt64 received_time = 0;
 
     while (true)
     {
-        count = recv(fd, buf, sizeof(buf), 0);
+        if (m_latency_tracking)
+            count = recv_timestamped(fd, buf, sizeof(buf), received_time);
+        else
+            count = recv(fd, buf, sizeof(buf), 0);
 
         if (count == -1)
         {
@@ -446,10 +581,9 @@ void EventListener::read_connection(FileDescriptor fd)
 #ifndef SEDNL_NOWARN
             //This isn't a big error, and mayb we should
             // use NDEBUG instead of SEDNL_NOWARN.
-            std::cerr << "warning: Reading data from connection "
-                      << fd
-                      << " failed." << std::endl;
-            std::cerr << "    " << strerror(errno) << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "EventListener::read_connection",
+                             "Reading data from connection " << fd
+                             << " failed.\n    " << strerror(errno));
 #endif /* !SEDNL_NOWARN */
             close_connection(fd);
             return;
@@ -461,25 +595,109 @@ void EventListener::read_connection(FileDescriptor fd)
             return;
         }
 
+        if (m_capture)
+            m_capture->append(fd, received_time ? received_time : latency_clock(),
+                              buf, static_cast<UInt32>(count));
+
+        //Protocol error
+        if (!process_data(cn, buf, static_cast<unsigned int>(count), received_time))
+        {
+            close_connection(fd);
+            return;
+        }
+    }
+}
+
+bool EventListener::process_data(const std::shared_ptr<Connection>& cn,
+                                 const char* data, unsigned int length,
+                                 UInt64 received_time)
+{
+    Event e;
+    const bool trusted = cn->is_trusted();
+    CompressionStats received;
+    RingBuf& buffer = cn->m_buffer;
+
+    cn->m_bytes_in.add(length);
+    m_bytes_in.add(length);
+
+    while (length > 0)
+    {
+        //The buffer is full of an incomplete frame: make room
+        // for the biggest one.
+        if (buffer.length() == buffer.size())
+        {
+            try
+            {
+                if (buffer.size() < MAX_FRAME_SIZE)
+                    buffer.grow(MAX_FRAME_SIZE);
+            }
+            catch(std::bad_alloc&)
+            {}
+        }
+
         //Push data in buffer
-        cn->m_buffer.put(buf, static_cast<unsigned int>(count));
+        const unsigned int count = std::min(length, buffer.size() - buffer.length());
+        if (count == 0 || !buffer.put(data, count))
+        {
+#ifndef SEDNL_NOWARN
+            SEDNL_DIAGNOSTIC(Error, "EventListener::buffer_full",
+                             "Can't buffer the data received from connection "
+                             << cn->get_fd() << ". Closed.");
+#endif /* !SEDNL_NOWARN */
+            return false;
+        }
+        data += count;
+        length -= count;
 
         //Try to read some events
-        while (cn->m_buffer.pick_event(e))
+        while (true)
         {
-            if (is_full(m_events[e.get_name()], m_max_queue_size)
-                || !m_events[e.get_name()].push(std::make_pair(cn, e)))
+            //A dropped packet is consumed : the next one may be complete.
+            const unsigned int before = buffer.length();
+            if (!buffer.pick_event(e, trusted, &received))
+            {
+                if (buffer.length() < before)
+                    continue;
+                break;
+            }
+
+            cn->m_events_in.add();
+
+            //Handled by the connection, not by the user
+            if (Connection::is_control_event(e))
+            {
+                cn->process_control_event(e);
+                if (!cn->flush_output()
+                    && std::find(m_unflushed.begin(), m_unflushed.end(), cn)
+                       == m_unflushed.end())
+                    m_unflushed.push_back(cn);
+                continue;
+            }
+
+            EventQueue& queue = event_queue(e.get_name());
+            EventCountersMap::Counters& counters = m_event_counters.get(e.get_name());
+            if (m_latency_tracking)
+            {
+                e.m_received_time = received_time;
+                e.m_queued_time = latency_clock();
+            }
+            if (is_full(queue, m_max_queue_size)
+                || !queue.push(std::make_pair(cn, e)))
             {
+                counters.dropped.add();
+                m_dropped_queue_full.add();
 #ifndef SEDNL_NOWARN
-                std::cerr << "Error: "
-                          << "Lost a \"" << e.get_name()
-                          << "\" event for fd "
-                          << fd
-                          << std::endl;
+                SEDNL_DIAGNOSTIC(Error, "EventListener::lost_event",
+                                 "Lost a \"" << e.get_name()
+                                 << "\" event for fd " << cn->get_fd());
 #endif /* !SEDNL_NOWARN */
             }
             else
             {
+                counters.events.add();
+                counters.bytes.add(e.get_packet().get_data().size());
+                m_events_in.add();
+
                 if (m_links.find(e.get_name()) != m_links.end()
                     && m_links[e.get_name()])
                     notify(m_links[e.get_name()]);
@@ -488,6 +706,51 @@ void EventListener::read_connection(FileDescriptor fd)
             }
         }
     }
+
+    if (const unsigned int dropped = cn->m_buffer.take_dropped())
+        m_dropped_invalid_packets.add(dropped);
+
+    if (received.decompressed_events)
+    {
+        cn->m_decompressed_events.add(received.decompressed_events);
+        cn->m_decompressed_received_bytes.add(received.received_bytes);
+        cn->m_decompressed_bytes.add(received.decompressed_bytes);
+        cn->m_decompress_ns.add(received.decompress_time.count());
+    }
+    return true;
+}
+
+bool EventListener::reap_zerocopy(FileDescriptor fd) noexcept
+{
+    std::shared_ptr<Connection> cn = get_connection(fd);
+    if (!cn)
+        return false;
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(cn->m_mutex);
+
+        if (!cn->m_zerocopy && cn->m_zerocopy_pending.empty())
+            return false;
+        if (cn->reap_zerocopy() < 0)
+            return false;
+    }
+    catch(std::exception &e)
+    {
+        warn_lock(e, "EventListener::reap_zerocopy()");
+        return false;
+    }
+
+#ifndef SEDNL_WINDOWS
+    //A send may have processed the notifications before us,
+    // so check the socket didn't fail.
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0
+        || error != 0)
+        return false;
+#endif /* !SEDNL_WINDOWS */
+    return true;
 }
 
 std::shared_ptr<Connection>
@@ -541,15 +804,18 @@ void EventListener::tell_disconnected(Connection *cn) noexcept
 
     if (m_poller)
         m_poller->remove_fd(ptr->m_fd);
-    disconnected_event(m_disconnected_queue, ptr, ptr->m_fd,
-                       "connection", m_max_queue_size);
+    m_disconnects++;
+    if (!disconnected_event(m_disconnected_queue, ptr, ptr->m_fd,
+                            "connection", m_max_queue_size))
+        m_dropped_disconnections++;
 }
 
 //We are called with the m_fd lock
 void EventListener::tell_disconnected(TCPServer *s) noexcept
 {
-    disconnected_event(m_server_disconnected_queue, s, s->get_fd(),
-                       "server", m_max_queue_size);
+    if (!disconnected_event(m_server_disconnected_queue, s, s->get_fd(),
+                            "server", m_max_queue_size))
+        m_dropped_disconnections++;
     notify(m_on_server_disconnect_link);
 }
 
@@ -564,11 +830,36 @@ void EventListener::run_imp()
     {
         //Wait ~100ms, and check events (this allow to EventListener::join
         // even if nothing happens)
+        const auto wait_start = std::chrono::steady_clock::now();
         m_poller->wait_for_events(100);
+        const auto process_start = std::chrono::steady_clock::now();
+        m_wait_time.add(std::chrono::duration_cast<std::chrono::nanoseconds>
+                        (process_start - wait_start).count());
+        m_wake_ups.add();
 
         Poller::Event e;
         while (m_poller->next_event(e))
         {
+#ifndef SEDNL_WINDOWS
+            //inject() woke us up : its data is processed below
+            if (e.fd == m_wake_pipe[0])
+            {
+                char buf[64];
+                while (read(m_wake_pipe[0], buf, sizeof(buf)) > 0)
+                    ;
+                continue;
+            }
+#endif /* !SEDNL_WINDOWS */
+
+            //MSG_ZEROCOPY notifications are reported as errors
+            if (e.is_error)
+            {
+                if (is_server(e.fd) || !reap_zerocopy(e.fd))
+                    e.is_close = true;
+                else if (!e.is_read)
+                    continue;
+            }
+
             //An error occured or the connection was closed
             if (e.is_close)
             {
@@ -583,9 +874,8 @@ void EventListener::run_imp()
             if (!e.is_read)
             {
 #ifndef SEDNL_NOWARN
-                std::cerr << "Warning: "
-                          << "epoll_wait() returned a non EPOLLIN event."
-                          << std::endl;
+                SEDNL_DIAGNOSTIC(Warning, "EventListener::poller_event",
+                                 "epoll_wait() returned a non EPOLLIN event.");
 #endif /* !SEDNL_NOWARN */
                 continue;
             }
@@ -605,11 +895,32 @@ void EventListener::run_imp()
                 continue;
             }
         }
+
+        process_injected();
+
+        //Answers to control events the sockets didn't accept yet
+        for (auto it = m_unflushed.begin(); it != m_unflushed.end();)
+        {
+            if ((*it)->flush_output())
+                it = m_unflushed.erase(it);
+            else
+                ++it;
+        }
+
+        m_process_time.add(std::chrono::duration_cast<std::chrono::nanoseconds>
+                           (std::chrono::steady_clock::now() - process_start).count());
     }
 
-    //Close all connections (and create events)
-    for (auto cn : m_internal_connections)
-        cn.second->disconnect();
+    //Close all connections (and create events). Connection::disconnect()
+    // removes the connection from m_internal_connections.
+    while (!m_internal_connections.empty())
+    {
+        auto it = m_internal_connections.begin();
+        const FileDescriptor fd = it->first;
+        std::shared_ptr<Connection> cn = it->second;
+        cn->disconnect();
+        m_internal_connections.erase(fd);
+    }
 
     //Join consumer threads
     for (auto consumer : m_consumers)
@@ -617,6 +928,10 @@ void EventListener::run_imp()
 
     //Release resources
     m_poller.release();
+    m_unflushed.clear();
+    Injection injection;
+    while (m_injected.pop(injection))
+        ;
     m_internal_connections.clear();
     clear_consumer_links();
 }
@@ -660,6 +975,99 @@ void EventListener::remove_consumer(EventConsumer* c) noexcept
     m_consumers.erase(it);
 }
 
+void EventListener::set_trusted(bool trusted) throw(EventException)
+{
+    if (m_running)
+        throw EventException(EventExceptionT::EventListenerRunning);
+    m_trusted = trusted;
+}
+
+void EventListener::set_latency_tracking(bool enable) throw(EventException)
+{
+    if (m_running)
+        throw EventException(EventExceptionT::EventListenerRunning);
+    m_latency_tracking = enable;
+}
+
+void EventListener::set_capture(const std::string& path) throw(EventException)
+{
+    if (m_running)
+        throw EventException(EventExceptionT::EventListenerRunning);
+    m_capture.reset();
+    if (!path.empty())
+        m_capture.reset(new CaptureWriter(path));
+}
+
+void EventListener::inject(const std::shared_ptr<Connection>& connection,
+                           const char* data, unsigned int length)
+{
+    const UInt64 received_time = m_latency_tracking ? latency_clock() : 0;
+
+    //Nobody else uses the connections and the queues
+    if (!m_running)
+    {
+        process_injection(connection, data, length, received_time);
+        return;
+    }
+
+    //Don't get ahead of the listener thread
+    while (m_running && m_injected.size() >= INJECT_QUEUE_SIZE)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    Injection injection;
+    injection.connection = connection;
+    injection.data.assign(data, data + length);
+    injection.received_time = received_time;
+    if (!m_injected.push(injection))
+    {
+#ifndef SEDNL_NOWARN
+        SEDNL_DIAGNOSTIC(Error, "EventListener::lost_injection",
+                         "Failed to queue " << length << " injected bytes.");
+#endif /* !SEDNL_NOWARN */
+        return;
+    }
+
+#ifndef SEDNL_WINDOWS
+    //A full pipe already wakes the listener up
+    if (m_wake_pipe[1] >= 0)
+    {
+        const char wake = 0;
+        const ssize_t written = write(m_wake_pipe[1], &wake, sizeof(wake));
+        (void)written;
+    }
+#endif /* !SEDNL_WINDOWS */
+}
+
+void EventListener::process_injected()
+{
+    //Keep reading the sockets while data keeps being injected
+    Injection injection;
+    for (unsigned int i = 0;
+         i < INJECT_QUEUE_SIZE && m_injected.pop(injection); i++)
+        process_injection(injection.connection,
+                          reinterpret_cast<const char*>(injection.data.data()),
+                          injection.data.size(), injection.received_time);
+}
+
+void EventListener::process_injection(const std::shared_ptr<Connection>& connection,
+                                      const char* data, unsigned int length,
+                                      UInt64 received_time)
+{
+    //Like read_connection(), by pieces that fit in the ring buffer.
+    const unsigned int piece = 512;
+    while (length > 0)
+    {
+        const unsigned int size = std::min(length, piece);
+        if (!process_data(connection, data, size, received_time))
+        {
+            connection->m_buffer.reset();
+            return;
+        }
+        data += size;
+        length -= size;
+    }
+}
+
 void EventListener::add_consumer(EventConsumer* c) noexcept
 {
     if (m_running)
@@ -685,13 +1093,61 @@ void EventListener::notify(ConsumerDescriptor* desc) noexcept
     catch(std::exception &e)
     {
 #ifndef SEDNL_NOWARN
-        std::cerr << "Error: "
-                  << "Failed to notify the thread described by "
-                  << desc
-                  << std::endl;
-        std::cerr << "    " << e.what() << std::endl;
+        SEDNL_DIAGNOSTIC(Error, "EventListener::notify",
+                         "Failed to notify the thread described by "
+                         << static_cast<const void*>(desc)
+                         << "\n    " << e.what());
 #endif /* !SEDNL_NOWARN */
     }
 }
 
+EventListener::EventQueue& EventListener::event_queue(const std::string& name)
+{
+    auto it = m_events.find(name);
+    if (it != m_events.end())
+        return it->second;
+
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    return m_events[name];
+}
+
+template <class T>
+static inline
+QueueMetrics queue_metrics(const T& queue)
+{
+    QueueMetrics metrics;
+    metrics.depth = queue.size();
+    metrics.high_water_mark = queue.high_water_mark();
+    return metrics;
+}
+
+ListenerMetrics EventListener::get_metrics() const
+{
+    ListenerMetrics metrics;
+
+    metrics.events = m_event_counters.snapshot();
+    {
+        std::lock_guard<std::mutex> lock(m_metrics_mutex);
+        for (auto& pair : m_events)
+            metrics.queues[pair.first] = queue_metrics(pair.second);
+    }
+
+    metrics.disconnected_queue = queue_metrics(m_disconnected_queue);
+    metrics.server_disconnected_queue = queue_metrics(m_server_disconnected_queue);
+
+    metrics.bytes_in = m_bytes_in.get();
+    metrics.events_in = m_events_in.get();
+    metrics.accepts = m_accepts.get();
+    metrics.disconnects = m_disconnects;
+    metrics.dropped_queue_full = m_dropped_queue_full.get();
+    metrics.dropped_disconnections = m_dropped_disconnections;
+    metrics.dropped_invalid_packets = m_dropped_invalid_packets.get();
+    metrics.failed_accepts = m_failed_accepts.get();
+    metrics.wait_time = std::chrono::nanoseconds(m_wait_time.get());
+    metrics.process_time = std::chrono::nanoseconds(m_process_time.get());
+    metrics.wake_ups = m_wake_ups.get();
+
+    return metrics;
+}
+
 } // namespace SedNL
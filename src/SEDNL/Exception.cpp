@@ -48,6 +48,8 @@ const char* TemplateException<NetworkExceptionT>::what() const noexcept
         return "Can't set socket mode to nonblocking.";
     case NetworkExceptionT::TimedOut:
         return "Connection timed out.";
+    case NetworkExceptionT::FrameTooLarge:
+        return "The event is too large to be sent in a single frame.";
     default:
         return "Unknown exception.";
     }
@@ -93,10 +95,18 @@ const char* TemplateException<PacketExceptionT>::what() const noexcept
         return "The next element of this packet is a Float.";
     case PacketExceptionT::DoubleExpected:
         return "The next element of this packet is a Double.";
+    case PacketExceptionT::VarIntExpected:
+        return "The next element of this packet is a VarInt.";
+    case PacketExceptionT::VarUIntExpected:
+        return "The next element of this packet is a VarUInt.";
     case PacketExceptionT::StringExpected:
         return "The next element of this packet is a String.";
+    case PacketExceptionT::BlobExpected:
+        return "The next element of this packet is a Blob.";
     case PacketExceptionT::ObjectExpected:
         return "The next element of this packet is an Object.";
+    case PacketExceptionT::ObjectArrayExpected:
+        return "The next element of this packet is an ObjectArray.";
 
     case PacketExceptionT::ArrayUInt8Expected:
         return "The next element of this packet is an ArrayUInt8.";
@@ -125,8 +135,24 @@ const char* TemplateException<PacketExceptionT>::what() const noexcept
     case PacketExceptionT::WrongSizedObject:
         return "The object stored in this packet doesn't mach the size"
             " of your object.";
+    case PacketExceptionT::SchemaMismatch:
+        return "The types of the members of the schema object stored in"
+            " this packet doesn't match the ones of your object.";
     case PacketExceptionT::WrongArray:
         return "Empty array or array too big.";
+    case PacketExceptionT::NoSuchField:
+        return "The packet (or the object) doesn't have this field.";
+    case PacketExceptionT::Truncated:
+        return "The packet ends in the middle of the data read.";
+    case PacketExceptionT::VarIntOverflow:
+        return "The varint read doesn't fit in the integer type.";
+    case PacketExceptionT::UnknownObject:
+        return "The changes read are relative to a state of the object"
+            " which is unknown.";
+    case PacketExceptionT::EndOfPacket:
+        return "The end of the packet was reached.";
+    case PacketExceptionT::TrailingData:
+        return "The packet has more elements than the ones read.";
     default:
         return "Unknown exception";
     }
@@ -154,6 +180,10 @@ const char* TemplateException<EventExceptionT>::what() const noexcept
     case EventExceptionT::PollerAddFailed:
         return "Failed to register filedescriptors into the Poller"
             " (epoll, select, WSAPoll).";
+    case EventExceptionT::CaptureFailed:
+        return "Failed to create, map or extend the capture file.";
+    case EventExceptionT::InvalidCapture:
+        return "The file isn't a SedNL capture file.";
     default:
         return "Unknown exception.";
     }
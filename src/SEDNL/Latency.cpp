@@ -0,0 +1,74 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+#include "SEDNL/Latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SedNL
+{
+
+UInt64 LatencyHistogram::bucket_max(unsigned int bucket) noexcept
+{
+    if (bucket < 8)
+        return bucket;
+
+    const unsigned int exponent = bucket / 8 + 2;
+    const UInt64 sub = bucket % 8;
+    return ((8 + sub + 1) << (exponent - 3)) - 1;
+}
+
+UInt64 LatencyHistogram::percentile(double q) const noexcept
+{
+    UInt64 counts[BUCKETS];
+    UInt64 total = 0;
+    for (unsigned int i = 0; i < BUCKETS; i++)
+        total += counts[i] = m_buckets[i].get();
+    if (total == 0)
+        return 0;
+
+    //Rank of the measure, from 1
+    const UInt64 rank = std::max<UInt64>(1, std::ceil(q * total));
+    UInt64 seen = 0;
+    for (unsigned int i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(bucket_max(i), m_max.get());
+    }
+    return m_max.get();
+}
+
+LatencyStats LatencyHistogram::stats() const noexcept
+{
+    LatencyStats stats;
+    for (unsigned int i = 0; i < BUCKETS; i++)
+        stats.count += m_buckets[i].get();
+    stats.p50 = std::chrono::nanoseconds(percentile(0.5));
+    stats.p99 = std::chrono::nanoseconds(percentile(0.99));
+    stats.p999 = std::chrono::nanoseconds(percentile(0.999));
+    stats.max = std::chrono::nanoseconds(m_max.get());
+    return stats;
+}
+
+} // namespace SedNL
@@ -21,19 +21,120 @@
 
 #include "SEDNL/Packet.hpp"
 #include "SEDNL/SocketHelp.hpp"
+#include "SEDNL/ByteSwap.hpp"
+#include "SEDNL/DeltaCoding.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 
 namespace SedNL
 {
 
 Packet::Packet()
+    :m_array_encoding(ArrayEncoding::Network),
+     m_string_encoding(StringEncoding::Terminated),
+     m_object_encoding(ObjectEncoding::Tagged),
+     m_has_native_arrays(false)
 {}
 
-bool Packet::valid_next_item(unsigned int size, unsigned int& i) noexcept
+//Info byte of native arrays
+#define NATIVE_BIG_ENDIAN   0x80
+#define NATIVE_PADDING_MASK 0x07
+
+//Native array types are the array types with the bit 0x20 set,
+// delta array types the integer array types with the bit 0x40 set.
+static inline
+Packet::Type network_array_type(Packet::Type t) noexcept
+{
+    return static_cast<Packet::Type>(static_cast<int>(t) & ~0x60);
+}
+
+static inline
+bool is_delta_array(Packet::Type t) noexcept
+{
+    switch (t)
+    {
+    case Packet::Type::DeltaArrayInt16:
+    case Packet::Type::DeltaArrayUInt16:
+    case Packet::Type::DeltaArrayInt32:
+    case Packet::Type::DeltaArrayUInt32:
+    case Packet::Type::DeltaArrayInt64:
+    case Packet::Type::DeltaArrayUInt64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//Delta array type of an array type, or Unknown if there is none.
+static inline
+Packet::Type delta_array_type(Packet::Type t) noexcept
+{
+    const auto delta = static_cast<Packet::Type>(static_cast<int>(t) | 0x40);
+    return is_delta_array(delta) ? delta : Packet::Type::Unknown;
+}
+
+static inline
+bool is_native_array(Packet::Type t) noexcept
+{
+    switch (t)
+    {
+    case Packet::Type::NativeArrayInt8:
+    case Packet::Type::NativeArrayUInt8:
+    case Packet::Type::NativeArrayInt16:
+    case Packet::Type::NativeArrayUInt16:
+    case Packet::Type::NativeArrayInt32:
+    case Packet::Type::NativeArrayUInt32:
+    case Packet::Type::NativeArrayFloat:
+    case Packet::Type::NativeArrayInt64:
+    case Packet::Type::NativeArrayUInt64:
+    case Packet::Type::NativeArrayDouble:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//Size of the elements of an array type (native or not), or 0.
+static inline
+unsigned int array_element_size(Packet::Type t) noexcept
+{
+    switch (network_array_type(t))
+    {
+    case Packet::Type::ArrayInt8:
+    case Packet::Type::ArrayUInt8:
+        return sizeof(UInt8);
+    case Packet::Type::ArrayInt16:
+    case Packet::Type::ArrayUInt16:
+        return sizeof(UInt16);
+    case Packet::Type::ArrayInt32:
+    case Packet::Type::ArrayUInt32:
+    case Packet::Type::ArrayFloat:
+        return sizeof(UInt32);
+    case Packet::Type::ArrayInt64:
+    case Packet::Type::ArrayUInt64:
+    case Packet::Type::ArrayDouble:
+        return sizeof(UInt64);
+    default:
+        return 0;
+    }
+}
+
+bool Packet::valid_next_item(unsigned int size, unsigned int& i,
+                             Index* index) const
 {
     Type t = static_cast<Type>(m_data[i]);
 
+    //Position of this item in the index
+    std::size_t item = 0;
+    if (index)
+    {
+        item = index->items.size();
+        index->items.push_back(Index::Item{i, 0, 0});
+    }
+
     switch(t)
     {
     case Type::Int8:
@@ -66,15 +167,94 @@ bool Packet::valid_next_item(unsigned int size, unsigned int& i) noexcept
     case Type::Double:
         i += sizeof(UInt64);
         break;
+    case Type::VarInt:
+    case Type::VarUInt:
+    {
+        UInt64 v;
+        const unsigned int length = __front_varint(i + 1, m_data, v);
+        if (length == 0)
+            return false;
+        i += length;
+        break;
+    }
     case Type::String:
     {
         i++;
-        while (m_data[i] != '\0' && i < size)
+        while (i < size && m_data[i] != '\0')
             i++;
         if (i == size)
             return false;
         break;
     }
+    case Type::SizedString:
+    case Type::Blob:
+    {
+        //Jump directly to the last byte
+        UInt64 length;
+        const unsigned int varint = __front_varint(i + 1, m_data, length);
+        if (varint == 0 || length >= size || i + varint + length >= size)
+            return false;
+        i += varint + length;
+        break;
+    }
+
+    case Type::SchemaObject:
+    {
+        //Members can't be validated without their types :
+        // jump directly to the last byte
+        if (i + sizeof(UInt16) >= size)
+            return false;
+        UInt64 length;
+        const unsigned int varint =
+            __front_varint(i + 1 + sizeof(UInt16), m_data, length);
+        if (varint == 0 || length >= size
+            || i + sizeof(UInt16) + varint + length >= size)
+            return false;
+        i += sizeof(UInt16) + varint + length;
+        break;
+    }
+
+    case Type::ObjectArray:
+    {
+        i++;
+        if (i + sizeof(UInt16) + sizeof(UInt8) > size)
+            return false;
+        const unsigned short count = __front_16(i, m_data);
+        const unsigned short fields = m_data[i + sizeof(UInt16)];
+        i += sizeof(UInt16) + sizeof(UInt8);
+        if (i + fields > size)
+            return false;
+        const unsigned int kinds = i;
+        i += fields;
+
+        //Columns aren't indexed, like the members of schema objects
+        for (int j = 0; j < fields; j++)
+        {
+            unsigned int items;
+            switch (m_data[kinds + j])
+            {
+            case SEDNL_COLUMN_PACKED:
+                items = 1;
+                break;
+            case SEDNL_COLUMN_ITEMS:
+                items = count;
+                break;
+            default:
+                return false;
+            }
+            for (unsigned int k = 0; k < items; k++)
+            {
+                if (i >= size)
+                    return false;
+                if (!valid_next_item(size, i))
+                    return false;
+                i++;
+            }
+        }
+        //Because of the for i++ :
+        i--;
+        break;
+    }
 
     case Type::Object:
     {
@@ -85,14 +265,40 @@ bool Packet::valid_next_item(unsigned int size, unsigned int& i) noexcept
         unsigned short length = static_cast<unsigned char>(m_data[i]);
         i += sizeof(UInt8);
 
+        //Each member takes at least one byte
+        if (length > size - i)
+            return false;
+
         for (int j = 0; j < length; j++)
         {
-            if (!valid_next_item(size, i))
+            if (i >= size)
+                return false;
+            if (!valid_next_item(size, i, index))
                 return false;
             i++;
         }
         //Because of the for i++ :
         i--;
+
+        //Members are indexed once they are all valid, so the length
+        // of invalid (nested) objects doesn't reserve memory. Each
+        // member is followed by the item starting at its end.
+        if (index)
+        {
+            const auto& items = index->items;
+            index->items[item].members = index->members.size();
+            std::size_t member = item + 1;
+            for (int j = 0; j < length; j++)
+            {
+                index->members.push_back(member);
+                member = std::lower_bound(items.begin() + member + 1,
+                                          items.end(), items[member].end,
+                                          [](const Index::Item& it,
+                                             unsigned int offset)
+                                          { return it.offset < offset; })
+                    - items.begin();
+            }
+        }
         break;
     }
 
@@ -143,9 +349,67 @@ bool Packet::valid_next_item(unsigned int size, unsigned int& i) noexcept
         i--;
         break;
     }
+
+    case Type::NativeArrayInt8:
+    case Type::NativeArrayUInt8:
+    case Type::NativeArrayInt16:
+    case Type::NativeArrayUInt16:
+    case Type::NativeArrayInt32:
+    case Type::NativeArrayUInt32:
+    case Type::NativeArrayFloat:
+    case Type::NativeArrayInt64:
+    case Type::NativeArrayUInt64:
+    case Type::NativeArrayDouble:
+    {
+        i++;
+        if (i + sizeof(UInt16) + sizeof(UInt8) > size)
+            return false;
+        unsigned short length = __front_16(i, m_data);
+        i += sizeof(UInt16);
+
+        //Info byte and padding
+        i += sizeof(UInt8) + (m_data[i] & NATIVE_PADDING_MASK);
+        i += length * array_element_size(t);
+
+        // See arrays.
+        i--;
+        break;
+    }
+
+    case Type::DeltaArrayInt16:
+    case Type::DeltaArrayUInt16:
+    case Type::DeltaArrayInt32:
+    case Type::DeltaArrayUInt32:
+    case Type::DeltaArrayInt64:
+    case Type::DeltaArrayUInt64:
+    {
+        i++;
+        if (i + sizeof(UInt16) > size)
+            return false;
+        unsigned short length = __front_16(i, m_data);
+        i += sizeof(UInt16);
+
+        std::size_t encoded = 0;
+        if (length && (i >= size
+                       || !__delta_length(&m_data[i], size - i, length,
+                                          array_element_size(t), encoded)))
+            return false;
+        i += encoded;
+
+        // See arrays.
+        i--;
+        break;
+    }
     default:
         return false;
     }
+
+    //The last byte of the item must be in the packet
+    if (i >= size)
+        return false;
+
+    if (index)
+        index->items[item].end = i + 1;
     return true;
 }
 
@@ -153,16 +417,40 @@ bool Packet::is_valid() noexcept
 {
     unsigned int size = m_data.size();
 
-    unsigned int i = 0;
-    for (; i < size; i++)
+    m_index.clear();
+
+    try
     {
-        if (!valid_next_item(size, i))
+        unsigned int i = 0;
+        for (; i < size; i++)
+        {
+            m_index.fields.push_back(m_index.items.size());
+            if (!valid_next_item(size, i, &m_index))
+            {
+                m_index.clear();
+                return false;
+            }
+        }
+
+        if (i != size)
+        {
+            m_index.clear();
             return false;
+        }
     }
+    catch (std::bad_alloc&)
+    {
+        //Validate without the index
+        m_index.clear();
 
-    if (i != size)
-        return false;
+        unsigned int i = 0;
+        for (; i < size; i++)
+            if (!valid_next_item(size, i))
+                return false;
+        return i == size;
+    }
 
+    m_index.size = size;
     return true;
 }
 
@@ -259,103 +547,282 @@ Packet& Packet::operator<< <double>(double dt)
     return *this;
 }
 
+void Packet::write_sized(Type type, const void* data, std::size_t size)
+{
+    const Byte* const bytes = static_cast<const Byte*>(data);
+    m_data.push_back(static_cast<Byte>(type));
+    __push_varint(m_data, size);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
 template<>
 Packet& Packet::operator<< <const char*>(const char* dt)
 {
+    if (m_string_encoding == StringEncoding::Sized)
+    {
+        write_sized(Type::SizedString, dt, strlen(dt));
+        return *this;
+    }
+
     m_data.push_back(static_cast<Byte>(Type::String));
-    while (*dt != 0)
-        m_data.push_back(*dt++);
-    m_data.push_back('\0');
+    //Also copy the '\0'
+    m_data.insert(m_data.end(), dt, dt + strlen(dt) + 1);
     return *this;
 }
 
-template<>
-Packet& Packet::operator<< <std::string>(std::string dt)
+Packet& Packet::operator<< (const std::string& dt)
 {
+    //Keep the '\0' inside the string
+    if (m_string_encoding == StringEncoding::Sized)
+    {
+        write_sized(Type::SizedString, dt.data(), dt.size());
+        return *this;
+    }
+
     return (*this) << dt.c_str();
 }
 
-#define __array(fct, cast_type, type)                           \
+Packet& Packet::operator<< (const Blob& dt)
+{
+    write_sized(Type::Blob, dt.data.data(), dt.data.size());
+    return *this;
+}
+
+Packet& Packet::operator<< (const StringView& dt)
+{
+    write_sized(Type::SizedString, dt.data(), dt.size());
+    return *this;
+}
+
+#define __array_header(type)                                    \
     if (static_cast<UInt16>(dt.size()) != dt.size())            \
         throw PacketException(PacketExceptionT::WrongArray);    \
                                                                 \
     m_data.push_back(static_cast<Byte>(type));                  \
     __push_16(m_data, static_cast<UInt16>(dt.size()));          \
-                                                                \
-    for (auto elm : dt)                                         \
-        fct(m_data, reinterpret_cast<cast_type&>(elm));         \
 
-template<typename T, typename S>
-inline
-void __push_8(std::vector<T>& data, S elm)
+void Packet::write_native_array(Type type, const void* data,
+                                std::size_t count, std::size_t size)
 {
-    data.push_back(static_cast<T>(elm));
+    if (static_cast<UInt16>(count) != count)
+        throw PacketException(PacketExceptionT::WrongArray);
+
+    //Elements are aligned on their size, from the begining of the
+    // packet data (allocated memory is always aligned enough).
+    const std::size_t header = m_data.size() + 1 + sizeof(UInt16) + sizeof(UInt8);
+    const unsigned int padding = (size - header % size) % size;
+
+    m_data.push_back(static_cast<Byte>(type) | 0x20);
+    __push_16(m_data, static_cast<UInt16>(count));
+    m_data.push_back((__is_big_endian() ? NATIVE_BIG_ENDIAN : 0) | padding);
+    m_data.insert(m_data.end(), padding, 0);
+
+    const Byte* const bytes = static_cast<const Byte*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + count * size);
+    m_has_native_arrays = true;
+}
+
+void Packet::write_delta_array(Type type, const void* data,
+                               std::size_t count, std::size_t size)
+{
+    m_data.push_back(static_cast<Byte>(type));
+    __push_16(m_data, static_cast<UInt16>(count));
+
+    const std::size_t idx = m_data.size();
+    m_data.resize(idx + __delta_max_length(count, size));
+    const std::size_t encoded = count ? __delta_encode(&m_data[idx], data,
+                                                       count, size) : 0;
+    m_data.resize(idx + encoded);
+}
+
+Packet Packet::with_network_arrays() const
+{
+    Packet p;
+    p.m_data.reserve(m_data.size());
+
+    unsigned int i = 0;
+    const unsigned int size = m_data.size();
+    while (i < size)
+    {
+        const Type t = static_cast<Type>(m_data[i]);
+
+        //Objects only have a header : their fields follow.
+        if (const unsigned int header = container_header_size(i))
+        {
+            p.m_data.insert(p.m_data.end(),
+                            m_data.begin() + i, m_data.begin() + i + header);
+            i += header;
+        }
+        else if (is_native_array(t))
+        {
+            const unsigned short length = __front_16(i + 1, m_data);
+            const UInt8 info = m_data[i + 1 + sizeof(UInt16)];
+            const unsigned int elm_size = array_element_size(t);
+            const unsigned int start = i + 1 + sizeof(UInt16) + sizeof(UInt8)
+                + (info & NATIVE_PADDING_MASK);
+
+            p.m_data.push_back(static_cast<Byte>(network_array_type(t)));
+            __push_16(p.m_data, length);
+            const std::size_t idx = p.m_data.size();
+            p.m_data.resize(idx + length * elm_size);
+            if (length == 0)
+                ;
+            else if (!(info & NATIVE_BIG_ENDIAN))
+                __array_swap(&p.m_data[idx], &m_data[start], length, elm_size);
+            else
+                memcpy(&p.m_data[idx], &m_data[start], length * elm_size);
+
+            i = start + length * elm_size;
+        }
+        else
+        {
+            //valid_next_item stop on the last byte of the item.
+            const unsigned int begin = i;
+            if (!valid_next_item(size, i))
+                throw PacketException(PacketExceptionT::Unknown);
+            i++;
+            p.m_data.insert(p.m_data.end(),
+                            m_data.begin() + begin, m_data.begin() + i);
+        }
+    }
+
+    return p;
 }
 
+//Grow the buffer once, and convert the whole array in place.
+#define __array(cast_type, type)                                \
+    if (m_array_encoding == ArrayEncoding::Native)              \
+    {                                                           \
+        write_native_array(type, dt.data(), dt.size(),          \
+                           sizeof(cast_type));                  \
+        return *this;                                           \
+    }                                                           \
+    if (m_array_encoding == ArrayEncoding::Delta                \
+        && delta_array_type(type) != Type::Unknown)             \
+    {                                                           \
+        if (static_cast<UInt16>(dt.size()) != dt.size())        \
+            throw PacketException(PacketExceptionT::WrongArray);\
+        write_delta_array(delta_array_type(type), dt.data(),    \
+                          dt.size(), sizeof(cast_type));        \
+        return *this;                                           \
+    }                                                           \
+    __array_header(type);                                       \
+                                                                \
+    const std::size_t idx = m_data.size();                      \
+    m_data.resize(idx + dt.size() * sizeof(cast_type));         \
+    if (!dt.empty())                                            \
+        __array_to_network(&m_data[idx], dt.data(),             \
+                           dt.size(), sizeof(cast_type));       \
+
+//Bytes don't need any conversion.
+#define __array_8(type)                                         \
+    if (m_array_encoding == ArrayEncoding::Native)              \
+    {                                                           \
+        write_native_array(type, dt.data(), dt.size(), 1);      \
+        return *this;                                           \
+    }                                                           \
+    __array_header(type);                                       \
+    m_data.insert(m_data.end(), dt.begin(), dt.end());          \
+
 Packet& Packet::operator<< (const std::vector<char>& dt)
 {
-    __array(__push_8, Int8, Type::ArrayInt8);
+    __array_8(Type::ArrayInt8);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<Int8>& dt)
 {
-    __array(__push_8, Int8, Type::ArrayInt8);
+    __array_8(Type::ArrayInt8);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<UInt8>& dt)
 {
-    __array(__push_8, UInt8, Type::ArrayUInt8);
+    __array_8(Type::ArrayUInt8);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<Int16>& dt)
 {
-    __array(__push_16, Int16, Type::ArrayInt16);
+    __array(Int16, Type::ArrayInt16);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<UInt16>& dt)
 {
-    __array(__push_16, UInt16, Type::ArrayUInt16);
+    __array(UInt16, Type::ArrayUInt16);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<Int32>& dt)
 {
-    __array(__push_32, Int32, Type::ArrayInt32);
+    __array(Int32, Type::ArrayInt32);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<UInt32>& dt)
 {
-    __array(__push_32, UInt32, Type::ArrayUInt32);
+    __array(UInt32, Type::ArrayUInt32);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<Int64>& dt)
 {
-    __array(__push_64, Int64, Type::ArrayInt64);
+    __array(Int64, Type::ArrayInt64);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<UInt64>& dt)
 {
-    __array(__push_64, UInt64, Type::ArrayUInt64);
+    __array(UInt64, Type::ArrayUInt64);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<float>& dt)
 {
-    __array(__push_32, UInt32, Type::ArrayFloat);
+    __array(UInt32, Type::ArrayFloat);
     return *this;
 }
 
 Packet& Packet::operator<< (const std::vector<double>& dt)
 {
-    __array(__push_64, UInt64, Type::ArrayDouble);
+    __array(UInt64, Type::ArrayDouble);
+    return *this;
+}
+
+#define __varint(type)                                  \
+    m_data.push_back(static_cast<Byte>(type));          \
+    __push_varint(m_data, dt.encoded());                \
     return *this;
+
+Packet& Packet::operator<< (VarInt<Int16> dt)
+{
+    __varint(Type::VarInt);
+}
+
+Packet& Packet::operator<< (VarInt<Int32> dt)
+{
+    __varint(Type::VarInt);
+}
+
+Packet& Packet::operator<< (VarInt<Int64> dt)
+{
+    __varint(Type::VarInt);
+}
+
+Packet& Packet::operator<< (VarInt<UInt16> dt)
+{
+    __varint(Type::VarUInt);
+}
+
+Packet& Packet::operator<< (VarInt<UInt32> dt)
+{
+    __varint(Type::VarUInt);
+}
+
+Packet& Packet::operator<< (VarInt<UInt64> dt)
+{
+    __varint(Type::VarUInt);
 }
 
 ////////////
@@ -368,9 +835,18 @@ const ByteArray& Packet::get_data() const
 }
 
 //
-//Assert the packet isn't corrupted
+//Reads check the bounds of what they read, since packets from
+// trusted connections aren't validated (see Connection::set_trusted()).
 //
 
+//Throw if the item at \a idx has less than \a length bytes.
+static inline
+void check_length(const ByteArray& data, std::size_t idx, std::size_t length)
+{
+    if (idx + length > data.size())
+        throw PacketException(PacketExceptionT::Truncated);
+}
+
 #define __read(_fct, _type, _ptype)                                     \
     {                                                                   \
         if (m_p->m_data.size() <= m_idx)                                \
@@ -380,6 +856,7 @@ const ByteArray& Packet::get_data() const
                                                                         \
         if (type != _ptype)                                             \
             exception_by_type(type);                                    \
+        check_length(m_p->m_data, m_idx, 1 + sizeof(_type));           \
         m_idx++;                                                        \
                                                                         \
         auto dt_ = _fct(m_idx, m_p->m_data);                            \
@@ -389,68 +866,91 @@ const ByteArray& Packet::get_data() const
         return *this;                                                   \
     }
 
+//Error reported when an item of type \a type is found instead of
+// the one expected.
 static
-void exception_by_type(Packet::Type type)
+PacketExceptionT error_by_type(Packet::Type type) noexcept
 {
+    //Native and delta arrays are arrays for the user.
+    if (is_native_array(type) || is_delta_array(type))
+        type = network_array_type(type);
+
     switch(type)
     {
     case  Packet::Type::Int8:
-        throw PacketException(PacketExceptionT::Int8Expected);
+        return PacketExceptionT::Int8Expected;
     case Packet::Type::Int16:
-        throw PacketException(PacketExceptionT::Int16Expected);
+        return PacketExceptionT::Int16Expected;
     case Packet::Type::Int32:
-        throw PacketException(PacketExceptionT::Int32Expected);
+        return PacketExceptionT::Int32Expected;
     case Packet::Type::Int64:
-        throw PacketException(PacketExceptionT::Int64Expected);
+        return PacketExceptionT::Int64Expected;
 
     case Packet::Type::UInt8:
-        throw PacketException(PacketExceptionT::UInt8Expected);
+        return PacketExceptionT::UInt8Expected;
     case Packet::Type::UInt16:
-        throw PacketException(PacketExceptionT::UInt16Expected);
+        return PacketExceptionT::UInt16Expected;
     case Packet::Type::UInt32:
-        throw PacketException(PacketExceptionT::UInt32Expected);
+        return PacketExceptionT::UInt32Expected;
     case Packet::Type::UInt64:
-        throw PacketException(PacketExceptionT::UInt64Expected);
+        return PacketExceptionT::UInt64Expected;
 
     case Packet::Type::Float:
-        throw PacketException(PacketExceptionT::FloatExpected);
+        return PacketExceptionT::FloatExpected;
     case Packet::Type::Double:
-        throw PacketException(PacketExceptionT::DoubleExpected);
+        return PacketExceptionT::DoubleExpected;
+
+    case Packet::Type::VarInt:
+        return PacketExceptionT::VarIntExpected;
+    case Packet::Type::VarUInt:
+        return PacketExceptionT::VarUIntExpected;
 
     case Packet::Type::ArrayInt8:
-        throw PacketException(PacketExceptionT::ArrayInt8Expected);
+        return PacketExceptionT::ArrayInt8Expected;
     case Packet::Type::ArrayInt16:
-        throw PacketException(PacketExceptionT::ArrayInt16Expected);
+        return PacketExceptionT::ArrayInt16Expected;
     case Packet::Type::ArrayInt32:
-        throw PacketException(PacketExceptionT::ArrayInt32Expected);
+        return PacketExceptionT::ArrayInt32Expected;
     case Packet::Type::ArrayInt64:
-        throw PacketException(PacketExceptionT::ArrayInt64Expected);
+        return PacketExceptionT::ArrayInt64Expected;
 
     case Packet::Type::ArrayUInt8:
-        throw PacketException(PacketExceptionT::ArrayUInt8Expected);
+        return PacketExceptionT::ArrayUInt8Expected;
     case Packet::Type::ArrayUInt16:
-        throw PacketException(PacketExceptionT::ArrayUInt16Expected);
+        return PacketExceptionT::ArrayUInt16Expected;
     case Packet::Type::ArrayUInt32:
-        throw PacketException(PacketExceptionT::ArrayUInt32Expected);
+        return PacketExceptionT::ArrayUInt32Expected;
     case Packet::Type::ArrayUInt64:
-        throw PacketException(PacketExceptionT::ArrayUInt64Expected);
+        return PacketExceptionT::ArrayUInt64Expected;
 
     case Packet::Type::ArrayFloat:
-        throw PacketException(PacketExceptionT::ArrayFloatExpected);
+        return PacketExceptionT::ArrayFloatExpected;
     case Packet::Type::ArrayDouble:
-        throw PacketException(PacketExceptionT::ArrayDoubleExpected);
+        return PacketExceptionT::ArrayDoubleExpected;
 
     case Packet::Type::String:
-        throw PacketException(PacketExceptionT::StringExpected);
+    case Packet::Type::SizedString:
+        return PacketExceptionT::StringExpected;
+    case Packet::Type::Blob:
+        return PacketExceptionT::BlobExpected;
 
     case Packet::Type::Object:
-        throw PacketException(PacketExceptionT::ObjectExpected);
+    case Packet::Type::SchemaObject:
+        return PacketExceptionT::ObjectExpected;
+    case Packet::Type::ObjectArray:
+        return PacketExceptionT::ObjectArrayExpected;
 
     default:
-        throw PacketException(PacketExceptionT::Unknown);
+        return PacketExceptionT::Unknown;
     }
 }
 
+static
+void exception_by_type(Packet::Type type)
+{
+    throw PacketException(error_by_type(type));
+}
+
 static
 inline
 UInt8 __front_8(unsigned int index, const ByteArray& data)
@@ -468,6 +968,7 @@ PacketReader& PacketReader::operator>> <char> (char& dt)
 
     if (type != Packet::Type::Int8 && type != Packet::Type::UInt8)
         exception_by_type(type);
+    check_length(m_p->m_data, m_idx, 1 + sizeof(Int8));
     m_idx++;
 
     dt = static_cast<char>(__front_8(m_idx, m_p->m_data));
@@ -536,133 +1037,639 @@ PacketReader& PacketReader::operator>> <double> (double& dt)
     __read(__front_64, double, Packet::Type::Double);
 }
 
-template<>
-PacketReader& PacketReader::operator>> <std::string> (std::string& dt)
+bool PacketReader::read_sized(bool blob, StringView& dt)
+    throw(PacketException)
 {
     if (m_p->m_data.size() <= m_idx)
-        return *this;
+        return false;
 
     auto type = static_cast<Packet::Type>(m_p->m_data[m_idx]);
+    const char* const data =
+        reinterpret_cast<const char*>(m_p->m_data.data());
 
-    if (type != Packet::Type::String)
+    if (!blob && type == Packet::Type::String)
+    {
+        const auto begin = m_p->m_data.begin() + m_idx + 1;
+        const auto end = std::find(begin, m_p->m_data.end(), '\0');
+        if (end == m_p->m_data.end())
+            throw PacketException(PacketExceptionT::Truncated);
+
+        dt = StringView(data + m_idx + 1, end - begin);
+        m_idx = (end - m_p->m_data.begin()) + 1;
+        return true;
+    }
+
+    if (type != (blob ? Packet::Type::Blob : Packet::Type::SizedString))
         exception_by_type(type);
-    m_idx++;
 
-    std::string out;
-    while (m_p->m_data[m_idx] != '\0')
-        out.push_back(m_p->m_data[m_idx++]);
-    m_idx++;
+    UInt64 length;
+    const unsigned int varint = __front_varint(m_idx + 1, m_p->m_data, length);
+    if (varint == 0 || length > m_p->m_data.size())
+        throw PacketException(PacketExceptionT::Truncated);
+    check_length(m_p->m_data, m_idx + 1 + varint, length);
 
-    using std::swap;
-    swap(dt, out);
+    dt = StringView(data + m_idx + 1 + varint, length);
+    m_idx += 1 + varint + length;
+    return true;
+}
 
+template<>
+PacketReader& PacketReader::operator>> <std::string> (std::string& dt)
+{
+    StringView view;
+    if (read_sized(false, view))
+        dt.assign(view.data(), view.size());
     return *this;
 }
 
-#define __read_array(fct, cast_type, packet_type)                       \
-    if (m_p->m_data.size() <= m_idx)                                    \
-        return *this;                                                   \
-                                                                        \
-    auto type = static_cast<Packet::Type>(m_p->m_data[m_idx]);          \
-                                                                        \
-    if (type != packet_type)                                            \
-        exception_by_type(type);                                        \
-    m_idx++;                                                            \
-                                                                        \
-    unsigned short length = __front_16(m_idx, m_p->m_data);             \
-    m_idx += sizeof(UInt16);                                            \
-                                                                        \
-    dt.clear();                                                         \
-    for (int i = 0; i < length; i++)                                    \
-    {                                                                   \
-        auto t = fct(m_idx, m_p->m_data);                               \
-        dt.push_back(reinterpret_cast<cast_type&>(t));                  \
-        m_idx += sizeof(cast_type);                                     \
-    }                                                                   \
-                                                                        \
+PacketReader& PacketReader::operator>> (StringView& dt)
+{
+    //A view over a blob is also allowed
+    if (next_type() == Packet::Type::Blob)
+        read_sized(true, dt);
+    else
+        read_sized(false, dt);
     return *this;
+}
 
+PacketReader& PacketReader::operator>> (Blob& dt)
+{
+    StringView view;
+    if (read_sized(true, view))
+        dt.data.assign(view.begin(), view.end());
+    return *this;
+}
 
-PacketReader& PacketReader::operator>> (std::vector<char>& dt)
+const Byte* PacketReader::read_array(Packet::Type type, Packet::Type alt,
+                                     unsigned short& length, bool& swap)
+    throw(PacketException)
 {
     if (m_p->m_data.size() <= m_idx)
-        return *this;
+        return nullptr;
 
-    auto type = static_cast<Packet::Type>(m_p->m_data[m_idx]);
+    const Packet::Type found = static_cast<Packet::Type>(m_p->m_data[m_idx]);
+    const Packet::Type network_type = network_array_type(found);
 
-    if (type != Packet::Type::ArrayInt8 && type != Packet::Type::ArrayUInt8)
-        exception_by_type(type);
-    m_idx++;
+    if (network_type != type && network_type != alt)
+        exception_by_type(found);
 
-    unsigned short length = __front_16(m_idx, m_p->m_data);
-    m_idx += sizeof(UInt16);
+    const bool native = is_native_array(found);
+    unsigned int idx = m_idx + 1;
+    check_length(m_p->m_data, idx, sizeof(UInt16) + (native ? 1 : 0));
 
-    dt.clear();
-    for (int i = 0; i < length; i++)
+    length = __front_16(idx, m_p->m_data);
+    idx += sizeof(UInt16);
+
+    if (native)
     {
-        dt.push_back(static_cast<char>(m_p->m_data[m_idx]));
-        m_idx += sizeof(UInt8);
+        const UInt8 info = m_p->m_data[idx];
+        swap = static_cast<bool>(info & NATIVE_BIG_ENDIAN) != __is_big_endian();
+        idx += sizeof(UInt8) + (info & NATIVE_PADDING_MASK);
     }
+    else
+        swap = !__is_big_endian();
+
+    const unsigned int data_length = length * array_element_size(found);
+    check_length(m_p->m_data, idx, data_length);
+
+    const Byte* const data = m_p->m_data.data() + idx;
+    m_idx = idx + data_length;
+    return data;
+}
+
+const Byte* PacketReader::read_delta_array(Packet::Type type, Packet::Type alt,
+                                           unsigned short& length,
+                                           std::size_t& available)
+    throw(PacketException)
+{
+    const Packet::Type found = static_cast<Packet::Type>(m_p->m_data[m_idx]);
+    const Packet::Type network_type = network_array_type(found);
+
+    if (network_type != type && network_type != alt)
+        exception_by_type(found);
+
+    unsigned int idx = m_idx + 1;
+    check_length(m_p->m_data, idx, sizeof(UInt16));
+    length = __front_16(idx, m_p->m_data);
+    idx += sizeof(UInt16);
+
+    //The decoder checks the bounds, and the caller moves m_idx.
+    available = m_p->m_data.size() - idx;
+    return m_p->m_data.data() + idx;
+}
+
+//Decode the delta array at \a src into \a dt, and move \a idx after it.
+template<typename T>
+static inline
+void decode_delta_array(std::vector<T>& dt, const Byte* src,
+                        std::size_t available, unsigned short length,
+                        const ByteArray& data, unsigned int& idx)
+{
+    std::size_t read = 0;
+    dt.resize(length);
+    if (length && !__delta_decode(dt.data(), src, available, length,
+                                  sizeof(T), read))
+        throw PacketException(PacketExceptionT::Truncated);
+    idx = (src - data.data()) + read;
+}
 
+#define __read_array(cast_type, packet_type, alt_type)                 \
+    unsigned short length;                                              \
+    if (is_delta_array(next_type()))                                    \
+    {                                                                   \
+        std::size_t available;                                          \
+        const Byte* const src = read_delta_array(packet_type, alt_type, \
+                                                 length, available);    \
+        decode_delta_array(dt, src, available, length,                  \
+                           m_p->m_data, m_idx);                         \
+        return *this;                                                   \
+    }                                                                   \
+    bool swap;                                                          \
+    const Byte* const src = read_array(packet_type, alt_type,          \
+                                       length, swap);                   \
+    if (!src)                                                           \
+        return *this;                                                   \
+                                                                        \
+    dt.resize(length);                                                  \
+    if (length && swap)                                                 \
+        __array_swap(dt.data(), src, length, sizeof(cast_type));        \
+    else if (length)                                                    \
+        memcpy(dt.data(), src, length * sizeof(cast_type));             \
+                                                                        \
     return *this;
+
+
+PacketReader& PacketReader::operator>> (std::vector<char>& dt)
+{
+    __read_array(char, Packet::Type::ArrayInt8, Packet::Type::ArrayUInt8);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<UInt8>& dt)
 {
-    __read_array(__front_8, UInt8, Packet::Type::ArrayUInt8);
+    __read_array(UInt8, Packet::Type::ArrayUInt8, Packet::Type::ArrayUInt8);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<Int8>& dt)
 {
-    __read_array(__front_8, Int8, Packet::Type::ArrayInt8);
+    __read_array(Int8, Packet::Type::ArrayInt8, Packet::Type::ArrayInt8);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<UInt16>& dt)
 {
-    __read_array(__front_16, UInt16, Packet::Type::ArrayUInt16);
+    __read_array(UInt16, Packet::Type::ArrayUInt16, Packet::Type::ArrayUInt16);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<Int16>& dt)
 {
-    __read_array(__front_16, Int16, Packet::Type::ArrayInt16);
+    __read_array(Int16, Packet::Type::ArrayInt16, Packet::Type::ArrayInt16);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<UInt32>& dt)
 {
-    __read_array(__front_32, UInt32, Packet::Type::ArrayUInt32);
+    __read_array(UInt32, Packet::Type::ArrayUInt32, Packet::Type::ArrayUInt32);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<Int32>& dt)
 {
-    __read_array(__front_32, Int32, Packet::Type::ArrayInt32);
+    __read_array(Int32, Packet::Type::ArrayInt32, Packet::Type::ArrayInt32);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<UInt64>& dt)
 {
-    __read_array(__front_64, UInt64, Packet::Type::ArrayUInt64);
+    __read_array(UInt64, Packet::Type::ArrayUInt64, Packet::Type::ArrayUInt64);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<Int64>& dt)
 {
-    __read_array(__front_64, Int64, Packet::Type::ArrayInt64);
+    __read_array(Int64, Packet::Type::ArrayInt64, Packet::Type::ArrayInt64);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<float>& dt)
 {
-    __read_array(__front_32, float, Packet::Type::ArrayFloat);
+    __read_array(float, Packet::Type::ArrayFloat, Packet::Type::ArrayFloat);
 }
 
 PacketReader& PacketReader::operator>> (std::vector<double>& dt)
 {
-    __read_array(__front_64, double, Packet::Type::ArrayDouble);
+    __read_array(double, Packet::Type::ArrayDouble, Packet::Type::ArrayDouble);
 }
 
-template<class T>
-static
-void show_array(std::ostream& os, std::vector<T> &v)
+bool PacketReader::read_varint(Packet::Type type, UInt64& encoded)
+    throw(PacketException)
 {
-    os << "{ ";
-    for (auto e : v)
+    if (m_p->m_data.size() <= m_idx)
+        return false;
+
+    auto found = static_cast<Packet::Type>(m_p->m_data[m_idx]);
+    if (found != type)
+        exception_by_type(found);
+
+    const unsigned int length = __front_varint(m_idx + 1, m_p->m_data, encoded);
+    if (length == 0)
+        throw PacketException(PacketExceptionT::Truncated);
+    m_idx += 1 + length;
+    return true;
+}
+
+//The reader isn't modified if the value doesn't fit.
+#define __read_varint(type)                                             \
+    const unsigned int idx = m_idx;                                     \
+    UInt64 encoded;                                                     \
+    if (read_varint(type, encoded) && !dt.decode(encoded))              \
+    {                                                                   \
+        m_idx = idx;                                                    \
+        throw PacketException(PacketExceptionT::VarIntOverflow);        \
+    }                                                                   \
+    return *this;
+
+PacketReader& PacketReader::operator>> (VarInt<Int16>& dt)
+{
+    __read_varint(Packet::Type::VarInt);
+}
+
+PacketReader& PacketReader::operator>> (VarInt<Int32>& dt)
+{
+    __read_varint(Packet::Type::VarInt);
+}
+
+PacketReader& PacketReader::operator>> (VarInt<Int64>& dt)
+{
+    __read_varint(Packet::Type::VarInt);
+}
+
+PacketReader& PacketReader::operator>> (VarInt<UInt16>& dt)
+{
+    __read_varint(Packet::Type::VarUInt);
+}
+
+PacketReader& PacketReader::operator>> (VarInt<UInt32>& dt)
+{
+    __read_varint(Packet::Type::VarUInt);
+}
+
+PacketReader& PacketReader::operator>> (VarInt<UInt64>& dt)
+{
+    __read_varint(Packet::Type::VarUInt);
+}
+
+//Array type matching each element type.
+template<typename T>
+struct ArrayType;
+
+#define __array_type(cast_type, packet_type)                           \
+    template<>                                                          \
+    struct ArrayType<cast_type>                                         \
+    {                                                                   \
+        static constexpr Packet::Type value = packet_type;              \
+    };
+
+__array_type(Int8, Packet::Type::ArrayInt8)
+__array_type(Int16, Packet::Type::ArrayInt16)
+__array_type(Int32, Packet::Type::ArrayInt32)
+__array_type(Int64, Packet::Type::ArrayInt64)
+__array_type(UInt8, Packet::Type::ArrayUInt8)
+__array_type(UInt16, Packet::Type::ArrayUInt16)
+__array_type(UInt32, Packet::Type::ArrayUInt32)
+__array_type(UInt64, Packet::Type::ArrayUInt64)
+__array_type(float, Packet::Type::ArrayFloat)
+__array_type(double, Packet::Type::ArrayDouble)
+
+#undef __array_type
+
+template<typename T>
+PacketReader& PacketReader::operator>> (ArrayView<T>& dt)
+{
+    unsigned short length;
+
+    //Delta arrays are always decoded
+    if (is_delta_array(next_type()))
+    {
+        std::size_t available;
+        const Byte* const src = read_delta_array(ArrayType<T>::value,
+                                                 ArrayType<T>::value,
+                                                 length, available);
+        decode_delta_array(dt.m_storage, src, available, length,
+                           m_p->m_data, m_idx);
+        dt.m_data = dt.m_storage.data();
+        dt.m_size = length;
+        return *this;
+    }
+
+    bool swap;
+    const Byte* const src = read_array(ArrayType<T>::value, ArrayType<T>::value,
+                                       length, swap);
+    if (!src)
+        return *this;
+
+    dt.m_size = length;
+    dt.m_storage.clear();
+
+    //Point directly into the packet
+    if (!swap && reinterpret_cast<std::uintptr_t>(src) % alignof(T) == 0)
+    {
+        dt.m_data = reinterpret_cast<const T*>(src);
+        return *this;
+    }
+
+    dt.m_storage.resize(length);
+    if (swap)
+        __array_swap(dt.m_storage.data(), src, length, sizeof(T));
+    else
+        memcpy(dt.m_storage.data(), src, length * sizeof(T));
+    dt.m_data = dt.m_storage.data();
+
+    return *this;
+}
+
+//! @cond Doxygen_Suppress
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<Int8>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<Int16>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<Int32>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<Int64>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<UInt8>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<UInt16>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<UInt32>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<UInt64>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<float>&);
+template SEDNL_API PacketReader& PacketReader::operator>> (ArrayView<double>&);
+//! @endcond
+
+bool PacketReader::fail(PacketExceptionT error) noexcept
+{
+    if (!m_failed)
+    {
+        m_failed = true;
+        m_error = error;
+    }
+    return false;
+}
+
+bool PacketReader::check_next(std::initializer_list<Packet::Type> types)
+    noexcept
+{
+    if (m_failed)
+        return false;
+
+    const unsigned int size = m_p->m_data.size();
+    if (m_idx >= size)
+        return fail(PacketExceptionT::EndOfPacket);
+
+    const Packet::Type found = next_type();
+    Packet::Type type = found;
+    if (is_native_array(type) || is_delta_array(type))
+        type = network_array_type(type);
+    if (std::find(types.begin(), types.end(), type) == types.end())
+        return fail(error_by_type(found));
+
+    //The items of a validated packet are complete
+    if (m_p->is_indexed())
+        return true;
+    unsigned int i = m_idx;
+    if (!m_p->valid_next_item(size, i))
+        return fail(PacketExceptionT::Truncated);
+    return true;
+}
+
+bool PacketReader::try_object_header(unsigned short length) noexcept
+{
+    if (!check_next({Packet::Type::Object}))
+        return false;
+
+    const UInt8 obj_length = static_cast<UInt8>(m_p->m_data[m_idx + 1]);
+    if (obj_length == 0)
+        return fail(PacketExceptionT::EmptyObject);
+    if (obj_length != length)
+        return fail(PacketExceptionT::WrongSizedObject);
+
+    m_idx += 2;
+    return true;
+}
+
+bool PacketReader::check_schema(UInt16 fingerprint) noexcept
+{
+    if (!check_next({Packet::Type::SchemaObject}))
+        return false;
+    if (__front_16(m_idx + 1, m_p->m_data) != fingerprint)
+        return fail(PacketExceptionT::SchemaMismatch);
+    return true;
+}
+
+//Once checked, the item can be read without exception.
+#define __try_read(...)                                                 \
+    if (!check_next({__VA_ARGS__}))                                     \
+        return false;                                                   \
+    *this >> dt;                                                        \
+    return true;
+
+template<>
+bool PacketReader::try_read<char> (char& dt)
+{
+    __try_read(Packet::Type::Int8, Packet::Type::UInt8);
+}
+
+template<>
+bool PacketReader::try_read<UInt8> (UInt8& dt)
+{
+    __try_read(Packet::Type::UInt8);
+}
+
+template<>
+bool PacketReader::try_read<Int8> (Int8& dt)
+{
+    __try_read(Packet::Type::Int8);
+}
+
+template<>
+bool PacketReader::try_read<UInt16> (UInt16& dt)
+{
+    __try_read(Packet::Type::UInt16);
+}
+
+template<>
+bool PacketReader::try_read<Int16> (Int16& dt)
+{
+    __try_read(Packet::Type::Int16);
+}
+
+template<>
+bool PacketReader::try_read<UInt32> (UInt32& dt)
+{
+    __try_read(Packet::Type::UInt32);
+}
+
+template<>
+bool PacketReader::try_read<Int32> (Int32& dt)
+{
+    __try_read(Packet::Type::Int32);
+}
+
+template<>
+bool PacketReader::try_read<UInt64> (UInt64& dt)
+{
+    __try_read(Packet::Type::UInt64);
+}
+
+template<>
+bool PacketReader::try_read<Int64> (Int64& dt)
+{
+    __try_read(Packet::Type::Int64);
+}
+
+template<>
+bool PacketReader::try_read<float> (float& dt)
+{
+    __try_read(Packet::Type::Float);
+}
+
+template<>
+bool PacketReader::try_read<double> (double& dt)
+{
+    __try_read(Packet::Type::Double);
+}
+
+template<>
+bool PacketReader::try_read<std::string> (std::string& dt)
+{
+    __try_read(Packet::Type::String, Packet::Type::SizedString);
+}
+
+bool PacketReader::try_read(StringView& dt)
+{
+    __try_read(Packet::Type::String, Packet::Type::SizedString,
+               Packet::Type::Blob);
+}
+
+bool PacketReader::try_read(Blob& dt)
+{
+    __try_read(Packet::Type::Blob);
+}
+
+bool PacketReader::try_read(std::vector<char>& dt)
+{
+    __try_read(Packet::Type::ArrayInt8, Packet::Type::ArrayUInt8);
+}
+
+bool PacketReader::try_read(std::vector<UInt8>& dt)
+{
+    __try_read(Packet::Type::ArrayUInt8);
+}
+
+bool PacketReader::try_read(std::vector<Int8>& dt)
+{
+    __try_read(Packet::Type::ArrayInt8);
+}
+
+bool PacketReader::try_read(std::vector<UInt16>& dt)
+{
+    __try_read(Packet::Type::ArrayUInt16);
+}
+
+bool PacketReader::try_read(std::vector<Int16>& dt)
+{
+    __try_read(Packet::Type::ArrayInt16);
+}
+
+bool PacketReader::try_read(std::vector<UInt32>& dt)
+{
+    __try_read(Packet::Type::ArrayUInt32);
+}
+
+bool PacketReader::try_read(std::vector<Int32>& dt)
+{
+    __try_read(Packet::Type::ArrayInt32);
+}
+
+bool PacketReader::try_read(std::vector<UInt64>& dt)
+{
+    __try_read(Packet::Type::ArrayUInt64);
+}
+
+bool PacketReader::try_read(std::vector<Int64>& dt)
+{
+    __try_read(Packet::Type::ArrayInt64);
+}
+
+bool PacketReader::try_read(std::vector<float>& dt)
+{
+    __try_read(Packet::Type::ArrayFloat);
+}
+
+bool PacketReader::try_read(std::vector<double>& dt)
+{
+    __try_read(Packet::Type::ArrayDouble);
+}
+
+template<typename T>
+bool PacketReader::try_read(ArrayView<T>& dt)
+{
+    __try_read(ArrayType<T>::value);
+}
+
+#undef __try_read
+
+//The value is decoded before reading it, to report the overflow.
+#define __try_read_varint(type)                                         \
+    if (!check_next({type}))                                            \
+        return false;                                                   \
+    UInt64 encoded;                                                     \
+    __front_varint(m_idx + 1, m_p->m_data, encoded);                    \
+    auto value = dt;                                                    \
+    if (!value.decode(encoded))                                         \
+        return fail(PacketExceptionT::VarIntOverflow);                  \
+    *this >> dt;                                                        \
+    return true;
+
+bool PacketReader::try_read(VarInt<Int16>& dt)
+{
+    __try_read_varint(Packet::Type::VarInt);
+}
+
+bool PacketReader::try_read(VarInt<Int32>& dt)
+{
+    __try_read_varint(Packet::Type::VarInt);
+}
+
+bool PacketReader::try_read(VarInt<Int64>& dt)
+{
+    __try_read_varint(Packet::Type::VarInt);
+}
+
+bool PacketReader::try_read(VarInt<UInt16>& dt)
+{
+    __try_read_varint(Packet::Type::VarUInt);
+}
+
+bool PacketReader::try_read(VarInt<UInt32>& dt)
+{
+    __try_read_varint(Packet::Type::VarUInt);
+}
+
+bool PacketReader::try_read(VarInt<UInt64>& dt)
+{
+    __try_read_varint(Packet::Type::VarUInt);
+}
+
+#undef __try_read_varint
+
+//! @cond Doxygen_Suppress
+template SEDNL_API bool PacketReader::try_read(ArrayView<Int8>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<Int16>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<Int32>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<Int64>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<UInt8>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<UInt16>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<UInt32>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<UInt64>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<float>&);
+template SEDNL_API bool PacketReader::try_read(ArrayView<double>&);
+//! @endcond
+
+template<class T>
+static
+void show_array(std::ostream& os, std::vector<T> &v)
+{
+    os << "{ ";
+    for (auto e : v)
         os << e << ", ";
     os << " }";
 }
@@ -702,14 +1709,39 @@ bool PacketReader::output_one(int& i, std::ostream& os)
     case Packet::Type::Double:
         __show_data_case(double);
 
+    case Packet::Type::VarInt:
+    {
+        VarInt<Int64> v;
+        *this >> v;
+        os << v.value;
+        break;
+    }
+    case Packet::Type::VarUInt:
+    {
+        VarInt<UInt64> v;
+        *this >> v;
+        os << v.value;
+        break;
+    }
+
     case Packet::Type::String:
+    case Packet::Type::SizedString:
         __show_data_case(std::string);
+    case Packet::Type::Blob:
+    {
+        Blob v;
+        *this >> v;
+        os << v.data.size() << " bytes";
+        break;
+    }
 
     case Packet::Type::Object:
     {
         os << "{ ";
 
         // Read object length and jump other Packet::Type and object's length.
+        if (m_idx + 1 >= m_p->m_data.size())
+            return false;
         unsigned short obj_length = static_cast<UInt8>(m_p->m_data[m_idx + 1]);
         m_idx += sizeof(UInt8) + sizeof(UInt8);
 
@@ -723,27 +1755,82 @@ bool PacketReader::output_one(int& i, std::ostream& os)
         break;
     }
 
+    case Packet::Type::ObjectArray:
+    {
+        check_length(m_p->m_data, m_idx, 1 + sizeof(UInt16) + sizeof(UInt8));
+        const unsigned short count = __front_16(m_idx + 1, m_p->m_data);
+        const unsigned short fields = m_p->m_data[m_idx + 1 + sizeof(UInt16)];
+        const unsigned int kinds = m_idx + 1 + sizeof(UInt16) + sizeof(UInt8);
+        check_length(m_p->m_data, kinds, fields);
+        m_idx = kinds + fields;
+
+        os << "[ " << count << " x { ";
+        for (int j = 0; j < fields; j++)
+        {
+            const unsigned int items =
+                (m_p->m_data[kinds + j] == SEDNL_COLUMN_ITEMS) ? count : 1;
+            os << "{ ";
+            for (unsigned int k = 0; k < items; k++)
+            {
+                if (!output_one(i, os))
+                    return false;
+                os << ", ";
+            }
+            os << " }, ";
+        }
+        os << " } ]";
+        break;
+    }
+
+    case Packet::Type::SchemaObject:
+    {
+        //Members can't be shown without their types
+        check_length(m_p->m_data, m_idx, 1 + sizeof(UInt16));
+        const UInt16 fingerprint = __front_16(m_idx + 1, m_p->m_data);
+        const unsigned int end = item_end(m_idx);
+        os << "{ schema " << fingerprint << ", "
+           << end - m_idx << " bytes }";
+        m_idx = end;
+        break;
+    }
+
     case Packet::Type::ArrayInt8:
+    case Packet::Type::NativeArrayInt8:
         __show_array_case(Int8);
     case Packet::Type::ArrayInt16:
+    case Packet::Type::NativeArrayInt16:
+    case Packet::Type::DeltaArrayInt16:
         __show_array_case(Int16);
     case Packet::Type::ArrayInt32:
+    case Packet::Type::NativeArrayInt32:
+    case Packet::Type::DeltaArrayInt32:
         __show_array_case(Int32);
     case Packet::Type::ArrayInt64:
+    case Packet::Type::NativeArrayInt64:
+    case Packet::Type::DeltaArrayInt64:
         __show_array_case(Int64);
 
     case Packet::Type::ArrayUInt8:
+    case Packet::Type::NativeArrayUInt8:
         __show_array_case(UInt8);
     case Packet::Type::ArrayUInt16:
+    case Packet::Type::NativeArrayUInt16:
+    case Packet::Type::DeltaArrayUInt16:
         __show_array_case(UInt16);
     case Packet::Type::ArrayUInt32:
+    case Packet::Type::NativeArrayUInt32:
+    case Packet::Type::DeltaArrayUInt32:
         __show_array_case(UInt32);
     case Packet::Type::ArrayUInt64:
+    case Packet::Type::NativeArrayUInt64:
+    case Packet::Type::DeltaArrayUInt64:
         __show_array_case(UInt64);
 
     case Packet::Type::ArrayFloat:
+    case Packet::Type::NativeArrayFloat:
         __show_array_case(float);
     case Packet::Type::ArrayDouble:
+    case Packet::Type::NativeArrayDouble:
         __show_array_case(double);
 
     default:
@@ -758,11 +1845,19 @@ std::ostream& operator<< (std::ostream& os, const Packet& p)
     int i = 0;
 
     os << "{ ";
-    while (r)
+    try
+    {
+        while (r)
+        {
+            if (!r.output_one(i, os))
+                return os << " CORRUPTED ---";
+            os << ", ";
+        }
+    }
+    //Truncated packet from a trusted connection
+    catch(PacketException&)
     {
-        if (!r.output_one(i, os))
-            return os << " CORRUPTED ---";
-        os << ", ";
+        return os << " CORRUPTED ---";
     }
     return os << "}";
 }
@@ -791,10 +1886,28 @@ const char* type_to_string(Packet::Type type)
         return "Float";
     case Packet::Type::Double:
         return "Double";
+    case Packet::Type::VarInt:
+        return "VarInt";
+    case Packet::Type::VarUInt:
+        return "VarUInt";
     case Packet::Type::String:
         return "String";
+    case Packet::Type::SizedString:
+        return "SizedString";
+    case Packet::Type::Blob:
+        return "Blob";
+    case Packet::Type::Compressed:
+        return "Compressed";
+    case Packet::Type::StringDef:
+        return "StringDef";
+    case Packet::Type::StringRef:
+        return "StringRef";
     case Packet::Type::Object:
         return "Object";
+    case Packet::Type::SchemaObject:
+        return "SchemaObject";
+    case Packet::Type::ObjectArray:
+        return "ObjectArray";
     case Packet::Type:: ArrayInt8:
         return "ArrayInt8";
     case Packet::Type::ArrayInt16:
@@ -815,6 +1928,38 @@ const char* type_to_string(Packet::Type type)
         return "ArrayFloat";
     case Packet::Type::ArrayDouble:
         return "ArrayDouble";
+    case Packet::Type::NativeArrayInt8:
+        return "NativeArrayInt8";
+    case Packet::Type::NativeArrayInt16:
+        return "NativeArrayInt16";
+    case Packet::Type::NativeArrayInt32:
+        return "NativeArrayInt32";
+    case Packet::Type::NativeArrayInt64:
+        return "NativeArrayInt64";
+    case Packet::Type::NativeArrayUInt8:
+        return "NativeArrayUInt8";
+    case Packet::Type::NativeArrayUInt16:
+        return "NativeArrayUInt16";
+    case Packet::Type::NativeArrayUInt32:
+        return "NativeArrayUInt32";
+    case Packet::Type::NativeArrayUInt64:
+        return "NativeArrayUInt64";
+    case Packet::Type::NativeArrayFloat:
+        return "NativeArrayFloat";
+    case Packet::Type::NativeArrayDouble:
+        return "NativeArrayDouble";
+    case Packet::Type::DeltaArrayInt16:
+        return "DeltaArrayInt16";
+    case Packet::Type::DeltaArrayInt32:
+        return "DeltaArrayInt32";
+    case Packet::Type::DeltaArrayInt64:
+        return "DeltaArrayInt64";
+    case Packet::Type::DeltaArrayUInt16:
+        return "DeltaArrayUInt16";
+    case Packet::Type::DeltaArrayUInt32:
+        return "DeltaArrayUInt32";
+    case Packet::Type::DeltaArrayUInt64:
+        return "DeltaArrayUInt64";
 
     case Packet::Type::Unknown:
     default:
@@ -833,6 +1978,7 @@ void PacketReader::read_object_header(unsigned short length)
     Packet::Type type = next_type();
     if (type != Packet::Type::Object)
         throw PacketException(PacketExceptionT::ObjectExpected);
+    check_length(m_p->m_data, m_idx, 2);
     UInt8 obj_length = static_cast<UInt8>(m_p->m_data[m_idx + 1]);
     if (obj_length == 0)
         throw PacketException(PacketExceptionT::EmptyObject);
@@ -843,6 +1989,235 @@ void PacketReader::read_object_header(unsigned short length)
     m_idx += 2;
 }
 
+unsigned short PacketReader::object_array_length() const
+    throw(PacketException)
+{
+    if (next_type() != Packet::Type::ObjectArray)
+        exception_by_type(next_type());
+    check_length(m_p->m_data, m_idx, 1 + sizeof(UInt16));
+    return __front_16(m_idx + 1, m_p->m_data);
+}
+
+void PacketReader::read_object_array_header(std::size_t count,
+                                            const Byte* kinds,
+                                            unsigned int fields)
+    throw(PacketException)
+{
+    if (next_type() != Packet::Type::ObjectArray)
+        exception_by_type(next_type());
+    check_length(m_p->m_data, m_idx, 1 + sizeof(UInt16) + sizeof(UInt8));
+    if (__front_16(m_idx + 1, m_p->m_data) != count
+        || m_p->m_data[m_idx + 1 + sizeof(UInt16)] != fields)
+        throw PacketException(PacketExceptionT::WrongSizedObject);
+
+    m_idx += 1 + sizeof(UInt16) + sizeof(UInt8);
+    check_length(m_p->m_data, m_idx, fields);
+    if (fields && memcmp(&m_p->m_data[m_idx], kinds, fields) != 0)
+        throw PacketException(PacketExceptionT::SchemaMismatch);
+    m_idx += fields;
+}
+
+unsigned int PacketReader::read_schema_header(UInt16 fingerprint)
+    throw(PacketException)
+{
+    if (next_type() != Packet::Type::SchemaObject)
+        throw PacketException(PacketExceptionT::ObjectExpected);
+    check_length(m_p->m_data, m_idx, 1 + sizeof(UInt16));
+    if (__front_16(m_idx + 1, m_p->m_data) != fingerprint)
+        throw PacketException(PacketExceptionT::SchemaMismatch);
+
+    UInt64 length;
+    const unsigned int varint =
+        __front_varint(m_idx + 1 + sizeof(UInt16), m_p->m_data, length);
+    if (varint == 0 || length > m_p->m_data.size())
+        throw PacketException(PacketExceptionT::Truncated);
+    m_idx += 1 + sizeof(UInt16) + varint;
+    check_length(m_p->m_data, m_idx, length);
+
+    return m_idx + length;
+}
+
+void PacketReader::read_schema_end(unsigned int end) const
+    throw(PacketException)
+{
+    //Same fingerprint, but other members
+    if (m_idx != end)
+        throw PacketException(PacketExceptionT::SchemaMismatch);
+}
+
+void PacketReader::read_schema_fixed(void* dt, unsigned int size)
+    throw(PacketException)
+{
+    check_length(m_p->m_data, m_idx, size);
+    switch (size)
+    {
+    case sizeof(UInt8):
+        *static_cast<UInt8*>(dt) = __front_8(m_idx, m_p->m_data);
+        break;
+    case sizeof(UInt16):
+    {
+        const UInt16 v = __front_16(m_idx, m_p->m_data);
+        memcpy(dt, &v, sizeof(v));
+        break;
+    }
+    case sizeof(UInt32):
+    {
+        const UInt32 v = __front_32(m_idx, m_p->m_data);
+        memcpy(dt, &v, sizeof(v));
+        break;
+    }
+    case sizeof(UInt64):
+    {
+        const UInt64 v = __front_64(m_idx, m_p->m_data);
+        memcpy(dt, &v, sizeof(v));
+        break;
+    }
+    }
+    m_idx += size;
+}
+
+UInt64 PacketReader::read_schema_varint() throw(PacketException)
+{
+    UInt64 encoded;
+    const unsigned int length = __front_varint(m_idx, m_p->m_data, encoded);
+    if (length == 0)
+        throw PacketException(PacketExceptionT::Truncated);
+    m_idx += length;
+    return encoded;
+}
+
+StringView PacketReader::read_schema_sized() throw(PacketException)
+{
+    const UInt64 length = read_schema_varint();
+    if (length > m_p->m_data.size())
+        throw PacketException(PacketExceptionT::Truncated);
+    check_length(m_p->m_data, m_idx, length);
+
+    const char* const data =
+        reinterpret_cast<const char*>(m_p->m_data.data());
+    const StringView view(data + m_idx, length);
+    m_idx += length;
+    return view;
+}
+
+unsigned short PacketReader::read_schema_length() throw(PacketException)
+{
+    check_length(m_p->m_data, m_idx, sizeof(UInt16));
+    const unsigned short length = __front_16(m_idx, m_p->m_data);
+    m_idx += sizeof(UInt16);
+    return length;
+}
+
+void PacketReader::read_schema_array(void* dt, std::size_t count,
+                                     std::size_t size)
+    throw(PacketException)
+{
+    check_length(m_p->m_data, m_idx, count * size);
+    if (count)
+        __array_from_network(dt, m_p->m_data.data() + m_idx, count, size);
+    m_idx += count * size;
+}
+
+std::size_t PacketReader::indexed_item(unsigned int offset) const
+    throw(PacketException)
+{
+    const auto& items = m_p->m_index.items;
+    auto it = std::lower_bound(items.begin(), items.end(), offset,
+                               [](const Packet::Index::Item& item,
+                                  unsigned int offset)
+                               { return item.offset < offset; });
+    if (it == items.end() || it->offset != offset)
+        throw PacketException(PacketExceptionT::NoSuchField);
+    return it - items.begin();
+}
+
+unsigned int PacketReader::item_end(unsigned int offset) const
+    throw(PacketException)
+{
+    const unsigned int size = m_p->m_data.size();
+    if (offset >= size)
+        throw PacketException(PacketExceptionT::NoSuchField);
+
+    if (m_p->is_indexed())
+        return m_p->m_index.items[indexed_item(offset)].end;
+
+    //valid_next_item stop on the last byte of the item.
+    if (!m_p->valid_next_item(size, offset))
+        throw PacketException(PacketExceptionT::Unknown);
+    return offset + 1;
+}
+
+std::size_t PacketReader::field_count() const
+{
+    if (m_p->is_indexed())
+        return m_p->m_index.fields.size();
+
+    std::size_t count = 0;
+    for (unsigned int i = 0; i < m_p->m_data.size(); i = item_end(i))
+        count++;
+    return count;
+}
+
+PacketReader& PacketReader::seek(std::size_t field) throw(PacketException)
+{
+    const unsigned int size = m_p->m_data.size();
+
+    if (m_p->is_indexed())
+    {
+        const auto& index = m_p->m_index;
+        if (field > index.fields.size())
+            throw PacketException(PacketExceptionT::NoSuchField);
+        m_idx = (field == index.fields.size())
+            ? size : index.items[index.fields[field]].offset;
+        return *this;
+    }
+
+    unsigned int i = 0;
+    for (; field > 0; field--)
+    {
+        if (i >= size)
+            throw PacketException(PacketExceptionT::NoSuchField);
+        i = item_end(i);
+    }
+    m_idx = i;
+    return *this;
+}
+
+PacketReader& PacketReader::skip(std::size_t count) throw(PacketException)
+{
+    unsigned int i = m_idx;
+    for (; count > 0; count--)
+        i = item_end(i);
+    m_idx = i;
+    return *this;
+}
+
+PacketReader& PacketReader::seek_member(std::size_t member)
+    throw(PacketException)
+{
+    if (next_type() != Packet::Type::Object)
+        throw PacketException(PacketExceptionT::ObjectExpected);
+    check_length(m_p->m_data, m_idx, 2);
+    const UInt8 length = static_cast<UInt8>(m_p->m_data[m_idx + 1]);
+    if (member >= length)
+        throw PacketException(PacketExceptionT::NoSuchField);
+
+    if (m_p->is_indexed())
+    {
+        const auto& index = m_p->m_index;
+        const auto& object = index.items[indexed_item(m_idx)];
+        m_idx = index.items[index.members[object.members + member]].offset;
+        return *this;
+    }
+
+    //Skip the header, then the previous members
+    unsigned int i = m_idx + 2;
+    for (; member > 0; member--)
+        i = item_end(i);
+    m_idx = i;
+    return *this;
+}
+
 void Packet::write_object_header(unsigned short length)
     throw(PacketException)
 {
@@ -853,4 +2228,118 @@ void Packet::write_object_header(unsigned short length)
     m_data.push_back(static_cast<UInt8>(length));
 }
 
+void Packet::write_object_array_header(std::size_t count, const Byte* kinds,
+                                       unsigned int fields)
+    throw(PacketException)
+{
+    assert(fields < 256);
+    if (static_cast<UInt16>(count) != count)
+        throw PacketException(PacketExceptionT::WrongArray);
+    m_data.push_back(static_cast<Byte>(Type::ObjectArray));
+    __push_16(m_data, static_cast<UInt16>(count));
+    m_data.push_back(static_cast<Byte>(fields));
+    m_data.insert(m_data.end(), kinds, kinds + fields);
+}
+
+unsigned int Packet::container_header_size(unsigned int i) const noexcept
+{
+    const unsigned int size = m_data.size();
+    switch (static_cast<Type>(m_data[i]))
+    {
+    case Type::Object:
+        return (i + 2 <= size) ? 2 : 0;
+    case Type::ObjectArray:
+    {
+        const unsigned int header = 1 + sizeof(UInt16) + sizeof(UInt8);
+        if (i + header > size)
+            return 0;
+        const unsigned int fields = m_data[i + 1 + sizeof(UInt16)];
+        return (i + header + fields <= size) ? header + fields : 0;
+    }
+    default:
+        return 0;
+    }
+}
+
+std::size_t Packet::write_schema_header(UInt16 fingerprint)
+{
+    m_data.push_back(static_cast<Byte>(Type::SchemaObject));
+    __push_16(m_data, fingerprint);
+    //Placeholder for the length, large enough for less than 128 bytes
+    m_data.push_back(0);
+    return m_data.size();
+}
+
+void Packet::write_schema_length(std::size_t payload)
+{
+    const std::size_t length = m_data.size() - payload;
+    if (length < 0x80)
+    {
+        m_data[payload - 1] = static_cast<Byte>(length);
+        return;
+    }
+
+    ByteArray varint;
+    __push_varint(varint, length);
+    m_data[payload - 1] = varint[0];
+    m_data.insert(m_data.begin() + payload, varint.begin() + 1, varint.end());
+}
+
+void Packet::write_schema_fixed(const void* dt, unsigned int size)
+{
+    switch (size)
+    {
+    case sizeof(UInt8):
+        m_data.push_back(*static_cast<const Byte*>(dt));
+        break;
+    case sizeof(UInt16):
+    {
+        UInt16 v;
+        memcpy(&v, dt, sizeof(v));
+        __push_16(m_data, v);
+        break;
+    }
+    case sizeof(UInt32):
+    {
+        UInt32 v;
+        memcpy(&v, dt, sizeof(v));
+        __push_32(m_data, v);
+        break;
+    }
+    case sizeof(UInt64):
+    {
+        UInt64 v;
+        memcpy(&v, dt, sizeof(v));
+        __push_64(m_data, v);
+        break;
+    }
+    }
+}
+
+void Packet::write_schema_varint(UInt64 encoded)
+{
+    __push_varint(m_data, encoded);
+}
+
+void Packet::write_schema_sized(const void* data, std::size_t size)
+{
+    const Byte* const bytes = static_cast<const Byte*>(data);
+    __push_varint(m_data, size);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
+void Packet::write_schema_array(const void* data, std::size_t count,
+                                std::size_t size)
+    throw(PacketException)
+{
+    if (static_cast<UInt16>(count) != count)
+        throw PacketException(PacketExceptionT::WrongArray);
+    __push_16(m_data, static_cast<UInt16>(count));
+
+    const std::size_t offset = m_data.size();
+    m_data.resize(offset + count * size);
+    if (count)
+        __array_to_network(m_data.data() + offset, data, count, size);
+}
+
 } // namespace SedNL
@@ -55,6 +55,9 @@ public:
         FileDescriptor fd;
         bool is_close;
         bool is_read;
+        //! \brief Something is waiting in the socket error queue
+        //!        (MSG_ZEROCOPY notifications), or the socket failed.
+        bool is_error;
     };
 
     //! \brief In case of fails, it close the poller.
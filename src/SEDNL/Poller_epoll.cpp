@@ -87,9 +87,10 @@ bool Poller::next_event(Event& e) noexcept
 
     e.fd = m_events[m_idx].data.fd;
     //An error occured or the connection was closed
-    e.is_close = m_events[m_idx].events & EPOLLERR
-        || m_events[m_idx].events & EPOLLHUP
+    e.is_close = m_events[m_idx].events & EPOLLHUP
         || m_events[m_idx].events & EPOLLRDHUP;
+    //An error occured, or MSG_ZEROCOPY notifications arrived
+    e.is_error = m_events[m_idx].events & EPOLLERR;
     //Ready to read
     e.is_read = m_events[m_idx].events & EPOLLIN;
 
@@ -113,6 +113,7 @@ bool Poller::next_event(Event& e) noexcept
 
     e.fd = m_idx;
     e.is_close = false;
+    e.is_error = false;
     e.is_read = FD_ISSET(m_idx, &m_tmp_readfds);
 #else /* !SEDNL_WINDOWS */
     // We do not use FD_ISSET to have a O(n)
@@ -139,6 +140,7 @@ bool Poller::next_event(Event& e) noexcept
 
     e.fd = m_tmp_readfds.fd_array[m_idx];
     e.is_close = false;
+    e.is_error = false;
     e.is_read = true;
 #endif /* !SEDNL_WINDOWS */
 
@@ -98,6 +98,7 @@ bool Poller::next_event(Event& e) noexcept
     //An error occured or the connection was closed
     e.is_close = m_events[m_idx].revents & POLLHUP
               || m_events[m_idx].revents & POLLNVAL;
+    e.is_error = false;
     //Ready to read
     e.is_read = m_events[m_idx].revents & POLLIN;
 
@@ -22,9 +22,15 @@
 #include "SEDNL/RingBuf.hpp"
 #include "SEDNL/SocketHelp.hpp"
 #include "SEDNL/Event.hpp"
+#include "SEDNL/Connection.hpp"
+#include "SEDNL/Compression.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
+
+#include <algorithm>
+#include <chrono>
 
 #define ROUND(pos) ((pos) % (m_size + 1))
-#define AT(pos)    m_dt[(pos)]
+#define AT(pos)    m_dt[ROUND(pos)]
 
 namespace SedNL
 {
@@ -32,9 +38,82 @@ namespace SedNL
 // We choose to 'lost' one byte, so that a full buffer contain exactly size bytes,
 // and we can read data in [m_start, m_end] (both included).
 RingBuf::RingBuf(unsigned int size) throw(std::bad_alloc)
-    :m_dt(new UInt8[size + 1]), m_size(size), m_start(0), m_end(0)
+    :m_dt(new UInt8[size + 1]), m_size(size), m_start(0), m_end(0),
+     m_dropped(0)
 {}
 
+void RingBuf::set_string_table(unsigned int size)
+{
+    std::vector<std::string>(size).swap(m_strings);
+}
+
+bool RingBuf::decode_strings(Packet& packet, StringDefs& defs) const
+{
+    const ByteArray& data = packet.m_data;
+    const unsigned int size = data.size();
+    ByteArray out;
+    out.reserve(size);
+
+    unsigned int i = 0;
+    while (i < size)
+    {
+        const Packet::Type t = static_cast<Packet::Type>(data[i]);
+
+        //Objects only have a header : their fields follow.
+        if (t == Packet::Type::Object || t == Packet::Type::ObjectArray)
+        {
+            const unsigned int header = packet.container_header_size(i);
+            if (header == 0)
+                return false;
+            out.insert(out.end(), data.begin() + i, data.begin() + i + header);
+            i += header;
+        }
+        else if (t == Packet::Type::StringDef || t == Packet::Type::StringRef)
+        {
+            UInt64 slot;
+            unsigned int length = __front_varint(i + 1, data, slot);
+            if (length == 0 || slot >= m_strings.size())
+                return false;
+            i += 1 + length;
+
+            //A string defined earlier in this packet hides the table.
+            const std::string* str = &m_strings[slot];
+            const auto def = defs.find(slot);
+            if (def != defs.end())
+                str = &def->second;
+            if (t == Packet::Type::StringDef)
+            {
+                UInt64 str_length;
+                length = __front_varint(i, data, str_length);
+                if (length == 0 || str_length > size - i - length)
+                    return false;
+                i += length;
+                std::string& defined = defs[slot];
+                defined.assign(data.begin() + i, data.begin() + i + str_length);
+                str = &defined;
+                i += str_length;
+            }
+
+            out.push_back(static_cast<Byte>(Packet::Type::SizedString));
+            __push_varint(out, str->size());
+            out.insert(out.end(), str->begin(), str->end());
+        }
+        else
+        {
+            //valid_next_item stop on the last byte of the item.
+            const unsigned int begin = i;
+            if (!packet.valid_next_item(size, i))
+                return false;
+            i++;
+            out.insert(out.end(), data.begin() + begin, data.begin() + i);
+        }
+    }
+
+    packet.m_data.swap(out);
+    packet.m_index.clear();
+    return true;
+}
+
 bool RingBuf::put(const char* string, unsigned int length) noexcept
 {
     //Not enougth memory
@@ -52,7 +131,25 @@ bool RingBuf::put(const char* string, unsigned int length) noexcept
     return true;
 }
 
-bool RingBuf::pick_event(Event& event) noexcept
+void RingBuf::grow(unsigned int size) throw(std::bad_alloc)
+{
+    if (size <= m_size)
+        return;
+
+    //Content is moved to the beginning of the new buffer.
+    std::unique_ptr<UInt8[]> dt(new UInt8[size + 1]);
+    const unsigned int used = length();
+    for (unsigned int i = 0; i < used; i++)
+        dt[i] = AT(m_start + i);
+
+    m_dt.swap(dt);
+    m_size = size;
+    m_start = 0;
+    m_end = used;
+}
+
+bool RingBuf::pick_event(Event& event, bool trusted,
+                         CompressionStats* stats) noexcept
 {
     try
     {
@@ -93,48 +190,92 @@ bool RingBuf::pick_event(Event& event) noexcept
             //It's a corrupted packet.
             //Log it and drop it
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: Corrupted packet. Dropped." << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "RingBuf::corrupted_packet",
+                             "Corrupted packet. Dropped.");
 #endif /* !SEDNL_NOWARN */
             m_start = ROUND(m_start + packet_length);
+            m_dropped++;
             return false;
         }
         Packet packet;
 
         //Jump over the '\0'
         NEXT_BYTE();
-        //Read packet content
+        //Read packet content, in at most two copies
+        // (it can wrap around the end of the buffer).
         try
         {
-            while (remaining)
-            {
-                packet.m_data.push_back(AT(dt_idx));
-                NEXT_BYTE();
-            }
+            const UInt8* const data = m_dt.get();
+            const unsigned int first = ROUND(dt_idx);
+            const unsigned int tail = std::min(remaining, m_size + 1 - first);
+
+            packet.m_data.reserve(remaining);
+            packet.m_data.insert(packet.m_data.end(),
+                                 data + first, data + first + tail);
+            packet.m_data.insert(packet.m_data.end(),
+                                 data, data + (remaining - tail));
+            dt_idx += remaining;
+            remaining = 0;
         }
         catch(std::exception& e)
         {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: Failed to place buffer's data into a packet."
-                      << std::endl;
+            SEDNL_DIAGNOSTIC(Warning, "RingBuf::packet_copy",
+                             "Failed to place buffer's data into a packet.");
 #endif /* !SEDNL_NOWARN */
             return false;
         }
 
-        if (!packet.is_valid())
+        //Save the new start position
+        m_start = ROUND(dt_idx);
+
+        //Decompressed before being validated like any packet
+        const bool compressed = !packet.m_data.empty()
+            && packet.m_data[0] == static_cast<Byte>(Packet::Type::Compressed);
+        if (compressed)
         {
+            const auto start = std::chrono::steady_clock::now();
+            ByteArray raw;
+            if (!__decompress_packet(packet.m_data, raw))
+            {
 #ifndef SEDNL_NOWARN
-            std::cerr << "Warning: Invalid packet for event \""
-                      << name
-                      << "\". Dropped." << std::endl;
+                SEDNL_DIAGNOSTIC(Warning, "RingBuf::corrupted_compressed_packet",
+                                 "Corrupted compressed packet for event \""
+                                 << name << "\". Dropped.");
 #endif /* !SEDNL_NOWARN */
-            return false;
+                m_dropped++;
+                return false;
+            }
+            if (stats)
+            {
+                stats->decompress_time += std::chrono::steady_clock::now() - start;
+                stats->decompressed_events++;
+                stats->received_bytes += packet.m_data.size();
+                stats->decompressed_bytes += raw.size();
+            }
+            packet.m_data.swap(raw);
         }
 
-        //Save the new start position
-        m_start = ROUND(dt_idx);
+        //The strings defined are only stored once the packet is valid
+        StringDefs defs;
+        if ((!m_strings.empty() && !decode_strings(packet, defs))
+            || (!trusted && !packet.is_valid()))
+        {
+#ifndef SEDNL_NOWARN
+            SEDNL_DIAGNOSTIC(Warning, "RingBuf::invalid_packet",
+                             "Invalid packet for event \""
+                             << name << "\". Dropped.");
+#endif /* !SEDNL_NOWARN */
+            m_dropped++;
+            return false;
+        }
 
         //Exception safe swap
-        Event(name, packet).swap(event);
+        Event received(name, std::move(packet));
+        received.m_compressed = compressed;
+        for (auto& def : defs)
+            m_strings[def.first].swap(def.second);
+        received.swap(event);
 
         return true;
     }
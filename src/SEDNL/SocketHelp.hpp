@@ -23,10 +23,17 @@
 #define SOCKET_HELP_HPP_
 
 #include "SEDNL/NetworkHeader.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
 
 #include <utility>
+#include <string>
 #include <thread>
 #include <iostream>
+#include <cstring>
+
+#ifndef SEDNL_WINDOWS
+#include <poll.h>
+#endif /* !SEDNL_WINDOWS */
 
 namespace SedNL
 {
@@ -37,10 +44,9 @@ static inline
 void warn_lock(std::exception& e, const char* name)
 {
 #ifndef SEDNL_NOWARN
-    std::cerr << "Error: "
-              << "std::mutex::lock failed in " << name
-              << std::endl;
-    std::cerr << "    " << e.what() << std::endl;
+    SEDNL_DIAGNOSTIC(Error, "warn_lock",
+                     "std::mutex::lock failed in " << name
+                     << "\n    " << e.what());
 #endif /* !SEDNL_NOWARN */
 }
 
@@ -95,6 +101,46 @@ inline bool set_reuseaddr(int fd)
     return true;
 }
 
+//! \brief Tell if the last socket call failed because
+//!        a non blocking socket wasn't ready.
+inline bool would_block()
+{
+#ifdef SEDNL_WINDOWS
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+//! \brief Wait at most \a timeout milliseconds for the socket \a fd
+//!        to be writable.
+//!
+//! \return False if the timeout expired.
+inline bool wait_writable(FileDescriptor fd, int timeout)
+{
+#ifdef SEDNL_WINDOWS
+    fd_set writefds;
+    FD_ZERO(&writefds);
+    FD_SET(fd, &writefds);
+
+    struct timeval tv;
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
+
+    return select(0, nullptr, &writefds, nullptr, &tv) > 0;
+#else
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+
+    int ret;
+    while ((ret = poll(&pfd, 1, timeout)) < 0 && errno == EINTR)
+        ;
+    return ret > 0;
+#endif
+}
+
 //! Try to obtain addresses with getaddrinfo
 //! See TCPServer::connect() and TCPClient::connect().
 template<typename T, typename U>
@@ -151,8 +197,7 @@ void __push_16(ByteArray& data, UInt16 dt)
 {
     const n_16 ndt = htons(static_cast<n_16>(dt));
     const Byte* const bytes = reinterpret_cast<const Byte*>(&ndt);
-    data.push_back(bytes[0]);
-    data.push_back(bytes[1]);
+    data.insert(data.end(), bytes, bytes + sizeof(ndt));
 }
 
 // Precondition : sizeof(Uint16) = 2 bytes in data starting from index.
@@ -172,10 +217,7 @@ void __push_32(ByteArray& data, UInt32 dt)
 {
     const n_32 ndt = htonl(static_cast<n_32>(dt));
     const Byte* const bytes = reinterpret_cast<const Byte*>(&ndt);
-    data.push_back(bytes[0]);
-    data.push_back(bytes[1]);
-    data.push_back(bytes[2]);
-    data.push_back(bytes[3]);
+    data.insert(data.end(), bytes, bytes + sizeof(ndt));
 }
 
 // Precondition : sizeof(Uint32) = 4 bytes in data starting from index.
@@ -213,8 +255,11 @@ void __push_64(ByteArray& data, UInt64 dt)
 {
     if (!__is_big_endian())
         __bytes_swap(dt);
-    __push_32(data, reinterpret_cast<UInt32*>(&dt)[0]);
-    __push_32(data, reinterpret_cast<UInt32*>(&dt)[1]);
+    UInt32* const blocks = reinterpret_cast<UInt32*>(&dt);
+    blocks[0] = htonl(static_cast<n_32>(blocks[0]));
+    blocks[1] = htonl(static_cast<n_32>(blocks[1]));
+    const Byte* const bytes = reinterpret_cast<const Byte*>(&dt);
+    data.insert(data.end(), bytes, bytes + sizeof(dt));
 }
 
 // Precondition : sizeof(Uint64) = 8 bytes in data starting from index.
@@ -232,6 +277,65 @@ UInt64 __front_64(unsigned int index, const ByteArray& data) noexcept
     return dt;
 }
 
+//Maximal length of a LEB128 varint (64 bits, 7 bits per byte)
+#define VARINT_MAX_LENGTH 10
+
+//! \brief Write \a dt as a LEB128 varint (7 bits per byte,
+//!        low bits first, 0x80 set on all bytes but the last).
+inline
+void __push_varint(ByteArray& data, UInt64 dt)
+{
+    Byte bytes[VARINT_MAX_LENGTH];
+    unsigned int length = 0;
+    while (dt >= 0x80)
+    {
+        bytes[length++] = static_cast<Byte>(dt) | 0x80;
+        dt >>= 7;
+    }
+    bytes[length++] = static_cast<Byte>(dt);
+    data.insert(data.end(), bytes, bytes + length);
+}
+
+//! \brief Read a LEB128 varint starting from \a index.
+//!
+//! \return The length of the varint, or 0 if it's truncated
+//!         or longer than VARINT_MAX_LENGTH bytes.
+inline
+unsigned int __front_varint(unsigned int index, const ByteArray& data,
+                            UInt64& dt) noexcept
+{
+    dt = 0;
+    for (unsigned int i = 0; i < VARINT_MAX_LENGTH; i++)
+    {
+        if (index + i >= data.size())
+            return 0;
+        const Byte b = data[index + i];
+        dt |= static_cast<UInt64>(b & 0x7F) << (7 * i);
+        if (!(b & 0x80))
+            return i + 1;
+    }
+    return 0;
+}
+
+//! \brief Build the header of an event named \a name whose
+//!        packet contain \a data_size bytes.
+//!
+//! See Event::get_header().
+inline
+ByteArray __event_header(const std::string& name, std::size_t data_size)
+{
+    //Size of the packet = |length : UInt16| + |name . '\0'| + |Packet|
+    const UInt16 length = data_size + name.length() + 1 + sizeof(UInt16);
+
+    ByteArray header;
+    header.reserve(sizeof(UInt16) + name.length() + 1);
+    __push_16(header, length);
+    header.insert(header.end(), name.begin(), name.end());
+    header.push_back('\0');
+
+    return header;
+}
+
 } // namespace SedNL
 
 #endif /* !SOCKET_HELP_HPP_ */
@@ -0,0 +1,172 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+#include "SEDNL/StateSync.hpp"
+#include "SEDNL/SocketHelp.hpp"
+
+#include <cstring>
+
+namespace SedNL
+{
+
+StateSync::StateSync()
+{}
+
+void StateSync::forget(UInt32 id)
+{
+    m_states.erase(id);
+}
+
+void StateSync::reset()
+{
+    m_states.clear();
+}
+
+std::size_t StateSync::size() const noexcept
+{
+    return m_states.size();
+}
+
+//Number of bytes of the mask of an object of \a fields fields
+static inline
+unsigned int mask_size(unsigned int fields) noexcept
+{
+    return 1 + (fields + 7) / 8;
+}
+
+static inline
+bool mask_bit(const Byte* mask, unsigned int field) noexcept
+{
+    return mask[1 + field / 8] & (1 << (field % 8));
+}
+
+bool StateSync::write_delta(Packet& packet, UInt32 id, const Packet& object)
+    throw(PacketException)
+{
+    const ByteArray& data = object.m_data;
+    const unsigned int size = data.size();
+    if (size < 2 || data[0] != static_cast<Byte>(Packet::Type::Object))
+        throw PacketException(PacketExceptionT::ObjectExpected);
+
+    //Split the object into its fields
+    State state;
+    const unsigned int fields = data[1];
+    state.offsets.resize(fields + 1);
+    unsigned int i = 2;
+    for (unsigned int j = 0; j < fields; j++)
+    {
+        state.offsets[j] = i;
+        //valid_next_item stop on the last byte of the item.
+        if (i >= size || !object.valid_next_item(size, i))
+            throw PacketException(PacketExceptionT::Unknown);
+        i++;
+    }
+    state.offsets[fields] = i;
+
+    //Compare them with the last state
+    auto it = m_states.find(id);
+    const bool known = it != m_states.end()
+        && it->second.offsets.size() == state.offsets.size();
+
+    Byte mask[1 + 256 / 8] = {static_cast<Byte>(fields)};
+    bool changed = !known;
+    for (unsigned int j = 0; j < fields; j++)
+    {
+        const unsigned int length = state.offsets[j + 1] - state.offsets[j];
+        if (known)
+        {
+            const State& last = it->second;
+            if (last.offsets[j + 1] - last.offsets[j] == length
+                && memcmp(&last.data[last.offsets[j]],
+                          &data[state.offsets[j]], length) == 0)
+                continue;
+        }
+        mask[1 + j / 8] |= 1 << (j % 8);
+        changed = true;
+    }
+    if (!changed)
+        return false;
+
+    packet << varint(id) << Blob(mask, mask_size(fields));
+    for (unsigned int j = 0; j < fields; j++)
+        if (mask_bit(mask, j))
+            packet.m_data.insert(packet.m_data.end(),
+                                 data.begin() + state.offsets[j],
+                                 data.begin() + state.offsets[j + 1]);
+
+    state.data = data;
+    m_states[id] = std::move(state);
+    return true;
+}
+
+void StateSync::read_delta(PacketReader& reader, UInt32& id, Packet& object)
+    throw(PacketException)
+{
+    VarInt<UInt32> vid;
+    StringView view;
+    reader >> vid >> view;
+    id = vid;
+
+    const Byte* const mask = reinterpret_cast<const Byte*>(view.data());
+    if (view.empty() || view.size() != mask_size(mask[0]))
+        throw PacketException(PacketExceptionT::WrongSizedObject);
+    const unsigned int fields = mask[0];
+
+    //Without the last state, all fields are needed
+    auto it = m_states.find(id);
+    const bool known = it != m_states.end()
+        && it->second.offsets.size() == fields + 1;
+    for (unsigned int j = 0; !known && j < fields; j++)
+        if (!mask_bit(mask, j))
+            throw PacketException(PacketExceptionT::UnknownObject);
+
+    //Rebuild the object from the changed fields and the last state
+    State state;
+    state.offsets.resize(fields + 1);
+    state.data.push_back(static_cast<Byte>(Packet::Type::Object));
+    state.data.push_back(static_cast<Byte>(fields));
+    const ByteArray& data = reader.m_p->m_data;
+    for (unsigned int j = 0; j < fields; j++)
+    {
+        state.offsets[j] = state.data.size();
+        if (mask_bit(mask, j))
+        {
+            const unsigned int begin = reader.m_idx;
+            const unsigned int end = reader.item_end(begin);
+            state.data.insert(state.data.end(),
+                              data.begin() + begin, data.begin() + end);
+            reader.m_idx = end;
+        }
+        else
+        {
+            const State& last = it->second;
+            state.data.insert(state.data.end(),
+                              last.data.begin() + last.offsets[j],
+                              last.data.begin() + last.offsets[j + 1]);
+        }
+    }
+    state.offsets[fields] = state.data.size();
+
+    object.m_data = state.data;
+    m_states[id] = std::move(state);
+}
+
+} // namespace SedNL
@@ -24,6 +24,7 @@
 #include "SEDNL/Exception.hpp"
 #include "SEDNL/SocketAddress.hpp"
 #include "SEDNL/EventListener.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
 
 #include <cstring>
 #include <memory>
@@ -80,6 +81,16 @@ TCPServer::~TCPServer() noexcept
         if (fd == -1)
             continue;
 
+        //SO_REUSEADDR only applies to the following bind
+        if (reuseaddr)
+            if (!set_reuseaddr(fd))
+            {
+#ifndef SEDNL_NOWARN
+                SEDNL_DIAGNOSTIC(Error, "TCPServer::reuseaddr",
+                                 "failed to set the SO_REUSEADDR flag.");
+#endif /* !SEDNL_NOWARN */
+            }
+
         int errcode = bind(fd, addr->ai_addr, addr->ai_addrlen);
 
         //We binded on this socket
@@ -93,16 +104,6 @@ TCPServer::~TCPServer() noexcept
     if (addr == nullptr)
         throw NetworkException(NetworkExceptionT::BindFailed);
 
-    if (reuseaddr)
-        if (!set_reuseaddr(fd))
-        {
-#ifndef SEDNL_NOWARN
-            std::cerr << "Error: "
-                      << "failed to set the SO_REUSEADDR flag."
-                      << std::endl;
-#endif /* !SEDNL_NOWARN */
-        }
-
     if (!set_non_blocking(fd))
         throw NetworkException(NetworkExceptionT::CantSetNonblocking);
 
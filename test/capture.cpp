@@ -0,0 +1,241 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Test cases, to check that captures are written, read and replayed
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <csignal>
+
+#include <sys/resource.h>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+static const char* CAPTURE = "capture_test.cap";
+
+//Wait at most one second for cond() to become true.
+template<typename F>
+static bool wait_for(F cond)
+{
+    for (int i = 0; i < 100 && !cond(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return cond();
+}
+
+static int records()
+{
+    const std::string data(3000, 'x');
+
+    //Test case 1 : records are read back, across chunks
+    {
+        CaptureWriter writer(CAPTURE, 4096);
+        for (UInt32 i = 0; i < 1000; i++)
+            ASSERT(writer.append(i % 7, 1000 + i, data.data(), i % 3000),
+                   "Test case 1 : can't append");
+        ASSERT(writer.append(3, 5000, nullptr, 0), "Test case 1 : can't append");
+    }
+    {
+        CaptureReader reader(CAPTURE);
+        CaptureRecord record;
+        for (UInt32 i = 0; i < 1000; i++)
+        {
+            ASSERT(reader.next(record), "Test case 1 : missing record " << i);
+            ASSERT(record.connection == i % 7 && record.timestamp == 1000 + i
+                   && record.length == i % 3000
+                   && std::string(record.data, record.length)
+                   == data.substr(0, i % 3000),
+                   "Test case 1 : wrong record " << i);
+        }
+        ASSERT(reader.next(record) && record.length == 0
+               && record.timestamp == 5000,
+               "Test case 1 : missing close record");
+        ASSERT(!reader.next(record), "Test case 1 : record after the end");
+
+        reader.rewind();
+        ASSERT(reader.next(record) && record.timestamp == 1000,
+               "Test case 1 : rewind failed");
+    }
+
+    //Test case 2 : not a capture
+    {
+        std::FILE* f = std::fopen(CAPTURE, "w");
+        std::fputs("this isn't a capture file", f);
+        std::fclose(f);
+        bool thrown = false;
+        try
+        {
+            CaptureReader reader(CAPTURE);
+        }
+        catch(EventException& e)
+        {
+            thrown = e.get_type() == EventExceptionT::InvalidCapture;
+        }
+        ASSERT(thrown, "Test case 2 : invalid capture accepted");
+    }
+    return EXIT_SUCCESS;
+}
+
+//Bind "value" events on \a consumer, and sum them.
+static void bind_sum(EventConsumer& consumer, std::atomic<int>& sum,
+                     std::atomic<int>& count)
+{
+    consumer.bind<Int32>("value", [&](Connection&, Int32 v) {
+            sum += v;
+            count++;
+        });
+}
+
+static int replay()
+{
+    try
+    {
+        //Test case 3 : capture the events received by a listener
+        {
+            SocketAddress addr(23463, "127.0.0.1");
+            TCPServer server(addr, true);
+            EventListener listener(server);
+            EventConsumer consumer(listener);
+            std::atomic<int> sum(0), count(0);
+            bind_sum(consumer, sum, count);
+            listener.set_capture(CAPTURE);
+            listener.run();
+            consumer.run();
+
+            TCPClient client(addr);
+            for (Int32 i = 1; i <= 100; i++)
+                client.send("value", make_packet(i));
+            ASSERT(wait_for([&]() { return count == 100; }),
+                   "Test case 3 : events not received");
+            client.disconnect();
+            ASSERT(wait_for([&]() {
+                        return listener.get_metrics().disconnects == 1; }),
+                "Test case 3 : not disconnected");
+
+            consumer.join();
+            listener.join();
+            listener.set_capture("");
+        }
+
+        //Test case 4 : replay it into the dispatch path
+        {
+            EventListener listener;
+            EventConsumer consumer(listener);
+            std::atomic<int> sum(0), count(0);
+            bind_sum(consumer, sum, count);
+            listener.run();
+            consumer.run();
+
+            CaptureReplayer replayer(CAPTURE);
+            ASSERT(replayer.replay(listener, 0) >= 2,
+                   "Test case 4 : records missing");
+            ASSERT(wait_for([&]() { return count == 100; }),
+                   "Test case 4 : events not replayed");
+            ASSERT(sum == 5050, "Test case 4 : wrong values replayed");
+
+            consumer.join();
+            listener.join();
+        }
+
+        //Test case 5 : replay it over loopback, at the original speed
+        {
+            SocketAddress addr(23464, "127.0.0.1");
+            TCPServer server(addr, true);
+            EventListener listener(server);
+            EventConsumer consumer(listener);
+            std::atomic<int> sum(0), count(0);
+            bind_sum(consumer, sum, count);
+            listener.run();
+            consumer.run();
+
+            CaptureReplayer replayer(CAPTURE);
+            replayer.replay(addr);
+            ASSERT(wait_for([&]() { return count == 100; }),
+                   "Test case 5 : events not replayed");
+            ASSERT(sum == 5050, "Test case 5 : wrong values replayed");
+
+            consumer.join();
+            listener.join();
+        }
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+    return EXIT_SUCCESS;
+}
+
+static int full_disk()
+{
+    const std::string data(3000, 'x');
+
+    //Test case 6 : a full disk fails appending, without a crash
+    struct rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &limit);
+    const rlim_t previous = limit.rlim_cur;
+    std::signal(SIGXFSZ, SIG_IGN);
+    UInt32 written = 0;
+    {
+        CaptureWriter writer(CAPTURE, 4096);
+        limit.rlim_cur = 64 << 10;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        while (written < 100 && writer.append(1, 1000 + written,
+                                              data.data(), data.size()))
+            written++;
+        const UInt64 size = writer.size();
+        bool appended = writer.append(1, 1, data.data(), data.size());
+        limit.rlim_cur = previous;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        ASSERT(written < 100 && !appended && writer.size() == size,
+               "Test case 6 : append beyond the file size limit");
+        ASSERT(writer.append(2, 5000, nullptr, 0),
+               "Test case 6 : can't append once the disk has room");
+    }
+    std::signal(SIGXFSZ, SIG_DFL);
+
+    CaptureReader reader(CAPTURE);
+    CaptureRecord record;
+    for (UInt32 i = 0; i < written; i++)
+        ASSERT(reader.next(record) && record.timestamp == 1000 + i
+               && std::string(record.data, record.length) == data,
+               "Test case 6 : wrong record " << i);
+    ASSERT(reader.next(record) && record.length == 0
+           && record.timestamp == 5000, "Test case 6 : missing close record");
+    return EXIT_SUCCESS;
+}
+
+int main()
+{
+    int result = records();
+    if (result == EXIT_SUCCESS)
+        result = full_disk();
+    if (result == EXIT_SUCCESS)
+        result = replay();
+    std::remove(CAPTURE);
+    return result;
+}
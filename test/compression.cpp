@@ -0,0 +1,144 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Test cases, to check that compressed events are transparently received
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+//Wait at most one second for cond() to become true.
+template<typename F>
+static bool wait_for(F cond)
+{
+    for (int i = 0; i < 100 && !cond(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return cond();
+}
+
+//A JSON like document, bigger than a connection buffer.
+static std::string make_document()
+{
+    std::string doc = "[";
+    for (int i = 0; i < 200; i++)
+        doc += "{\"id\":" + std::to_string(i) + ",\"name\":\"monster\",\"alive\":true},";
+    return doc + "]";
+}
+
+static int run(Compression codec)
+{
+    try
+    {
+        SocketAddress addr(23458, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener server_listener(server);
+        EventConsumer consumer(server_listener);
+
+        const std::string doc = make_document();
+        ByteArray noise(1000);
+        std::mt19937 rng(42);
+        for (Byte& b : noise)
+            b = rng();
+
+        std::atomic<int> received(0);
+        std::atomic<int> correct(0);
+        std::atomic<Connection*> server_cn(nullptr);
+
+        consumer.bind("doc").set_function([&](Connection& c, const Event& e) {
+                std::string str;
+                PacketReader(e.get_packet()) >> str;
+                correct += e.is_compressed() && str == doc;
+                server_cn = &c;
+                received++;
+            });
+        consumer.bind("small").set_function([&](Connection&, const Event& e) {
+                Int32 i;
+                PacketReader(e.get_packet()) >> i;
+                correct += !e.is_compressed() && i == 42;
+                received++;
+            });
+        consumer.bind("noise").set_function([&](Connection&, const Event& e) {
+                Blob b;
+                PacketReader(e.get_packet()) >> b;
+                correct += !e.is_compressed() && b.data == noise;
+                received++;
+            });
+        server_listener.run();
+        consumer.run();
+
+        TCPClient client(addr);
+        EventListener client_listener(client);
+        client_listener.run();
+
+        ASSERT(client.set_compression(codec, 64)
+               || codec == Compression::Zlib, "LZ isn't available");
+
+        client.send("doc", make_packet(doc));
+        client.send("small", make_packet(Int32(42)));
+        Packet p;
+        p << Blob(noise);
+        client.send("noise", p);
+        ASSERT(wait_for([&]() { return received == 3; }), "Events not received");
+        ASSERT(correct == 3, "Events corrupted");
+
+        const CompressionStats sent = client.get_compression_stats();
+        ASSERT(sent.compressed_events == 1 && sent.incompressible_events == 1,
+               "Wrong compression stats");
+        ASSERT(sent.send_ratio() < 0.5, "Document not compressed enough : "
+               << sent.send_ratio());
+        ASSERT(wait_for([&]() {
+                    return server_cn.load()->get_compression_stats()
+                        .decompressed_bytes == doc.size() + 2; }),
+            "Wrong decompression stats");
+        server_cn.load()->reset_compression_stats();
+        ASSERT(server_cn.load()->get_compression_stats().decompressed_events
+               == 0, "Decompression stats not reset");
+
+        consumer.join();
+        client_listener.join();
+        server_listener.join();
+        client.disconnect();
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+    return EXIT_SUCCESS;
+}
+
+int main()
+{
+    //Zlib falls back to LZ if it isn't available
+    if (run(Compression::LZ) != EXIT_SUCCESS
+        || run(Compression::Zlib) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    //HUGE SUCCESS :)
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Test cases, to check the rate limiter and the delivery of diagnostics
+
+#include "SEDNL/sednl.hpp"
+#include "SEDNL/DiagnosticHelp.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+static std::mutex g_mutex;
+static std::vector<std::string> g_messages;
+static UInt64 g_suppressed = 0;
+
+static void collect(const Diagnostic& d)
+{
+    std::lock_guard<std::mutex> lk(g_mutex);
+    if (d.suppressed)
+        g_suppressed += d.suppressed;
+    else
+        g_messages.push_back(d.message);
+}
+
+static void report(int i)
+{
+    SEDNL_DIAGNOSTIC(Warning, "test::report", "Message " << i << '.');
+}
+
+static void report_from_threads(int count)
+{
+    SEDNL_DIAGNOSTIC(Error, "test::threads", "Thread message " << count);
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    DiagnosticSink sink;
+    sink.set_function<&collect>();
+    set_diagnostic_sink(sink);
+
+    //Test case 1 : formatting, delivered by flush_diagnostics()
+    report(-42);
+    flush_diagnostics();
+    {
+        std::lock_guard<std::mutex> lk(g_mutex);
+        ASSERT(g_messages.size() == 1, "Test case 1 : the message wasn't delivered");
+        ASSERT(g_messages[0] == "Message -42.", "Test case 1 : bad message "
+               << g_messages[0]);
+        g_messages.clear();
+    }
+
+    //Test case 2 : a site is rate limited, and every message is
+    // either delivered or counted in a summary.
+    for (int i = 0; i < 1000; i++)
+        report(i);
+    flush_diagnostics();
+    {
+        std::lock_guard<std::mutex> lk(g_mutex);
+        ASSERT(g_messages.size() <= 3 * SEDNL_DIAGNOSTIC_RATE,
+               "Test case 2 : the site isn't rate limited");
+        ASSERT(g_messages.size() + g_suppressed == 1000,
+               "Test case 2 : lost messages");
+        g_messages.clear();
+        g_suppressed = 0;
+    }
+
+    //Test case 3 : the same, from several threads
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+            threads.push_back(std::thread([]() {
+                        for (int i = 0; i < 5000; i++)
+                            report_from_threads(i);
+                    }));
+        for (std::thread& t : threads)
+            t.join();
+    }
+    flush_diagnostics();
+    {
+        std::lock_guard<std::mutex> lk(g_mutex);
+        ASSERT(g_messages.size() + g_suppressed == 20000,
+               "Test case 3 : lost messages");
+    }
+
+    //Test case 4 : long messages are truncated
+    {
+        DiagnosticMessage message;
+        message << std::string(1000, 'a') << 12;
+        ASSERT(std::string(message.c_str()).size()
+               == DiagnosticMessage::Capacity - 1,
+               "Test case 4 : bad truncation");
+    }
+
+    set_diagnostic_sink(DiagnosticSink());
+    return EXIT_SUCCESS;
+}
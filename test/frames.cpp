@@ -0,0 +1,114 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Test cases, to check that events of any size fit in the receive buffer
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+//Wait at most one second for cond() to become true.
+template<typename F>
+static bool wait_for(F cond)
+{
+    for (int i = 0; i < 100 && !cond(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return cond();
+}
+
+int main()
+{
+    try
+    {
+        SocketAddress addr(23465, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener server_listener(server);
+        EventConsumer consumer(server_listener);
+
+        std::atomic<int> received(0);
+        std::atomic<int> sizes_ok(0);
+
+        consumer.bind("bulk").set_function([&](Connection&, const Event& e) {
+                std::vector<UInt8> data;
+                PacketReader(e.get_packet()) >> data;
+                bool ok = true;
+                for (unsigned int i = 0; i < data.size(); i++)
+                    ok = ok && data[i] == static_cast<UInt8>(i);
+                if (ok)
+                    sizes_ok++;
+                received++;
+            });
+        server_listener.run();
+        consumer.run();
+
+        TCPClient client(addr);
+
+        //Test case 1 : Small, then bigger than the initial buffer, up to
+        // the biggest frame (|length| + "bulk\0" + |type, length| + data)
+        const unsigned int sizes[] = {10, 4000, 5000, 20000,
+                                      MAX_FRAME_SIZE - 7 - 3, 10};
+        for (unsigned int size : sizes)
+        {
+            std::vector<UInt8> data(size);
+            for (unsigned int i = 0; i < size; i++)
+                data[i] = static_cast<UInt8>(i);
+            client.send("bulk", make_packet(data));
+        }
+        ASSERT(wait_for([&]() { return received == 6; }),
+               "Events lost, " << received << " received");
+        ASSERT(sizes_ok == 6, "Events corrupted");
+
+        //Test case 2 : An event bigger than a frame is refused
+        bool refused = false;
+        try
+        {
+            client.send("bulk", make_packet(std::vector<UInt8>(MAX_FRAME_SIZE)));
+        }
+        catch(NetworkException& e)
+        {
+            refused = e.get_type() == NetworkExceptionT::FrameTooLarge;
+        }
+        ASSERT(refused, "A frame too large was sent");
+
+        //The connection is still usable
+        client.send("bulk", make_packet(std::vector<UInt8>(3)));
+        ASSERT(wait_for([&]() { return received == 7; }),
+               "Event lost after a frame too large");
+
+        consumer.join();
+        server_listener.join();
+        client.disconnect();
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+
+    //HUGE SUCCESS :)
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Test cases, to check the counters of listeners, consumers and connections
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+//Wait at most one second for cond() to become true.
+template<typename F>
+static bool wait_for(F cond)
+{
+    for (int i = 0; i < 100 && !cond(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return cond();
+}
+
+static int counters()
+{
+    try
+    {
+        SocketAddress addr(23461, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener listener(server);
+        EventConsumer consumer(listener);
+
+        std::atomic<int> sum(0);
+        std::atomic<Connection*> server_cn(nullptr);
+
+        listener.on_connect().set_function([&](Connection& c) {
+                server_cn = &c;
+            });
+        consumer.bind<Int32>("value", [&](Connection&, Int32 v) {
+                sum += v;
+            });
+        consumer.bind("throw").set_function([](Connection&, const Event&) {
+                throw std::runtime_error("expected by the test");
+            });
+        listener.run();
+        consumer.run();
+
+        TCPClient client(addr);
+        for (Int32 i = 1; i <= 10; i++)
+            client.send("value", make_packet(i));
+        client.send("value", make_packet("not an integer"));
+        client.send("throw");
+        client.send("throw");
+
+        ASSERT(wait_for([&]() {
+                    return consumer.get_metrics().events_out == 13; }),
+            "Events not processed");
+        ASSERT(sum == 55, "Wrong values received");
+
+        //Consumer
+        const ConsumerMetrics consumed = consumer.get_metrics();
+        ASSERT(consumed.events.at("value").events == 11
+               && consumed.events.at("throw").events == 2,
+               "Wrong number of events processed");
+        ASSERT(consumed.dropped_mismatched == 1
+               && consumed.events.at("value").dropped == 1,
+               "The mismatched packet wasn't counted");
+        ASSERT(consumed.handler_exceptions == 2,
+               "The exceptions weren't counted");
+
+        //Listener
+        const ListenerMetrics received = listener.get_metrics();
+        ASSERT(received.events_in == 13
+               && received.events.at("value").events == 11
+               && received.events.at("throw").events == 2,
+               "Wrong number of events received");
+        ASSERT(received.accepts == 1 && received.failed_accepts == 0,
+               "Wrong number of connections accepted");
+        ASSERT(received.dropped_queue_full == 0
+               && received.dropped_invalid_packets == 0,
+               "No event should be dropped");
+        ASSERT(received.queues.at("value").depth == 0
+               && received.queues.at("value").high_water_mark >= 1,
+               "Wrong queue metrics");
+        ASSERT(received.wake_ups > 0 && received.wait_time.count() > 0,
+               "Poller wasn't timed");
+
+        //Connections
+        const ConnectionMetrics sent = client.get_metrics();
+        ASSERT(sent.events_out == 13, "Wrong number of events sent");
+        ASSERT(server_cn.load()->get_metrics().bytes_in == sent.bytes_out
+               && received.bytes_in == sent.bytes_out,
+               "Wrong number of bytes received: " << received.bytes_in
+               << " instead of " << sent.bytes_out);
+
+        client.disconnect();
+        ASSERT(wait_for([&]() {
+                    return listener.get_metrics().disconnects == 1
+                        && consumer.get_metrics().disconnections == 0; }),
+            "The disconnection wasn't counted");
+        ASSERT(consumer.get_latency().empty(),
+               "The latency shouldn't be tracked by default");
+
+        consumer.join();
+        listener.join();
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+    return EXIT_SUCCESS;
+}
+
+static int latency()
+{
+    //Histogram precision
+    {
+        LatencyHistogram histogram;
+        for (UInt64 i = 1; i <= 1000; i++)
+            histogram.record(i * 1000);
+        const LatencyStats stats = histogram.stats();
+        ASSERT(stats.count == 1000, "Wrong number of measures");
+        ASSERT(stats.p50.count() >= 500000 && stats.p50.count() <= 562500,
+               "Wrong median: " << stats.p50.count());
+        ASSERT(stats.p999.count() >= 999000 && stats.max.count() == 1000000,
+               "Wrong tail: " << stats.p999.count());
+    }
+
+    try
+    {
+        SocketAddress addr(23462, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener listener(server);
+        EventConsumer consumer(listener);
+        std::atomic<int> received(0);
+
+        listener.set_latency_tracking(true);
+        consumer.bind("sleep").set_function([&](Connection&, const Event&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                received++;
+            });
+        listener.run();
+        consumer.run();
+
+        TCPClient client(addr);
+        for (int i = 0; i < 20; i++)
+            client.send("sleep");
+        ASSERT(wait_for([&]() { return received == 20; }), "Events not processed");
+
+        ASSERT(wait_for([&]() {
+                    auto latency = consumer.get_latency();
+                    return latency.count("sleep")
+                        && latency["sleep"].total.count == 20; }),
+            "The latency wasn't measured");
+        const EventLatency latency = consumer.get_latency()["sleep"];
+        ASSERT(latency.handler.p50 >= std::chrono::milliseconds(2),
+               "Wrong handler latency: " << latency.handler.p50.count());
+        ASSERT(latency.total.max >= latency.handler.max
+               && latency.total.p99 >= latency.queue.p50,
+               "Wrong total latency");
+
+        client.disconnect();
+        consumer.join();
+        listener.join();
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+    return EXIT_SUCCESS;
+}
+
+int main()
+{
+    if (counters() != EXIT_SUCCESS || latency() != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
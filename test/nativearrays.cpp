@@ -0,0 +1,105 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Test cases, to check the negotiation of native arrays between two peers
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+//Wait at most one second for cond() to become true.
+template<typename F>
+static bool wait_for(F cond)
+{
+    for (int i = 0; i < 100 && !cond(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return cond();
+}
+
+int main()
+{
+    try
+    {
+        SocketAddress addr(23457, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener server_listener(server);
+        EventConsumer consumer(server_listener);
+
+        std::atomic<int> received(0);
+        std::atomic<bool> zero_copy(false);
+        std::atomic<bool> server_native(false);
+
+        consumer.bind("tensor").set_function([&](Connection& c, const Event& e) {
+                ArrayView<float> view;
+                PacketReader(e.get_packet()) >> view;
+                zero_copy = view.is_zero_copy() && view.size() == 1000
+                    && view[999] == 999.f;
+                server_native = c.has_native_arrays();
+                received++;
+            });
+        server_listener.run();
+        consumer.run();
+
+        TCPClient client(addr);
+        EventListener client_listener(client);
+        client_listener.run();
+
+        std::vector<float> tensor(1000);
+        for (unsigned int i = 0; i < tensor.size(); i++)
+            tensor[i] = i;
+        Packet p;
+        p.set_array_encoding(Packet::ArrayEncoding::Native);
+        p << tensor;
+
+        //Before the negotiation, arrays are converted
+        client.send("tensor", p);
+        ASSERT(wait_for([&]() { return received == 1; }), "Event not received");
+        ASSERT(!zero_copy, "Native arrays sent before the negotiation");
+
+        client.negotiate_native_arrays();
+        ASSERT(wait_for([&]() { return client.has_native_arrays(); }),
+               "Native arrays refused by the server");
+
+        client.send("tensor", p);
+        ASSERT(wait_for([&]() { return received == 2; }), "Event not received");
+        ASSERT(zero_copy, "Native array wasn't read without copy");
+        ASSERT(server_native, "The server didn't accept native arrays");
+
+        consumer.join();
+        client_listener.join();
+        server_listener.join();
+        client.disconnect();
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+
+    //HUGE SUCCESS :)
+    return EXIT_SUCCESS;
+}
@@ -24,11 +24,117 @@
 #include "SEDNL/Packet.hpp"
 #include "SEDNL/Event.hpp"
 #include "SEDNL/RingBuf.hpp"
+#include "SEDNL/Connection.hpp"
+#include "SEDNL/Serializer.hpp"
+#include "SEDNL/StateSync.hpp"
 
 #include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <thread>
 
 using namespace SedNL;
 
+struct Point
+{
+    Int32 x;
+    Int32 y;
+    std::string label;
+
+    SEDNL_SERIALIZABLE(x, y, label);
+};
+
+struct Sample
+{
+    VarInt<UInt32> id;
+    VarInt<Int64> delta;
+
+    SEDNL_SERIALIZABLE(id, delta);
+};
+
+struct Body
+{
+    Point position;
+    float mass;
+    std::vector<Int16> path;
+    Blob tag;
+
+    SEDNL_SERIALIZABLE(position, mass, path, tag);
+};
+
+//Same members as Point, but another layout
+struct WidePoint
+{
+    Int64 x;
+    Int32 y;
+    std::string label;
+
+    SEDNL_SERIALIZABLE(x, y, label);
+};
+
+//Serializable without SEDNL_SERIALIZABLE
+struct Custom
+{
+    Int32 value;
+
+    void serialize(Packet& p) { p << value; }
+    void unserialize(PacketReader& r) { r >> value; }
+};
+
+struct Holder
+{
+    Custom custom;
+    Point point;
+
+    SEDNL_SERIALIZABLE(custom, point);
+};
+
+struct Player
+{
+    Int32 id;
+    float x, y, z;
+    std::string name;
+    UInt16 health;
+    UInt16 mana;
+    std::vector<Int16> items;
+    Int64 score;
+    Point target;
+
+    SEDNL_SERIALIZABLE(id, x, y, z, name, health, mana, items, score, target);
+};
+
+struct Outer
+{
+    Holder holder;
+    Int8 flag;
+
+    SEDNL_SERIALIZABLE(holder, flag);
+};
+
+//Count the allocations, to check that builders don't copy their arguments
+static std::size_t g_allocations = 0;
+static std::size_t g_allocated = 0;
+
+void* operator new(std::size_t size)
+{
+    g_allocations++;
+    g_allocated += size;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+//Through a pointer, so GCC doesn't pair free() with the new expressions
+static void (*volatile g_free)(void*) = std::free;
+
+void operator delete(void* p) noexcept
+{
+    g_free(p);
+}
+
 #define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
 
 int main()
@@ -329,6 +435,957 @@ int main()
         }
     }
 
+    //Test case 7 : packed_size is exact, and builders allocate once
+    {
+        static_assert(PackedSize<Int32>::value == 5, "Int32 packed size");
+        static_assert(PackedSize<double>::value == 9, "double packed size");
+
+        std::vector<float> v(100, 1.f);
+        std::string str = "Hello";
+        Point pt = {1, 2, "point"};
+
+        Packet p = make_packet(str, (Int8)1, 3.14, v, "World", pt, (UInt64)4);
+
+        ASSERT(packed_size(str, (Int8)1, 3.14, v, "World", pt, (UInt64)4)
+               == p.get_data().size(), "packed_size differ from the data size");
+        ASSERT(p.get_data().capacity() == p.get_data().size(),
+               "make_packet reallocated its buffer");
+        ASSERT(p.is_valid(), "make_packet built an invalid packet");
+
+        write_to_packet(p, v, str);
+        ASSERT(p.get_data().capacity() == p.get_data().size(),
+               "write_to_packet reallocated its buffer");
+
+        PacketReader r(p);
+        std::string s1, s2;
+        Int8 i8;
+        double d;
+        std::vector<float> u1, u2;
+        Point q;
+        UInt64 ui64;
+        r >> s1 >> i8 >> d >> u1 >> s2 >> q >> ui64 >> u2;
+        ASSERT(s1 == str && i8 == 1 && d == 3.14 && u1 == v && s2 == "World"
+               && q.x == 1 && q.y == 2 && q.label == "point" && ui64 == 4
+               && u2 == v, "make_packet corrupted the data");
+    }
+
+    //Test case 7b : packed_size(packet, ...) is an upper bound with
+    // the encodings of the packet
+    {
+        const std::string str(200, 'a');
+        const std::vector<Int16> v16 = {1, -300, 32000, -32000, 5};
+        const std::vector<UInt64> v64 = {1, 0xFFFFFFFFFFFFFFFFull, 0, 42};
+        const std::vector<double> vd(10, 2.5);
+        const Point pt = {1, -2, str};
+        std::vector<Body> bodies(3);
+        for (unsigned int i = 0; i < bodies.size(); i++)
+        {
+            bodies[i].position = {(Int32)i, -(Int32)i, "body"};
+            bodies[i].mass = i * 1.5f;
+            bodies[i].path = v16;
+            bodies[i].tag.data.assign(i * 100, 7);
+        }
+        const std::vector<Body> no_bodies;
+
+        for (unsigned int i = 0; i < 3 * 2 * 2; i++)
+        {
+            //Start unaligned, to get the largest padding
+            Packet p;
+            p << (Int8)1;
+            p.set_array_encoding(i % 3 == 0 ? Packet::ArrayEncoding::Network
+                                 : i % 3 == 1 ? Packet::ArrayEncoding::Native
+                                 : Packet::ArrayEncoding::Delta);
+            p.set_string_encoding((i / 3) % 2 ? Packet::StringEncoding::Sized
+                                  : Packet::StringEncoding::Terminated);
+            p.set_object_encoding(i / 6 ? Packet::ObjectEncoding::Schema
+                                  : Packet::ObjectEncoding::Tagged);
+
+            const std::size_t before = p.get_data().size();
+            const std::size_t bound = packed_size(p, str, "World", v16, v64,
+                                                  vd, pt, bodies, no_bodies);
+            write_to_packet(p, str, "World", v16, v64, vd, pt,
+                            bodies, no_bodies);
+            ASSERT(p.get_data().size() - before <= bound,
+                   "packed_size is not an upper bound (encodings " << i << ")");
+            ASSERT(p.get_data().capacity() == before + bound,
+                   "write_to_packet reallocated its buffer (encodings "
+                   << i << ")");
+            ASSERT(p.is_valid(), "write_to_packet built an invalid packet");
+        }
+
+        //Long strings have a longer size in StringEncoding::Sized
+        Packet p;
+        p.set_string_encoding(Packet::StringEncoding::Sized);
+        p << str;
+        ASSERT(packed_size(p, str) == p.get_data().size(),
+               "Wrong sized string packed_size");
+    }
+
+    //Test case 7c : Builders don't copy the strings
+    {
+        const std::string str(100, 's');
+        const std::vector<float> v(20, 1.f);
+        for (int encoding = 0; encoding < 2; encoding++)
+        {
+            Packet p;
+            p.set_string_encoding(encoding ? Packet::StringEncoding::Sized
+                                  : Packet::StringEncoding::Terminated);
+            const std::size_t before = g_allocations;
+            write_to_packet(p, str, (Int32)1, v, str);
+            //Only the data buffer, and nothing once the pool is warm
+            ASSERT(g_allocations - before <= 1, "write_to_packet allocated "
+                   << g_allocations - before << " times (encoding "
+                   << encoding << ")");
+        }
+        const std::size_t before = g_allocations;
+        Packet p = make_packet(str, (Int32)1, v, str);
+        ASSERT(g_allocations - before <= 1, "make_packet allocated "
+               << g_allocations - before << " times");
+    }
+
+    //Test case 8 : Arrays of every length around the SIMD block sizes
+    {
+        for (unsigned int n = 0; n < 70; n++)
+        {
+            std::vector<Int16>  v1(n);
+            std::vector<UInt32> v2(n);
+            std::vector<float>  v3(n);
+            std::vector<UInt64> v4(n);
+            std::vector<double> v5(n);
+            for (unsigned int i = 0; i < n; i++)
+            {
+                v1[i] = -(Int16)(i * 257);
+                v2[i] = 0x01020304u * i;
+                v3[i] = i * 0.5f;
+                v4[i] = 0x0102030405060708ull * i;
+                v5[i] = -(double)i / 3;
+            }
+
+            Packet p = make_packet(v1, v2, v3, v4, v5);
+
+            std::vector<Int16>  u1;
+            std::vector<UInt32> u2;
+            std::vector<float>  u3;
+            std::vector<UInt64> u4;
+            std::vector<double> u5;
+            PacketReader r(p);
+            r >> u1 >> u2 >> u3 >> u4 >> u5;
+
+            ASSERT(v1 == u1 && v2 == u2 && v3 == u3 && v4 == u4 && v5 == u5,
+                   "Array of length " << n << " corrupted");
+        }
+
+        //Elements are big endian on the wire
+        Packet p = make_packet(std::vector<UInt32>({0x01020304u, 0x05060708u}),
+                               std::vector<UInt64>({0x0102030405060708ull}));
+        const ByteArray expected = {0x87, 0, 2, 1, 2, 3, 4, 5, 6, 7, 8,
+                                    0x88, 0, 1, 1, 2, 3, 4, 5, 6, 7, 8};
+        ASSERT(p.get_data() == expected, "Arrays aren't in network byte order");
+    }
+
+    //Test case 9 : Native arrays, read as vectors and as views
+    {
+        std::vector<float> v1 = {1.5f, 2.5f, 3.5f};
+        std::vector<UInt64> v2 = {1, 0x0102030405060708ull};
+        std::vector<Int8> v3 = {-1, 2};
+
+        Packet p;
+        p.set_array_encoding(Packet::ArrayEncoding::Native);
+        //The Int8 misalign the next arrays
+        write_to_packet(p, (Int8)1, v1, v3, v2);
+        write_as_object(p, v2, v1);
+
+        ASSERT(p.is_valid(), "Native arrays : Valid packet with is_valid() == false!");
+
+        Int8 i8;
+        std::vector<float> u1;
+        std::vector<Int8> u3;
+        ArrayView<UInt64> w2;
+        ArrayView<UInt64> w4;
+        ArrayView<float> w5;
+        PacketReader r(p);
+        r >> i8 >> u1 >> u3 >> w2;
+        read_as_object(r, w4, w5);
+
+        ASSERT(u1 == v1 && u3 == v3, "Native arrays read as vectors corrupted");
+        ASSERT(std::vector<UInt64>(w2.begin(), w2.end()) == v2
+               && std::vector<UInt64>(w4.begin(), w4.end()) == v2
+               && std::vector<float>(w5.begin(), w5.end()) == v1,
+               "Native arrays read as views corrupted");
+        ASSERT(w2.is_zero_copy() && w4.is_zero_copy() && w5.is_zero_copy(),
+               "Native arrays were copied");
+        ASSERT(reinterpret_cast<std::uintptr_t>(w2.data()) % alignof(UInt64) == 0,
+               "Native array isn't aligned");
+
+        //Views also read network arrays
+        ArrayView<float> w1;
+        PacketReader(make_packet(v1)) >> w1;
+        ASSERT(std::vector<float>(w1.begin(), w1.end()) == v1 && !w1.is_zero_copy(),
+               "Network array read as view corrupted");
+
+        //Copies of a view own their storage
+        ArrayView<float> copy = w1;
+        ASSERT(copy.data() != w1.data() && copy[2] == 3.5f, "Copied view corrupted");
+
+        //Big endian native UInt32 array {0x01020304} without padding.
+        Packet q;
+        write_to_packet(q, (Int8)0, (Int8)0);
+        const Byte big[] = {0xA7, 0, 1, 0x80, 1, 2, 3, 4};
+        ByteArray data = q.get_data();
+        data.insert(data.end(), big, big + sizeof(big));
+        Packet b;
+        ArrayView<UInt32> w6;
+        std::vector<UInt32> u6;
+        //Build it through a RingBuf, as received packets.
+        {
+            RingBuf buf(300);
+            ByteArray frame = {0, (Byte)(4 + data.size()), 'b', '\0'};
+            frame.insert(frame.end(), data.begin(), data.end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event e;
+            ASSERT(buf.pick_event(e), "Big endian native array dropped");
+            b = e.get_packet();
+        }
+        PacketReader rb(b);
+        rb >> i8 >> i8 >> w6;
+        PacketReader(b) >> i8 >> i8 >> u6;
+        ASSERT(w6.size() == 1 && w6[0] == 0x01020304u && u6 == std::vector<UInt32>({0x01020304u}),
+               "Big endian native array corrupted");
+    }
+
+    //Test case 10 : Random access to the fields, with and without index
+    {
+        std::vector<Int16> v = {1, 2, 3};
+        Point pt = {7, 8, "pt"};
+        Packet p;
+        write_to_packet(p, (UInt8)1, std::string("skip me"), v, pt,
+                        (Int32)42);
+
+        Packet indexed = p;
+        ASSERT(indexed.is_valid(), "Packet with object not valid");
+
+        for (const Packet* packet : {&p, &indexed})
+        {
+            PacketReader r(*packet);
+            ASSERT(r.field_count() == 5, "Wrong field count");
+
+            Int32 i32 = 0;
+            r.seek(4) >> i32;
+            ASSERT(i32 == 42 && !r, "Seek to the last field failed");
+
+            UInt8 u8 = 0;
+            r.seek(0) >> u8;
+            ASSERT(u8 == 1, "Seek to the first field failed");
+
+            std::vector<Int16> w;
+            r.skip() >> w;
+            ASSERT(w == v, "Skip failed");
+
+            //Member 1 of the Point, then the following items
+            Int32 y = 0;
+            std::string label;
+            i32 = 0;
+            r.seek_member(1) >> y >> label >> i32;
+            ASSERT(y == 8 && label == "pt" && i32 == 42,
+                   "Seek to an object member failed");
+
+            r.seek(3).skip();
+            ASSERT(r.next_type() == Packet::Type::Int32, "Skip of an object failed");
+
+            bool thrown = false;
+            try { r.seek(6); } catch (PacketException&) { thrown = true; }
+            ASSERT(thrown, "Seek past the end not detected");
+
+            thrown = false;
+            try { r.seek(0).seek_member(0); } catch (PacketException&) { thrown = true; }
+            ASSERT(thrown, "Seek member of a non object not detected");
+
+            r.seek(5);
+            ASSERT(!r, "Seek to the end failed");
+        }
+
+        //Writing drops the index
+        indexed << (Int8)0;
+        ASSERT(PacketReader(indexed).field_count() == 6, "Outdated index used");
+
+        //Members following nested objects
+        Outer outer;
+        outer.holder.custom.value = 3;
+        outer.holder.point = pt;
+        outer.flag = 9;
+        Packet nested;
+        write_to_packet(nested, outer, (Int32)42);
+        ASSERT(nested.is_valid(), "Packet with nested objects not valid");
+        Int8 flag = 0;
+        Int32 i32 = 0;
+        PacketReader(nested).seek_member(1) >> flag >> i32;
+        ASSERT(flag == 9 && i32 == 42, "Seek to a member after an object failed");
+
+        //Nested objects claiming more members than the packet holds
+        // are rejected without reserving their members
+        ByteArray frame = {0x07, 0xD4, 'z', '\0'};
+        for (int i = 0; i < 1000; i++)
+        {
+            frame.push_back(static_cast<Byte>(Packet::Type::Object));
+            frame.push_back(255);
+        }
+        RingBuf buf(4000);
+        buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+        Event e;
+        const std::size_t before = g_allocated;
+        ASSERT(!buf.pick_event(e), "Hostile nested objects accepted");
+        ASSERT(g_allocated - before < 200000, "Hostile nested objects took "
+               << g_allocated - before << " bytes");
+    }
+
+    //Test case 11 : Trusted packets aren't validated, reads check the bounds
+    {
+        //{Int32 : 2 bytes missing}, {String : no '\0'}, {ArrayInt16 : 3 elements, 1 present}
+        const std::vector<ByteArray> corrupted = {
+            {0x03, 0, 0},
+            {0x20, 'a', 'b'},
+            {0x82, 0, 3, 0, 1},
+        };
+
+        for (const ByteArray& data : corrupted)
+        {
+            RingBuf buf(300);
+            ByteArray frame = {0, (Byte)(4 + data.size()), 't', '\0'};
+            frame.insert(frame.end(), data.begin(), data.end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event e;
+            ASSERT(buf.pick_event(e, true), "Trusted packet dropped");
+
+            bool thrown = false;
+            try
+            {
+                Int32 i32;
+                std::string str;
+                std::vector<Int16> v16;
+                PacketReader r(e.get_packet());
+                switch (r.next_type())
+                {
+                case Packet::Type::Int32: r >> i32; break;
+                case Packet::Type::String: r >> str; break;
+                default: r >> v16; break;
+                }
+            }
+            catch (PacketException& e)
+            {
+                thrown = e.get_type() == PacketExceptionT::Truncated;
+            }
+            ASSERT(thrown, "Read past the end of a trusted packet");
+        }
+    }
+
+    //Test case 12 : Varints
+    {
+        //LEB128, and zigzag for signed values
+        ASSERT(make_packet(varint((UInt32)300)).get_data() == ByteArray({0x09, 0xAC, 0x02}),
+               "Wrong VarUInt encoding");
+        ASSERT(make_packet(varint((Int32)-1), varint((Int32)1), varint((Int16)-64)).get_data()
+               == ByteArray({0x0A, 0x01, 0x0A, 0x02, 0x0A, 0x7F}),
+               "Wrong VarInt encoding");
+
+        const std::vector<Int64> signed_values = {0, 1, -1, 63, -64, 64, -65,
+                                                  std::numeric_limits<Int64>::max(),
+                                                  std::numeric_limits<Int64>::min()};
+        for (Int64 v : signed_values)
+        {
+            Packet p = make_packet(varint(v));
+            ASSERT(p.get_data().size() == packed_size(varint(v)), "Wrong varint packed_size");
+            ASSERT(p.is_valid(), "Varint not valid");
+            VarInt<Int64> r;
+            PacketReader(p) >> r;
+            ASSERT(r == v, "VarInt corrupted : " << v);
+        }
+
+        Packet p = make_packet(varint(std::numeric_limits<UInt64>::max()));
+        ASSERT(p.get_data().size() == 11 && p.is_valid(), "Wrong 64 bits varint");
+        VarInt<UInt64> u64;
+        PacketReader(p) >> u64;
+        ASSERT(u64 == std::numeric_limits<UInt64>::max(), "VarUInt corrupted");
+
+        //Too big for the type read
+        bool thrown = false;
+        try
+        {
+            VarInt<UInt16> u16;
+            PacketReader(make_packet(varint((UInt32)70000))) >> u16;
+        }
+        catch (PacketException& e)
+        {
+            thrown = e.get_type() == PacketExceptionT::VarIntOverflow;
+        }
+        ASSERT(thrown, "Varint overflow not detected");
+
+        //Truncated varint
+        Packet truncated = make_packet(varint((UInt32)300));
+        ByteArray data = truncated.get_data();
+        data.pop_back();
+        {
+            RingBuf buf(300);
+            ByteArray frame = {0, (Byte)(4 + data.size()), 't', '\0'};
+            frame.insert(frame.end(), data.begin(), data.end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event e;
+            ASSERT(!buf.pick_event(e), "Truncated varint accepted");
+        }
+
+        //Serializable objects, much smaller than with Int32 / Int64
+        Sample s = {5, -3};
+        Packet ps;
+        ps << s;
+        ASSERT(ps.get_data().size() == 2 + 2 + 2, "Wrong serialized varints size");
+        Sample s2;
+        PacketReader(ps) >> s2;
+        ASSERT(s2.id == 5u && s2.delta == -3, "Serialized varints corrupted");
+    }
+
+    //Test case 13 : Delta encoded arrays
+    {
+        std::vector<Int64> timestamps(1000);
+        std::vector<UInt32> ids(1000);
+        for (unsigned int i = 0; i < timestamps.size(); i++)
+        {
+            timestamps[i] = 1400000000000LL + i * 16 + (i % 3);
+            ids[i] = 100000 + i * 7;
+        }
+
+        Packet p;
+        p.set_array_encoding(Packet::ArrayEncoding::Delta);
+        p << timestamps << ids << std::vector<float>({1.f, 2.f});
+        ASSERT(p.is_valid(), "Delta arrays not valid");
+        ASSERT(p.get_data()[0] == 0xC4, "Int64 array not delta encoded");
+        ASSERT(p.get_data().size() < (8 + 4) * 1000 / 4,
+               "Delta arrays too big : " << p.get_data().size());
+
+        std::vector<Int64> t2;
+        ArrayView<UInt32> ids2;
+        std::vector<float> f2;
+        PacketReader(p) >> t2 >> ids2 >> f2;
+        ASSERT(t2 == timestamps, "Delta Int64 array corrupted");
+        ASSERT(std::vector<UInt32>(ids2.begin(), ids2.end()) == ids,
+               "Delta UInt32 array read as view corrupted");
+        ASSERT(f2 == std::vector<float>({1.f, 2.f}), "Float array corrupted");
+
+        //Any value, any length around the block size, every type
+        for (unsigned int n : {0, 1, 255, 256, 257, 600})
+        {
+            std::vector<Int16> i16(n);
+            std::vector<UInt16> u16(n);
+            std::vector<Int32> i32(n);
+            std::vector<UInt64> u64(n);
+            for (unsigned int i = 0; i < n; i++)
+            {
+                i16[i] = (i % 2) ? -32768 : 32767;
+                u16[i] = i * 977;
+                i32[i] = (i % 5) ? -i * 123457 : 2147483647;
+                u64[i] = (i % 3) ? ~(UInt64)i : (UInt64)i << 40;
+            }
+            Packet d;
+            d.set_array_encoding(Packet::ArrayEncoding::Delta);
+            d << i16 << u16 << i32 << u64;
+            ASSERT(d.is_valid(), "Delta arrays of length " << n << " not valid");
+
+            std::vector<Int16> ri16;
+            std::vector<UInt16> ru16;
+            std::vector<Int32> ri32;
+            std::vector<UInt64> ru64;
+            PacketReader(d) >> ri16 >> ru16 >> ri32 >> ru64;
+            ASSERT(ri16 == i16 && ru16 == u16 && ri32 == i32 && ru64 == u64,
+                   "Delta arrays of length " << n << " corrupted");
+        }
+
+        //Truncated varints
+        ByteArray data = {0xC3, 0, 2, 0x02, 0x80};
+        {
+            RingBuf buf(300);
+            ByteArray frame = {0, (Byte)(4 + data.size()), 'd', '\0'};
+            frame.insert(frame.end(), data.begin(), data.end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event e;
+            ASSERT(!buf.pick_event(e), "Truncated delta array accepted");
+        }
+    }
+
+    //Test case 14 : Sized strings, blobs and string views
+    {
+        const std::string zeros("a\0b\0c", 5);
+        Packet p;
+        p.set_string_encoding(Packet::StringEncoding::Sized);
+        p << zeros << "hello" << Blob("\x01\x00\xFF", 3) << Int8(7);
+        ASSERT(p.is_valid(), "Sized strings not valid");
+
+        //[type][varint length][bytes]
+        const ByteArray& data = p.get_data();
+        ASSERT(data.size() == (2 + 5) + (2 + 5) + (2 + 3) + 2,
+               "Wrong sized strings size : " << data.size());
+        ASSERT(data[0] == 0x21 && data[1] == 5 && data[14] == 0x22,
+               "Wrong sized strings layout");
+
+        std::string s1;
+        StringView s2;
+        Blob b;
+        Int8 i8;
+        PacketReader r(p);
+        r >> s1 >> s2 >> b >> i8;
+        ASSERT(s1 == zeros, "Embedded '\\0' lost");
+        ASSERT(s2 == StringView("hello", 5) && s2.str() == "hello",
+               "String view corrupted");
+        ASSERT(s2.data() == reinterpret_cast<const char*>(data.data()) + 9,
+               "String view doesn't point into the packet");
+        ASSERT(b.data == ByteArray({0x01, 0x00, 0xFF}), "Blob corrupted");
+        ASSERT(i8 == 7, "Int8 after the blob corrupted");
+
+        //Skipped in O(1), views work on C strings and blobs too
+        Packet q;
+        q << "old" << Blob(ByteArray(300, 0x42)) << std::string("new");
+        ASSERT(q.is_valid(), "Long blob not valid");
+        StringView v1, v2;
+        PacketReader rq(q);
+        rq >> v1;
+        rq.skip() >> v2;
+        ASSERT(v1 == StringView("old", 3) && v2 == StringView("new", 3),
+               "Views over C strings corrupted");
+        PacketReader(q).skip() >> v1;
+        ASSERT(v1.size() == 300 && v1[299] == 0x42, "View over a blob corrupted");
+
+        //A string isn't a blob
+        bool thrown = false;
+        try { PacketReader(q) >> b; }
+        catch(PacketException&) { thrown = true; }
+        ASSERT(thrown, "String read as a blob");
+
+        //Length past the end of the packet
+        ByteArray bad = {0x21, 0x05, 'a', 'b'};
+        {
+            RingBuf buf(300);
+            ByteArray frame = {0, (Byte)(4 + bad.size()), 's', '\0'};
+            frame.insert(frame.end(), bad.begin(), bad.end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event e;
+            ASSERT(!buf.pick_event(e), "Truncated sized string accepted");
+        }
+    }
+
+    //Test case 15 : Compressed packets are decompressed before validation
+    {
+        //{Compressed, LZ, 22 bytes} : the string "aaaa...a" (20 'a')
+        // as two literals, a match of 19 bytes at offset 1, and a '\0'.
+        ByteArray lz = {0x23, 0x01, 22,
+                        0x2F, 0x20, 'a', 0x01, 0x00, 0x00, 0x10, 0x00};
+        ByteArray bad_offset = lz;
+        bad_offset[6] = 0x03;
+        ByteArray bad_size = lz;
+        bad_size[2] = 23;
+        ByteArray bad_codec = lz;
+        bad_codec[1] = 0x09;
+
+        RingBuf buf(300);
+        for (const ByteArray* data : {&lz, &bad_offset, &bad_size, &bad_codec})
+        {
+            ByteArray frame = {0, (Byte)(4 + data->size()), 'z', '\0'};
+            frame.insert(frame.end(), data->begin(), data->end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+        }
+
+        Event e;
+        CompressionStats stats;
+        ASSERT(buf.pick_event(e, false, &stats), "Compressed packet dropped");
+        std::string str;
+        PacketReader(e.get_packet()) >> str;
+        ASSERT(e.is_compressed() && str == std::string(20, 'a'),
+               "Compressed packet corrupted");
+        ASSERT(stats.decompressed_events == 1 && stats.received_bytes == 11
+               && stats.decompressed_bytes == 22, "Wrong decompression stats");
+
+        for (int i = 0; i < 3; i++)
+            ASSERT(!buf.pick_event(e, true), "Corrupted compressed packet "
+                   << i << " accepted");
+        ASSERT(buf.length() == 0, "Corrupted compressed packets not consumed");
+    }
+
+    //Test case 16 : Packets don't allocate memory once the pool is warm
+    if (!getenv("SEDNL_NO_POOL"))
+    {
+        RingBuf buf(4000);
+        const std::vector<Int32> values(200, 7);
+        UInt64 heap = 0;
+        for (int i = 0; i < 1000; i++)
+        {
+            //Build, send (frame), receive and destroy an event
+            Event e("pool", make_packet(i, std::string(i % 50, 'p'), values));
+            const ByteArray frame = e.pack();
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event r;
+            ASSERT(buf.pick_event(r), "Pooled packet dropped");
+            ASSERT(r.get_packet().get_data() == e.get_packet().get_data(),
+                   "Pooled packet corrupted");
+
+            if (i == 100)
+                heap = get_buffer_pool_stats().heap_allocations;
+        }
+        const BufferPoolStats stats = get_buffer_pool_stats();
+        ASSERT(stats.heap_allocations == heap, "Packets still allocate : "
+               << stats.heap_allocations - heap << " allocations");
+        ASSERT(stats.reused > 1000, "Buffers weren't reused");
+    }
+
+    //Test case 16b : The depot keeps a bounded size of buffers
+    if (!getenv("SEDNL_NO_POOL"))
+    {
+        set_buffer_pool_depot_size(64 << 10);
+        const UInt64 released = get_buffer_pool_stats().heap_releases;
+        //Its cached buffers go to the depot when the thread exits
+        std::thread([]() {
+                std::vector<ByteArray> buffers(200, ByteArray(4096));
+            }).join();
+        BufferPoolStats stats = get_buffer_pool_stats();
+        ASSERT(stats.depot_bytes > 0 && stats.depot_bytes <= 64 << 10,
+               "Wrong depot size : " << stats.depot_bytes << " bytes");
+        ASSERT(stats.heap_releases - released >= 200 - 16,
+               "Buffers above the depot size weren't released");
+
+        trim_buffer_pool();
+        stats = get_buffer_pool_stats();
+        ASSERT(stats.depot_bytes == 0, "The depot wasn't trimmed");
+        set_buffer_pool_depot_size(BUFFER_POOL_DEPOT_SIZE);
+    }
+
+    //Test case 17 : Schema objects, without the types of the members
+    {
+        Body body;
+        body.position.x = -3;
+        body.position.y = 70000;
+        body.position.label = "rock";
+        body.mass = 2.5f;
+        body.path = {1, -2, 300};
+        body.tag = Blob("\x01\x00\x02", 3);
+
+        Packet tagged, schema;
+        schema.set_object_encoding(Packet::ObjectEncoding::Schema);
+        tagged << body << Int8(5);
+        schema << body << Int8(5);
+        ASSERT(schema.is_valid(), "Schema object not valid");
+
+        //{SchemaObject, fingerprint, length}, and no nested header
+        const ByteArray& data = schema.get_data();
+        ASSERT(data[0] == 0x41 && data[3] == data.size() - 4 - 2,
+               "Wrong schema object header");
+        //Point (4 + 4 + 1 + 4), mass, path (2 + 3 * 2), tag (1 + 3)
+        ASSERT(data.size() == 4 + 13 + 4 + 8 + 4 + 2
+               && data.size() < tagged.get_data().size(),
+               "Wrong schema object size : " << data.size() << " bytes vs "
+               << tagged.get_data().size() << " tagged");
+
+        //Both encodings are read, and the reader ends after the object
+        for (const Packet* p : {&tagged, &schema})
+        {
+            Body read;
+            Int8 after;
+            PacketReader(*p) >> read >> after;
+            ASSERT(read.position.x == -3 && read.position.y == 70000
+                   && read.position.label == "rock" && read.mass == 2.5f
+                   && read.path == body.path && read.tag.data == body.tag.data
+                   && after == 5, "Schema object corrupted");
+        }
+
+        //Long objects, through the validation of a ring buffer
+        Point longer = body.position;
+        longer.label = std::string(300, 'l');
+        Packet lp;
+        lp.set_object_encoding(Packet::ObjectEncoding::Schema);
+        lp << longer << Int8(6);
+        RingBuf buf(1000);
+        const ByteArray frame = Event("schema", lp).pack();
+        buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+        Event e;
+        ASSERT(buf.pick_event(e), "Long schema object dropped");
+        Point lread;
+        Int8 lafter;
+        PacketReader(e.get_packet()) >> lread >> lafter;
+        ASSERT(lread.label == longer.label && lafter == 6,
+               "Long schema object corrupted");
+
+        //Another layout is detected
+        bool thrown = false;
+        WidePoint wide;
+        try { PacketReader(lp) >> wide; }
+        catch(PacketException&) { thrown = true; }
+        ASSERT(thrown, "Schema object read with another layout");
+
+        //Objects with an unknown member stay tagged, members don't
+        Outer outer;
+        outer.holder.custom.value = 11;
+        outer.holder.point = body.position;
+        outer.flag = 1;
+        Packet op;
+        op.set_object_encoding(Packet::ObjectEncoding::Schema);
+        op << outer.holder << outer;
+        ASSERT(op.is_valid() && op.get_data()[0] == 0x40,
+               "Object with an unknown member not tagged");
+        Holder hread;
+        Outer oread;
+        PacketReader(op) >> hread >> oread;
+        ASSERT(hread.custom.value == 11 && hread.point.y == 70000
+               && oread.holder.custom.value == 11
+               && oread.holder.point.label == "rock" && oread.flag == 1,
+               "Nested schema objects corrupted");
+    }
+
+    //Test case 18 : Vectors of objects, written column by column
+    {
+        std::vector<Body> bodies(500);
+        for (std::size_t i = 0; i < bodies.size(); i++)
+        {
+            bodies[i].position.x = i;
+            bodies[i].position.y = -static_cast<Int32>(i * i);
+            bodies[i].position.label = std::string(i % 7, 'b');
+            bodies[i].mass = i / 4.f;
+            bodies[i].path.assign(i % 3, static_cast<Int16>(i));
+            bodies[i].tag = Blob(&i, i % 2);
+        }
+        std::vector<Sample> samples(3);
+        samples[1].id = 300;
+        samples[2].delta = -5;
+
+        Packet p;
+        p << bodies << std::vector<Point>() << samples << Int8(9);
+        ASSERT(p.is_valid(), "Object arrays not valid");
+
+        Packet one_by_one;
+        for (const Body& body : bodies)
+            one_by_one << body;
+        ASSERT(p.get_data().size() < one_by_one.get_data().size(),
+               "Object array too big : " << p.get_data().size()
+               << " bytes vs " << one_by_one.get_data().size());
+
+        std::vector<Body> rbodies;
+        std::vector<Point> rpoints(4);
+        std::vector<Sample> rsamples;
+        Int8 after;
+        PacketReader(p) >> rbodies >> rpoints >> rsamples >> after;
+        ASSERT(rbodies.size() == bodies.size() && rpoints.empty()
+               && rsamples.size() == 3 && after == 9,
+               "Wrong object array sizes");
+        for (std::size_t i = 0; i < bodies.size(); i++)
+            ASSERT(rbodies[i].position.x == bodies[i].position.x
+                   && rbodies[i].position.y == bodies[i].position.y
+                   && rbodies[i].position.label == bodies[i].position.label
+                   && rbodies[i].mass == bodies[i].mass
+                   && rbodies[i].path == bodies[i].path
+                   && rbodies[i].tag.data == bodies[i].tag.data,
+                   "Object " << i << " of the object array corrupted");
+        ASSERT(rsamples[1].id == 300U && rsamples[2].delta == -5,
+               "Object array of varints corrupted");
+
+        //Numeric columns use the array encodings
+        Packet delta;
+        delta.set_array_encoding(Packet::ArrayEncoding::Delta);
+        delta << bodies;
+        ASSERT(delta.is_valid()
+               && delta.get_data().size() < p.get_data().size(),
+               "Delta encoded columns not smaller");
+        PacketReader(delta) >> rbodies;
+        ASSERT(rbodies.back().position.y == bodies.back().position.y,
+               "Delta encoded columns corrupted");
+
+        //Another type of object
+        bool thrown = false;
+        std::vector<WidePoint> wide;
+        Packet points;
+        points << std::vector<Point>(2);
+        try { PacketReader(points) >> wide; }
+        catch(PacketException&) { thrown = true; }
+        ASSERT(thrown, "Object array read as another type");
+
+        //A column shorter than the objects : {2 Points, 3 members},
+        // x : {ArrayInt32, 1 element}, y : {ArrayInt32, 2 elements}
+        // and label : 2 strings.
+        ByteArray bad = {0x42, 0, 2, 3, 0x00, 0x00, 0x01,
+                         0x83, 0, 1, 0, 0, 0, 1,
+                         0x83, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2,
+                         0x20, 'a', 0, 0x20, 0};
+        {
+            RingBuf buf(300);
+            ByteArray frame = {0, (Byte)(4 + bad.size()), 'o', '\0'};
+            frame.insert(frame.end(), bad.begin(), bad.end());
+            buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+            Event e;
+            ASSERT(buf.pick_event(e), "Object array dropped");
+            std::vector<Point> short_column;
+            thrown = false;
+            try { PacketReader(e.get_packet()) >> short_column; }
+            catch(PacketException&) { thrown = true; }
+            ASSERT(thrown, "Short column accepted");
+        }
+    }
+
+    //Test case 19 : Synchronization of objects by their changed fields
+    {
+        StateSync sender, receiver;
+        std::vector<Player> players(2);
+        for (int i = 0; i < 2; i++)
+        {
+            players[i].id = i;
+            players[i].x = players[i].y = players[i].z = i;
+            players[i].name = "player";
+            players[i].health = players[i].mana = 100;
+            players[i].items = {1, 2, 3};
+            players[i].score = 1LL << 40;
+            players[i].target.label = "target";
+        }
+
+        //Full objects first, then their changes
+        Packet full, delta, none;
+        for (Player& player : players)
+            ASSERT(sender.write(full, player.id, player),
+                   "First state not written");
+        const std::vector<Player> first = players;
+        players[1].x = 2.5f;
+        players[1].health = 42;
+        for (Player& player : players)
+            sender.write(delta, player.id, player);
+        for (Player& player : players)
+            ASSERT(!sender.write(none, player.id, player),
+                   "Unchanged state written");
+        ASSERT(none.get_data().empty() && sender.size() == 2,
+               "Wrong sender state");
+        ASSERT(delta.get_data().size() * 4 < full.get_data().size(),
+               "Changes too big : " << delta.get_data().size()
+               << " bytes vs " << full.get_data().size());
+
+        //A receiver needs the full objects
+        bool thrown = false;
+        UInt32 id;
+        Player player;
+        try { PacketReader r(delta); StateSync().read(r, id, player); }
+        catch(PacketException&) { thrown = true; }
+        ASSERT(thrown, "Changes applied without the last state");
+
+        //Unchanged objects aren't in the changes
+        for (const Packet* p : {&full, &delta})
+        {
+            PacketReader r(*p);
+            unsigned int count = 0;
+            while (r)
+            {
+                Player read;
+                receiver.read(r, id, read);
+                ASSERT(id < 2 && (p == &full || id == 1), "Wrong object id");
+                const Player& sent = (p == &full) ? first[id] : players[id];
+                ASSERT(read.x == sent.x && read.health == sent.health
+                       && read.name == sent.name && read.items == sent.items
+                       && read.score == sent.score
+                       && read.target.label == sent.target.label,
+                       "Object " << id << " wrongly rebuilt");
+                count++;
+            }
+            ASSERT(count == (p == &full ? 2U : 1U), "Wrong number of objects");
+        }
+
+        //Forgotten objects are written again
+        sender.reset();
+        Packet again;
+        ASSERT(sender.write(again, 1, players[1])
+               && again.get_data().size() > delta.get_data().size(),
+               "Object not written again after reset()");
+    }
+
+    //Test case 20 : Reads reporting errors without exceptions
+    {
+        Point point = {1, 2, "a"};
+        Body body;
+        body.position = point;
+        body.mass = 3.f;
+        body.path = {1, 2};
+        Packet packet = make_packet((Int32)7, std::string("seven"),
+                                    varint((UInt32)70000), point, body);
+
+        Int32 i32 = 0;
+        std::string str;
+        VarInt<UInt32> v32;
+        Point read_point;
+        Body read_body;
+        PacketReader r(packet);
+        ASSERT(r.try_read(i32) && r.try_read(str) && r.try_read(v32)
+               && r.try_read(read_point) && r.try_read(read_body)
+               && !r.failed(), "Good packet rejected");
+        ASSERT(i32 == 7 && str == "seven" && v32.value == 70000
+               && read_point.label == "a" && read_body.path == body.path,
+               "Wrong values read");
+
+        //Past the end
+        ASSERT(!r.try_read(i32) && r.get_error() == PacketExceptionT::EndOfPacket,
+               "Read past the end");
+
+        //The first error is kept, and the reader isn't moved
+        PacketReader bad(packet);
+        Int16 i16 = 5;
+        VarInt<UInt16> v16;
+        ASSERT(!bad.try_read(i16) && i16 == 5
+               && bad.get_error() == PacketExceptionT::Int32Expected,
+               "Wrong type read");
+        ASSERT(!bad.try_read(i32) && bad.get_error() == PacketExceptionT::Int32Expected,
+               "Error not kept");
+        bad.clear_error();
+        ASSERT(bad.try_read(i32) && bad.try_read(str), "Error not cleared");
+        ASSERT(!bad.try_read(v16) && bad.get_error() == PacketExceptionT::VarIntOverflow,
+               "Varint overflow not reported");
+        bad.clear_error();
+        ASSERT(bad.try_read(v32), "Reader moved by a failed read");
+
+        //Objects with other members
+        WidePoint wide;
+        ASSERT(!bad.try_read(wide) && bad.get_error() == PacketExceptionT::Int32Expected
+               && bad.next_type() == Packet::Type::Object,
+               "Wrong object read");
+        bad.clear_error();
+        Int32 x, y;
+        ASSERT(!try_read_as_object(bad, x, y)
+               && bad.get_error() == PacketExceptionT::WrongSizedObject,
+               "Object of another size read");
+        bad.clear_error();
+        ASSERT(try_read_as_object(bad, x, y, str) && x == 1 && y == 2,
+               "Object not read");
+
+        //Objects having their own unserialize()
+        Holder holder, read_holder;
+        holder.custom.value = 3;
+        holder.point = point;
+        Packet holders = make_packet(holder, (Int8)0);
+        PacketReader hr(holders);
+        ASSERT(hr.try_read(read_holder) && read_holder.custom.value == 3
+               && read_holder.point.label == "a", "Holder not read");
+        ASSERT(!hr.try_read(read_holder.custom)
+               && hr.get_error() == PacketExceptionT::Int8Expected
+               && hr.next_type() == Packet::Type::Int8,
+               "Wrong custom object read");
+
+        //Schema objects with another fingerprint
+        Packet schema;
+        schema.set_object_encoding(Packet::ObjectEncoding::Schema);
+        schema << point;
+        PacketReader sr(schema);
+        ASSERT(!sr.try_read(wide) && sr.get_error() == PacketExceptionT::SchemaMismatch,
+               "Schema object of another type read");
+        sr.clear_error();
+        ASSERT(sr.try_read(read_point) && read_point.y == 2, "Schema object not read");
+
+        //Truncated items of trusted packets
+        const ByteArray data = {0x03, 0, 0};
+        RingBuf buf(300);
+        ByteArray frame = {0, (Byte)(4 + data.size()), 't', '\0'};
+        frame.insert(frame.end(), data.begin(), data.end());
+        buf.put(reinterpret_cast<const char*>(frame.data()), frame.size());
+        Event e;
+        ASSERT(buf.pick_event(e, true), "Trusted packet dropped");
+        PacketReader tr(e.get_packet());
+        ASSERT(!tr.try_read(i32) && tr.get_error() == PacketExceptionT::Truncated,
+               "Truncated item read");
+    }
+
     //HUGE SUCCESS :)
     return EXIT_SUCCESS;
 }
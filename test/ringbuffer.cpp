@@ -108,6 +108,53 @@ int main()
                " should be empty.");
     }
 
+    //Events crossing the end of the buffer
+    {
+        Event e;
+        RingBuf buf(15);
+
+        for (int i = 0; i < 10; i++)
+        {
+            //9 bytes packet, abc name, then an Int16 with value 0x0102.
+            ASSERT(buf.put("\0\011abc\0\2\1\2", 9) == true, "Can't put data");
+            ASSERT(buf.pick_event(e) == true, "Can't pick event!");
+            ASSERT(e.get_name() == "abc", "Wrong name after a turn");
+
+            Int16 v = 0;
+            try
+            {
+                PacketReader(e.get_packet()) >> v;
+            }
+            catch(...)
+            {
+                ASSERT(false, "Reading data as Int16 failed");
+            }
+            ASSERT(v == 0x0102, "Wrong value read after a turn");
+        }
+    }
+
+    //Growing keeps the content, even across the end of the buffer
+    {
+        Event e;
+        RingBuf buf(15);
+
+        ASSERT(buf.put("\0\011abc\0\2\1\2", 9) == true, "Can't put data");
+        ASSERT(buf.pick_event(e) == true, "Can't pick event!");
+        //12 bytes packet, two Int16
+        ASSERT(buf.put("\0\014abc\0\2\1\2", 9) == true, "Can't put data");
+
+        buf.grow(30);
+        ASSERT(buf.size() == 30, "Buffer didn't grow");
+        ASSERT(buf.length() == 9, "Content lost while growing");
+        ASSERT(buf.put("\2\3\4", 3) == true, "Can't put data after growing");
+        ASSERT(buf.pick_event(e) == true, "Can't pick event after growing");
+        ASSERT(e.get_name() == "abc" && e.get_packet().get_data().size() == 6,
+               "Wrong event after growing");
+
+        buf.grow(20);
+        ASSERT(buf.size() == 30, "Buffer shrunk");
+    }
+
     //HUGE SUCCESS :)
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,244 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+
+// Test cases, to check that slots store, copy and call their callbacks
+
+#include "SEDNL/Slot.hpp"
+#include "SEDNL/Event.hpp"
+#include "SEDNL/EventConsumer.hpp"
+#include "SEDNL/Connection.hpp"
+#include "SEDNL/Packet.hpp"
+
+#include <iostream>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+static int g_sum = 0;
+
+static void add(int v)
+{
+    g_sum += v;
+}
+
+struct Counter
+{
+    int sum = 0;
+
+    void add(int v)
+    {
+        sum += v;
+    }
+
+    void on_event(Connection&, const Event&)
+    {
+        sum++;
+    }
+};
+
+//Count the living copies of a callback.
+struct Tracked
+{
+    static int alive;
+
+    Tracked(int* out) : out(out), label("tracked") { alive++; }
+    Tracked(const Tracked& t) : out(t.out), label(t.label) { alive++; }
+    ~Tracked() { alive--; }
+
+    void operator()(int v) { *out += v * label.size(); }
+
+    int* out;
+    std::string label;
+};
+
+int Tracked::alive = 0;
+
+//A handler too big to fit inside a slot.
+struct BigHandler
+{
+    BigHandler() : prefix("a long enough prefix to be allocated"), suffix("!") {}
+
+    void add(int v)
+    {
+        sum += v * (prefix.size() + suffix.size());
+    }
+
+    std::string prefix;
+    std::string suffix;
+    Tracked tracked = Tracked(&sum);
+    int sum = 0;
+};
+
+int main()
+{
+    //Test case 1 : Empty slot
+    {
+        Slot<int> slot;
+        ASSERT(!slot, "Test 1: A new slot should be empty");
+        slot(42);
+    }
+
+    //Test case 2 : Function pointer, lambda and std::function
+    {
+        Slot<int> slot;
+        g_sum = 0;
+        slot.set_function(add);
+        ASSERT(slot, "Test 2: The slot should contain a callback");
+        slot(1);
+        int local = 0;
+        slot.set_function([&](int v) { local += v; });
+        slot(2);
+        slot.set_function(std::function<void(int)>(add));
+        slot(3);
+        ASSERT(g_sum == 4 && local == 2, "Test 2: Wrong callbacks called");
+        slot.reset();
+        ASSERT(!slot, "Test 2: reset() should empty the slot");
+    }
+
+    //Test case 3 : Member functions
+    {
+        Counter counter;
+        Slot<int> slot;
+        slot.set_function(&counter, &Counter::add);
+        slot(1);
+        slot.set_function<Counter, &Counter::add>(&counter);
+        slot(2);
+        slot.set_function(counter, &Counter::add);
+        slot(4);
+        ASSERT(counter.sum == 3, "Test 3: Wrong member function calls");
+
+        g_sum = 0;
+        slot.set_function<&add>();
+        slot(5);
+        ASSERT(g_sum == 5, "Test 3: Wrong function call");
+    }
+
+    //Test case 4 : Copy, move and destruction of the callback
+    {
+        int out = 0;
+        {
+            Slot<int> slot;
+            slot.set_function(Tracked(&out));
+            ASSERT(Tracked::alive == 1, "Test 4: The callback should be stored once");
+            Slot<int> copy(slot);
+            Slot<int> moved(std::move(slot));
+            ASSERT(!slot && copy && moved, "Test 4: Wrong slots after copy and move");
+            ASSERT(Tracked::alive == 2, "Test 4: Wrong number of callbacks after copy and move");
+            copy(1);
+            moved(1);
+            copy = moved;
+            ASSERT(Tracked::alive == 2, "Test 4: Wrong number of callbacks after assignation");
+            copy.set_function(add);
+            ASSERT(Tracked::alive == 1, "Test 4: The replaced callback should be destroyed");
+        }
+        ASSERT(Tracked::alive == 0, "Test 4: The callback should be destroyed with the slot");
+        ASSERT(out == 14, "Test 4: Wrong calls of the callback");
+    }
+
+    //Test case 5 : Binding a member function to a consumer
+    {
+        Counter counter;
+        EventConsumer consumer;
+        Slot<Connection&, const Event&>& slot =
+            consumer.bind<Counter, &Counter::on_event>("count", &counter);
+        ASSERT(slot, "Test 5: The event should be bound");
+        Connection cn;
+        slot(cn, Event("count"));
+        ASSERT(counter.sum == 1, "Test 5: The member function wasn't called");
+    }
+
+    //Test case 6 : Binding the arguments of an event
+    {
+        EventConsumer consumer;
+        int calls = 0;
+        std::string name;
+        Int32 id = 0;
+        std::vector<float> position;
+        Slot<Connection&, const Event&>& slot =
+            consumer.bind<std::string, Int32, std::vector<float>>("move",
+                [&](Connection&, std::string& n, Int32 i, const std::vector<float>& p) {
+                    name = n;
+                    id = i;
+                    position = p;
+                    calls++;
+                });
+        Connection cn;
+
+        Packet good;
+        good << "player" << (Int32)7 << std::vector<float>{1.f, 2.f};
+        slot(cn, Event("move", good));
+        ASSERT(calls == 1 && name == "player" && id == 7
+               && position == std::vector<float>({1.f, 2.f}),
+               "Test 6: The arguments weren't read");
+
+        Packet wrong_type;
+        wrong_type << "player" << (Int16)7 << std::vector<float>{1.f};
+        slot(cn, Event("move", wrong_type));
+        Packet too_short;
+        too_short << "player" << (Int32)7;
+        slot(cn, Event("move", too_short));
+        Packet too_long;
+        too_long << "player" << (Int32)7 << std::vector<float>{1.f} << (Int32)8;
+        slot(cn, Event("move", too_long));
+        ASSERT(calls == 1, "Test 6: Mismatched packets should be dropped");
+    }
+
+    //Test case 7 : Callbacks bigger than the slot buffer
+    {
+        std::string first = "first";
+        std::string second = "second";
+        std::string result;
+        {
+            Slot<int> slot;
+            slot.set_function([=, &result](int v) {
+                result = first + second + std::to_string(v); });
+            Slot<int> copy(slot);
+            slot.reset();
+            copy(1);
+            ASSERT(result == "firstsecond1", "Test 7: Wrong call of a big lambda");
+
+            BigHandler handler;
+            static_assert(sizeof(handler) > Slot<int>::StorageSize,
+                          "BigHandler should be bigger than a slot buffer");
+            ASSERT(Tracked::alive == 1, "Test 7: Wrong number of callbacks");
+            slot.set_function(handler, &BigHandler::add);
+            ASSERT(Tracked::alive == 2, "Test 7: The handler should be copied once");
+            Slot<int> moved(slot);
+            copy = moved;
+            slot = std::move(moved);
+            ASSERT(Tracked::alive == 3, "Test 7: Wrong number of copies of the handler");
+            copy(1);
+            slot(1);
+            ASSERT(handler.sum == 0, "Test 7: The slot should call a copy of the handler");
+            copy.set_function(add);
+            ASSERT(Tracked::alive == 2, "Test 7: The replaced handler should be destroyed");
+        }
+        ASSERT(Tracked::alive == 0, "Test 7: The handlers should be destroyed");
+    }
+
+    return EXIT_SUCCESS;
+}
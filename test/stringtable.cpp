@@ -0,0 +1,176 @@
+// SEDNL - Copyright (c) 2013 Jeremy S. Cochoy
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+//     1. The origin of this software must not be misrepresented; you must not
+//        claim that you wrote the original software. If you use this software
+//        in a product, an acknowledgment in the product documentation would
+//        be appreciated but is not required.
+//
+//     2. Altered source versions must be plainly marked as such, and must not
+//        be misrepresented as being the original software.
+//
+//     3. This notice may not be removed or altered from any source
+//        distribution.
+
+// Test cases, to check that strings sent through a string table
+// are received unchanged
+
+#include "SEDNL/sednl.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+
+using namespace SedNL;
+
+#define ASSERT(exp, msg) {if (!(exp)) { std::cerr << msg << std::endl; return EXIT_FAILURE; }}
+
+//Wait at most one second for cond() to become true.
+template<typename F>
+static bool wait_for(F cond)
+{
+    for (int i = 0; i < 100 && !cond(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return cond();
+}
+
+//Terminated strings stop at the '\0'
+static std::string make_tag(int i)
+{
+    if (i % 3)
+        return "tag";
+    return std::string("a\0b", i % 2 ? 3 : 1);
+}
+
+struct Entity
+{
+    std::string type;
+    Int32 id;
+    std::string region;
+
+    SEDNL_SERIALIZABLE(type, id, region);
+};
+
+int main()
+{
+    try
+    {
+        SocketAddress addr(23460, "127.0.0.1");
+        TCPServer server(addr, true);
+        EventListener server_listener(server);
+        EventConsumer consumer(server_listener);
+
+        //More distinct strings than slots, to evict some of them
+        const std::vector<std::string> types = {"orc", "goblin", "troll",
+                                                "dragon", "x", "orc"};
+        const std::vector<std::string> regions = {"north", "south"};
+        const int nb_events = 60;
+
+        std::atomic<int> received(0);
+        std::atomic<int> correct(0);
+        consumer.bind("entity").set_function([&](Connection&, const Event& e) {
+                Entity entity;
+                std::string tag;
+                PacketReader(e.get_packet()) >> entity >> tag;
+                const int i = entity.id;
+                correct += entity.type == types[i % types.size()]
+                    && entity.region == regions[i % regions.size()]
+                    && tag == make_tag(i);
+                received++;
+            });
+        std::atomic<int> giants(0);
+        consumer.bind("giant").set_function([&](Connection&, const Event& e) {
+                std::string name;
+                PacketReader(e.get_packet()) >> name;
+                giants += name == "ogre" ? 1 : 1000;
+            });
+        server_listener.run();
+        consumer.run();
+
+        TCPClient client(addr);
+        EventListener client_listener(client);
+        client_listener.run();
+
+        client.set_string_table(4);
+        ASSERT(wait_for([&]() { return client.get_string_table_size() == 4; }),
+               "String table refused by the server");
+
+        //Size of the packets compressed, without the string table
+        std::size_t plain_bytes = 0;
+        for (int i = 0; i < nb_events; i++)
+        {
+            //Sized and terminated strings, with and without compression
+            Entity entity = {types[i % types.size()], i,
+                             regions[i % regions.size()]};
+            Packet p;
+            if (i % 2)
+                p.set_string_encoding(Packet::StringEncoding::Sized);
+            p << entity << std::string(i % 3 ? "tag" : "a\0b", 3);
+            //Then with a table big enough for all the strings
+            if (i == nb_events / 2)
+            {
+                client.set_string_table(16);
+                client.set_compression(Compression::LZ, 0);
+                ASSERT(wait_for([&]() {
+                            return client.get_string_table_size() == 16; }),
+                    "Bigger string table refused by the server");
+            }
+            if (i >= nb_events / 2)
+                plain_bytes += p.get_data().size();
+            client.send("entity", p);
+        }
+        ASSERT(wait_for([&]() { return received == nb_events; }),
+               "Events not received : " << received);
+        ASSERT(correct == nb_events, "Strings corrupted : "
+               << nb_events - correct << " events");
+        //Strings are compressed once replaced by their index
+        ASSERT(client.get_compression_stats().raw_bytes < plain_bytes * 3 / 4,
+               "Strings weren't replaced : "
+               << client.get_compression_stats().raw_bytes
+               << " bytes instead of " << plain_bytes);
+
+        //A frame that isn't sent doesn't leave its strings in the table
+        ByteArray noise(MAX_FRAME_SIZE);
+        std::mt19937 rng(42);
+        for (Byte& b : noise)
+            b = rng();
+        try
+        {
+            client.send("giant", make_packet(std::string("ogre"), Blob(noise)));
+            ASSERT(false, "A frame too large was sent");
+        }
+        catch(NetworkException& e)
+        {
+            ASSERT(e.get_type() == NetworkExceptionT::FrameTooLarge,
+                   "Wrong exception : " << e.what());
+        }
+        ASSERT(wait_for([&]() { return client.get_string_table_size() == 16; }),
+               "String table not renegotiated");
+        client.send("giant", make_packet(std::string("ogre")));
+        client.send("giant", make_packet(std::string("ogre")));
+        ASSERT(wait_for([&]() { return giants >= 2; }), "Events not received");
+        ASSERT(giants == 2, "String of an unsent frame used");
+
+        consumer.join();
+        client_listener.join();
+        server_listener.join();
+        client.disconnect();
+    }
+    catch(std::exception& e)
+    {
+        ASSERT(false, "An exception occured : " << e.what());
+    }
+
+    //HUGE SUCCESS :)
+    return EXIT_SUCCESS;
+}